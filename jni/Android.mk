@@ -7,11 +7,17 @@ LOCAL_C_INCLUDES := \
         $(LOCAL_PATH)/cxcore/include 
 LOCAL_CFLAGS := $(LOCAL_C_INCLUDES:%=-I%)
 LOCAL_LDLIBS := -L$(SYSROOT)/usr/lib -ldl
+# armeabi-v7a is compiled with -mfpu=neon, so the library then requires a CPU
+# with NEON: the compiler may use NEON instructions anywhere in the module
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+LOCAL_ARM_NEON := true
+endif
 
 LOCAL_SRC_FILES := \
         cxcore/src/cxalloc.cpp \
         cxcore/src/cxarithm.cpp \
         cxcore/src/cxarray.cpp \
+        cxcore/src/cxarrstats.cpp \
         cxcore/src/cxcmp.cpp \
         cxcore/src/cxconvert.cpp \
         cxcore/src/cxcopy.cpp \
@@ -53,6 +59,11 @@ LOCAL_C_INCLUDES := \
         $(LOCAL_PATH)/cv/include 
 LOCAL_CFLAGS := $(LOCAL_C_INCLUDES:%=-I%)
 LOCAL_LDLIBS := -L$(SYSROOT)/usr/lib -ldl
+# armeabi-v7a is compiled with -mfpu=neon, so the library then requires a CPU
+# with NEON: the compiler may use NEON instructions anywhere in the module
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+LOCAL_ARM_NEON := true
+endif
 
 LOCAL_SRC_FILES := \
         cv/src/cvaccum.cpp \
@@ -66,6 +77,7 @@ LOCAL_SRC_FILES := \
         cv/src/cvcanny.cpp \
         cv/src/cvcolor.cpp \
         cv/src/cvcondens.cpp \
+        cv/src/cvconncomp.cpp \
         cv/src/cvcontours.cpp \
         cv/src/cvcontourtree.cpp \
         cv/src/cvconvhull.cpp \
@@ -75,6 +87,7 @@ LOCAL_SRC_FILES := \
         cv/src/cvdistransform.cpp \
         cv/src/cvdominants.cpp \
         cv/src/cvemd.cpp \
+        cv/src/cvfast.cpp \
         cv/src/cvfeatureselect.cpp \
         cv/src/cvfilter.cpp \
         cv/src/cvfloodfill.cpp \
@@ -274,3 +287,4 @@ LOCAL_STATIC_LIBRARIES := cxcore cv cvaux cvml cvhighgui
 
 include $(BUILD_SHARED_LIBRARY)
 
+include $(LOCAL_PATH)/../tests/perf/Android.mk
@@ -76,6 +76,9 @@ CVAPI(void) cvCopyMakeBorder( const CvArr* src, CvArr* dst, CvPoint offset,
 #define CV_GAUSSIAN  2
 #define CV_MEDIAN 3
 #define CV_BILATERAL 4
+/* approximate bilateral filter (bilateral grid), the cost does not depend on sigma_space;
+   8uC1 and 8uC3 only, 32f images are processed with the exact CV_BILATERAL filter */
+#define CV_BILATERAL_GRID 5
 
 /* Smoothes array (removes noise) */
 CVAPI(void) cvSmooth( const CvArr* src, CvArr* dst,
@@ -264,11 +267,45 @@ CVAPI(void)  cvCvtColor( const CvArr* src, CvArr* dst, int code );
 
 #define  CV_WARP_FILL_OUTLIERS 8
 #define  CV_WARP_INVERSE_MAP  16
+/* cvWarpAffine/cvWarpPerspective of 8-bit images: tiled multi-threaded transformation
+   with coordinates rounded to 1/32 of pixel. Applies to CV_INTER_LINEAR only,
+   the flag is ignored with the other interpolation methods */
+#define  CV_WARP_FIXED_POINT  32
 
 /* Resizes image (input array is resized to fit the destination array) */
 CVAPI(void)  cvResize( const CvArr* src, CvArr* dst,
                        int interpolation CV_DEFAULT( CV_INTER_LINEAR ));
 
+/* Precomputed tables and buffers for resizing images of the given size and type
+   to the given size with the given interpolation method */
+typedef struct CvResizePlan
+{
+    CvSize src_size;
+    CvSize dst_size;
+    int type;
+    int interpolation;
+    int mode;       // the code path chosen for the parameters above
+
+    // bilinear interpolation tables (fixed-point coefficients)
+    int xmax;       // the first destination column that is not interpolated
+    int* xofs;      // source offset for each destination row element
+    int* yofs;      // source row for each destination row
+    short* xalpha;  // pair of horizontal coefficients for each row element
+    short* yalpha;  // pair of vertical coefficients for each row
+
+    // temporary buffers
+    int* buf;
+}
+CvResizePlan;
+
+CVAPI(CvResizePlan*) cvCreateResizePlan( CvSize src_size, CvSize dst_size, int type,
+                                         int interpolation CV_DEFAULT( CV_INTER_LINEAR ));
+
+CVAPI(void) cvReleaseResizePlan( CvResizePlan** plan );
+
+/* Resizes image using the plan created for the source and destination sizes and type */
+CVAPI(void)  cvResizeWithPlan( const CvArr* src, CvArr* dst, CvResizePlan* plan );
+
 /* Warps image with affine transform */ 
 CVAPI(void)  cvWarpAffine( const CvArr* src, CvArr* dst, const CvMat* map_matrix,
                            int flags CV_DEFAULT(CV_INTER_LINEAR+CV_WARP_FILL_OUTLIERS),
@@ -390,6 +427,44 @@ CVAPI(void)  cvGetQuadrangleSubPix( const CvArr* src, CvArr* dst,
 CVAPI(void)  cvMatchTemplate( const CvArr* image, const CvArr* templ,
                               CvArr* result, int method );
 
+/* Precomputed spectra of a set of templates matched against images of the given size */
+typedef struct CvMatchTemplatePlan
+{
+    CvSize img_size;
+    int type;
+    int method;
+    int count;              // number of templates
+    CvSize* templ_size;
+    CvSize dftsize;         // DFT size of an image tile, shared by all the templates
+    CvSize blocksize;       // size of the result tile computed from one image tile
+    CvMat** templ_dft;      // padded and scaled spectrum of every template, plane by plane
+    CvScalar* templ_mean;   // template statistics used by the normalized methods
+    double* templ_norm;
+    double* templ_sum2;
+
+    // temporary buffers
+    int nthreads;
+    CvMat** img_dft;        // spectrum of the current image tile of every thread
+    CvMat** prod;           // product of the spectra (and a temporary plane if cn > 1)
+    CvMat** split;          // split channels of the image tile if cn > 1
+    CvMat* sum;             // integral images of the source image
+    CvMat* sqsum;
+}
+CvMatchTemplatePlan;
+
+/* Computes the template spectra once so that the templates can be matched against
+   many images. All the templates must have the same type (8uC<n> or 32fC<n>) */
+CVAPI(CvMatchTemplatePlan*) cvCreateMatchTemplatePlan( CvSize img_size,
+                                    const CvArr** templs, int count, int method );
+
+CVAPI(void) cvReleaseMatchTemplatePlan( CvMatchTemplatePlan** plan );
+
+/* Matches all the templates of the plan against the image. The forward DFT of every
+   image tile is shared by all the templates. results[i] must be a 32fC1 array of
+   (W - w_i + 1)x(H - h_i + 1) size */
+CVAPI(void) cvMatchTemplateWithPlan( const CvArr* image, CvArr** results,
+                                     CvMatchTemplatePlan* plan );
+
 /* Computes earth mover distance between
    two weighted point sets (called signatures) */
 CVAPI(float)  cvCalcEMD2( const CvArr* signature1,
@@ -406,7 +481,21 @@ CVAPI(float)  cvCalcEMD2( const CvArr* signature1,
 \****************************************************************************************/
 
 /* Retrieves outer and optionally inner boundaries of white (non-zero) connected
-   components in the black (zero) background */
+   components in the black (zero) background.
+   With method = CV_LINK_RUNS the components and the hierarchy are the same as with
+   the other methods, but the contours themselves differ:
+   - every contour is a closed polygon of the end points of the horizontal runs
+     (the first and the last pixel of each run crossed by the boundary) rather than
+     a chain of all the boundary pixels; a one-pixel run gives two equal points;
+   - the outer contours start at the same top-left pixel but go in the opposite
+     direction, i.e. cvContourArea is positive for them and negative for the holes;
+   - a hole contour goes through the component pixels just left and right of the
+     hole in the hole rows only, it starts at the pixel right of the first hole run
+     and does not include the component pixels above and below the hole, so its
+     bounding rectangle is one row shorter at the top and at the bottom;
+   - the contours on the same level (the h_next lists) come in the raster order of
+     their first points, which is the reverse of the order of the other methods,
+     and with CV_RETR_LIST all the outer contours precede all the holes */
 CVAPI(int)  cvFindContours( CvArr* image, CvMemStorage* storage, CvSeq** first_contour,
                             int header_size CV_DEFAULT(sizeof(CvContour)),
                             int mode CV_DEFAULT(CV_RETR_LIST),
@@ -453,6 +542,14 @@ CVAPI(void) cvStartReadChainPoints( CvChain* chain, CvChainPtReader* reader );
 /* Retrieves the next chain point */
 CVAPI(CvPoint) cvReadChainPoint( CvChainPtReader* reader );
 
+/* Labels 4- or 8-connected components of non-zero pixels in a single pass
+   without tracing their contours. Returns the sequence of CvComponentStats
+   in the raster order of the components' first pixels; the optional 32-bit
+   label image gets 0 for the background and i+1 for the i-th component */
+CVAPI(CvSeq*) cvConnectedComponents( const CvArr* image, CvArr* labels,
+                                     CvMemStorage* storage,
+                                     int connectivity CV_DEFAULT(8) );
+
 
 /****************************************************************************************\
 *                                  Motion Analysis                                       *
@@ -910,6 +1007,13 @@ CVAPI(void)  cvCalcProbDensity( const CvHistogram* hist1, const CvHistogram* his
 /* equalizes histogram of 8-bit single-channel image */
 CVAPI(void)  cvEqualizeHist( const CvArr* src, CvArr* dst );
 
+/* contrast-limited adaptive histogram equalization (CLAHE) of 8-bit single-channel image;
+   tile_grid is the number of tiles, clip_limit is the maximum height of a histogram bin
+   relative to the average bin height (<=0 - no clipping) */
+CVAPI(void)  cvEqualizeHistAdaptive( const CvArr* src, CvArr* dst,
+                                     CvSize tile_grid CV_DEFAULT(cvSize(8,8)),
+                                     double clip_limit CV_DEFAULT(40) );
+
 
 #define  CV_VALUE  1
 #define  CV_ARRAY  2
@@ -936,6 +1040,34 @@ CVAPI(void)  cvDistTransform( const CvArr* src, CvArr* dst,
                               const float* mask CV_DEFAULT(NULL),
                               CvArr* labels CV_DEFAULT(NULL));
 
+/* Tables and per-thread buffers of the exact euclidean distance transform */
+typedef struct CvDistTransformPlan
+{
+    CvSize size;            // image size the plan is created for
+    float* col_sqr_tab;     // i*i for i < size.height, "infinity" for size.height <= i < 2*size.height
+    float* row_sqr_tab;     // i*i for i < size.width
+    float* inv_tab;         // 0.5/i for 0 < i < size.width
+
+    // temporary buffers
+    int nthreads;
+    int* buf;               // nthreads blocks of buf_step elements
+    int buf_step;
+}
+CvDistTransformPlan;
+
+CVAPI(CvDistTransformPlan*) cvCreateDistTransformPlan( CvSize size );
+
+CVAPI(void) cvReleaseDistTransformPlan( CvDistTransformPlan** plan );
+
+/* Computes the exact euclidean distance from every non-zero pixel of the 8uC1 image
+   to the nearest zero pixel (as cvDistTransform with CV_DIST_L2 and CV_DIST_MASK_PRECISE)
+   without allocating memory. The columns and then the rows are processed in parallel.
+   If labels (32sC1) is not NULL, it receives the index y*width + x of the nearest
+   zero pixel, or -1 if there are no zero pixels */
+CVAPI(void) cvDistTransformWithPlan( const CvArr* src, CvArr* dst,
+                                     CvDistTransformPlan* plan,
+                                     CvArr* labels CV_DEFAULT(NULL) );
+
 
 /* Types of thresholding */
 #define CV_THRESH_BINARY      0  /* value = value > threshold ? max_value : 0       */
@@ -956,10 +1088,14 @@ CVAPI(double)  cvThreshold( const CvArr*  src, CvArr*  dst,
 
 #define CV_ADAPTIVE_THRESH_MEAN_C  0
 #define CV_ADAPTIVE_THRESH_GAUSSIAN_C  1
+/* the same as CV_ADAPTIVE_THRESH_MEAN_C, but computed from running sums at a cost that
+   does not depend on the block size; near the image border the block is clipped
+   by the image instead of extrapolating the image pixels */
+#define CV_ADAPTIVE_THRESH_INTEGRAL_C  2
 
 /* Applies adaptive threshold to grayscale image.
-   The two parameters for methods CV_ADAPTIVE_THRESH_MEAN_C and
-   CV_ADAPTIVE_THRESH_GAUSSIAN_C are:
+   The two parameters for methods CV_ADAPTIVE_THRESH_MEAN_C,
+   CV_ADAPTIVE_THRESH_GAUSSIAN_C and CV_ADAPTIVE_THRESH_INTEGRAL_C are:
    neighborhood size (3, 5, 7 etc.),
    and a constant subtracted from mean (...,-3,-2,-1,0,1,2,3,...) */
 CVAPI(void)  cvAdaptiveThreshold( const CvArr* src, CvArr* dst, double max_value,
@@ -989,6 +1125,40 @@ CVAPI(void)  cvFloodFill( CvArr* image, CvPoint seed_point,
 CVAPI(void)  cvCanny( const CvArr* image, CvArr* edges, double threshold1,
                       double threshold2, int  aperture_size CV_DEFAULT(3) );
 
+/* Reusable buffers of the Canny edge detector */
+typedef struct CvCannyState
+{
+    CvSize size;        // image size the buffers are allocated for
+    int nbands;         // number of horizontal bands processed in parallel
+
+    // temporary buffers
+    uchar* map;         // (size.height+2) x (size.width+2) edge map with 1-pixel border
+    int mapstep;
+    int* mag;           // 3 rolling gradient magnitude rows per band
+    short* deriv;       // 3 rolling dx and dy rows per band
+    uchar*** band_stack;// stack of the strong edge pixels of each band, grows on overflow;
+                        // the stack of the first band is also the hysteresis stack
+    int* band_size;     // capacity of each band stack
+    int* band_count;    // number of strong edge pixels found in each band
+    int* band_row;      // first row of each band not processed yet; a band stops
+                        // early when its stack is full and resumes after it grows
+    CvMat* dx;          // full-size derivatives, allocated only for aperture_size > 3
+    CvMat* dy;
+}
+CvCannyState;
+
+/* Allocates the buffers for images of the given size. The gradient and
+   the non-maxima suppression are computed in <nbands> horizontal bands in parallel,
+   0 means one band per thread, 1 disables the parallel processing */
+CVAPI(CvCannyState*) cvCreateCannyState( CvSize size, int nbands CV_DEFAULT(0) );
+
+CVAPI(void) cvReleaseCannyState( CvCannyState** state );
+
+/* The same as cvCanny, but does not allocate memory */
+CVAPI(void) cvCannyWithState( const CvArr* image, CvArr* edges, double threshold1,
+                              double threshold2, CvCannyState* state,
+                              int aperture_size CV_DEFAULT(3) );
+
 /* Calculates constraint image for corner detection
    Dx^2 * Dyy + Dxx * Dy^2 - 2 * Dx * Dy * Dxy.
    Applying threshold to the result gives coordinates of corners */
@@ -1027,6 +1197,22 @@ CVAPI(void)  cvGoodFeaturesToTrack( const CvArr* image, CvArr* eig_image,
                                    int use_harris CV_DEFAULT(0),
                                    double k CV_DEFAULT(0.04) );
 
+#define CV_FAST_9   9
+#define CV_FAST_12  12
+
+/* Finds FAST corners: the pixels with an arc of at least 9 (CV_FAST_9) or 12 (CV_FAST_12)
+   contiguous pixels on the circle of radius 3 that are all brighter than the center
+   by more than <threshold> or all darker. The corners are scored by the largest threshold
+   they pass, suppressed in 3x3 neighborhoods and, if there are more than *corner_count
+   of them, selected uniformly over the image, strongest first. The corners closer than
+   min_distance to a stronger selected corner are skipped. The output can be passed
+   to cvFindCornerSubPix or cvCalcOpticalFlowPyrLK */
+CVAPI(void)  cvFASTFeatures( const CvArr* image, CvPoint2D32f* corners,
+                             int* corner_count, int threshold,
+                             int type CV_DEFAULT(CV_FAST_9),
+                             double min_distance CV_DEFAULT(0),
+                             const CvArr* mask CV_DEFAULT(NULL) );
+
 #define CV_HOUGH_STANDARD 0
 #define CV_HOUGH_PROBABILISTIC 1
 #define CV_HOUGH_MULTI_SCALE 2
@@ -1104,6 +1290,8 @@ typedef struct CvSURFParams
 
     int nOctaves;
     int nOctaveLayers;
+
+    int upright; /* if non-zero, the orientation is not estimated (dir = 0) */
 }
 CvSURFParams;
 
@@ -1112,6 +1300,14 @@ CVAPI(void) cvExtractSURF( const CvArr* img, const CvArr* mask,
                            CvSeq** keypoints, CvSeq** descriptors,
                            CvMemStorage* storage, CvSURFParams params );
 
+/* the same as cvExtractSURF, but uses the integral image <sum> of <img>
+   (32sC1, (img->rows+1) x (img->cols+1), as computed by cvIntegral) instead of
+   computing it, so that it can be shared with e.g. the Haar classifier cascade.
+   If sum is NULL, it is computed internally */
+CVAPI(void) cvExtractSURFFromIntegral( const CvArr* img, const CvArr* sum,
+                           const CvArr* mask, CvSeq** keypoints, CvSeq** descriptors,
+                           CvMemStorage* storage, CvSURFParams params );
+
 /****************************************************************************************\
 *                         Haar-like Object Detection functions                           *
 \****************************************************************************************/
@@ -1427,6 +1623,14 @@ CVAPI(void) cvReleaseStereoBMState( CvStereoBMState** state );
 CVAPI(void) cvFindStereoCorrespondenceBM( const CvArr* left, const CvArr* right,
                                           CvArr* disparity, CvStereoBMState* state );
 
+/* Updates the disparity map computed by the previous call with the same state, parameters
+   and image size after the images have changed within changed_rect. Only the rows
+   affected by the change are recomputed. Falls back to cvFindStereoCorrespondenceBM
+   when the state has no pre-filtered images of that size */
+CVAPI(void) cvUpdateStereoCorrespondenceBM( const CvArr* left, const CvArr* right,
+                                            CvArr* disparity, CvStereoBMState* state,
+                                            CvRect changed_rect );
+
 /* Kolmogorov-Zabin stereo-correspondence algorithm (a.k.a. KZ1) */
 #define CV_STEREO_GC_OCCLUDED  SHRT_MAX
 
@@ -1448,6 +1652,16 @@ typedef struct CvStereoGCState
     CvMat* ptrRight;
     CvMat* vtxBuf;
     CvMat* edgeBuf;
+
+    // tiled mode: the image is split into tiles of tileWidth x tileHeight pixels,
+    // which are solved independently and in parallel. 0 (default) means one graph
+    // for the whole image
+    int tileWidth;
+    int tileHeight;
+    int tileOverlap;    // context added around each tile; the disparity range
+                        // is added to the left and right margins as well
+    int tileBufSize;    // [out] size of the graph buffers of one tile, in bytes
+    CvMat* tileBuf;     // graph buffers of the threads in the tiled mode
 }
 CvStereoGCState;
 
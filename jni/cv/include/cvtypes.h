@@ -75,6 +75,15 @@ typedef struct CvConnectedComp
 }
 CvConnectedComp;
 
+/* Statistics of a connected component found by cvConnectedComponents */
+typedef struct CvComponentStats
+{
+    int area;               /* number of pixels */
+    CvRect rect;            /* bounding box */
+    CvPoint2D32f centroid;  /* mean of the pixel coordinates */
+}
+CvComponentStats;
+
 /*
 Internal structure that is used for sequental retrieving contours from the image.
 It supports both hierarchical and plane variants of Suzuki algorithm.
@@ -93,6 +102,9 @@ typedef struct _CvContourScanner* CvContourScanner;
 #define CV_CHAIN_APPROX_SIMPLE      2
 #define CV_CHAIN_APPROX_TC89_L1     3
 #define CV_CHAIN_APPROX_TC89_KCOS   4
+/* links the runs of non-zero pixels without copying the image; the contours consist
+   of the run end points, all the retrieval modes are supported (see cvFindContours
+   for how the result differs from the other methods) */
 #define CV_LINK_RUNS                5
 
 /* Freeman chain reader state */
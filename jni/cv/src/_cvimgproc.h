@@ -71,6 +71,10 @@ typedef CvStatus (CV_STDCALL * CvFilterFixedIPPFunc)
 #define CV_END     2
 #define CV_MIDDLE  4
 
+/* finds the runs of non-zero pixels in the 8-bit row: the start and the end (exclusive)
+   of the i-th run are written to runs[i*runstep] and runs[i*runstep+1] */
+int icvFindRuns_8u( const uchar* src, int width, int* runs, int runstep );
+
 void
 icvCrossCorr( const CvArr* _img, const CvArr* _templ,
               CvArr* _corr, CvPoint anchor=cvPoint(0,0) );
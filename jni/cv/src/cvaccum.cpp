@@ -396,10 +396,10 @@ cvAcc( const void* arr, void* sumarr, const void* maskarr )
     CvMat sumstub, *sum = (CvMat*)sumarr;
     CvMat maskstub, *mask = (CvMat*)maskarr;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitAddTable( &acc_tab, &accmask_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT( mat ) || !CV_IS_MAT( sum ))
@@ -498,10 +498,10 @@ cvSquareAcc( const void* arr, void* sq_sum, const void* maskarr )
     CvMat sumstub, *sum = (CvMat*)sq_sum;
     CvMat maskstub, *mask = (CvMat*)maskarr;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitAddSquareTable( &acc_tab, &accmask_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     CV_CALL( mat = cvGetMat( mat, &stub, &coi1 ));
@@ -596,10 +596,10 @@ cvMultiplyAcc( const void* arrA, const void* arrB,
     CvMat sumstub, *sum = (CvMat*)acc;
     CvMat maskstub, *mask = (CvMat*)maskarr;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitAddProductTable( &acc_tab, &accmask_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     CV_CALL( mat1 = cvGetMat( mat1, &stub1, &coi1 ));
@@ -706,10 +706,10 @@ cvRunningAvg( const void* arrY, void* arrU,
     CvMat sumstub, *sum = (CvMat*)arrU;
     CvMat maskstub, *mask = (CvMat*)maskarr;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitAddWeightedTable( &acc_tab, &accmask_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     CV_CALL( mat = cvGetMat( mat, &stub, &coi1 ));
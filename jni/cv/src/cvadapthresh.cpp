@@ -100,6 +100,360 @@ icvAdaptiveThreshold_MeanC( const CvMat* src, CvMat* dst, int method,
 }
 
 
+
+/* CV_ADAPTIVE_THRESH_INTEGRAL_C: the block sums are taken from the running column sums
+   and their prefix sums, so the cost per pixel does not depend on the block size.
+   The products (pixel + delta)*area must fit into int, which limits the block area.
+   The prefix sums of a row may exceed INT_MAX, so they are unsigned: they wrap
+   modulo 2^32, which cancels in the difference of two of them, and the block sums
+   themselves are below 256*ICV_ADAPTIVE_MAX_AREA */
+#define ICV_ADAPTIVE_MAX_AREA  (1 << 22)
+
+typedef void (*CvAccColumnSumsFunc)( int* colsum, const uchar* src, int width, int sub );
+typedef void (*CvAdaptiveThresholdInnerFunc)( const uchar* s, const unsigned* sum0,
+                                              const unsigned* sum1,
+                                              uchar* d, int len, int area, int idelta,
+                                              int inv, uchar maxval );
+
+typedef struct CvAdaptiveIntegralParams
+{
+    const CvMat* src;
+    CvMat* dst;
+    int radius;
+    int idelta;         // clipped to [-256,256], which does not change the result
+    int inv;            // CV_THRESH_BINARY_INV
+    uchar max_value;
+    int* buf;           // width*2 + 1 ints per thread
+    CvAccColumnSumsFunc acc_colsums;
+    CvAdaptiveThresholdInnerFunc threshold_inner;
+}
+CvAdaptiveIntegralParams;
+
+
+/* colsum[x] += src[x] or, if sub != 0, colsum[x] -= src[x] */
+static void
+icvAccColumnSums_C( int* colsum, const uchar* src, int width, int sub )
+{
+    int x;
+
+    if( !sub )
+        for( x = 0; x < width; x++ )
+            colsum[x] += src[x];
+    else
+        for( x = 0; x < width; x++ )
+            colsum[x] -= src[x];
+}
+
+/* Thresholds len pixels, which blocks have the same area: sum0 and sum1 point
+   to the prefix sums at the left and the right block borders */
+static void
+icvAdaptiveThresholdInner_C( const uchar* s, const unsigned* sum0, const unsigned* sum1,
+                             uchar* d, int len, int area, int idelta, int inv, uchar maxval )
+{
+    int x;
+
+    for( x = 0; x < len; x++ )
+    {
+        int t = (s[x] + idelta)*area > (int)(sum1[x] - sum0[x]);
+        d[x] = (uchar)(t != inv ? maxval : 0);
+    }
+}
+
+#if CV_SSE2
+
+static void
+icvAccColumnSums_SSE2( int* colsum, const uchar* src, int width, int sub )
+{
+    __m128i z = _mm_setzero_si128();
+    int x = 0;
+
+    for( ; x <= width - 16; x += 16 )
+    {
+        __m128i v = _mm_loadu_si128( (const __m128i*)(src + x) );
+        __m128i lo = _mm_unpacklo_epi8( v, z ), hi = _mm_unpackhi_epi8( v, z );
+        __m128i v0 = _mm_unpacklo_epi16( lo, z ), v1 = _mm_unpackhi_epi16( lo, z );
+        __m128i v2 = _mm_unpacklo_epi16( hi, z ), v3 = _mm_unpackhi_epi16( hi, z );
+        __m128i* c = (__m128i*)(colsum + x);
+        if( !sub )
+        {
+            _mm_storeu_si128( c, _mm_add_epi32( _mm_loadu_si128( c ), v0 ));
+            _mm_storeu_si128( c + 1, _mm_add_epi32( _mm_loadu_si128( c + 1 ), v1 ));
+            _mm_storeu_si128( c + 2, _mm_add_epi32( _mm_loadu_si128( c + 2 ), v2 ));
+            _mm_storeu_si128( c + 3, _mm_add_epi32( _mm_loadu_si128( c + 3 ), v3 ));
+        }
+        else
+        {
+            _mm_storeu_si128( c, _mm_sub_epi32( _mm_loadu_si128( c ), v0 ));
+            _mm_storeu_si128( c + 1, _mm_sub_epi32( _mm_loadu_si128( c + 1 ), v1 ));
+            _mm_storeu_si128( c + 2, _mm_sub_epi32( _mm_loadu_si128( c + 2 ), v2 ));
+            _mm_storeu_si128( c + 3, _mm_sub_epi32( _mm_loadu_si128( c + 3 ), v3 ));
+        }
+    }
+
+    icvAccColumnSums_C( colsum + x, src + x, width - x, sub );
+}
+
+/* low 32 bits of the 32x32-bit products (SSE2 has no _mm_mullo_epi32) */
+CV_INLINE __m128i
+icvMulLo32( __m128i a, __m128i b )
+{
+    __m128i t0 = _mm_mul_epu32( a, b );
+    __m128i t1 = _mm_mul_epu32( _mm_srli_si128( a, 4 ), _mm_srli_si128( b, 4 ));
+    return _mm_unpacklo_epi32( _mm_shuffle_epi32( t0, _MM_SHUFFLE(0,0,2,0) ),
+                               _mm_shuffle_epi32( t1, _MM_SHUFFLE(0,0,2,0) ));
+}
+
+static void
+icvAdaptiveThresholdInner_SSE2( const uchar* s, const unsigned* sum0, const unsigned* sum1,
+                                uchar* d, int len, int area, int idelta, int inv, uchar maxval )
+{
+    __m128i z = _mm_setzero_si128(), varea = _mm_set1_epi32(area);
+    __m128i vdelta = _mm_set1_epi16((short)idelta), vmax = _mm_set1_epi8((char)maxval);
+    __m128i vinv = _mm_set1_epi8((char)(inv ? -1 : 0));
+    int x = 0;
+
+    for( ; x <= len - 16; x += 16 )
+    {
+        __m128i v = _mm_loadu_si128( (const __m128i*)(s + x) );
+        __m128i lo = _mm_add_epi16( _mm_unpacklo_epi8( v, z ), vdelta );
+        __m128i hi = _mm_add_epi16( _mm_unpackhi_epi8( v, z ), vdelta );
+        __m128i m0, m1, m2, m3;
+        #define ICV_ADAPTIVE_CMP_SSE2( v16, unpack, k )                         \
+            _mm_cmpgt_epi32( icvMulLo32( _mm_srai_epi32( unpack( v16, v16 ), 16 ), varea ),\
+                _mm_sub_epi32( _mm_loadu_si128( (const __m128i*)(sum1 + x + k) ),  \
+                               _mm_loadu_si128( (const __m128i*)(sum0 + x + k) )))
+        m0 = ICV_ADAPTIVE_CMP_SSE2( lo, _mm_unpacklo_epi16, 0 );
+        m1 = ICV_ADAPTIVE_CMP_SSE2( lo, _mm_unpackhi_epi16, 4 );
+        m2 = ICV_ADAPTIVE_CMP_SSE2( hi, _mm_unpacklo_epi16, 8 );
+        m3 = ICV_ADAPTIVE_CMP_SSE2( hi, _mm_unpackhi_epi16, 12 );
+        #undef ICV_ADAPTIVE_CMP_SSE2
+        m0 = _mm_packs_epi16( _mm_packs_epi32( m0, m1 ), _mm_packs_epi32( m2, m3 ));
+        _mm_storeu_si128( (__m128i*)(d + x), _mm_and_si128( _mm_xor_si128( m0, vinv ), vmax ));
+    }
+
+    icvAdaptiveThresholdInner_C( s + x, sum0 + x, sum1 + x, d + x, len - x,
+                                 area, idelta, inv, maxval );
+}
+
+#endif
+
+#if CV_NEON
+
+static void
+icvAccColumnSums_NEON( int* colsum, const uchar* src, int width, int sub )
+{
+    int x = 0;
+
+    for( ; x <= width - 16; x += 16 )
+    {
+        uint8x16_t v = vld1q_u8( src + x );
+        uint16x8_t lo = vmovl_u8( vget_low_u8(v) ), hi = vmovl_u8( vget_high_u8(v) );
+        int32x4_t v0 = vreinterpretq_s32_u32( vmovl_u16( vget_low_u16(lo) ));
+        int32x4_t v1 = vreinterpretq_s32_u32( vmovl_u16( vget_high_u16(lo) ));
+        int32x4_t v2 = vreinterpretq_s32_u32( vmovl_u16( vget_low_u16(hi) ));
+        int32x4_t v3 = vreinterpretq_s32_u32( vmovl_u16( vget_high_u16(hi) ));
+        int* c = colsum + x;
+        if( !sub )
+        {
+            vst1q_s32( c, vaddq_s32( vld1q_s32( c ), v0 ));
+            vst1q_s32( c + 4, vaddq_s32( vld1q_s32( c + 4 ), v1 ));
+            vst1q_s32( c + 8, vaddq_s32( vld1q_s32( c + 8 ), v2 ));
+            vst1q_s32( c + 12, vaddq_s32( vld1q_s32( c + 12 ), v3 ));
+        }
+        else
+        {
+            vst1q_s32( c, vsubq_s32( vld1q_s32( c ), v0 ));
+            vst1q_s32( c + 4, vsubq_s32( vld1q_s32( c + 4 ), v1 ));
+            vst1q_s32( c + 8, vsubq_s32( vld1q_s32( c + 8 ), v2 ));
+            vst1q_s32( c + 12, vsubq_s32( vld1q_s32( c + 12 ), v3 ));
+        }
+    }
+
+    icvAccColumnSums_C( colsum + x, src + x, width - x, sub );
+}
+
+static void
+icvAdaptiveThresholdInner_NEON( const uchar* s, const unsigned* sum0, const unsigned* sum1,
+                                uchar* d, int len, int area, int idelta, int inv, uchar maxval )
+{
+    int32x4_t varea = vdupq_n_s32(area);
+    int16x8_t vdelta = vdupq_n_s16((short)idelta);
+    uint8x16_t vmax = vdupq_n_u8(maxval), vinv = vdupq_n_u8(inv ? 255 : 0);
+    int x = 0;
+
+    for( ; x <= len - 16; x += 16 )
+    {
+        uint8x16_t v = vld1q_u8( s + x );
+        int16x8_t lo = vaddq_s16( vreinterpretq_s16_u16( vmovl_u8( vget_low_u8(v) )), vdelta );
+        int16x8_t hi = vaddq_s16( vreinterpretq_s16_u16( vmovl_u8( vget_high_u8(v) )), vdelta );
+        uint32x4_t m0, m1, m2, m3;
+        uint8x16_t m;
+        #define ICV_ADAPTIVE_CMP_NEON( v16, k )                                 \
+            vcgtq_s32( vmulq_s32( vmovl_s16( v16 ), varea ), vreinterpretq_s32_u32( \
+                       vsubq_u32( vld1q_u32( sum1 + x + k ), vld1q_u32( sum0 + x + k ))))
+        m0 = ICV_ADAPTIVE_CMP_NEON( vget_low_s16(lo), 0 );
+        m1 = ICV_ADAPTIVE_CMP_NEON( vget_high_s16(lo), 4 );
+        m2 = ICV_ADAPTIVE_CMP_NEON( vget_low_s16(hi), 8 );
+        m3 = ICV_ADAPTIVE_CMP_NEON( vget_high_s16(hi), 12 );
+        #undef ICV_ADAPTIVE_CMP_NEON
+        m = vcombine_u8( vmovn_u16( vcombine_u16( vmovn_u32(m0), vmovn_u32(m1) )),
+                         vmovn_u16( vcombine_u16( vmovn_u32(m2), vmovn_u32(m3) )));
+        vst1q_u8( d + x, vandq_u8( veorq_u8( m, vinv ), vmax ));
+    }
+
+    icvAdaptiveThresholdInner_C( s + x, sum0 + x, sum1 + x, d + x, len - x,
+                                 area, idelta, inv, maxval );
+}
+
+#endif
+
+static const CvDispatchVariant icvAccColumnSums_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvAccColumnSums_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvAccColumnSums_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvAccColumnSums_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvAdaptiveThresholdInner_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvAdaptiveThresholdInner_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvAdaptiveThresholdInner_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvAdaptiveThresholdInner_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvAccColumnSums_entry =
+    CV_DISPATCH_ENTRY( "cvAdaptiveThreshold_colsums", icvAccColumnSums_variants );
+static CvDispatchEntry icvAdaptiveThresholdInner_entry =
+    CV_DISPATCH_ENTRY( "cvAdaptiveThreshold_integral", icvAdaptiveThresholdInner_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvAccColumnSums_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvAdaptiveThresholdInner_entry );
+
+
+/* Thresholds the rows [start,end). A pixel is compared with the mean of the block
+   clipped by the image: (src + delta)*area > sum for CV_THRESH_BINARY */
+static void CV_CDECL
+icvAdaptiveThresholdIntegralBody( int start, int end, void* userdata )
+{
+    const CvAdaptiveIntegralParams* p = (const CvAdaptiveIntegralParams*)userdata;
+    const CvMat* src = p->src;
+    int width = src->cols, height = src->rows, r = p->radius;
+    int idelta = p->idelta, inv = p->inv;
+    uchar maxval = p->max_value;
+    int* colsum = p->buf + cvGetThreadNum()*(width*2 + 1);
+    unsigned* sum = (unsigned*)(colsum + width);
+    int x, y;
+
+    memset( colsum, 0, width*sizeof(colsum[0]) );
+    for( y = MAX( start - r, 0 ); y < MIN( start + r, height ); y++ )
+        p->acc_colsums( colsum, src->data.ptr + src->step*y, width, 0 );
+
+    for( y = start; y < end; y++ )
+    {
+        const uchar* s = src->data.ptr + src->step*y;
+        uchar* d = p->dst->data.ptr + p->dst->step*y;
+        int rows = MIN( y + r, height - 1 ) - MAX( y - r, 0 ) + 1;
+        int xl = MIN( r, width ), xr = MAX( width - r, xl );
+
+        if( y + r < height )
+            p->acc_colsums( colsum, src->data.ptr + src->step*(y + r), width, 0 );
+
+        sum[0] = 0;
+        for( x = 0; x < width; x++ )
+            sum[x+1] = sum[x] + (unsigned)colsum[x];
+
+        // the blocks clipped by the left and the right image borders
+        for( x = 0; x < width; x++ )
+        {
+            int x0, x1, t;
+            if( x == xl )
+                x = xr;
+            if( x >= width )
+                break;
+            x0 = MAX( x - r, 0 );
+            x1 = MIN( x + r + 1, width );
+            t = (s[x] + idelta)*(x1 - x0)*rows > (int)(sum[x1] - sum[x0]);
+            d[x] = (uchar)(t != inv ? maxval : 0);
+        }
+
+        // the inner part, where the block area is the same for all the pixels
+        p->threshold_inner( s + xl, sum + xl - r, sum + xl + r + 1, d + xl, xr - xl,
+                            (r*2 + 1)*rows, idelta, inv, maxval );
+
+        if( y - r >= 0 )
+            p->acc_colsums( colsum, src->data.ptr + src->step*(y - r), width, 1 );
+    }
+}
+
+
+static void
+icvAdaptiveThreshold_IntegralC( const CvMat* src, CvMat* dst, int maxValue,
+                                int type, int size, double delta )
+{
+    CvMat* temp = 0;
+    CV_FUNCNAME( "icvAdaptiveThreshold_IntegralC" );
+
+    __BEGIN__;
+
+    CvAdaptiveIntegralParams p;
+    int idelta = type == CV_THRESH_BINARY ? cvCeil(delta) : cvFloor(delta);
+    int nthreads = cvGetNumThreads(), r = size/2;
+
+    if( size <= 1 || (size&1) == 0 )
+        CV_ERROR( CV_StsOutOfRange, "Neighborhood size must be >=3 and odd (3, 5, 7, ...)" );
+
+    if( CV_MAT_TYPE(src->type) != CV_8UC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "Only 8-bit single-channel images are supported" );
+
+    if( maxValue < 0 )
+    {
+        CV_CALL( cvSetZero( dst ));
+        EXIT;
+    }
+
+    if( (double)MIN( size, src->cols )*MIN( size, src->rows ) > ICV_ADAPTIVE_MAX_AREA )
+    {
+        CV_CALL( icvAdaptiveThreshold_MeanC( src, dst, CV_ADAPTIVE_THRESH_MEAN_C,
+                                             maxValue, type, size, delta ));
+        EXIT;
+    }
+
+    // the source rows are read up to block_size/2 rows ahead and behind,
+    // so the in-place operation needs a copy
+    if( src->data.ptr == dst->data.ptr )
+    {
+        CV_CALL( temp = cvCloneMat( src ));
+        src = temp;
+    }
+
+    p.src = src;
+    p.dst = dst;
+    p.radius = r;
+    p.idelta = MAX( MIN( idelta, 256 ), -256 );
+    p.inv = type == CV_THRESH_BINARY_INV;
+    p.max_value = (uchar)MIN( maxValue, 255 );
+    CV_CALL( p.buf = (int*)cvAlloc( nthreads*(src->cols*2 + 1)*sizeof(p.buf[0]) ));
+    p.acc_colsums = (CvAccColumnSumsFunc)cvGetDispatchFunc( &icvAccColumnSums_entry );
+    p.threshold_inner =
+        (CvAdaptiveThresholdInnerFunc)cvGetDispatchFunc( &icvAdaptiveThresholdInner_entry );
+
+    // each stripe starts with summing up the block rows
+    cvParallelFor( src->rows, icvAdaptiveThresholdIntegralBody, &p, MAX( size*2, 16 ));
+
+    cvFree( &p.buf );
+
+    __END__;
+
+    cvReleaseMat( &temp );
+}
+
 CV_IMPL void
 cvAdaptiveThreshold( const void *srcIm, void *dstIm, double maxValue,
                      int method, int type, int blockSize, double param1 )
@@ -134,6 +488,10 @@ cvAdaptiveThreshold( const void *srcIm, void *dstIm, double maxValue,
         CV_CALL( icvAdaptiveThreshold_MeanC( src, dst, method, cvRound(maxValue),type,
                                              blockSize, param1 ));
         break;
+    case CV_ADAPTIVE_THRESH_INTEGRAL_C:
+        CV_CALL( icvAdaptiveThreshold_IntegralC( src, dst, cvRound(maxValue), type,
+                                                 blockSize, param1 ));
+        break;
     default:
         CV_ERROR( CV_BADCOEF_ERR, "" );
     }
@@ -39,104 +39,380 @@
 //
 //M*/
 
+
 #include "_cv.h"
 
 icvCannyGetSize_t icvCannyGetSize_p = 0;
 icvCanny_16s8u_C1R_t icvCanny_16s8u_C1R_p = 0;
 
-CV_IMPL void
-cvCanny( const void* srcarr, void* dstarr,
-         double low_thresh, double high_thresh, int aperture_size )
+/* the bands are not made thinner than that */
+#define ICV_CANNY_MIN_BAND_HEIGHT 16
+
+#define CANNY_SHIFT 15
+#define TG22  (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5)
+
+CV_INLINE int
+icvCannyMagnitude( int vx, int vy, int l2 )
 {
-    CvMat *dx = 0, *dy = 0;
-    void *buffer = 0;
-    uchar **stack_top, **stack_bottom = 0;
+    Cv32suf m;
+    if( !l2 )
+        return abs(vx) + abs(vy);
+    m.f = (float)sqrt((double)vx*vx + (double)vy*vy);
+    return m.i;
+}
 
-    CV_FUNCNAME( "cvCanny" );
+typedef void (*CvCannyDerivRowFunc)( const uchar* r0, const uchar* r1, const uchar* r2,
+                                     int width, short* dx, short* dy, int* mag, int l2 );
+typedef void (*CvCannyWeakBlocksFunc)( const int* mag, int nblocks, int low, uchar* weak );
+typedef void (*CvCannyOutputRowFunc)( const uchar* map, uchar* dst, int width );
 
-    __BEGIN__;
+/* The scalar part of icvCannyDerivRow_3x3: the pixels [x, width-1) and the first
+   and the last pixels with the replicated border */
+static void
+icvCannyDerivRowTail( const uchar* r0, const uchar* r1, const uchar* r2, int width,
+                      short* dx, short* dy, int* mag, int l2, int x )
+{
+    int last = width - 1;
 
-    CvMat srcstub, *src = (CvMat*)srcarr;
-    CvMat dststub, *dst = (CvMat*)dstarr;
-    CvSize size;
-    int flags = aperture_size;
-    int low, high;
-    int* mag_buf[3];
-    uchar* map;
-    int mapstep, maxsize;
-    int i, j;
-    CvMat mag_row;
+    for( ; x < last; x++ )
+    {
+        int vx = (r0[x+1] - r0[x-1]) + (r1[x+1] - r1[x-1])*2 + (r2[x+1] - r2[x-1]);
+        int vy = (r2[x-1] + r2[x]*2 + r2[x+1]) - (r0[x-1] + r0[x]*2 + r0[x+1]);
+        dx[x] = (short)vx;
+        dy[x] = (short)vy;
+        mag[x] = icvCannyMagnitude( vx, vy, l2 );
+    }
 
-    CV_CALL( src = cvGetMat( src, &srcstub ));
-    CV_CALL( dst = cvGetMat( dst, &dststub ));
+    for( x = 0; x <= last; x += MAX( last, 1 ))
+    {
+        int xl = MAX( x - 1, 0 ), xr = MIN( x + 1, last );
+        int vx = (r0[xr] - r0[xl]) + (r1[xr] - r1[xl])*2 + (r2[xr] - r2[xl]);
+        int vy = (r2[xl] + r2[x]*2 + r2[xr]) - (r0[xl] + r0[x]*2 + r0[xr]);
+        dx[x] = (short)vx;
+        dy[x] = (short)vy;
+        mag[x] = icvCannyMagnitude( vx, vy, l2 );
+    }
+}
 
-    if( CV_MAT_TYPE( src->type ) != CV_8UC1 ||
-        CV_MAT_TYPE( dst->type ) != CV_8UC1 )
-        CV_ERROR( CV_StsUnsupportedFormat, "" );
+/* Computes 3x3 Sobel derivatives of the row r1 (r0 and r2 are the neighbor rows,
+   the border is replicated) together with the gradient magnitude.
+   The magnitude is |dx|+|dy| or, if l2 != 0, the float sqrt(dx*dx+dy*dy)
+   stored as int bits (non-negative floats compare the same way as ints) */
+static void
+icvCannyDerivRow_3x3_C( const uchar* r0, const uchar* r1, const uchar* r2, int width,
+                        short* dx, short* dy, int* mag, int l2 )
+{
+    icvCannyDerivRowTail( r0, r1, r2, width, dx, dy, mag, l2, 1 );
+}
 
-    if( !CV_ARE_SIZES_EQ( src, dst ))
-        CV_ERROR( CV_StsUnmatchedSizes, "" );
+/* weak[k] = 1 if all the 8 magnitudes of the block k are not above low */
+static void
+icvCannyWeakBlocks_C( const int* mag, int nblocks, int low, uchar* weak )
+{
+    int k;
 
-    if( low_thresh > high_thresh )
+    for( k = 0; k < nblocks; k++, mag += 8 )
+        weak[k] = (uchar)(mag[0] <= low && mag[1] <= low && mag[2] <= low &&
+                          mag[3] <= low && mag[4] <= low && mag[5] <= low &&
+                          mag[6] <= low && mag[7] <= low);
+}
+
+static void
+icvCannyOutputRow_C( const uchar* map, uchar* dst, int width )
+{
+    int j;
+
+    for( j = 0; j < width; j++ )
+        dst[j] = (uchar)-(map[j] >> 1);
+}
+
+#if CV_SSE2
+
+static void
+icvCannyDerivRow_3x3_SSE2( const uchar* r0, const uchar* r1, const uchar* r2, int width,
+                           short* dx, short* dy, int* mag, int l2 )
+{
+    __m128i z = _mm_setzero_si128();
+    int x = 1;
+
+    for( ; x <= width - 9; x += 8 )
     {
-        double t;
-        CV_SWAP( low_thresh, high_thresh, t );
+        __m128i a0 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(r0 + x - 1) ), z );
+        __m128i b0 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(r0 + x) ), z );
+        __m128i c0 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(r0 + x + 1) ), z );
+        __m128i a1 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(r1 + x - 1) ), z );
+        __m128i c1 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(r1 + x + 1) ), z );
+        __m128i a2 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(r2 + x - 1) ), z );
+        __m128i b2 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(r2 + x) ), z );
+        __m128i c2 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(r2 + x + 1) ), z );
+        __m128i vx = _mm_add_epi16( _mm_add_epi16( _mm_sub_epi16( c0, a0 ), _mm_sub_epi16( c2, a2 )),
+                                    _mm_slli_epi16( _mm_sub_epi16( c1, a1 ), 1 ));
+        __m128i vy = _mm_sub_epi16(
+            _mm_add_epi16( _mm_add_epi16( a2, c2 ), _mm_slli_epi16( b2, 1 )),
+            _mm_add_epi16( _mm_add_epi16( a0, c0 ), _mm_slli_epi16( b0, 1 )));
+        _mm_storeu_si128( (__m128i*)(dx + x), vx );
+        _mm_storeu_si128( (__m128i*)(dy + x), vy );
+
+        if( !l2 )
+        {
+            __m128i m = _mm_add_epi16( _mm_max_epi16( vx, _mm_sub_epi16( z, vx )),
+                                       _mm_max_epi16( vy, _mm_sub_epi16( z, vy )));
+            _mm_storeu_si128( (__m128i*)(mag + x), _mm_unpacklo_epi16( m, z ));
+            _mm_storeu_si128( (__m128i*)(mag + x + 4), _mm_unpackhi_epi16( m, z ));
+        }
+        else
+        {
+            // dx*dx + dy*dy < 2^24 is converted to float exactly, and the single-precision
+            // square root gives the same result as the rounded double-precision one
+            __m128i lo = _mm_unpacklo_epi16( vx, vy ), hi = _mm_unpackhi_epi16( vx, vy );
+            __m128 m0 = _mm_sqrt_ps( _mm_cvtepi32_ps( _mm_madd_epi16( lo, lo )));
+            __m128 m1 = _mm_sqrt_ps( _mm_cvtepi32_ps( _mm_madd_epi16( hi, hi )));
+            _mm_storeu_si128( (__m128i*)(mag + x), _mm_castps_si128( m0 ));
+            _mm_storeu_si128( (__m128i*)(mag + x + 4), _mm_castps_si128( m1 ));
+        }
     }
 
-    aperture_size &= INT_MAX;
-    if( (aperture_size & 1) == 0 || aperture_size < 3 || aperture_size > 7 )
-        CV_ERROR( CV_StsBadFlag, "" );
+    icvCannyDerivRowTail( r0, r1, r2, width, dx, dy, mag, l2, x );
+}
 
-    size = cvGetMatSize( src );
+static void
+icvCannyWeakBlocks_SSE2( const int* mag, int nblocks, int low, uchar* weak )
+{
+    __m128i vlow = _mm_set1_epi32(low);
+    int k;
+
+    for( k = 0; k < nblocks; k++, mag += 8 )
+    {
+        __m128i t = _mm_or_si128(
+            _mm_cmpgt_epi32( _mm_loadu_si128( (const __m128i*)mag ), vlow ),
+            _mm_cmpgt_epi32( _mm_loadu_si128( (const __m128i*)(mag + 4) ), vlow ));
+        weak[k] = (uchar)(_mm_movemask_epi8( t ) == 0);
+    }
+}
 
-    dx = cvCreateMat( size.height, size.width, CV_16SC1 );
-    dy = cvCreateMat( size.height, size.width, CV_16SC1 );
-    cvSobel( src, dx, 1, 0, aperture_size );
-    cvSobel( src, dy, 0, 1, aperture_size );
+static void
+icvCannyOutputRow_SSE2( const uchar* map, uchar* dst, int width )
+{
+    __m128i two = _mm_set1_epi8(2);
+    int j = 0;
 
-    if( icvCannyGetSize_p && icvCanny_16s8u_C1R_p && !(flags & CV_CANNY_L2_GRADIENT) )
+    for( ; j <= width - 16; j += 16 )
+        _mm_storeu_si128( (__m128i*)(dst + j), _mm_cmpeq_epi8(
+            _mm_loadu_si128( (const __m128i*)(map + j) ), two ));
+
+    icvCannyOutputRow_C( map + j, dst + j, width - j );
+}
+
+#endif
+
+#if CV_NEON
+
+static void
+icvCannyDerivRow_3x3_NEON( const uchar* r0, const uchar* r1, const uchar* r2, int width,
+                           short* dx, short* dy, int* mag, int l2 )
+{
+    int x = 1;
+
+    for( ; x <= width - 9; x += 8 )
     {
-        int buf_size=  0;
-        IPPI_CALL( icvCannyGetSize_p( size, &buf_size ));
-        CV_CALL( buffer = cvAlloc( buf_size ));
-        IPPI_CALL( icvCanny_16s8u_C1R_p( (short*)dx->data.ptr, dx->step,
-                                     (short*)dy->data.ptr, dy->step,
-                                     dst->data.ptr, dst->step,
-                                     size, (float)low_thresh,
-                                     (float)high_thresh, buffer ));
-        EXIT;
+        int16x8_t a0 = vreinterpretq_s16_u16( vmovl_u8( vld1_u8( r0 + x - 1 )));
+        int16x8_t b0 = vreinterpretq_s16_u16( vmovl_u8( vld1_u8( r0 + x )));
+        int16x8_t c0 = vreinterpretq_s16_u16( vmovl_u8( vld1_u8( r0 + x + 1 )));
+        int16x8_t a1 = vreinterpretq_s16_u16( vmovl_u8( vld1_u8( r1 + x - 1 )));
+        int16x8_t c1 = vreinterpretq_s16_u16( vmovl_u8( vld1_u8( r1 + x + 1 )));
+        int16x8_t a2 = vreinterpretq_s16_u16( vmovl_u8( vld1_u8( r2 + x - 1 )));
+        int16x8_t b2 = vreinterpretq_s16_u16( vmovl_u8( vld1_u8( r2 + x )));
+        int16x8_t c2 = vreinterpretq_s16_u16( vmovl_u8( vld1_u8( r2 + x + 1 )));
+        int16x8_t vx = vaddq_s16( vaddq_s16( vsubq_s16( c0, a0 ), vsubq_s16( c2, a2 )),
+                                  vshlq_n_s16( vsubq_s16( c1, a1 ), 1 ));
+        int16x8_t vy = vsubq_s16( vaddq_s16( vaddq_s16( a2, c2 ), vshlq_n_s16( b2, 1 )),
+                                  vaddq_s16( vaddq_s16( a0, c0 ), vshlq_n_s16( b0, 1 )));
+        vst1q_s16( dx + x, vx );
+        vst1q_s16( dy + x, vy );
+
+        if( !l2 )
+        {
+            int16x8_t m = vaddq_s16( vabsq_s16( vx ), vabsq_s16( vy ));
+            vst1q_s32( mag + x, vmovl_s16( vget_low_s16( m )));
+            vst1q_s32( mag + x + 4, vmovl_s16( vget_high_s16( m )));
+        }
+        else // ARMv7 NEON has no vector square root
+            for( int k = 0; k < 8; k++ )
+                mag[x+k] = icvCannyMagnitude( dx[x+k], dy[x+k], 1 );
     }
 
-    if( flags & CV_CANNY_L2_GRADIENT )
+    icvCannyDerivRowTail( r0, r1, r2, width, dx, dy, mag, l2, x );
+}
+
+static void
+icvCannyWeakBlocks_NEON( const int* mag, int nblocks, int low, uchar* weak )
+{
+    int32x4_t vlow = vdupq_n_s32(low);
+    int k;
+
+    for( k = 0; k < nblocks; k++, mag += 8 )
     {
-        Cv32suf ul, uh;
-        ul.f = (float)low_thresh;
-        uh.f = (float)high_thresh;
+        uint32x4_t t = vorrq_u32( vcgtq_s32( vld1q_s32( mag ), vlow ),
+                                  vcgtq_s32( vld1q_s32( mag + 4 ), vlow ));
+        uint32x2_t t2 = vorr_u32( vget_low_u32(t), vget_high_u32(t) );
+        weak[k] = (uchar)((vget_lane_u32( t2, 0 ) | vget_lane_u32( t2, 1 )) == 0);
+    }
+}
+
+static void
+icvCannyOutputRow_NEON( const uchar* map, uchar* dst, int width )
+{
+    uint8x16_t two = vdupq_n_u8(2);
+    int j = 0;
+
+    for( ; j <= width - 16; j += 16 )
+        vst1q_u8( dst + j, vceqq_u8( vld1q_u8( map + j ), two ));
+
+    icvCannyOutputRow_C( map + j, dst + j, width - j );
+}
+
+#endif
+
+static const CvDispatchVariant icvCannyDerivRow_3x3_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvCannyDerivRow_3x3_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvCannyDerivRow_3x3_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvCannyDerivRow_3x3_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvCannyWeakBlocks_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvCannyWeakBlocks_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvCannyWeakBlocks_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvCannyWeakBlocks_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvCannyOutputRow_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvCannyOutputRow_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvCannyOutputRow_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvCannyOutputRow_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvCannyDerivRow_3x3_entry =
+    CV_DISPATCH_ENTRY( "cvCanny_deriv_3x3", icvCannyDerivRow_3x3_variants );
+static CvDispatchEntry icvCannyWeakBlocks_entry =
+    CV_DISPATCH_ENTRY( "cvCanny_weak_blocks", icvCannyWeakBlocks_variants );
+static CvDispatchEntry icvCannyOutputRow_entry =
+    CV_DISPATCH_ENTRY( "cvCanny_output", icvCannyOutputRow_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvCannyDerivRow_3x3_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvCannyWeakBlocks_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvCannyOutputRow_entry );
+
+
+typedef struct CvCannyBandParams
+{
+    const CvMat* src;
+    CvMat* dst;
+    CvCannyState* state;
+    const CvMat* dx;        // precomputed derivatives, 0 for the fused 3x3 Sobel
+    const CvMat* dy;
+    int low, high, l2;
+    CvCannyDerivRowFunc deriv_row;
+    CvCannyWeakBlocksFunc weak_blocks;
+    CvCannyOutputRowFunc output_row;
+}
+CvCannyBandParams;
+
 
-        low = ul.i;
-        high = uh.i;
+/* Computes the derivatives and the gradient magnitude of the row y. Outside of the image
+   the magnitude is 0. mag[-1] and mag[width] are always set to 0 */
+static void
+icvCannyGradientRow( const CvCannyBandParams* p, int y, int* mag, short* deriv,
+                     const short** dx, const short** dy )
+{
+    int width = p->state->size.width, height = p->state->size.height;
+    int x;
+
+    mag[-1] = mag[width] = 0;
+
+    if( (unsigned)y >= (unsigned)height )
+    {
+        memset( mag, 0, width*sizeof(mag[0]) );
+        *dx = *dy = 0;
+    }
+    else if( p->dx )
+    {
+        *dx = (const short*)(p->dx->data.ptr + p->dx->step*y);
+        *dy = (const short*)(p->dy->data.ptr + p->dy->step*y);
+        for( x = 0; x < width; x++ )
+            mag[x] = icvCannyMagnitude( (*dx)[x], (*dy)[x], p->l2 );
     }
     else
     {
-        low = cvFloor( low_thresh );
-        high = cvFloor( high_thresh );
+        int step = p->src->step;
+        const uchar* r1 = p->src->data.ptr + step*y;
+        p->deriv_row( y > 0 ? r1 - step : r1, r1, y < height - 1 ? r1 + step : r1,
+                      width, deriv, deriv + width, mag, p->l2 );
+        *dx = deriv;
+        *dy = deriv + width;
     }
+}
+
+
+#define CANNY_PUSH(d)    *(d) = (uchar)2, *stack_top++ = (d)
+#define CANNY_POP(d)     (d) = *--stack_top
+
+/* Reallocates the stack of the band b so that it can hold at least
+   extra more entries on top of the used ones; returns the new stack */
+static uchar**
+icvCannyGrowStack( CvCannyState* state, int b, int used, int extra )
+{
+    uchar** stack = 0;
+
+    CV_FUNCNAME( "icvCannyGrowStack" );
+
+    __BEGIN__;
+
+    int size = MAX( state->band_size[b]*3/2, used + extra );
 
-    CV_CALL( buffer = cvAlloc( (size.width+2)*(size.height+2) +
-                                (size.width+2)*3*sizeof(int)) );
+    CV_CALL( stack = (uchar**)cvAlloc( size*sizeof(stack[0]) ));
+    memcpy( stack, state->band_stack[b], used*sizeof(stack[0]) );
+    cvFree( &state->band_stack[b] );
+    state->band_stack[b] = stack;
+    state->band_size[b] = size;
 
-    mag_buf[0] = (int*)buffer;
-    mag_buf[1] = mag_buf[0] + size.width + 2;
-    mag_buf[2] = mag_buf[1] + size.width + 2;
-    map = (uchar*)(mag_buf[2] + size.width + 2);
-    mapstep = size.width + 2;
+    __END__;
 
-    maxsize = MAX( 1 << 10, size.width*size.height/10 );
-    CV_CALL( stack_top = stack_bottom = (uchar**)cvAlloc( maxsize*sizeof(stack_top[0]) ));
+    return stack;
+}
 
-    memset( mag_buf[0], 0, (size.width+2)*sizeof(int) );
-    memset( map, 1, mapstep );
-    memset( map + mapstep*(size.height + 1), 1, mapstep );
+/* Computes the gradient and performs the non-maxima suppression in the bands
+   [start,end). Each band keeps 3 gradient rows and pushes the strong edge pixels
+   to its own part of the stack. It fills the map with one of the following values:
+     0 - the pixel might belong to an edge
+     1 - the pixel can not belong to an edge
+     2 - the pixel does belong to an edge
+   The band starts from band_row[b]. It stops before a row that might not fit
+   into its stack, leaving band_row[b] there, as the workers must not allocate
+   memory (and raise errors); the caller grows the stack and runs the band again */
+static void CV_CDECL
+icvCannyBandBody( int start, int end, void* userdata )
+{
+    const CvCannyBandParams* p = (const CvCannyBandParams*)userdata;
+    CvCannyState* state = p->state;
+    int width = state->size.width, height = state->size.height;
+    int mapstep = state->mapstep, low = p->low, high = p->high;
+    int nblocks = width/8;
+    uchar* weak = (uchar*)cvStackAlloc( nblocks + 1 );
+    int b, i, j;
 
     /* sector numbers 
        (Top-Left Origin)
@@ -150,136 +426,93 @@ cvCanny( const void* srcarr, void* dstarr,
         3   2   1
     */
 
-    #define CANNY_PUSH(d)    *(d) = (uchar)2, *stack_top++ = (d)
-    #define CANNY_POP(d)     (d) = *--stack_top
-
-    mag_row = cvMat( 1, size.width, CV_32F );
-
-    // calculate magnitude and angle of gradient, perform non-maxima supression.
-    // fill the map with one of the following values:
-    //   0 - the pixel might belong to an edge
-    //   1 - the pixel can not belong to an edge
-    //   2 - the pixel does belong to an edge
-    for( i = 0; i <= size.height; i++ )
+    for( b = start; b < end; b++ )
     {
-        int* _mag = mag_buf[(i > 0) + 1] + 1;
-        float* _magf = (float*)_mag;
-        const short* _dx = (short*)(dx->data.ptr + dx->step*i);
-        const short* _dy = (short*)(dy->data.ptr + dy->step*i);
-        uchar* _map;
-        int x, y;
-        int magstep1, magstep2;
-        int prev_flag = 0;
-
-        if( i < size.height )
-        {
-            _mag[-1] = _mag[size.width] = 0;
-
-            if( !(flags & CV_CANNY_L2_GRADIENT) )
-                for( j = 0; j < size.width; j++ )
-                    _mag[j] = abs(_dx[j]) + abs(_dy[j]);
-            else if( icvFilterSobelVert_8u16s_C1R_p != 0 ) // check for IPP
-            {
-                // use vectorized sqrt
-                mag_row.data.fl = _magf;
-                for( j = 0; j < size.width; j++ )
-                {
-                    x = _dx[j]; y = _dy[j];
-                    _magf[j] = (float)((double)x*x + (double)y*y);
-                }
-                cvPow( &mag_row, &mag_row, 0.5 );
-            }
-            else
-            {
-                for( j = 0; j < size.width; j++ )
-                {
-                    x = _dx[j]; y = _dy[j];
-                    _magf[j] = (float)sqrt((double)x*x + (double)y*y);
-                }
-            }
-        }
-        else
-            memset( _mag-1, 0, (size.width + 2)*sizeof(int) );
-
-        // at the very beginning we do not have a complete ring
-        // buffer of 3 magnitude rows for non-maxima suppression
-        if( i == 0 )
+        int ystart = (int)((int64)b*height/state->nbands);
+        int y0 = state->band_row[b];
+        int y1 = (int)((int64)(b+1)*height/state->nbands);
+        uchar** stack_bottom = state->band_stack[b];
+        uchar** stack_top = stack_bottom + state->band_count[b];
+        int* mag_buf[3];
+        short* deriv_buf[3];
+        const short* dx_buf[3], *dy_buf[3];
+
+        if( y0 >= y1 )
             continue;
 
-        _map = map + mapstep*i + 1;
-        _map[-1] = _map[size.width] = 1;
-        
-        _mag = mag_buf[1] + 1; // take the central row
-        _dx = (short*)(dx->data.ptr + dx->step*(i-1));
-        _dy = (short*)(dy->data.ptr + dy->step*(i-1));
-        
-        magstep1 = (int)(mag_buf[2] - mag_buf[1]);
-        magstep2 = (int)(mag_buf[0] - mag_buf[1]);
-
-        if( (stack_top - stack_bottom) + size.width > maxsize )
+        for( j = 0; j < 3; j++ )
         {
-            uchar** new_stack_bottom;
-            maxsize = MAX( maxsize * 3/2, maxsize + size.width );
-            CV_CALL( new_stack_bottom = (uchar**)cvAlloc( maxsize * sizeof(stack_top[0])) );
-            memcpy( new_stack_bottom, stack_bottom, (stack_top - stack_bottom)*sizeof(stack_top[0]) );
-            stack_top = new_stack_bottom + (stack_top - stack_bottom);
-            cvFree( &stack_bottom );
-            stack_bottom = new_stack_bottom;
+            mag_buf[j] = state->mag + (b*3 + j)*(width + 2) + 1;
+            deriv_buf[j] = state->deriv + (b*3 + j)*width*2;
         }
 
-        for( j = 0; j < size.width; j++ )
-        {
-            #define CANNY_SHIFT 15
-            #define TG22  (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5)
-
-            x = _dx[j];
-            y = _dy[j];
-            int s = x ^ y;
-            int m = _mag[j];
+        icvCannyGradientRow( p, y0 - 1, mag_buf[0], deriv_buf[0], &dx_buf[0], &dy_buf[0] );
+        icvCannyGradientRow( p, y0, mag_buf[1], deriv_buf[1], &dx_buf[1], &dy_buf[1] );
 
-            x = abs(x);
-            y = abs(y);
-            if( m > low )
+        for( i = y0; i < y1; i++ )
+        {
+            const int* _mag = mag_buf[1];
+            const short* _dx = dx_buf[1];
+            const short* _dy = dy_buf[1];
+            uchar* _map = state->map + mapstep*(i+1) + 1;
+            int magstep1, magstep2, k;
+            int prev_flag = 0;
+            int* tmag;
+            short* tderiv;
+            const short* tdx;
+
+            // a row can push at most width pixels
+            if( (stack_top - stack_bottom) + width > state->band_size[b] )
+                break;
+
+            icvCannyGradientRow( p, i + 1, mag_buf[2], deriv_buf[2], &dx_buf[2], &dy_buf[2] );
+
+            magstep1 = (int)(mag_buf[2] - mag_buf[1]);
+            magstep2 = (int)(mag_buf[0] - mag_buf[1]);
+            p->weak_blocks( _mag, nblocks, low, weak );
+
+            for( j = 0; j < width; j++ )
             {
-                int tg22x = x * TG22;
-                int tg67x = tg22x + ((x + x) << CANNY_SHIFT);
-
-                y <<= CANNY_SHIFT;
+                int x, y, s, m = _mag[j];
 
-                if( y < tg22x )
+                // skip the runs of weak pixels
+                if( (j & 7) == 0 && (j >> 3) < nblocks && weak[j >> 3] )
                 {
-                    if( m > _mag[j-1] && m >= _mag[j+1] )
-                    {
-                        if( m > high && !prev_flag && _map[j-mapstep] != 2 )
-                        {
-                            CANNY_PUSH( _map + j );
-                            prev_flag = 1;
-                        }
-                        else
-                            _map[j] = (uchar)0;
-                        continue;
-                    }
+                    for( k = 0; k < 8; k++ )
+                        _map[j+k] = (uchar)1;
+                    prev_flag = 0;
+                    j += 7;
+                    continue;
                 }
-                else if( y > tg67x )
+
+                if( m > low )
                 {
-                    if( m > _mag[j+magstep2] && m >= _mag[j+magstep1] )
+                    int tg22x, tg67x, is_max;
+
+                    x = _dx[j];
+                    y = _dy[j];
+                    s = x ^ y;
+                    x = abs(x);
+                    y = abs(y);
+                    tg22x = x * TG22;
+                    tg67x = tg22x + ((x + x) << CANNY_SHIFT);
+                    y <<= CANNY_SHIFT;
+
+                    if( y < tg22x )
+                        is_max = m > _mag[j-1] && m >= _mag[j+1];
+                    else if( y > tg67x )
+                        is_max = m > _mag[j+magstep2] && m >= _mag[j+magstep1];
+                    else
                     {
-                        if( m > high && !prev_flag && _map[j-mapstep] != 2 )
-                        {
-                            CANNY_PUSH( _map + j );
-                            prev_flag = 1;
-                        }
-                        else
-                            _map[j] = (uchar)0;
-                        continue;
+                        s = s < 0 ? -1 : 1;
+                        is_max = m > _mag[j+magstep2-s] && m > _mag[j+magstep1+s];
                     }
-                }
-                else
-                {
-                    s = s < 0 ? -1 : 1;
-                    if( m > _mag[j+magstep2-s] && m > _mag[j+magstep1+s] )
+
+                    if( is_max )
                     {
-                        if( m > high && !prev_flag && _map[j-mapstep] != 2 )
+                        // the previous map row of the first band row belongs to another band,
+                        // so it is not checked there; it only affects the stack contents
+                        if( m > high && !prev_flag && (i == ystart || _map[j-mapstep] != 2) )
                         {
                             CANNY_PUSH( _map + j );
                             prev_flag = 1;
@@ -289,31 +522,256 @@ cvCanny( const void* srcarr, void* dstarr,
                         continue;
                     }
                 }
+                prev_flag = 0;
+                _map[j] = (uchar)1;
             }
-            prev_flag = 0;
-            _map[j] = (uchar)1;
+
+            // scroll the ring buffers
+            tmag = mag_buf[0]; mag_buf[0] = mag_buf[1]; mag_buf[1] = mag_buf[2]; mag_buf[2] = tmag;
+            tderiv = deriv_buf[0]; deriv_buf[0] = deriv_buf[1];
+            deriv_buf[1] = deriv_buf[2]; deriv_buf[2] = tderiv;
+            tdx = dx_buf[0]; dx_buf[0] = dx_buf[1]; dx_buf[1] = dx_buf[2]; dx_buf[2] = tdx;
+            tdx = dy_buf[0]; dy_buf[0] = dy_buf[1]; dy_buf[1] = dy_buf[2]; dy_buf[2] = tdx;
         }
 
-        // scroll the ring buffer
-        _mag = mag_buf[0];
-        mag_buf[0] = mag_buf[1];
-        mag_buf[1] = mag_buf[2];
-        mag_buf[2] = _mag;
+        state->band_row[b] = i;
+        state->band_count[b] = (int)(stack_top - stack_bottom);
+    }
+}
+
+
+/* Forms the final image from the edge map */
+static void CV_CDECL
+icvCannyOutputBody( int start, int end, void* userdata )
+{
+    const CvCannyBandParams* p = (const CvCannyBandParams*)userdata;
+    const CvCannyState* state = p->state;
+    int width = state->size.width, i;
+
+    for( i = start; i < end; i++ )
+    {
+        const uchar* _map = state->map + state->mapstep*(i+1) + 1;
+        p->output_row( _map, p->dst->data.ptr + p->dst->step*i, width );
+    }
+}
+
+
+CV_IMPL CvCannyState*
+cvCreateCannyState( CvSize size, int nbands )
+{
+    CvCannyState* state = 0;
+
+    CV_FUNCNAME( "cvCreateCannyState" );
+
+    __BEGIN__;
+
+    int b;
+
+    if( size.width <= 0 || size.height <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "The image size must be positive" );
+
+    if( nbands <= 0 )
+        nbands = cvGetNumThreads();
+    nbands = MAX( MIN( nbands, size.height/ICV_CANNY_MIN_BAND_HEIGHT ), 1 );
+
+    CV_CALL( state = (CvCannyState*)cvAlloc( sizeof(*state) ));
+    memset( state, 0, sizeof(*state) );
+
+    state->size = size;
+    state->nbands = nbands;
+    state->mapstep = size.width + 2;
+    CV_CALL( state->map = (uchar*)cvAlloc( state->mapstep*(size.height + 2) ));
+    CV_CALL( state->mag = (int*)cvAlloc( nbands*3*(size.width + 2)*sizeof(state->mag[0]) ));
+    CV_CALL( state->deriv = (short*)cvAlloc( nbands*3*size.width*2*sizeof(state->deriv[0]) ));
+    CV_CALL( state->band_stack = (uchar***)cvAlloc( nbands*sizeof(state->band_stack[0]) ));
+    memset( state->band_stack, 0, nbands*sizeof(state->band_stack[0]) );
+    CV_CALL( state->band_size = (int*)cvAlloc( nbands*3*sizeof(state->band_size[0]) ));
+    state->band_count = state->band_size + nbands;
+    state->band_row = state->band_count + nbands;
+
+    // the stacks start at 1/10 of the band area and grow when they overflow
+    for( b = 0; b < nbands; b++ )
+    {
+        int y0 = (int)((int64)b*size.height/nbands);
+        int y1 = (int)((int64)(b+1)*size.height/nbands);
+        state->band_size[b] = MAX( 1 << 10, (int)((int64)size.width*(y1 - y0)/10) );
+        CV_CALL( state->band_stack[b] = (uchar**)cvAlloc(
+            state->band_size[b]*sizeof(state->band_stack[b][0]) ));
+    }
+
+    // the map border is never overwritten
+    memset( state->map, 1, state->mapstep*(size.height + 2) );
+
+    __END__;
+
+    if( cvGetErrStatus() < 0 )
+        cvReleaseCannyState( &state );
+    return state;
+}
+
+
+CV_IMPL void
+cvReleaseCannyState( CvCannyState** state )
+{
+    CV_FUNCNAME( "cvReleaseCannyState" );
+
+    __BEGIN__;
+
+    int b;
+
+    if( !state )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( !*state )
+        EXIT;
+
+    cvFree( &(*state)->map );
+    cvFree( &(*state)->mag );
+    cvFree( &(*state)->deriv );
+    if( (*state)->band_stack )
+        for( b = 0; b < (*state)->nbands; b++ )
+            cvFree( &(*state)->band_stack[b] );
+    cvFree( &(*state)->band_stack );
+    cvFree( &(*state)->band_size );
+    cvReleaseMat( &(*state)->dx );
+    cvReleaseMat( &(*state)->dy );
+    cvFree( state );
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvCannyWithState( const void* srcarr, void* dstarr, double low_thresh,
+                  double high_thresh, CvCannyState* state, int aperture_size )
+{
+    CV_FUNCNAME( "cvCannyWithState" );
+
+    __BEGIN__;
+
+    CvMat srcstub, *src = (CvMat*)srcarr;
+    CvMat dststub, *dst = (CvMat*)dstarr;
+    CvCannyBandParams p;
+    CvSize size;
+    int flags = aperture_size;
+    uchar **stack_top, **stack_bottom;
+    int mapstep, b;
+
+    CV_CALL( src = cvGetMat( src, &srcstub ));
+    CV_CALL( dst = cvGetMat( dst, &dststub ));
+
+    if( !state )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( CV_MAT_TYPE( src->type ) != CV_8UC1 ||
+        CV_MAT_TYPE( dst->type ) != CV_8UC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+
+    if( !CV_ARE_SIZES_EQ( src, dst ))
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    size = cvGetMatSize( src );
+    if( size.width != state->size.width || size.height != state->size.height )
+        CV_ERROR( CV_StsUnmatchedSizes, "The state was created for another image size" );
+
+    if( low_thresh > high_thresh )
+    {
+        double t;
+        CV_SWAP( low_thresh, high_thresh, t );
+    }
+
+    aperture_size &= INT_MAX;
+    if( (aperture_size & 1) == 0 || aperture_size < 3 || aperture_size > 7 )
+        CV_ERROR( CV_StsBadFlag, "" );
+
+    p.src = src;
+    p.dst = dst;
+    p.state = state;
+    p.dx = p.dy = 0;
+    p.l2 = (flags & CV_CANNY_L2_GRADIENT) != 0;
+    p.deriv_row = (CvCannyDerivRowFunc)cvGetDispatchFunc( &icvCannyDerivRow_3x3_entry );
+    p.weak_blocks = (CvCannyWeakBlocksFunc)cvGetDispatchFunc( &icvCannyWeakBlocks_entry );
+    p.output_row = (CvCannyOutputRowFunc)cvGetDispatchFunc( &icvCannyOutputRow_entry );
+
+    if( aperture_size > 3 )
+    {
+        if( !state->dx )
+        {
+            CV_CALL( state->dx = cvCreateMat( size.height, size.width, CV_16SC1 ));
+            CV_CALL( state->dy = cvCreateMat( size.height, size.width, CV_16SC1 ));
+        }
+        CV_CALL( cvSobel( src, state->dx, 1, 0, aperture_size ));
+        CV_CALL( cvSobel( src, state->dy, 0, 1, aperture_size ));
+        p.dx = state->dx;
+        p.dy = state->dy;
+    }
+
+    if( p.l2 )
+    {
+        Cv32suf ul, uh;
+        ul.f = (float)low_thresh;
+        uh.f = (float)high_thresh;
+
+        p.low = ul.i;
+        p.high = uh.i;
+    }
+    else
+    {
+        p.low = cvFloor( low_thresh );
+        p.high = cvFloor( high_thresh );
+    }
+
+    // calculate magnitude and angle of gradient, perform non-maxima supression.
+    // The bands whose stacks overflowed are resumed after growing the stacks here
+    for( b = 0; b < state->nbands; b++ )
+    {
+        state->band_row[b] = (int)((int64)b*size.height/state->nbands);
+        state->band_count[b] = 0;
+    }
+
+    for( ;; )
+    {
+        int overflow = 0;
+
+        cvParallelFor( state->nbands, icvCannyBandBody, &p );
+
+        for( b = 0; b < state->nbands; b++ )
+            if( state->band_row[b] < (int)((int64)(b+1)*size.height/state->nbands) )
+            {
+                CV_CALL( icvCannyGrowStack( state, b, state->band_count[b], size.width ));
+                overflow = 1;
+            }
+
+        if( !overflow )
+            break;
+    }
+
+    // append the stacks of the other bands to the first one
+    stack_bottom = state->band_stack[0];
+    stack_top = stack_bottom + state->band_count[0];
+    for( b = 1; b < state->nbands; b++ )
+    {
+        int used = (int)(stack_top - stack_bottom), count = state->band_count[b];
+        if( used + count > state->band_size[0] )
+        {
+            CV_CALL( stack_bottom = icvCannyGrowStack( state, 0, used, count ));
+            stack_top = stack_bottom + used;
+        }
+        memcpy( stack_top, state->band_stack[b], count*sizeof(stack_top[0]) );
+        stack_top += count;
     }
 
     // now track the edges (hysteresis thresholding)
+    mapstep = state->mapstep;
     while( stack_top > stack_bottom )
     {
         uchar* m;
-        if( (stack_top - stack_bottom) + 8 > maxsize )
+
+        if( (stack_top - stack_bottom) + 8 > state->band_size[0] )
         {
-            uchar** new_stack_bottom;
-            maxsize = MAX( maxsize * 3/2, maxsize + 8 );
-            CV_CALL( new_stack_bottom = (uchar**)cvAlloc( maxsize * sizeof(stack_top[0])) );
-            memcpy( new_stack_bottom, stack_bottom, (stack_top - stack_bottom)*sizeof(stack_top[0]) );
-            stack_top = new_stack_bottom + (stack_top - stack_bottom);
-            cvFree( &stack_bottom );
-            stack_bottom = new_stack_bottom;
+            int used = (int)(stack_top - stack_bottom);
+            CV_CALL( stack_bottom = icvCannyGrowStack( state, 0, used, 8 ));
+            stack_top = stack_bottom + used;
         }
 
         CANNY_POP(m);
@@ -337,21 +795,79 @@ cvCanny( const void* srcarr, void* dstarr,
     }
 
     // the final pass, form the final image
-    for( i = 0; i < size.height; i++ )
+    cvParallelFor( size.height, icvCannyOutputBody, &p, MAX( (1 << 16)/size.width, 1 ));
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvCanny( const void* srcarr, void* dstarr,
+         double low_thresh, double high_thresh, int aperture_size )
+{
+    CvMat *dx = 0, *dy = 0;
+    void *buffer = 0;
+    CvCannyState* state = 0;
+
+    CV_FUNCNAME( "cvCanny" );
+
+    __BEGIN__;
+
+    CvMat srcstub, *src = (CvMat*)srcarr;
+    CvMat dststub, *dst = (CvMat*)dstarr;
+    CvSize size;
+    int flags = aperture_size;
+
+    CV_CALL( src = cvGetMat( src, &srcstub ));
+    CV_CALL( dst = cvGetMat( dst, &dststub ));
+
+    if( CV_MAT_TYPE( src->type ) != CV_8UC1 ||
+        CV_MAT_TYPE( dst->type ) != CV_8UC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+
+    if( !CV_ARE_SIZES_EQ( src, dst ))
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    size = cvGetMatSize( src );
+
+    if( icvCannyGetSize_p && icvCanny_16s8u_C1R_p && !(flags & CV_CANNY_L2_GRADIENT) )
     {
-        const uchar* _map = map + mapstep*(i+1) + 1;
-        uchar* _dst = dst->data.ptr + dst->step*i;
-        
-        for( j = 0; j < size.width; j++ )
-            _dst[j] = (uchar)-(_map[j] >> 1);
+        int buf_size=  0;
+
+        if( low_thresh > high_thresh )
+        {
+            double t;
+            CV_SWAP( low_thresh, high_thresh, t );
+        }
+
+        aperture_size &= INT_MAX;
+        if( (aperture_size & 1) == 0 || aperture_size < 3 || aperture_size > 7 )
+            CV_ERROR( CV_StsBadFlag, "" );
+
+        dx = cvCreateMat( size.height, size.width, CV_16SC1 );
+        dy = cvCreateMat( size.height, size.width, CV_16SC1 );
+        cvSobel( src, dx, 1, 0, aperture_size );
+        cvSobel( src, dy, 0, 1, aperture_size );
+
+        IPPI_CALL( icvCannyGetSize_p( size, &buf_size ));
+        CV_CALL( buffer = cvAlloc( buf_size ));
+        IPPI_CALL( icvCanny_16s8u_C1R_p( (short*)dx->data.ptr, dx->step,
+                                     (short*)dy->data.ptr, dy->step,
+                                     dst->data.ptr, dst->step,
+                                     size, (float)low_thresh,
+                                     (float)high_thresh, buffer ));
+        EXIT;
     }
 
+    CV_CALL( state = cvCreateCannyState( size ));
+    CV_CALL( cvCannyWithState( src, dst, low_thresh, high_thresh, state, flags ));
+
     __END__;
 
     cvReleaseMat( &dx );
     cvReleaseMat( &dy );
     cvFree( &buffer );
-    cvFree( &stack_bottom );
+    cvReleaseCannyState( &state );
 }
 
 /* End of file. */
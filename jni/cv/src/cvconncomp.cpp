@@ -0,0 +1,584 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                        Intel License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000, Intel Corporation, all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of Intel Corporation may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "_cv.h"
+
+/****************************************************************************************\
+*                       Run-based connected component labeling                           *
+\****************************************************************************************/
+
+/* The image is split into horizontal stripes that are labeled in parallel.
+   Every stripe extracts the runs of non-zero pixels row by row and joins them
+   with the overlapping runs of the previous row using union-find; the stripe
+   uses its own range of provisional labels, so the threads never touch
+   the same parent entries. The component statistics are accumulated per run.
+   The runs are counted in a first pass, so the run, parent and statistics
+   arrays hold exactly one entry per run (a run gets at most one new label).
+   Then the first and the last rows of the neighbor stripes are joined
+   serially, the labels are renumbered in raster order and, optionally,
+   the label image is filled from the stored runs in parallel */
+
+typedef struct CvCompRun
+{
+    int start, end;     // [start, end) x-range of the run
+    int label;          // provisional label
+}
+CvCompRun;
+
+typedef struct CvCompAcc
+{
+    int area;
+    int x0, y0, x1, y1; // inclusive bounding box
+    int64 sx, sy;       // sums of the pixel coordinates
+}
+CvCompAcc;
+
+typedef int (*CvFindRunsFunc)( const uchar* src, int width, int* runs, int runstep );
+typedef int (*CvCountRunsFunc)( const uchar* src, int width );
+
+typedef struct CvConnCompParams
+{
+    const CvMat* src;
+    CvMat* labels;      // 32s output labels, NULL if not requested
+    int conn8;
+    int nstripes;
+    int* parent;
+    CvCompAcc* acc;
+    CvCompRun* runs;    // the runs of all the rows, in raster order
+    int* rowruns;       // index of the first run and the number of runs of every row;
+                        // the labels of a stripe start from the index of its first run + 1
+    int* nlabels;       // number of provisional labels used by each stripe
+    CvFindRunsFunc find_runs;
+    CvCountRunsFunc count_runs;
+}
+CvConnCompParams;
+
+
+/* Finds the runs of non-zero pixels in the row. The SIMD variants skip
+   uniform 16-pixel blocks in the background and inside the runs */
+static int
+icvFindRuns_8u_C( const uchar* src, int width, int* runs, int runstep )
+{
+    int x = 0, n = 0;
+
+    for( ;; )
+    {
+        for( ; x < width && src[x] == 0; x++ )
+            ;
+        if( x >= width )
+            break;
+        runs[n*runstep] = x;
+        for( ; x < width && src[x] != 0; x++ )
+            ;
+        runs[(n++)*runstep + 1] = x;
+    }
+
+    return n;
+}
+
+/* Counts the runs of non-zero pixels in the row [x, width), i.e. the non-zero pixels
+   that start the row or follow a zero pixel */
+CV_INLINE int
+icvCountRunsTail_8u( const uchar* src, int x, int width )
+{
+    int n = 0, prev;
+
+    for( prev = x > 0 && src[x-1] != 0; x < width; x++ )
+    {
+        int nz = src[x] != 0;
+        n += nz & (prev ^ 1);
+        prev = nz;
+    }
+
+    return n;
+}
+
+static int
+icvCountRuns_8u_C( const uchar* src, int width )
+{
+    return icvCountRunsTail_8u( src, 0, width );
+}
+
+#if CV_SSE2
+
+static int
+icvFindRuns_8u_SSE2( const uchar* src, int width, int* runs, int runstep )
+{
+    __m128i z = _mm_setzero_si128();
+    int x = 0, n = 0;
+
+    for( ;; )
+    {
+        for( ; x <= width - 16; x += 16 )
+            if( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_loadu_si128(
+                (const __m128i*)(src + x)), z )) != 0xffff )
+                break;
+        for( ; x < width && src[x] == 0; x++ )
+            ;
+        if( x >= width )
+            break;
+        runs[n*runstep] = x;
+
+        for( ; x <= width - 16; x += 16 )
+            if( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_loadu_si128(
+                (const __m128i*)(src + x)), z )) != 0 )
+                break;
+        for( ; x < width && src[x] != 0; x++ )
+            ;
+        runs[(n++)*runstep + 1] = x;
+    }
+
+    return n;
+}
+
+static int
+icvCountRuns_8u_SSE2( const uchar* src, int width )
+{
+    __m128i z = _mm_setzero_si128();
+    int x = 0, n = 0, carry = 0;
+
+    for( ; x <= width - 16; x += 16 )
+    {
+        int m = _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_loadu_si128(
+            (const __m128i*)(src + x)), z )) ^ 0xffff;
+        int t = m & ~((m << 1) | carry);
+        carry = m >> 15;
+        if( t == 0 )
+            continue;
+        t -= (t >> 1) & 0x5555;
+        t = (t & 0x3333) + ((t >> 2) & 0x3333);
+        t = (t + (t >> 4)) & 0x0f0f;
+        n += (t + (t >> 8)) & 0x1f;
+    }
+
+    return n + icvCountRunsTail_8u( src, x, width );
+}
+
+#endif
+
+#if CV_NEON
+
+CV_INLINE int icvIsZero_8u( uint8x16_t v )
+{
+    uint64x2_t t = vreinterpretq_u64_u8( v );
+    return (vgetq_lane_u64( t, 0 ) | vgetq_lane_u64( t, 1 )) == 0;
+}
+
+static int
+icvFindRuns_8u_NEON( const uchar* src, int width, int* runs, int runstep )
+{
+    int x = 0, n = 0;
+
+    for( ;; )
+    {
+        for( ; x <= width - 16; x += 16 )
+            if( !icvIsZero_8u( vld1q_u8( src + x )))
+                break;
+        for( ; x < width && src[x] == 0; x++ )
+            ;
+        if( x >= width )
+            break;
+        runs[n*runstep] = x;
+
+        for( ; x <= width - 16; x += 16 )
+            if( !icvIsZero_8u( vceqq_u8( vld1q_u8( src + x ), vdupq_n_u8(0) )))
+                break;
+        for( ; x < width && src[x] != 0; x++ )
+            ;
+        runs[(n++)*runstep + 1] = x;
+    }
+
+    return n;
+}
+
+static int
+icvCountRuns_8u_NEON( const uchar* src, int width )
+{
+    uint8x16_t nz0 = vdupq_n_u8(0);
+    uint32x4_t sum = vdupq_n_u32(0);
+    uint64x2_t total;
+    int x = 0;
+
+    for( ; x <= width - 16; x += 16 )
+    {
+        uint8x16_t v = vld1q_u8( src + x );
+        uint8x16_t nz = vtstq_u8( v, v );
+        uint8x16_t t = vbicq_u8( nz, vextq_u8( nz0, nz, 15 ));
+        sum = vpadalq_u16( sum, vpaddlq_u8( vshrq_n_u8( t, 7 )));
+        nz0 = nz;
+    }
+
+    total = vpaddlq_u32( sum );
+    return (int)(vgetq_lane_u64( total, 0 ) + vgetq_lane_u64( total, 1 )) +
+           icvCountRunsTail_8u( src, x, width );
+}
+
+#endif
+
+static const CvDispatchVariant icvFindRuns_8u_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvFindRuns_8u_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvFindRuns_8u_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvFindRuns_8u_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvCountRuns_8u_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvCountRuns_8u_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvCountRuns_8u_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvCountRuns_8u_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvFindRuns_8u_entry =
+    CV_DISPATCH_ENTRY( "cvConnectedComponents_find_runs_8u", icvFindRuns_8u_variants );
+static CvDispatchEntry icvCountRuns_8u_entry =
+    CV_DISPATCH_ENTRY( "cvConnectedComponents_count_runs_8u", icvCountRuns_8u_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvFindRuns_8u_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvCountRuns_8u_entry );
+
+
+/* the entry point for the other modules (cvFindContours with CV_LINK_RUNS) */
+int
+icvFindRuns_8u( const uchar* src, int width, int* runs, int runstep )
+{
+    CvFindRunsFunc func = (CvFindRunsFunc)cvGetDispatchFunc( &icvFindRuns_8u_entry );
+    return func( src, width, runs, runstep );
+}
+
+
+CV_INLINE int
+icvFindRoot( int* parent, int i )
+{
+    while( parent[i] != i )
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+
+/* Joins the runs of the current row with the overlapping runs of the previous one.
+   The runs without a label get a new one starting from *next_label */
+static void
+icvJoinRuns( int* parent, const CvCompRun* prev, int nprev,
+             CvCompRun* cur, int ncur, int conn8, int* next_label )
+{
+    int i, j = 0;
+
+    for( i = 0; i < ncur; i++ )
+    {
+        int s = cur[i].start - conn8, e = cur[i].end + conn8;
+        int l = cur[i].label, k, t;
+
+        // the runs are sorted, so the previous runs that end before this one
+        // do not overlap the next runs either
+        for( ; j < nprev && prev[j].end <= s; j++ )
+            ;
+
+        for( k = j; k < nprev && prev[k].start < e; k++ )
+        {
+            int r = icvFindRoot( parent, prev[k].label );
+            if( l == 0 )
+                l = r;
+            else if( r != l )
+            {
+                l = icvFindRoot( parent, l );
+                if( r < l )
+                    CV_SWAP( r, l, t );
+                parent[r] = l;
+            }
+        }
+
+        if( l == 0 && next_label )
+        {
+            l = (*next_label)++;
+            parent[l] = l;
+        }
+        cur[i].label = l;
+    }
+}
+
+
+static void
+icvLabelStripe( const CvConnCompParams* p, int k )
+{
+    const CvMat* src = p->src;
+    int width = src->cols, height = src->rows;
+    int y, y0 = k*height/p->nstripes, y1 = (k + 1)*height/p->nstripes;
+    int nprev = 0;
+    int base = p->rowruns[y0*2] + 1, next_label = base;
+    CvCompRun* cur = p->runs + p->rowruns[y0*2];
+    CvCompRun* prev = cur;
+    int* parent = p->parent;
+    CvCompAcc* acc = p->acc;
+
+    for( y = y0; y < y1; y++ )
+    {
+        int i, ncur = p->find_runs( src->data.ptr + src->step*y, width, &cur->start,
+                                    sizeof(cur[0])/sizeof(int) );
+        int new_label = next_label;
+
+        for( i = 0; i < ncur; i++ )
+            cur[i].label = 0;
+        icvJoinRuns( parent, prev, nprev, cur, ncur, p->conn8, &next_label );
+
+        for( i = 0; i < ncur; i++ )
+        {
+            int s = cur[i].start, e = cur[i].end, len = e - s;
+            CvCompAcc* a = acc + cur[i].label;
+
+            // every new label is given to a single run
+            if( cur[i].label >= new_label )
+            {
+                a->area = 0;
+                a->x0 = s; a->x1 = e - 1;
+                a->y0 = a->y1 = y;
+                a->sx = a->sy = 0;
+            }
+            else
+            {
+                a->x0 = MIN( a->x0, s );
+                a->x1 = MAX( a->x1, e - 1 );
+                a->y1 = y;
+            }
+            a->area += len;
+            a->sx += (int64)(s + e - 1)*len/2;
+            a->sy += (int64)y*len;
+        }
+
+        assert( ncur == p->rowruns[y*2+1] );
+        prev = cur;
+        nprev = ncur;
+        cur += ncur;
+    }
+
+    p->nlabels[k] = next_label - base;
+}
+
+
+static void CV_CDECL
+icvCountRunsBody( int start, int end, void* userdata )
+{
+    const CvConnCompParams* p = (const CvConnCompParams*)userdata;
+    const CvMat* src = p->src;
+
+    for( ; start < end; start++ )
+        p->rowruns[start*2+1] = p->count_runs( src->data.ptr + src->step*start, src->cols );
+}
+
+
+static void CV_CDECL
+icvLabelStripesBody( int start, int end, void* userdata )
+{
+    for( ; start < end; start++ )
+        icvLabelStripe( (const CvConnCompParams*)userdata, start );
+}
+
+
+/* Fills the label image from the runs, the final labels are stored as -parent[label] */
+static void CV_CDECL
+icvFillLabelsBody( int start, int end, void* userdata )
+{
+    const CvConnCompParams* p = (const CvConnCompParams*)userdata;
+    const int* parent = p->parent;
+    int width = p->labels->cols;
+
+    for( ; start < end; start++ )
+    {
+        int* l = (int*)(p->labels->data.ptr + p->labels->step*start);
+        const CvCompRun* runs = p->runs + p->rowruns[start*2];
+        int i, x = 0, n = p->rowruns[start*2+1];
+
+        for( i = 0; i < n; i++ )
+        {
+            int label = -parent[runs[i].label];
+            for( ; x < runs[i].start; x++ )
+                l[x] = 0;
+            for( ; x < runs[i].end; x++ )
+                l[x] = label;
+        }
+        for( ; x < width; x++ )
+            l[x] = 0;
+    }
+}
+
+
+CV_IMPL CvSeq*
+cvConnectedComponents( const CvArr* image, CvArr* labelsarr,
+                       CvMemStorage* storage, int connectivity )
+{
+    CvSeq* comps = 0;
+    CvConnCompParams p;
+
+    CV_FUNCNAME( "cvConnectedComponents" );
+
+    memset( &p, 0, sizeof(p) );
+
+    __BEGIN__;
+
+    CvMat srcstub, *src = (CvMat*)image;
+    CvMat labelstub, *labels = (CvMat*)labelsarr;
+    int k, l, y, nstripes, ncomps = 0;
+    int64 nruns = 0;
+
+    CV_CALL( src = cvGetMat( src, &srcstub ));
+    if( CV_MAT_TYPE(src->type) != CV_8UC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "The input image must be 8-bit single-channel" );
+
+    if( labels )
+    {
+        CV_CALL( labels = cvGetMat( labels, &labelstub ));
+        if( CV_MAT_TYPE(labels->type) != CV_32SC1 )
+            CV_ERROR( CV_StsUnsupportedFormat, "The label image must be 32-bit integer" );
+        if( !CV_ARE_SIZES_EQ( src, labels ))
+            CV_ERROR( CV_StsUnmatchedSizes, "" );
+    }
+
+    if( !storage )
+        CV_ERROR( CV_StsNullPtr, "NULL storage pointer" );
+
+    if( connectivity != 4 && connectivity != 8 )
+        CV_ERROR( CV_StsBadFlag, "Connectivity must be 4 or 8" );
+
+    CV_CALL( comps = cvCreateSeq( 0, sizeof(CvSeq), sizeof(CvComponentStats), storage ));
+
+    nstripes = MAX( MIN( cvGetNumThreads(), src->rows/32 ), 1 );
+    p.src = src;
+    p.labels = labels;
+    p.conn8 = connectivity == 8;
+    p.find_runs = (CvFindRunsFunc)cvGetDispatchFunc( &icvFindRuns_8u_entry );
+    p.count_runs = (CvCountRunsFunc)cvGetDispatchFunc( &icvCountRuns_8u_entry );
+    p.nstripes = nstripes;
+
+    CV_CALL( p.rowruns = (int*)cvAlloc( (src->rows*2 + nstripes)*sizeof(p.rowruns[0]) ));
+    p.nlabels = p.rowruns + src->rows*2;
+
+    // count the runs, then size the arrays by the actual number of them
+    // (the parent and statistics entries are initialized when the labels are created)
+    cvParallelFor( src->rows, icvCountRunsBody, &p, 16 );
+    for( y = 0; y < src->rows; y++ )
+    {
+        p.rowruns[y*2] = (int)nruns;
+        nruns += p.rowruns[y*2+1];
+    }
+    if( nruns >= INT_MAX )
+        CV_ERROR( CV_StsOutOfRange, "Too many runs in the image" );
+
+    CV_CALL( p.parent = (int*)cvAlloc( (size_t)(nruns + 1)*sizeof(p.parent[0]) ));
+    CV_CALL( p.acc = (CvCompAcc*)cvAlloc( (size_t)(nruns + 1)*sizeof(p.acc[0]) ));
+    CV_CALL( p.runs = (CvCompRun*)cvAlloc( (size_t)(nruns + 1)*sizeof(p.runs[0]) ));
+
+    cvParallelFor( nstripes, icvLabelStripesBody, &p, 1 );
+
+    // join the stripes
+    for( k = 1; k < nstripes; k++ )
+    {
+        y = k*src->rows/nstripes;
+        icvJoinRuns( p.parent, p.runs + p.rowruns[y*2-2], p.rowruns[y*2-1],
+                     p.runs + p.rowruns[y*2], p.rowruns[y*2+1], p.conn8, 0 );
+    }
+
+    // Renumber the labels in raster order. The roots are always the smallest labels
+    // of their trees, so the parent of every label is already final when it is visited.
+    // The final labels are stored as -parent[l] and the statistics are gathered
+    // in acc[1..ncomps]: acc[ncomps] never lies after the currently visited entry
+    for( k = 0; k < nstripes; k++ )
+    {
+        int base = p.rowruns[k*src->rows/nstripes*2] + 1;
+        for( l = base; l < base + p.nlabels[k]; l++ )
+        {
+            int r = p.parent[l];
+            if( r == l )
+            {
+                p.parent[l] = -(++ncomps);
+                p.acc[ncomps] = p.acc[l];
+            }
+            else
+            {
+                CvCompAcc* a = p.acc + l;
+                CvCompAcc* b;
+                r = p.parent[r];
+                p.parent[l] = r;
+                b = p.acc + (-r);
+                b->x0 = MIN( b->x0, a->x0 );
+                b->x1 = MAX( b->x1, a->x1 );
+                b->y0 = MIN( b->y0, a->y0 );
+                b->y1 = MAX( b->y1, a->y1 );
+                b->area += a->area;
+                b->sx += a->sx;
+                b->sy += a->sy;
+            }
+        }
+    }
+
+    for( l = 1; l <= ncomps; l++ )
+    {
+        const CvCompAcc* a = p.acc + l;
+        CvComponentStats s;
+        s.area = a->area;
+        s.rect = cvRect( a->x0, a->y0, a->x1 - a->x0 + 1, a->y1 - a->y0 + 1 );
+        s.centroid = cvPoint2D32f( (double)a->sx/a->area, (double)a->sy/a->area );
+        CV_CALL( cvSeqPush( comps, &s ));
+    }
+
+    if( labels )
+        cvParallelFor( src->rows, icvFillLabelsBody, &p, 16 );
+
+    __END__;
+
+    cvFree( &p.parent );
+    cvFree( &p.acc );
+    cvFree( &p.runs );
+    cvFree( &p.rowruns );
+
+    return comps;
+}
+
+/* End of file. */
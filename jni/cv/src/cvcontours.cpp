@@ -1118,7 +1118,6 @@ cvEndFindContours( CvContourScanner * _scanner )
 #define ICV_SINGLE                  0
 #define ICV_CONNECTING_ABOVE        1
 #define ICV_CONNECTING_BELOW        -1
-#define ICV_IS_COMPONENT_POINT(val) ((val) != 0)
 
 #define CV_GET_WRITTEN_ELEM( writer ) ((writer).ptr - (writer).seq->elem_size)
 
@@ -1127,21 +1126,137 @@ typedef  struct CvLinkedRunPoint
     struct CvLinkedRunPoint* link;
     struct CvLinkedRunPoint* next;
     CvPoint pt;
+    int label;      // the node of the run for the run start point and the node of
+                    // the background gap on the left of the run for the run end point
 }
 CvLinkedRunPoint;
 
+/* Union-find node of a run or of a background gap between the runs, used to build
+   the contour hierarchy. Node 0 is the background connected to the image border */
+typedef struct CvRunNode
+{
+    int parent;
+    int info;       // run: the gap on its left; gap: the run above its first pixel or -1.
+                    // The roots are the first runs/gaps of their components in raster order
+    CvSeq* contour; // contour of the root component
+}
+CvRunNode;
+
+typedef struct CvRunContour
+{
+    CvSeq* contour;
+    int parent;     // node of the parent contour, 0 for the top-level contours
+}
+CvRunContour;
+
 
+static int
+icvFindRunRoot( CvRunNode* nodes, int i )
+{
+    while( nodes[i].parent != i )
+    {
+        nodes[i].parent = nodes[nodes[i].parent].parent;
+        i = nodes[i].parent;
+    }
+    return i;
+}
+
+
+static void
+icvMergeRunNodes( CvRunNode* nodes, int a, int b )
+{
+    a = icvFindRunRoot( nodes, a );
+    b = icvFindRunRoot( nodes, b );
+    if( a < b )
+        nodes[b].parent = a;
+    else if( b < a )
+        nodes[a].parent = b;
+}
+
+
+CV_INLINE int
+icvNewRunNode( CvRunNode* nodes, int* count, int info )
+{
+    int i = (*count)++;
+    nodes[i].parent = i;
+    nodes[i].info = info;
+    nodes[i].contour = 0;
+    return i;
+}
+
+
+/* Creates the nodes for the runs (ids) and the gaps (gaps[k] is on the left of run k)
+   of the new row and joins them with the 8-connected runs and the 4-connected gaps
+   of the previous row. The runs are given as [start,end) pairs; the empty gaps get -1 */
+static void
+icvLabelRunRow( CvRunNode* nodes, int* count, int width, int border_row,
+                const int* uruns, const int* uids, const int* ugaps, int nu,
+                const int* runs, int* ids, int* gaps, int n )
+{
+    int k, j = 0, m = 0;
+
+    for( k = 0; k <= n; k++ )
+    {
+        int gs = k > 0 ? runs[k*2-1] : 0, ge = k < n ? runs[k*2] : width, mm;
+
+        if( gs >= ge )
+        {
+            gaps[k] = -1;
+            continue;
+        }
+
+        if( border_row || k == 0 || k == n )
+            gaps[k] = 0;
+        else
+        {
+            for( ; j < nu && uruns[j*2+1] <= gs; j++ )
+                ;
+            gaps[k] = icvNewRunNode( nodes, count, j < nu && uruns[j*2] <= gs ? uids[j] : -1 );
+        }
+
+        if( !ugaps )
+            continue;
+
+        // the upper gap m spans [uruns[m*2-1], uruns[m*2])
+        for( ; m <= nu && (m < nu ? uruns[m*2] : width) <= gs; m++ )
+            ;
+        for( mm = m; mm <= nu && (mm > 0 ? uruns[mm*2-1] : 0) < ge; mm++ )
+            if( ugaps[mm] >= 0 )
+                icvMergeRunNodes( nodes, gaps[k], ugaps[mm] );
+    }
+
+    for( k = 0, j = 0; k < n; k++ )
+    {
+        int rs = runs[k*2], re = runs[k*2+1], jj;
+
+        ids[k] = icvNewRunNode( nodes, count, gaps[k] >= 0 ? gaps[k] : 0 );
+
+        for( ; j < nu && uruns[j*2+1] < rs; j++ )
+            ;
+        for( jj = j; jj < nu && uruns[jj*2] <= re; jj++ )
+            icvMergeRunNodes( nodes, ids[k], uids[jj] );
+    }
+}
+
+
+/* Links the runs of non-zero pixels into the contours (CV_LINK_RUNS method).
+   The image is never copied: only the runs, the union-find nodes used for
+   the hierarchy and two rows of run coordinates are stored. The contours
+   consist of the run end points */
 static int
 icvFindContoursInInterval( const CvArr* src,
                            /*int minValue, int maxValue,*/
                            CvMemStorage* storage,
                            CvSeq** result,
-                           int contourHeaderSize )
+                           int contourHeaderSize,
+                           int mode, CvPoint offset )
 {
     int count = 0;
     CvMemStorage* storage00 = 0;
     CvMemStorage* storage01 = 0;
     CvSeq* first = 0;
+    int* rowbuf = 0;
+    CvRunNode* nodes = 0;
 
     CV_FUNCNAME( "icvFindContoursInInterval" );
 
@@ -1176,7 +1291,11 @@ icvFindContoursInInterval( const CvArr* src,
 
     CvSeq* external_contours;
     CvSeq* internal_contours;
-    CvSeq* prev = 0;
+
+    int  maxruns, nnodes = 0, max_nodes = 0;
+    int  *uruns, *lruns, *uids, *lids, *ugaps, *lgaps, *tmp_ptr;
+    CvSeq*  found = 0;
+    CvContour  frame;
 
     if( !storage )
         CV_ERROR( CV_StsNullPtr, "NULL storage pointer" );
@@ -1187,6 +1306,9 @@ icvFindContoursInInterval( const CvArr* src,
     if( contourHeaderSize < (int)sizeof(CvContour))
         CV_ERROR( CV_StsBadSize, "Contour header size must be >= sizeof(CvContour)" );
 
+    if( mode < CV_RETR_EXTERNAL || mode > CV_RETR_TREE )
+        CV_ERROR( CV_StsOutOfRange, "Unknown contour retrieval mode" );
+
     CV_CALL( storage00 = cvCreateChildMemStorage(storage));
     CV_CALL( storage01 = cvCreateChildMemStorage(storage));
 
@@ -1201,6 +1323,20 @@ icvFindContoursInInterval( const CvArr* src,
         img_size = cvGetMatSize( mat );
     }
 
+    // two rows of runs, run nodes and gap nodes
+    maxruns = (img_size.width + 1)/2;
+    CV_CALL( rowbuf = (int*)cvAlloc( (maxruns*4 + 1)*2*sizeof(rowbuf[0]) ));
+    uruns = rowbuf;
+    lruns = uruns + maxruns*2;
+    uids = lruns + maxruns*2;
+    lids = uids + maxruns;
+    ugaps = lids + maxruns;
+    lgaps = ugaps + maxruns + 1;
+
+    max_nodes = maxruns*2 + 2;
+    CV_CALL( nodes = (CvRunNode*)cvAlloc( max_nodes*sizeof(nodes[0]) ));
+    icvNewRunNode( nodes, &nnodes, -1 );
+
     // Create temporary sequences
     runs = cvCreateSeq(0, sizeof(CvSeq), sizeof(CvLinkedRunPoint), storage00 );
     cvStartAppendToSeq( runs, &writer );
@@ -1211,6 +1347,7 @@ icvFindContoursInInterval( const CvArr* src,
     tmp_prev = &(tmp);
     tmp_prev->next = 0;
     tmp_prev->link = 0;
+    tmp.label = 0;
 
     // First line. None of runs is binded
     tmp.pt.y = 0;
@@ -1218,23 +1355,20 @@ icvFindContoursInInterval( const CvArr* src,
     CV_WRITE_SEQ_ELEM( tmp, writer );
     upper_line = (CvLinkedRunPoint*)CV_GET_WRITTEN_ELEM( writer );
 
+    n = icvFindRuns_8u( src_data, img_size.width, uruns, 2 );
+    icvLabelRunRow( nodes, &nnodes, img_size.width, 1, 0, 0, 0, 0, uruns, uids, ugaps, n );
+
     tmp_prev = upper_line;
-    for( j = 0; j < img_size.width; )
+    for( j = 0; j < n; j++ )
     {
-        for( ; j < img_size.width && !ICV_IS_COMPONENT_POINT(src_data[j]); j++ )
-            ;
-        if( j == img_size.width )
-            break;
-
-        tmp.pt.x = j;
+        tmp.pt.x = uruns[j*2];
+        tmp.label = uids[j];
         CV_WRITE_SEQ_ELEM( tmp, writer );
         tmp_prev->next = (CvLinkedRunPoint*)CV_GET_WRITTEN_ELEM( writer );
         tmp_prev = tmp_prev->next;
 
-        for( ; j < img_size.width && ICV_IS_COMPONENT_POINT(src_data[j]); j++ )
-            ;
-
-        tmp.pt.x = j-1;
+        tmp.pt.x = uruns[j*2+1] - 1;
+        tmp.label = MAX( ugaps[j], 0 );
         CV_WRITE_SEQ_ELEM( tmp, writer );
         tmp_prev->next = (CvLinkedRunPoint*)CV_GET_WRITTEN_ELEM( writer );
         tmp_prev->link = tmp_prev->next;
@@ -1254,21 +1388,30 @@ icvFindContoursInInterval( const CvArr* src,
         src_data += img_step;
         tmp.pt.y = i;
         all_total = runs->total;
-        for( j = 0; j < img_size.width; )
+
+        n = icvFindRuns_8u( src_data, img_size.width, lruns, 2 );
+        if( nnodes + n*2 + 1 > max_nodes )
         {
-            for( ; j < img_size.width && !ICV_IS_COMPONENT_POINT(src_data[j]); j++ )
-                ;
-            if( j == img_size.width ) break;
+            CvRunNode* new_nodes;
+            max_nodes = MAX( max_nodes*2, nnodes + n*2 + 1 );
+            CV_CALL( new_nodes = (CvRunNode*)cvAlloc( max_nodes*sizeof(nodes[0]) ));
+            memcpy( new_nodes, nodes, nnodes*sizeof(nodes[0]) );
+            cvFree( &nodes );
+            nodes = new_nodes;
+        }
+        icvLabelRunRow( nodes, &nnodes, img_size.width, i == img_size.height - 1,
+                        uruns, uids, ugaps, upper_total/2, lruns, lids, lgaps, n );
 
-            tmp.pt.x = j;
+        for( j = 0; j < n; j++ )
+        {
+            tmp.pt.x = lruns[j*2];
+            tmp.label = lids[j];
             CV_WRITE_SEQ_ELEM( tmp, writer );
             tmp_prev->next = (CvLinkedRunPoint*)CV_GET_WRITTEN_ELEM( writer );
             tmp_prev = tmp_prev->next;
 
-            for( ; j < img_size.width && ICV_IS_COMPONENT_POINT(src_data[j]); j++ )
-                ;
-
-            tmp.pt.x = j-1;
+            tmp.pt.x = lruns[j*2+1] - 1;
+            tmp.label = MAX( lgaps[j], 0 );
             CV_WRITE_SEQ_ELEM( tmp, writer );
             tmp_prev = tmp_prev->next = (CvLinkedRunPoint*)CV_GET_WRITTEN_ELEM( writer );
         }//j
@@ -1408,6 +1551,9 @@ icvFindContoursInInterval( const CvArr* src,
         }
         upper_line = lower_line;
         upper_total = lower_total;
+        CV_SWAP( uruns, lruns, tmp_ptr );
+        CV_SWAP( uids, lids, tmp_ptr );
+        CV_SWAP( ugaps, lgaps, tmp_ptr );
     }//i
 
     upper_run = upper_line;
@@ -1424,18 +1570,22 @@ icvFindContoursInInterval( const CvArr* src,
     external_contours = cvEndWriteSeq( &writer_ext );
     internal_contours = cvEndWriteSeq( &writer_int );
 
-    for( k = 0; k < 2; k++ )
+    CV_CALL( found = cvCreateSeq( 0, sizeof(CvSeq), sizeof(CvRunContour), storage01 ));
+
+    for( k = 0; k < (mode == CV_RETR_EXTERNAL ? 1 : 2); k++ )
     {
         CvSeq* contours = k == 0 ? external_contours : internal_contours;
 
         cvStartReadSeq( contours, &reader );
 
-        for( j = 0; j < contours->total; j++, count++ )
+        for( j = 0; j < contours->total; j++ )
         {
             CvLinkedRunPoint* p_temp;
             CvLinkedRunPoint* p00;
             CvLinkedRunPoint* p01;
             CvSeq* contour;
+            CvRunContour rc;
+            int root = 0;
 
             CV_READ_SEQ_ELEM( p00, reader );
             p01 = p00;
@@ -1443,11 +1593,40 @@ icvFindContoursInInterval( const CvArr* src,
             if( !p00->link )
                 continue;
 
+            // Every component is traced from its first run, which stores the outer
+            // background region. The hole contours may start at any gap of the hole,
+            // the ones that turn out to be connected to the image border are skipped
+            rc.parent = 0;
+            if( k == 0 )
+            {
+                root = icvFindRunRoot( nodes, p00->label );
+                if( nodes[root].contour )
+                    continue;
+                if( mode == CV_RETR_EXTERNAL || mode == CV_RETR_TREE )
+                {
+                    int outer = icvFindRunRoot( nodes, nodes[root].info );
+                    if( outer != 0 && mode == CV_RETR_EXTERNAL )
+                        continue;
+                    rc.parent = outer;
+                }
+            }
+            else
+            {
+                root = icvFindRunRoot( nodes, p00->next->label );
+                if( root == 0 || nodes[root].contour )
+                    continue;
+                if( mode != CV_RETR_LIST && nodes[root].info >= 0 )
+                    rc.parent = icvFindRunRoot( nodes, nodes[root].info );
+            }
+
             cvStartWriteSeq( CV_SEQ_ELTYPE_POINT | CV_SEQ_POLYLINE | CV_SEQ_FLAG_CLOSED,
                              contourHeaderSize, sizeof(CvPoint), storage, &writer );
             do
             {
-                CV_WRITE_SEQ_ELEM( p00->pt, writer );
+                CvPoint pt = p00->pt;
+                pt.x += offset.x;
+                pt.y += offset.y;
+                CV_WRITE_SEQ_ELEM( pt, writer );
                 p_temp = p00;
                 p00 = p00->link;
                 p_temp->link = 0;
@@ -1456,28 +1635,34 @@ icvFindContoursInInterval( const CvArr* src,
 
             contour = cvEndWriteSeq( &writer );
             cvBoundingRect( contour, 1 );
+            count++;
 
             if( k != 0 )
                 contour->flags |= CV_SEQ_FLAG_HOLE;
 
-            if( !first )
-                prev = first = contour;
-            else
-            {
-                contour->h_prev = prev;
-                prev = prev->h_next = contour;
-            }
+            nodes[root].contour = contour;
+            rc.contour = contour;
+            CV_CALL( cvSeqPush( found, &rc ));
         }
     }
 
-    __END__;
+    // the contours are inserted in the reverse order to keep the tracing order
+    memset( &frame, 0, sizeof(frame) );
+    for( j = found->total - 1; j >= 0; j-- )
+    {
+        CvRunContour* rc = (CvRunContour*)cvGetSeqElem( found, j );
+        CvSeq* parent = rc->parent ? nodes[rc->parent].contour : (CvSeq*)&frame;
+        CV_CALL( cvInsertNodeIntoTree( rc->contour, parent, &frame ));
+    }
+    first = frame.v_next;
 
-    if( !first )
-        count = -1;
+    __END__;
 
     if( result )
         *result = first;
 
+    cvFree( &rowbuf );
+    cvFree( &nodes );
     cvReleaseMemStorage(&storage00);
     cvReleaseMemStorage(&storage01);
 
@@ -1525,12 +1710,8 @@ cvFindContours( void*  img,  CvMemStorage*  storage,
 
     if( method == CV_LINK_RUNS )
     {
-        if( offset.x != 0 || offset.y != 0 )
-            CV_ERROR( CV_StsOutOfRange,
-            "Nonzero offset is not supported in CV_LINK_RUNS yet" );
-
         CV_CALL( count = icvFindContoursInInterval( img, storage,
-                                    firstContour, cntHeaderSize ));
+                                    firstContour, cntHeaderSize, mode, offset ));
     }
     else
     {
@@ -441,106 +441,114 @@ icvGetDistanceTransformMask( int maskType, float *metrics )
 }
 
 
-static void
-icvTrueDistTrans( const CvMat* src, CvMat* dst )
-{
-    CvMat* buffer = 0;
-
-    CV_FUNCNAME( "cvDistTransform2" );
-
-    __BEGIN__;
+/* number of adjacent columns processed together by the column pass */
+#define ICV_EDT_BLOCK  32
 
-    int i, m, n;
-    int sstep, dstep;
-    const float inf = 1e6f;
-    int thread_count = cvGetNumThreads();
-    int pass1_sz, pass2_sz;
-
-    if( !CV_ARE_SIZES_EQ( src, dst ))
-        CV_ERROR( CV_StsUnmatchedSizes, "" );
-
-    if( CV_MAT_TYPE(src->type) != CV_8UC1 ||
-        CV_MAT_TYPE(dst->type) != CV_32FC1 )
-        CV_ERROR( CV_StsUnsupportedFormat,
-        "The input image must have 8uC1 type and the output one must have 32fC1 type" );
-
-    m = src->rows;
-    n = src->cols;
-
-    // (see stage 1 below):
-    // sqr_tab: 2*m, sat_tab: 3*m + 1, d: m*thread_count,
-    pass1_sz = src->rows*(5 + thread_count) + 1;
-    // (see stage 2):
-    // sqr_tab & inv_tab: n each; f & v: n*thread_count each; z: (n+1)*thread_count
-    pass2_sz = src->cols*(2 + thread_count*3) + thread_count;
-    CV_CALL( buffer = cvCreateMat( 1, MAX(pass1_sz, pass2_sz), CV_32FC1 ));
+typedef struct CvDistTransformParams
+{
+    const CvMat* src;
+    CvMat* dst;
+    CvMat* labels;
+    const CvDistTransformPlan* plan;
+}
+CvDistTransformParams;
 
-    sstep = src->step;
-    dstep = dst->step / sizeof(float);
 
-    // stage 1: compute 1d distance transform of each column
+/* stage 1: computes the squared 1d distance transform of the column blocks [start, end).
+   The columns of a block are scanned together row by row, so that the memory
+   is accessed sequentially. If the labels are requested, they receive
+   the row of the nearest zero pixel in the column (or -1) */
+static void CV_CDECL
+icvDistTransformColumnsBody( int start, int end, void* userdata )
+{
+    const CvDistTransformParams* p = (const CvDistTransformParams*)userdata;
+    int m = p->plan->size.height, n = p->plan->size.width;
+    int sstep = p->src->step, dstep = p->dst->step/sizeof(float);
+    int lstep = p->labels ? p->labels->step/sizeof(int) : 0;
+    const float* sqr_tab = p->plan->col_sqr_tab;
+    int* d = p->plan->buf + p->plan->buf_step*cvGetThreadNum();
+    int* dist = d + m*ICV_EDT_BLOCK;
+    int* frow = dist + ICV_EDT_BLOCK;
+    int b, j, x;
+
+    for( b = start; b < end; b++ )
     {
-    float* sqr_tab = buffer->data.fl;
-    int* sat_tab = (int*)(sqr_tab + m*2);
-    const int shift = m*2;
+        int x0 = b*ICV_EDT_BLOCK, bw = MIN( ICV_EDT_BLOCK, n - x0 );
+        const uchar* sptr = p->src->data.ptr + (m-1)*sstep + x0;
+        float* dptr = p->dst->data.fl + x0;
+        int* drow = d + (m-1)*ICV_EDT_BLOCK;
 
-    for( i = 0; i < m; i++ )
-        sqr_tab[i] = (float)(i*i);
-    for( i = m; i < m*2; i++ )
-        sqr_tab[i] = inf;
-    for( i = 0; i < shift; i++ )
-        sat_tab[i] = 0;
-    for( ; i <= m*3; i++ )
-        sat_tab[i] = i - shift;
-
-#ifdef _OPENMP
-    #pragma omp parallel for num_threads(thread_count)
-#endif
-    for( i = 0; i < n; i++ )
-    {
-        const uchar* sptr = src->data.ptr + i + (m-1)*sstep;
-        float* dptr = dst->data.fl + i;
-        int* d = (int*)(sat_tab + m*3+1+m*cvGetThreadNum());
-        int j, dist = m-1;
+        // distance to the nearest zero pixel below (or at) the current one
+        for( x = 0; x < bw; x++ )
+            drow[x] = sptr[x] == 0 ? 0 : m;
 
-        for( j = m-1; j >= 0; j--, sptr -= sstep )
+        for( j = m-2; j >= 0; j-- )
         {
-            dist = (dist + 1) & (sptr[0] == 0 ? 0 : -1);
-            d[j] = dist;
+            sptr -= sstep;
+            drow -= ICV_EDT_BLOCK;
+            for( x = 0; x < bw; x++ )
+                drow[x] = sptr[x] == 0 ? 0 : drow[x + ICV_EDT_BLOCK] + 1;
         }
 
-        dist = m-1;
-        for( j = 0; j < m; j++, dptr += dstep )
+        for( x = 0; x < bw; x++ )
+            dist[x] = m-1;
+
+        if( !p->labels )
         {
-            dist = dist + 1 - sat_tab[dist + 1 - d[j] + shift];
-            d[j] = dist;
-            dptr[0] = sqr_tab[dist];
+            for( j = 0; j < m; j++, drow += ICV_EDT_BLOCK, dptr += dstep )
+                for( x = 0; x < bw; x++ )
+                {
+                    int t = MIN( dist[x] + 1, drow[x] );
+                    dist[x] = t;
+                    dptr[x] = sqr_tab[t];
+                }
         }
-    }
-    }
+        else
+        {
+            int* lptr = p->labels->data.i + x0;
 
-    // stage 2: compute modified distance transform for each row
-    {
-    float* inv_tab = buffer->data.fl;
-    float* sqr_tab = inv_tab + n;
+            for( x = 0; x < bw; x++ )
+                frow[x] = -1;
 
-    inv_tab[0] = sqr_tab[0] = 0.f;
-    for( i = 1; i < n; i++ )
-    {
-        inv_tab[i] = (float)(0.5/i);
-        sqr_tab[i] = (float)(i*i);
+            for( j = 0; j < m; j++, drow += ICV_EDT_BLOCK, dptr += dstep, lptr += lstep )
+                for( x = 0; x < bw; x++ )
+                {
+                    int t = dist[x] + 1;
+                    if( drow[x] <= t )
+                    {
+                        t = drow[x];
+                        frow[x] = j + t;
+                    }
+                    dist[x] = t;
+                    dptr[x] = sqr_tab[t];
+                    lptr[x] = t < m ? frow[x] : -1;
+                }
+        }
     }
+}
 
-#ifdef _OPENMP
-    #pragma omp parallel for num_threads(thread_count) schedule(dynamic)
-#endif
-    for( i = 0; i < m; i++ )
+
+/* stage 2: computes the modified distance transform of the rows [start, end)
+   as the lower envelope of the parabolas rooted at the column distances */
+static void CV_CDECL
+icvDistTransformRowsBody( int start, int end, void* userdata )
+{
+    const CvDistTransformParams* p = (const CvDistTransformParams*)userdata;
+    int n = p->plan->size.width;
+    const float* sqr_tab = p->plan->row_sqr_tab;
+    const float* inv_tab = p->plan->inv_tab;
+    const float inf = 1e6f;
+    float* f = (float*)(p->plan->buf + p->plan->buf_step*cvGetThreadNum());
+    float* z = f + n;
+    int* v = (int*)(z + n + 1);
+    int* lab = v + n;
+    int i;
+
+    for( i = start; i < end; i++ )
     {
-        float* d = (float*)(dst->data.ptr + i*dst->step);
-        float* f = sqr_tab + n + (n*3+1)*cvGetThreadNum();
-        float* z = f + n;
-        int* v = (int*)(z + n + 1);
-        int p, q, k;
+        float* d = (float*)(p->dst->data.ptr + i*p->dst->step);
+        int* lrow = p->labels ? (int*)(p->labels->data.ptr + i*p->labels->step) : 0;
+        int q, k, r;
 
         v[0] = 0;
         z[0] = -inf;
@@ -554,8 +562,8 @@ icvTrueDistTrans( const CvMat* src, CvMat* dst )
 
             for(;;k--)
             {
-                p = v[k];
-                float s = (fq + sqr_tab[q] - d[p] - sqr_tab[p])*inv_tab[q - p];
+                r = v[k];
+                float s = (fq + sqr_tab[q] - d[r] - sqr_tab[r])*inv_tab[q - r];
                 if( s > z[k] )
                 {
                     k++;
@@ -567,21 +575,178 @@ icvTrueDistTrans( const CvMat* src, CvMat* dst )
             }
         }
 
-        for( q = 0, k = 0; q < n; q++ )
+        if( !lrow )
         {
-            while( z[k+1] < q )
-                k++;
-            p = v[k];
-            d[q] = sqr_tab[abs(q - p)] + f[p];
+            for( q = 0, k = 0; q < n; q++ )
+            {
+                while( z[k+1] < q )
+                    k++;
+                r = v[k];
+                float t = sqr_tab[abs(q - r)] + f[r];
+                d[q] = (float)sqrt(t);
+            }
+        }
+        else
+        {
+            memcpy( lab, lrow, n*sizeof(lab[0]) );
+            for( q = 0, k = 0; q < n; q++ )
+            {
+                while( z[k+1] < q )
+                    k++;
+                r = v[k];
+                float t = sqr_tab[abs(q - r)] + f[r];
+                d[q] = (float)sqrt(t);
+                lrow[q] = lab[r] >= 0 ? lab[r]*n + r : -1;
+            }
         }
     }
+}
+
+
+/* (Re)allocates the per-thread buffers of the plan */
+static void
+icvAllocDistTransformBuffers( CvDistTransformPlan* plan, int nthreads )
+{
+    CV_FUNCNAME( "icvAllocDistTransformBuffers" );
+
+    __BEGIN__;
+
+    int m = plan->size.height, n = plan->size.width;
+
+    cvFree( &plan->buf );
+    plan->nthreads = 0;
+
+    // stage 1: m*ICV_EDT_BLOCK distances below + current distance and row of the nearest zero;
+    // stage 2: f, z, v and the labels of the row
+    plan->buf_step = MAX( (m + 2)*ICV_EDT_BLOCK, n*4 + 1 );
+    plan->buf_step = cvAlign( plan->buf_step, 16 );
+    CV_CALL( plan->buf = (int*)cvAlloc( nthreads*plan->buf_step*sizeof(plan->buf[0]) ));
+    plan->nthreads = nthreads;
+
+    __END__;
+}
+
+
+CV_IMPL CvDistTransformPlan*
+cvCreateDistTransformPlan( CvSize size )
+{
+    CvDistTransformPlan* plan = 0;
+
+    CV_FUNCNAME( "cvCreateDistTransformPlan" );
+
+    __BEGIN__;
+
+    int i, m = size.height, n = size.width;
+    const float inf = 1e6f;
+
+    if( m <= 0 || n <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "The image size must be positive" );
+
+    CV_CALL( plan = (CvDistTransformPlan*)cvAlloc( sizeof(*plan) ));
+    memset( plan, 0, sizeof(*plan) );
+    plan->size = size;
+
+    // the three tables share one block
+    CV_CALL( plan->col_sqr_tab = (float*)cvAlloc( (m*2 + n*2)*sizeof(float) ));
+    plan->row_sqr_tab = plan->col_sqr_tab + m*2;
+    plan->inv_tab = plan->row_sqr_tab + n;
+
+    for( i = 0; i < m; i++ )
+        plan->col_sqr_tab[i] = (float)(i*i);
+    for( i = m; i < m*2; i++ )
+        plan->col_sqr_tab[i] = inf;
+
+    plan->inv_tab[0] = plan->row_sqr_tab[0] = 0.f;
+    for( i = 1; i < n; i++ )
+    {
+        plan->inv_tab[i] = (float)(0.5/i);
+        plan->row_sqr_tab[i] = (float)(i*i);
     }
 
-    cvPow( dst, dst, 0.5 );
+    CV_CALL( icvAllocDistTransformBuffers( plan, cvGetNumThreads() ));
 
     __END__;
 
-    cvReleaseMat( &buffer );
+    if( cvGetErrStatus() < 0 )
+        cvReleaseDistTransformPlan( &plan );
+    return plan;
+}
+
+
+CV_IMPL void
+cvReleaseDistTransformPlan( CvDistTransformPlan** plan )
+{
+    CV_FUNCNAME( "cvReleaseDistTransformPlan" );
+
+    __BEGIN__;
+
+    if( !plan )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( !*plan )
+        EXIT;
+
+    cvFree( &(*plan)->col_sqr_tab );
+    cvFree( &(*plan)->buf );
+    cvFree( plan );
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvDistTransformWithPlan( const CvArr* srcarr, CvArr* dstarr,
+                         CvDistTransformPlan* plan, CvArr* labelsarr )
+{
+    CV_FUNCNAME( "cvDistTransformWithPlan" );
+
+    __BEGIN__;
+
+    CvMat srcstub, *src = (CvMat*)srcarr;
+    CvMat dststub, *dst = (CvMat*)dstarr;
+    CvMat lstub, *labels = (CvMat*)labelsarr;
+    CvDistTransformParams p;
+
+    if( !plan )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    CV_CALL( src = cvGetMat( src, &srcstub ));
+    CV_CALL( dst = cvGetMat( dst, &dststub ));
+
+    if( !CV_ARE_SIZES_EQ( src, dst ))
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    if( CV_MAT_TYPE(src->type) != CV_8UC1 ||
+        CV_MAT_TYPE(dst->type) != CV_32FC1 )
+        CV_ERROR( CV_StsUnsupportedFormat,
+        "The input image must have 8uC1 type and the output one must have 32fC1 type" );
+
+    if( src->cols != plan->size.width || src->rows != plan->size.height )
+        CV_ERROR( CV_StsUnmatchedSizes, "The image size differs from the size of the plan" );
+
+    if( labels )
+    {
+        CV_CALL( labels = cvGetMat( labels, &lstub ));
+        if( CV_MAT_TYPE( labels->type ) != CV_32SC1 )
+            CV_ERROR( CV_StsUnsupportedFormat, "the output array of labels must be 32sC1" );
+
+        if( !CV_ARE_SIZES_EQ( labels, dst ))
+            CV_ERROR( CV_StsUnmatchedSizes, "the array of labels has a different size" );
+    }
+
+    if( cvGetNumThreads() > plan->nthreads )
+        CV_CALL( icvAllocDistTransformBuffers( plan, cvGetNumThreads() ));
+
+    p.src = src;
+    p.dst = dst;
+    p.labels = labels;
+    p.plan = plan;
+
+    cvParallelFor( (src->cols + ICV_EDT_BLOCK - 1)/ICV_EDT_BLOCK,
+                   icvDistTransformColumnsBody, &p );
+    cvParallelFor( src->rows, icvDistTransformRowsBody, &p, 8 );
+
+    __END__;
 }
 
 
@@ -707,6 +872,7 @@ cvDistTransform( const void* srcarr, void* dstarr,
     CvMat* temp = 0;
     CvMat* src_copy = 0;
     CvMemStorage* st = 0;
+    CvDistTransformPlan* plan = 0;
     
     CV_FUNCNAME( "cvDistTransform" );
 
@@ -743,7 +909,8 @@ cvDistTransform( const void* srcarr, void* dstarr,
 
     if( maskSize == CV_DIST_MASK_PRECISE )
     {
-        CV_CALL( icvTrueDistTrans( src, dst ));
+        CV_CALL( plan = cvCreateDistTransformPlan( cvGetMatSize(src) ));
+        CV_CALL( cvDistTransformWithPlan( src, dst, plan ));
         EXIT;
     }
     
@@ -854,6 +1021,7 @@ cvDistTransform( const void* srcarr, void* dstarr,
     cvReleaseMat( &temp );
     cvReleaseMat( &src_copy );
     cvReleaseMemStorage( &st );
+    cvReleaseDistTransformPlan( &plan );
 }
 
 /* End of file. */
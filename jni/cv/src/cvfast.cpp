@@ -0,0 +1,609 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                        Intel License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000, Intel Corporation, all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of Intel Corporation may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "_cv.h"
+
+/****************************************************************************************\
+*                          FAST segment test corner detector                             *
+\****************************************************************************************/
+
+/* the Bresenham circle of radius 3 */
+static const int icvFastCircle[16][2] =
+{
+    {0, 3}, {1, 3}, {2, 2}, {3, 1}, {3, 0}, {3, -1}, {2, -2}, {1, -3},
+    {0, -3}, {-1, -3}, {-2, -2}, {-3, -1}, {-3, 0}, {-3, 1}, {-2, 2}, {-1, 3}
+};
+
+typedef struct CvFastCorner
+{
+    int x, y;
+    int score;
+    int rank;       // rank of the corner in its selection cell
+}
+CvFastCorner;
+
+#define  cmp_fast_score( a, b )                                            \
+    ((a).score > (b).score || ((a).score == (b).score &&                   \
+    ((a).y < (b).y || ((a).y == (b).y && (a).x < (b).x))))
+
+#define  cmp_fast_rank( a, b )                                             \
+    ((a).rank < (b).rank || ((a).rank == (b).rank && cmp_fast_score( a, b )))
+
+static CV_IMPLEMENT_QSORT( icvSortFastCorners, CvFastCorner, cmp_fast_score )
+static CV_IMPLEMENT_QSORT( icvSortFastCornersByRank, CvFastCorner, cmp_fast_rank )
+
+
+typedef int (*CvFastScoreFunc)( const uchar* ptr, const int* pixel, int arc, int threshold );
+typedef int (*CvFastTestRowFunc)( const uchar* ptr, const int* pixel, int x0, int x1,
+                                  int threshold, int arc, const uchar* threshold_tab,
+                                  uchar* mask );
+
+/* the largest threshold the pixel is still a corner with: the largest over
+   the arcs of <arc> pixels of the smallest difference with the center.
+   The arcs starting at k and k+1 share arc-1 pixels; the SIMD variants
+   evaluate 8 pairs of arcs at once, the scalar one drops the arcs
+   that cannot improve the current bound early */
+static int
+icvFastScore_C( const uchar* ptr, const int* pixel, int arc, int threshold )
+{
+    int k, j, c = ptr[0];
+    int d[32], a0 = threshold + 1, b0;
+
+    for( k = 0; k < 16; k++ )
+        d[k] = d[k+16] = c - ptr[pixel[k]];
+
+    // darker arcs
+    for( k = 0; k < 16; k += 2 )
+    {
+        int a = d[k+1];
+        for( j = 2; j < arc && a > a0; j++ )
+            a = MIN( a, d[k+j] );
+        if( a <= a0 )
+            continue;
+        a0 = MAX( a0, MIN( a, d[k] ));
+        a0 = MAX( a0, MIN( a, d[k+arc] ));
+    }
+
+    // brighter arcs
+    b0 = -a0;
+    for( k = 0; k < 16; k += 2 )
+    {
+        int b = d[k+1];
+        for( j = 2; j < arc && b < b0; j++ )
+            b = MAX( b, d[k+j] );
+        if( b >= b0 )
+            continue;
+        b0 = MIN( b0, MAX( b, d[k] ));
+        b0 = MIN( b0, MAX( b, d[k+arc] ));
+    }
+
+    return -b0 - 1;
+}
+
+
+/* Marks the corners of the pixels [x0,x1) of the row in <mask> and returns
+   their number. The 4 quadrant pixels reject most of the pixels first:
+   any arc of 9 or more pixels contains two neighbor quadrant pixels */
+static int
+icvFastTestRow_C( const uchar* ptr, const int* pixel, int x0, int x1,
+                  int threshold, int arc, const uchar* threshold_tab, uchar* mask )
+{
+    int x, n = 0, k;
+
+    for( x = x0; x < x1; x++ )
+    {
+        const uchar* p = ptr + x;
+        const uchar* tab = threshold_tab + 255 - p[0];
+        int d = tab[p[pixel[0]]] | tab[p[pixel[8]]], is_corner = 0;
+
+        mask[x] = 0;
+        if( d == 0 )
+            continue;
+
+        d &= tab[p[pixel[2]]] | tab[p[pixel[10]]];
+        d &= tab[p[pixel[4]]] | tab[p[pixel[12]]];
+        d &= tab[p[pixel[6]]] | tab[p[pixel[14]]];
+        if( d == 0 )
+            continue;
+
+        d &= tab[p[pixel[1]]] | tab[p[pixel[9]]];
+        d &= tab[p[pixel[3]]] | tab[p[pixel[11]]];
+        d &= tab[p[pixel[5]]] | tab[p[pixel[13]]];
+        d &= tab[p[pixel[7]]] | tab[p[pixel[15]]];
+
+        if( d & 1 )
+        {
+            int vt = p[0] - threshold, count = 0;
+            for( k = 0; k < 16 + arc - 1 && count < arc; k++ )
+                count = p[pixel[k]] < vt ? count + 1 : 0;
+            is_corner = count >= arc;
+        }
+
+        if( (d & 2) && !is_corner )
+        {
+            int vt = p[0] + threshold, count = 0;
+            for( k = 0; k < 16 + arc - 1 && count < arc; k++ )
+                count = p[pixel[k]] > vt ? count + 1 : 0;
+            is_corner = count >= arc;
+        }
+
+        if( is_corner )
+        {
+            mask[x] = 255;
+            n++;
+        }
+    }
+
+    return n;
+}
+
+#if CV_SSE2
+
+static int
+icvFastScore_SSE2( const uchar* ptr, const int* pixel, int arc, int /*threshold*/ )
+{
+    __m128i q0 = _mm_set1_epi16(-1000), q1 = _mm_set1_epi16(1000);
+    short d[48], q[8];
+    int k, j, c = ptr[0];
+
+    for( k = 0; k < 16; k++ )
+        d[k] = d[k+16] = d[k+32] = (short)(c - ptr[pixel[k]]);
+
+    for( k = 0; k < 16; k += 8 )
+    {
+        __m128i a = _mm_loadu_si128( (const __m128i*)(d + k + 1) ), b = a, v;
+        for( j = 2; j < arc; j++ )
+        {
+            v = _mm_loadu_si128( (const __m128i*)(d + k + j) );
+            a = _mm_min_epi16( a, v );
+            b = _mm_max_epi16( b, v );
+        }
+        v = _mm_loadu_si128( (const __m128i*)(d + k) );
+        q0 = _mm_max_epi16( q0, _mm_min_epi16( a, v ));
+        q1 = _mm_min_epi16( q1, _mm_max_epi16( b, v ));
+        v = _mm_loadu_si128( (const __m128i*)(d + k + arc) );
+        q0 = _mm_max_epi16( q0, _mm_min_epi16( a, v ));
+        q1 = _mm_min_epi16( q1, _mm_max_epi16( b, v ));
+    }
+    q0 = _mm_max_epi16( q0, _mm_sub_epi16( _mm_setzero_si128(), q1 ));
+    _mm_storeu_si128( (__m128i*)q, q0 );
+
+    for( k = 1; k < 8; k++ )
+        q[0] = MAX( q[0], q[k] );
+    return q[0] - 1;
+}
+
+static int
+icvFastTestRow_SSE2( const uchar* ptr, const int* pixel, int x0, int x1,
+                     int threshold, int arc, const uchar* threshold_tab, uchar* mask )
+{
+    __m128i delta = _mm_set1_epi8(-128), t = _mm_set1_epi8((char)threshold);
+    __m128i K = _mm_set1_epi8((char)(arc - 1));
+    int x = x0, n = 0, k;
+
+    for( ; x <= x1 - 16; x += 16 )
+    {
+        const uchar* p = ptr + x;
+        __m128i v = _mm_loadu_si128( (const __m128i*)p );
+        __m128i v0 = _mm_xor_si128( _mm_adds_epu8( v, t ), delta );
+        __m128i v1 = _mm_xor_si128( _mm_subs_epu8( v, t ), delta );
+        __m128i x0_ = _mm_xor_si128( _mm_loadu_si128( (const __m128i*)(p + pixel[0]) ), delta );
+        __m128i x1_ = _mm_xor_si128( _mm_loadu_si128( (const __m128i*)(p + pixel[4]) ), delta );
+        __m128i x2_ = _mm_xor_si128( _mm_loadu_si128( (const __m128i*)(p + pixel[8]) ), delta );
+        __m128i x3_ = _mm_xor_si128( _mm_loadu_si128( (const __m128i*)(p + pixel[12]) ), delta );
+        __m128i m0, m1, c0, c1, max0, max1;
+        int m;
+
+        m0 = _mm_and_si128( _mm_cmpgt_epi8( x0_, v0 ), _mm_cmpgt_epi8( x1_, v0 ));
+        m1 = _mm_and_si128( _mm_cmpgt_epi8( v1, x0_ ), _mm_cmpgt_epi8( v1, x1_ ));
+        m0 = _mm_or_si128( m0, _mm_and_si128( _mm_cmpgt_epi8( x1_, v0 ), _mm_cmpgt_epi8( x2_, v0 )));
+        m1 = _mm_or_si128( m1, _mm_and_si128( _mm_cmpgt_epi8( v1, x1_ ), _mm_cmpgt_epi8( v1, x2_ )));
+        m0 = _mm_or_si128( m0, _mm_and_si128( _mm_cmpgt_epi8( x2_, v0 ), _mm_cmpgt_epi8( x3_, v0 )));
+        m1 = _mm_or_si128( m1, _mm_and_si128( _mm_cmpgt_epi8( v1, x2_ ), _mm_cmpgt_epi8( v1, x3_ )));
+        m0 = _mm_or_si128( m0, _mm_and_si128( _mm_cmpgt_epi8( x3_, v0 ), _mm_cmpgt_epi8( x0_, v0 )));
+        m1 = _mm_or_si128( m1, _mm_and_si128( _mm_cmpgt_epi8( v1, x3_ ), _mm_cmpgt_epi8( v1, x0_ )));
+        if( !_mm_movemask_epi8( _mm_or_si128( m0, m1 )))
+        {
+            _mm_storeu_si128( (__m128i*)(mask + x), _mm_setzero_si128() );
+            continue;
+        }
+
+        // the lengths of the brighter and the darker runs around the circle
+        c0 = c1 = max0 = max1 = _mm_setzero_si128();
+        for( k = 0; k < 16 + arc - 1; k++ )
+        {
+            __m128i xk = _mm_xor_si128( _mm_loadu_si128( (const __m128i*)(p + pixel[k]) ), delta );
+            m0 = _mm_cmpgt_epi8( xk, v0 );
+            m1 = _mm_cmpgt_epi8( v1, xk );
+            c0 = _mm_and_si128( _mm_sub_epi8( c0, m0 ), m0 );
+            c1 = _mm_and_si128( _mm_sub_epi8( c1, m1 ), m1 );
+            max0 = _mm_max_epu8( max0, c0 );
+            max1 = _mm_max_epu8( max1, c1 );
+        }
+        m0 = _mm_cmpgt_epi8( _mm_max_epu8( max0, max1 ), K );
+        _mm_storeu_si128( (__m128i*)(mask + x), m0 );
+        m = _mm_movemask_epi8( m0 );
+        for( ; m != 0; m &= m - 1 )
+            n++;
+    }
+
+    return n + icvFastTestRow_C( ptr, pixel, x, x1, threshold, arc, threshold_tab, mask );
+}
+
+#endif
+
+#if CV_NEON
+
+/* The NEON variants have been compared with the C ones only under an x86
+   emulation of the arm_neon.h intrinsics, not on an ARM device */
+
+static int
+icvFastScore_NEON( const uchar* ptr, const int* pixel, int arc, int /*threshold*/ )
+{
+    int16x8_t q0 = vdupq_n_s16(-1000), q1 = vdupq_n_s16(1000);
+    short d[48], q[8];
+    int k, j, c = ptr[0];
+
+    for( k = 0; k < 16; k++ )
+        d[k] = d[k+16] = d[k+32] = (short)(c - ptr[pixel[k]]);
+
+    for( k = 0; k < 16; k += 8 )
+    {
+        int16x8_t a = vld1q_s16( d + k + 1 ), b = a, v;
+        for( j = 2; j < arc; j++ )
+        {
+            v = vld1q_s16( d + k + j );
+            a = vminq_s16( a, v );
+            b = vmaxq_s16( b, v );
+        }
+        v = vld1q_s16( d + k );
+        q0 = vmaxq_s16( q0, vminq_s16( a, v ));
+        q1 = vminq_s16( q1, vmaxq_s16( b, v ));
+        v = vld1q_s16( d + k + arc );
+        q0 = vmaxq_s16( q0, vminq_s16( a, v ));
+        q1 = vminq_s16( q1, vmaxq_s16( b, v ));
+    }
+    q0 = vmaxq_s16( q0, vnegq_s16( q1 ));
+    vst1q_s16( q, q0 );
+
+    for( k = 1; k < 8; k++ )
+        q[0] = MAX( q[0], q[k] );
+    return q[0] - 1;
+}
+
+static int
+icvFastTestRow_NEON( const uchar* ptr, const int* pixel, int x0, int x1,
+                     int threshold, int arc, const uchar* threshold_tab, uchar* mask )
+{
+    uint8x16_t t = vdupq_n_u8((uchar)threshold), K = vdupq_n_u8((uchar)(arc - 1));
+    int x = x0, n = 0, k;
+
+    for( ; x <= x1 - 16; x += 16 )
+    {
+        const uchar* p = ptr + x;
+        uint8x16_t v = vld1q_u8( p );
+        uint8x16_t v0 = vqaddq_u8( v, t ), v1 = vqsubq_u8( v, t );
+        uint8x16_t x0_ = vld1q_u8( p + pixel[0] ), x1_ = vld1q_u8( p + pixel[4] );
+        uint8x16_t x2_ = vld1q_u8( p + pixel[8] ), x3_ = vld1q_u8( p + pixel[12] );
+        uint8x16_t m0, m1, c0, c1, max0, max1, one = vdupq_n_u8(1);
+        uint64x2_t any;
+
+        m0 = vandq_u8( vcgtq_u8( x0_, v0 ), vcgtq_u8( x1_, v0 ));
+        m1 = vandq_u8( vcltq_u8( x0_, v1 ), vcltq_u8( x1_, v1 ));
+        m0 = vorrq_u8( m0, vandq_u8( vcgtq_u8( x1_, v0 ), vcgtq_u8( x2_, v0 )));
+        m1 = vorrq_u8( m1, vandq_u8( vcltq_u8( x1_, v1 ), vcltq_u8( x2_, v1 )));
+        m0 = vorrq_u8( m0, vandq_u8( vcgtq_u8( x2_, v0 ), vcgtq_u8( x3_, v0 )));
+        m1 = vorrq_u8( m1, vandq_u8( vcltq_u8( x2_, v1 ), vcltq_u8( x3_, v1 )));
+        m0 = vorrq_u8( m0, vandq_u8( vcgtq_u8( x3_, v0 ), vcgtq_u8( x0_, v0 )));
+        m1 = vorrq_u8( m1, vandq_u8( vcltq_u8( x3_, v1 ), vcltq_u8( x0_, v1 )));
+        any = vreinterpretq_u64_u8( vorrq_u8( m0, m1 ));
+        if( (vgetq_lane_u64( any, 0 ) | vgetq_lane_u64( any, 1 )) == 0 )
+        {
+            vst1q_u8( mask + x, vdupq_n_u8(0) );
+            continue;
+        }
+
+        c0 = c1 = max0 = max1 = vdupq_n_u8(0);
+        for( k = 0; k < 16 + arc - 1; k++ )
+        {
+            uint8x16_t xk = vld1q_u8( p + pixel[k] );
+            m0 = vcgtq_u8( xk, v0 );
+            m1 = vcltq_u8( xk, v1 );
+            c0 = vandq_u8( vaddq_u8( c0, one ), m0 );
+            c1 = vandq_u8( vaddq_u8( c1, one ), m1 );
+            max0 = vmaxq_u8( max0, c0 );
+            max1 = vmaxq_u8( max1, c1 );
+        }
+        m0 = vcgtq_u8( vmaxq_u8( max0, max1 ), K );
+        vst1q_u8( mask + x, m0 );
+        for( k = 0; k < 16; k++ )
+            n += mask[x + k] != 0;
+    }
+
+    return n + icvFastTestRow_C( ptr, pixel, x, x1, threshold, arc, threshold_tab, mask );
+}
+
+#endif
+
+static const CvDispatchVariant icvFastScore_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvFastScore_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvFastScore_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvFastScore_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvFastTestRow_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvFastTestRow_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvFastTestRow_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvFastTestRow_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvFastScore_entry =
+    CV_DISPATCH_ENTRY( "cvFASTFeatures_score", icvFastScore_variants );
+static CvDispatchEntry icvFastTestRow_entry =
+    CV_DISPATCH_ENTRY( "cvFASTFeatures_test", icvFastTestRow_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvFastScore_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvFastTestRow_entry );
+
+
+CV_IMPL void
+cvFASTFeatures( const CvArr* image, CvPoint2D32f* corners, int* corner_count,
+                int threshold, int type, double min_distance, const CvArr* maskarr )
+{
+    CvMemStorage* storage = 0;
+    uchar* buffer = 0;
+    CvFastCorner* cand = 0;
+    int* cells = 0;
+
+    CV_FUNCNAME( "cvFASTFeatures" );
+
+    __BEGIN__;
+
+    CvMat stub, *img = (CvMat*)image;
+    CvMat maskstub, *mask = (CvMat*)maskarr;
+    CvSeq* seq;
+    CvSeqWriter writer;
+    int pixel[32];
+    uchar threshold_tab[512];
+    int* score_buf[3];
+    int* corner_buf[3];
+    int ncorners[3];
+    int x, y, k, width, height, max_count, count = 0, total;
+    CvFastScoreFunc score_func;
+    CvFastTestRowFunc test_func;
+
+    if( !corners || !corner_count )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    max_count = *corner_count;
+    *corner_count = 0;
+
+    CV_CALL( img = cvGetMat( img, &stub ));
+    if( CV_MAT_TYPE(img->type) != CV_8UC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "The input image must be 8-bit single-channel" );
+
+    if( mask )
+    {
+        CV_CALL( mask = cvGetMat( mask, &maskstub ));
+        if( !CV_IS_MASK_ARR( mask ))
+            CV_ERROR( CV_StsBadMask, "" );
+        if( !CV_ARE_SIZES_EQ( img, mask ))
+            CV_ERROR( CV_StsUnmatchedSizes, "" );
+    }
+
+    if( type != CV_FAST_9 && type != CV_FAST_12 )
+        CV_ERROR( CV_StsBadArg, "The detector type must be CV_FAST_9 or CV_FAST_12" );
+
+    if( max_count <= 0 )
+        CV_ERROR( CV_StsBadArg, "maximal corners number is non positive" );
+
+    if( min_distance < 0 )
+        CV_ERROR( CV_StsBadArg, "min distance is negative" );
+
+    threshold = MIN( MAX( threshold, 0 ), 255 );
+    width = img->cols;
+    height = img->rows;
+    if( width < 7 || height < 7 )
+        EXIT;
+
+    for( k = 0; k < 16; k++ )
+        pixel[k] = pixel[k+16] = icvFastCircle[k][0] - icvFastCircle[k][1]*img->step;
+
+    // 1 - darker than the center by more than threshold, 2 - brighter
+    for( k = -255; k <= 255; k++ )
+        threshold_tab[k+255] = (uchar)(k < -threshold ? 1 : k > threshold ? 2 : 0);
+
+    score_func = (CvFastScoreFunc)cvGetDispatchFunc( &icvFastScore_entry );
+    test_func = (CvFastTestRowFunc)cvGetDispatchFunc( &icvFastTestRow_entry );
+
+    // 3 rows of scores and corner positions for the 3x3 non-maxima suppression
+    CV_CALL( buffer = (uchar*)cvAlloc( width*(3*sizeof(int)*2 + 1) ));
+    for( k = 0; k < 3; k++ )
+    {
+        score_buf[k] = (int*)buffer + width*k;
+        corner_buf[k] = (int*)buffer + width*(k + 3);
+        memset( score_buf[k], 0, width*sizeof(int) );
+        ncorners[k] = 0;
+    }
+
+    CV_CALL( storage = cvCreateMemStorage(0) );
+    cvStartWriteSeq( 0, sizeof(CvSeq), sizeof(CvFastCorner), storage, &writer );
+
+    // the row y is tested while the corners of the row y-1 are suppressed
+    for( y = 3; y < height - 2; y++ )
+    {
+        int* score = score_buf[(y - 3) % 3];
+        int* cornerpos = corner_buf[(y - 3) % 3];
+        const int* prev = score_buf[(y - 4 + 3) % 3];
+        const int* pprev = score_buf[(y - 5 + 3) % 3];
+        const int* prevpos = corner_buf[(y - 4 + 3) % 3];
+        int n = 0, nprev = ncorners[(y - 4 + 3) % 3];
+
+        memset( score, 0, width*sizeof(score[0]) );
+
+        if( y < height - 3 )
+        {
+            const uchar* ptr = img->data.ptr + img->step*y;
+            uchar* m = buffer + width*6*sizeof(int);
+
+            if( test_func( ptr, pixel, 3, width - 3, threshold,
+                           type, threshold_tab, m ) > 0 )
+                for( x = 3; x < width - 3; x++ )
+                    if( m[x] )
+                    {
+                        score[x] = score_func( ptr + x, pixel, type, threshold );
+                        cornerpos[n++] = x;
+                    }
+        }
+        ncorners[(y - 3) % 3] = n;
+
+        if( y == 3 )
+            continue;
+
+        for( k = 0; k < nprev; k++ )
+        {
+            int s;
+            x = prevpos[k];
+            s = prev[x];
+            if( s > prev[x-1] && s > prev[x+1] &&
+                s > pprev[x-1] && s > pprev[x] && s > pprev[x+1] &&
+                s > score[x-1] && s > score[x] && s > score[x+1] &&
+                (!mask || CV_MAT_ELEM( *mask, uchar, y - 1, x )))
+            {
+                CvFastCorner c;
+                c.x = x;
+                c.y = y - 1;
+                c.score = s;
+                c.rank = 0;
+                CV_WRITE_SEQ_ELEM( c, writer );
+            }
+        }
+    }
+
+    seq = cvEndWriteSeq( &writer );
+    total = seq->total;
+    if( total == 0 )
+        EXIT;
+
+    CV_CALL( cand = (CvFastCorner*)cvAlloc( total*sizeof(cand[0]) ));
+    cvCvtSeqToArray( seq, cand );
+    icvSortFastCorners( cand, total, 0 );
+
+    // Spread the corners uniformly: the image is divided into about max_count cells
+    // and every cell gives its strongest corner before any cell gives its second one
+    if( total > max_count )
+    {
+        int cell = MAX( cvCeil( sqrt( (double)width*height/max_count )), 1 );
+        int gw = (width + cell - 1)/cell, gh = (height + cell - 1)/cell;
+
+        CV_CALL( cells = (int*)cvAlloc( gw*gh*sizeof(cells[0]) ));
+        memset( cells, 0, gw*gh*sizeof(cells[0]) );
+        for( k = 0; k < total; k++ )
+            cand[k].rank = cells[(cand[k].y/cell)*gw + cand[k].x/cell]++;
+        icvSortFastCornersByRank( cand, total, 0 );
+        cvFree( &cells );
+    }
+
+    if( min_distance >= 1 )
+    {
+        // the accepted corners are bucketed into cells of min_distance size,
+        // so only the 3x3 neighbor cells are checked
+        int cell = cvCeil( min_distance ), min_dist = cvRound( min_distance*min_distance );
+        int gw = (width + cell - 1)/cell, gh = (height + cell - 1)/cell;
+        int* next;
+
+        CV_CALL( cells = (int*)cvAlloc( (gw*gh + max_count)*sizeof(cells[0]) ));
+        next = cells + gw*gh;
+        for( k = 0; k < gw*gh; k++ )
+            cells[k] = -1;
+
+        for( k = 0; k < total && count < max_count; k++ )
+        {
+            int cx = cand[k].x/cell, cy = cand[k].y/cell, i, j, ok = 1;
+
+            for( j = MAX( cy - 1, 0 ); j <= MIN( cy + 1, gh - 1 ) && ok; j++ )
+                for( i = MAX( cx - 1, 0 ); i <= MIN( cx + 1, gw - 1 ) && ok; i++ )
+                {
+                    int idx = cells[j*gw + i];
+                    for( ; idx >= 0; idx = next[idx] )
+                    {
+                        int dx = cand[k].x - cvRound(corners[idx].x);
+                        int dy = cand[k].y - cvRound(corners[idx].y);
+                        if( dx*dx + dy*dy < min_dist )
+                        {
+                            ok = 0;
+                            break;
+                        }
+                    }
+                }
+
+            if( ok )
+            {
+                corners[count] = cvPoint2D32f( cand[k].x, cand[k].y );
+                next[count] = cells[cy*gw + cx];
+                cells[cy*gw + cx] = count++;
+            }
+        }
+    }
+    else
+        for( ; count < total && count < max_count; count++ )
+            corners[count] = cvPoint2D32f( cand[count].x, cand[count].y );
+
+    *corner_count = count;
+
+    __END__;
+
+    cvFree( &buffer );
+    cvFree( &cand );
+    cvFree( &cells );
+    cvReleaseMemStorage( &storage );
+}
+
+/* End of file. */
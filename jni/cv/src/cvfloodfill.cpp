@@ -1033,10 +1033,10 @@ cvFloodFill( CvArr* arr, CvPoint seed_point,
     CvMat maskstub, *mask = (CvMat*)maskarr;
     CvSize size;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitFloodFill( ffill_tab, ffillgrad_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     CV_CALL( img = cvGetMat( img, &stub ));
@@ -443,7 +443,7 @@ CvHomographyEstimator::CvHomographyEstimator(int _modelPoints)
 
 int CvHomographyEstimator::runKernel( const CvMat* m1, const CvMat* m2, CvMat* H )
 {
-    int i, count = m1->rows*m1->cols;
+    int i, count = m1->rows*m1->cols, solved = 0;
     const CvPoint2D64f* M = (const CvPoint2D64f*)m1->data.ptr;
     const CvPoint2D64f* m = (const CvPoint2D64f*)m2->data.ptr;
 
@@ -494,7 +494,32 @@ int CvHomographyEstimator::runKernel( const CvMat* m1, const CvMat* m2, CvMat* H
     }
     cvCompleteSymm( &_LtL );
 
-    cvSVD( &_LtL, &_W, 0, &_V, CV_SVD_MODIFY_A + CV_SVD_V_T );
+    // RANSAC subsets are tiny, and there the full SVD dominates the hypothesis
+    // cost. In the normalized coordinates the centroid can not be mapped to
+    // infinity unless the configuration is degenerate, so h33 may be fixed to 1
+    // and the other coefficients found from the 8x8 normal equations
+    if( count <= 5 )
+    {
+        double A[8][8], b[8];
+        CvMat _A = cvMat( 8, 8, CV_64F, A );
+        CvMat _b = cvMat( 8, 1, CV_64F, b );
+        CvMat _h = cvMat( 8, 1, CV_64F, V[8] );
+        int j;
+
+        for( i = 0; i < 8; i++ )
+        {
+            for( j = 0; j < 8; j++ )
+                A[i][j] = LtL[i][j];
+            b[i] = -LtL[i][8];
+        }
+
+        solved = cvSolveBatch( &_A, &_b, &_h, 1, CV_LU ) > 0;
+        V[8][8] = 1.;
+    }
+
+    if( !solved )
+        cvSVD( &_LtL, &_W, 0, &_V, CV_SVD_MODIFY_A + CV_SVD_V_T );
+
     cvMatMul( &_invHnorm, &_H0, &_Htemp );
     cvMatMul( &_Htemp, &_Hnorm2, &_H0 );
     cvConvertScale( &_H0, H, 1./_H0.data.db[8] );
@@ -515,7 +515,7 @@ cvCompareHist( const CvHistogram* hist1,
         CvSparseMatIterator iterator;
         CvSparseNode *node1, *node2;
 
-        if( mat1->heap->active_count > mat2->heap->active_count )
+        if( CV_SPARSE_MAT_COUNT(mat1) > CV_SPARSE_MAT_COUNT(mat2) )
         {
             CvSparseMat* t;
             CV_SWAP( mat1, mat2, t );
@@ -866,6 +866,140 @@ icvCalcHistLookupTables8u( const CvHistogram* hist, int dims, int* size, int* ta
 
 /***************************** C A L C   H I S T O G R A M *************************/
 
+/*
+   256-bin histogram engine for 8-bit images.
+
+   Consecutive pixels very often have the same value, so the naive "hist[ptr[x]]++"
+   loop stalls on the store-to-load forwarding of the same counter. The engine
+   distributes the pixels between 4 interleaved sub-histograms, which are summed up
+   at the end. The image is split into horizontal stripes processed on
+   cvGetNumThreads() threads, each thread accumulates into its own histogram and the
+   per-thread histograms are reduced after the parallel loop.
+*/
+
+#define ICV_HIST8U_MIN_STRIPE_SIZE  (1 << 15) // minimal number of pixels per stripe
+
+typedef struct CvHist8uParams
+{
+    const uchar* src;
+    int step;
+    const uchar* mask;
+    int mask_step;
+    int width;
+    int* thread_hist; // cvGetNumThreads() x 256 histograms
+}
+CvHist8uParams;
+
+static void
+icvCalcHist8uRows( const uchar* src, int step, const uchar* mask, int mask_step,
+                   int width, int rows, int* hist )
+{
+    int sub[4][256];
+    int x, i;
+
+    memset( sub, 0, sizeof(sub) );
+
+    for( ; rows--; src += step )
+    {
+        if( !mask )
+        {
+            for( x = 0; x <= width - 4; x += 4 )
+            {
+                int v0 = src[x], v1 = src[x+1], v2 = src[x+2], v3 = src[x+3];
+                sub[0][v0]++; sub[1][v1]++;
+                sub[2][v2]++; sub[3][v3]++;
+            }
+
+            for( ; x < width; x++ )
+                sub[0][src[x]]++;
+        }
+        else
+        {
+            for( x = 0; x <= width - 4; x += 4 )
+            {
+                // the mask values are converted to 0/1 increments without branches
+                sub[0][src[x]] += mask[x] != 0;
+                sub[1][src[x+1]] += mask[x+1] != 0;
+                sub[2][src[x+2]] += mask[x+2] != 0;
+                sub[3][src[x+3]] += mask[x+3] != 0;
+            }
+
+            for( ; x < width; x++ )
+                sub[0][src[x]] += mask[x] != 0;
+            mask += mask_step;
+        }
+    }
+
+    for( i = 0; i < 256; i++ )
+        hist[i] += (sub[0][i] + sub[1][i]) + (sub[2][i] + sub[3][i]);
+}
+
+
+static void CV_CDECL
+icvCalcHist8uBody( int start, int end, void* _params )
+{
+    const CvHist8uParams* p = (const CvHist8uParams*)_params;
+    int* hist = p->thread_hist + cvGetThreadNum()*256;
+
+    icvCalcHist8uRows( p->src + start*p->step, p->step,
+                       p->mask ? p->mask + start*p->mask_step : 0, p->mask_step,
+                       p->width, end - start, hist );
+}
+
+
+/* Accumulates the histogram of 8-bit single-channel image (with optional mask)
+   to hist[0..255]. The histogram is not cleared. */
+static void
+icvCalcHist8u( const uchar* src, int step, const uchar* mask, int mask_step,
+               CvSize size, int* hist )
+{
+    int nthreads = cvGetNumThreads();
+    int* thread_hist;
+    CvHist8uParams p;
+    int i, k;
+
+    if( size.width <= 0 || size.height <= 0 )
+        return;
+
+    // a continuous image is processed as a sequence of row blocks,
+    // so that it can be split between the threads
+    if( size.height == 1 && size.width >= ICV_HIST8U_MIN_STRIPE_SIZE*2 && nthreads > 1 )
+    {
+        const int block = 1 << 12;
+        int rows = size.width/block, tail = size.width - rows*block;
+
+        icvCalcHist8u( src, block, mask, block, cvSize(block, rows), hist );
+        if( tail > 0 )
+            icvCalcHist8uRows( src + rows*block, 0, mask ? mask + rows*block : 0, 0,
+                               tail, 1, hist );
+        return;
+    }
+
+    if( nthreads <= 1 || (double)size.width*size.height < ICV_HIST8U_MIN_STRIPE_SIZE*2 )
+    {
+        icvCalcHist8uRows( src, step, mask, mask_step, size.width, size.height, hist );
+        return;
+    }
+
+    thread_hist = (int*)cvStackAlloc( nthreads*256*sizeof(thread_hist[0]) );
+    memset( thread_hist, 0, nthreads*256*sizeof(thread_hist[0]) );
+
+    p.src = src;
+    p.step = step;
+    p.mask = mask;
+    p.mask_step = mask_step;
+    p.width = size.width;
+    p.thread_hist = thread_hist;
+
+    cvParallelFor( size.height, icvCalcHist8uBody, &p,
+                   MAX( ICV_HIST8U_MIN_STRIPE_SIZE/size.width, 1 ));
+
+    for( k = 0; k < nthreads; k++ )
+        for( i = 0; i < 256; i++ )
+            hist[i] += thread_hist[k*256 + i];
+}
+
+
 // Calculates histogram for one or more 8u arrays
 static CvStatus CV_STDCALL
     icvCalcHist_8u_C1R( uchar** img, int step, uchar* mask, int maskStep,
@@ -903,37 +1037,7 @@ static CvStatus CV_STDCALL
             int tab1d[256];
             memset( tab1d, 0, sizeof(tab1d));
 
-            for( ; size.height--; img[0] += step )
-            {
-                uchar* ptr = img[0];
-                if( !mask )
-                {
-                    for( x = 0; x <= size.width - 4; x += 4 )
-                    {
-                        int v0 = ptr[x];
-                        int v1 = ptr[x+1];
-
-                        tab1d[v0]++;
-                        tab1d[v1]++;
-
-                        v0 = ptr[x+2];
-                        v1 = ptr[x+3];
-
-                        tab1d[v0]++;
-                        tab1d[v1]++;
-                    }
-
-                    for( ; x < size.width; x++ )
-                        tab1d[ptr[x]]++;
-                }
-                else
-                {
-                    for( x = 0; x < size.width; x++ )
-                        if( mask[x] )
-                            tab1d[ptr[x]]++;
-                    mask += maskStep;
-                }
-            }
+            icvCalcHist8u( img[0], step, mask, maskStep, size, tab1d );
 
             for( i = 0; i < 256; i++ )
             {
@@ -1065,13 +1169,17 @@ static CvStatus CV_STDCALL
     else
     {
         CvSparseMat* mat = (CvSparseMat*)(hist->bins);
-        int node_idx[CV_MAX_DIM];
+        int* idxbuf = (int*)cvAlloc( size.width*dims*sizeof(idxbuf[0]) );
 
+        // the bin indices of a row are collected first and then added
+        // to the table in one call
         for( ; size.height--; )
         {
-            if( !mask )
+            int* node_idx = idxbuf;
+
+            for( x = 0; x < size.width; x++ )
             {
-                for( x = 0; x < size.width; x++ )
+                if( !mask || mask[x] )
                 {
                     for( i = 0; i < dims; i++ )
                     {
@@ -1081,38 +1189,20 @@ static CvStatus CV_STDCALL
                         node_idx[i] = idx;
                     }
                     if( i == dims )
-                    {
-                        int* bin = (int*)cvPtrND( mat, node_idx, 0, 1 );
-                        bin[0]++;
-                    }
+                        node_idx += dims;
                 }
             }
-            else
-            {
-                for( x = 0; x < size.width; x++ )
-                {
-                    if( mask[x] )
-                    {
-                        for( i = 0; i < dims; i++ )
-                        {
-                            int idx = tab[i*256 + img[i][x]];
-                            if( idx < 0 )
-                                break;
-                            node_idx[i] = idx;
-                        }
-                        if( i == dims )
-                        {
-                            int* bin = (int*)cvPtrND( mat, node_idx, 0, 1, 0 );
-                            bin[0]++;
-                        }
-                    }
-                }
+
+            cvIncSparseND( mat, idxbuf, (int)(node_idx - idxbuf)/dims, 1 );
+
+            if( mask )
                 mask += maskStep;
-            }
 
             for( i = 0; i < dims; i++ )
                 img[i] += step;
         }
+
+        cvFree( &idxbuf );
     }
 
     return CV_OK;
@@ -1331,10 +1421,12 @@ static CvStatus CV_STDCALL
     else
     {
         CvSparseMat* mat = (CvSparseMat*)(hist->bins);
-        int node_idx[CV_MAX_DIM];
+        int* idxbuf = (int*)cvAlloc( size.width*dims*sizeof(idxbuf[0]) );
 
         for( ; size.height--; )
         {
+            int* node_idx = idxbuf;
+
             if( uniform )
             {
                 for( x = 0; x < size.width; x++ )
@@ -1350,10 +1442,7 @@ static CvStatus CV_STDCALL
                             node_idx[i] = idx;
                         }
                         if( i == dims )
-                        {
-                            int* bin = (int*)cvPtrND( mat, node_idx, 0, 1, 0 );
-                            bin[0]++;
-                        }
+                            node_idx += dims;
                     }
                 }
             }
@@ -1378,20 +1467,21 @@ static CvStatus CV_STDCALL
                             node_idx[i] = idx;
                         }
                         if( i == dims )
-                        {
-                            int* bin = (int*)cvPtrND( mat, node_idx, 0, 1, 0 );
-                            bin[0]++;
-                        }
+                            node_idx += dims;
                     }
                 }
             }
 
+            cvIncSparseND( mat, idxbuf, (int)(node_idx - idxbuf)/dims, 1 );
+
             for( i = 0; i < dims; i++ )
                 img[i] += step;
 
             if( mask )
                 mask += maskStep;
         }
+
+        cvFree( &idxbuf );
     }
 
     return CV_OK;
@@ -1490,19 +1580,6 @@ cvCalcArrHist( CvArr** img, CvHistogram* hist,
     {
         CV_CALL( cvConvert( (CvMatND*)hist->bins, &dense ));
     }
-    else
-    {
-        CvSparseMat* mat = (CvSparseMat*)(hist->bins);
-        CvSparseMatIterator iterator;
-        CvSparseNode* node;
-
-        for( node = cvInitSparseMatIterator( mat, &iterator );
-             node != 0; node = cvGetNextSparseNode( &iterator ))
-        {
-            Cv32suf* val = (Cv32suf*)CV_NODE_VAL( mat, node );
-            val->i = cvRound( val->f );
-        }
-    }
 
     if( CV_MAT_DEPTH(mat0->type) > CV_8S && !CV_HIST_HAS_RANGES(hist))
         CV_ERROR( CV_StsBadArg, "histogram ranges must be set (via cvSetHistBinRanges) "
@@ -1524,23 +1601,11 @@ cvCalcArrHist( CvArr** img, CvHistogram* hist,
         CV_ERROR( CV_StsUnsupportedFormat, "Unsupported array type" );
     }
 
+    // (the sparse bins are incremented in place by cvIncSparseND)
     if( !CV_IS_SPARSE_HIST(hist))
     {
         CV_CALL( cvConvert( &dense, (CvMatND*)hist->bins ));
     }
-    else
-    {
-        CvSparseMat* mat = (CvSparseMat*)(hist->bins);
-        CvSparseMatIterator iterator;
-        CvSparseNode* node;
-
-        for( node = cvInitSparseMatIterator( mat, &iterator );
-             node != 0; node = cvGetNextSparseNode( &iterator ))
-        {
-            Cv32suf* val = (Cv32suf*)CV_NODE_VAL( mat, node );
-            val->f = (float)val->i;
-        }
-    }
     
     __END__;
 }
@@ -2308,46 +2373,227 @@ cvCalcProbDensity( const CvHistogram* hist, const CvHistogram* hist_mask,
 }
 
 
-CV_IMPL void cvEqualizeHist( const CvArr* src, CvArr* dst )
+CV_IMPL void cvEqualizeHist( const CvArr* srcarr, CvArr* dstarr )
 {
-    CvHistogram* hist = 0;
-    CvMat* lut = 0;
-    
     CV_FUNCNAME( "cvEqualizeHist" );
 
     __BEGIN__;
 
-    int i, hist_sz = 256;
-    CvSize img_sz;
+    CvMat sstub, *src = (CvMat*)srcarr;
+    CvMat dstub, *dst = (CvMat*)dstarr;
+    CvMat lut;
+    CvSize size;
+    int hist[256];
+    uchar lut_data[256];
+    int i, sum = 0, step;
     float scale;
-    float* h;
-    int sum = 0;
-    int type;
-    
-    CV_CALL( type = cvGetElemType( src ));
-    if( type != CV_8UC1 )
+
+    CV_CALL( src = cvGetMat( src, &sstub ));
+    CV_CALL( dst = cvGetMat( dst, &dstub ));
+
+    if( CV_MAT_TYPE(src->type) != CV_8UC1 )
         CV_ERROR( CV_StsUnsupportedFormat, "Only 8uC1 images are supported" );
 
-    CV_CALL( hist = cvCreateHist( 1, &hist_sz, CV_HIST_ARRAY ));
-    CV_CALL( lut = cvCreateMat( 1, 256, CV_8UC1 ));
-    CV_CALL( cvCalcArrHist( (CvArr**)&src, hist ));
-    CV_CALL( img_sz = cvGetSize( src ));
-    scale = 255.f/(img_sz.width*img_sz.height);
-    h = (float*)cvPtr1D( hist->bins, 0 );
+    size = cvGetMatSize( src );
+    step = src->step;
+    if( CV_IS_MAT_CONT(src->type) )
+    {
+        size.width *= size.height;
+        size.height = 1;
+        step = CV_STUB_STEP;
+    }
+
+    memset( hist, 0, sizeof(hist) );
+    icvCalcHist8u( src->data.ptr, step, 0, 0, size, hist );
+
+    scale = 255.f/(src->cols*src->rows);
+    for( i = 0; i < 256; i++ )
+    {
+        sum += hist[i];
+        lut_data[i] = (uchar)cvRound(sum*scale);
+    }
+
+    lut_data[0] = 0;
+    lut = cvMat( 1, 256, CV_8UC1, lut_data );
+    CV_CALL( cvLUT( src, dst, &lut ));
+
+    __END__;
+}
+
+
+/*
+   Contrast-limited adaptive histogram equalization (CLAHE).
+
+   The image is divided into tile_grid.width x tile_grid.height tiles. The histograms
+   of all the tiles are computed by the same 8-bit histogram engine as above
+   (the rows of tiles are processed in parallel), each histogram is clipped at
+   clip_limit*(tile_area/256) with the excess redistributed uniformly over the bins,
+   and turned into a per-tile equalization LUT. Every output pixel is then
+   bilinearly interpolated between the LUTs of the 4 nearest tiles.
+*/
+
+typedef struct CvCLAHEParams
+{
+    const CvMat* src;
+    CvMat* dst;
+    int tiles_x, tiles_y;
+    int tile_w, tile_h;
+    double clip_limit;
+    uchar* luts;        // tiles_y x tiles_x x 256
+    const int* xofs;    // 2 x width: offsets of the left and right LUTs
+    const float* xalpha;
+}
+CvCLAHEParams;
+
+static void CV_CDECL
+icvCLAHECalcLutsBody( int start, int end, void* _params )
+{
+    const CvCLAHEParams* p = (const CvCLAHEParams*)_params;
+    const CvMat* src = p->src;
+    int ty, tx, i;
+
+    for( ty = start; ty < end; ty++ )
+    {
+        int y0 = ty*p->tile_h, y1 = MIN( y0 + p->tile_h, src->rows );
+
+        for( tx = 0; tx < p->tiles_x; tx++ )
+        {
+            int x0 = tx*p->tile_w, x1 = MIN( x0 + p->tile_w, src->cols );
+            int area = (x1 - x0)*(y1 - y0), sum = 0;
+            uchar* lut = p->luts + (ty*p->tiles_x + tx)*256;
+            int hist[256];
+            float scale = 255.f/area;
+
+            memset( hist, 0, sizeof(hist) );
+            icvCalcHist8uRows( src->data.ptr + y0*src->step + x0, src->step, 0, 0,
+                               x1 - x0, y1 - y0, hist );
+
+            if( p->clip_limit > 0 )
+            {
+                int limit = MAX( cvRound(p->clip_limit*area/256), 1 );
+                int excess = 0, bonus, residual;
+
+                for( i = 0; i < 256; i++ )
+                    if( hist[i] > limit )
+                    {
+                        excess += hist[i] - limit;
+                        hist[i] = limit;
+                    }
+
+                bonus = excess/256;
+                residual = excess - bonus*256;
+                for( i = 0; i < 256; i++ )
+                    hist[i] += bonus + (i < residual);
+            }
+
+            for( i = 0; i < 256; i++ )
+            {
+                sum += hist[i];
+                lut[i] = (uchar)MIN( cvRound(sum*scale), 255 );
+            }
+        }
+    }
+}
+
+
+static void CV_CDECL
+icvCLAHEInterpolateBody( int start, int end, void* _params )
+{
+    const CvCLAHEParams* p = (const CvCLAHEParams*)_params;
+    const CvMat* src = p->src;
+    int width = src->cols, y, x;
+
+    for( y = start; y < end; y++ )
+    {
+        const uchar* sptr = src->data.ptr + y*src->step;
+        uchar* dptr = p->dst->data.ptr + y*p->dst->step;
+        float fy = (y + 0.5f)/p->tile_h - 0.5f;
+        int ty1 = cvFloor(fy), ty2 = ty1 + 1;
+        float ay = fy - ty1;
+        const uchar *lut1, *lut2;
+
+        ty1 = MAX( ty1, 0 );
+        ty2 = MIN( ty2, p->tiles_y - 1 );
+        lut1 = p->luts + ty1*p->tiles_x*256;
+        lut2 = p->luts + ty2*p->tiles_x*256;
+
+        for( x = 0; x < width; x++ )
+        {
+            int v = sptr[x], ofs1 = p->xofs[x] + v, ofs2 = p->xofs[x + width] + v;
+            float ax = p->xalpha[x];
+            float t1 = lut1[ofs1] + (lut1[ofs2] - lut1[ofs1])*ax;
+            float t2 = lut2[ofs1] + (lut2[ofs2] - lut2[ofs1])*ax;
+            dptr[x] = (uchar)cvRound( t1 + (t2 - t1)*ay );
+        }
+    }
+}
+
+
+CV_IMPL void cvEqualizeHistAdaptive( const CvArr* srcarr, CvArr* dstarr,
+                                     CvSize tile_grid, double clip_limit )
+{
+    uchar* luts = 0;
+    int* xofs = 0;
+
+    CV_FUNCNAME( "cvEqualizeHistAdaptive" );
+
+    __BEGIN__;
+
+    CvMat sstub, *src = (CvMat*)srcarr;
+    CvMat dstub, *dst = (CvMat*)dstarr;
+    CvCLAHEParams p;
+    float* xalpha;
+    int x;
+
+    CV_CALL( src = cvGetMat( src, &sstub ));
+    CV_CALL( dst = cvGetMat( dst, &dstub ));
+
+    if( CV_MAT_TYPE(src->type) != CV_8UC1 || !CV_ARE_TYPES_EQ( src, dst ))
+        CV_ERROR( CV_StsUnsupportedFormat, "Only 8uC1 images are supported" );
 
-    for( i = 0; i < hist_sz; i++ )
+    if( !CV_ARE_SIZES_EQ( src, dst ))
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    if( tile_grid.width <= 0 || tile_grid.height <= 0 ||
+        tile_grid.width > src->cols || tile_grid.height > src->rows )
+        CV_ERROR( CV_StsOutOfRange, "The tile grid must be non-empty and "
+                                    "not larger than the image" );
+
+    p.src = src;
+    p.dst = dst;
+    p.tiles_x = tile_grid.width;
+    p.tiles_y = tile_grid.height;
+    p.tile_w = (src->cols + p.tiles_x - 1)/p.tiles_x;
+    p.tile_h = (src->rows + p.tiles_y - 1)/p.tiles_y;
+    // rounding the tile size up may leave the last tiles empty
+    p.tiles_x = (src->cols + p.tile_w - 1)/p.tile_w;
+    p.tiles_y = (src->rows + p.tile_h - 1)/p.tile_h;
+    p.clip_limit = clip_limit;
+
+    CV_CALL( luts = (uchar*)cvAlloc( p.tiles_x*p.tiles_y*256 ));
+    CV_CALL( xofs = (int*)cvAlloc( src->cols*(sizeof(int)*2 + sizeof(float)) ));
+    xalpha = (float*)(xofs + src->cols*2);
+
+    for( x = 0; x < src->cols; x++ )
     {
-        sum += cvRound(h[i]);
-        lut->data.ptr[i] = (uchar)cvRound(sum*scale);
+        float fx = (x + 0.5f)/p.tile_w - 0.5f;
+        int tx1 = cvFloor(fx), tx2 = tx1 + 1;
+        xalpha[x] = fx - tx1;
+        xofs[x] = MAX( tx1, 0 )*256;
+        xofs[x + src->cols] = MIN( tx2, p.tiles_x - 1 )*256;
     }
+    p.luts = luts;
+    p.xofs = xofs;
+    p.xalpha = xalpha;
 
-    lut->data.ptr[0] = 0;
-    CV_CALL( cvLUT( src, dst, lut ));
+    cvParallelFor( p.tiles_y, icvCLAHECalcLutsBody, &p );
+    cvParallelFor( src->rows, icvCLAHEInterpolateBody, &p,
+                   MAX( (1 << 14)/src->cols, 1 ));
 
     __END__;
 
-    cvReleaseHist(&hist);
-    cvReleaseMat(&lut);
+    cvFree( &luts );
+    cvFree( &xofs );
 }
 
 /* Implementation of RTTI and Generic Functions for CvHistogram */
@@ -62,7 +62,7 @@ float icvLinearCoeffs[(ICV_LINEAR_TAB_SIZE+1)*2];
 void icvInitLinearCoeffTab()
 {
     static int inittab = 0;
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         for( int i = 0; i <= ICV_LINEAR_TAB_SIZE; i++ )
         {
@@ -71,7 +71,7 @@ void icvInitLinearCoeffTab()
             icvLinearCoeffs[i*2+1] = 1.f - x;
         }
 
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 }
 
@@ -81,7 +81,7 @@ float icvCubicCoeffs[(ICV_CUBIC_TAB_SIZE+1)*2];
 void icvInitCubicCoeffTab()
 {
     static int inittab = 0;
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
 #if 0
         // classical Mitchell-Netravali filter
@@ -111,7 +111,7 @@ void icvInitCubicCoeffTab()
             icvCubicCoeffs[i*2+1] = (float)ICV_CUBIC_2(x);
         }
 
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 }
 
@@ -650,10 +650,10 @@ cvResize( const CvArr* srcarr, CvArr* dstarr, int method )
     if( !CV_ARE_TYPES_EQ( src, dst ))
         CV_ERROR( CV_StsUnmatchedFormats, "" );
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitResizeTab( &bilin_tab, &bicube_tab, &areafast_tab, &area_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     ssize = cvGetMatSize( src );
@@ -945,6 +945,1215 @@ cvResize( const CvArr* srcarr, CvArr* dstarr, int method )
 }
 
 
+/****************************************************************************************\
+*                                   Resize plans                                         *
+\****************************************************************************************/
+
+/*
+   A resize plan holds everything cvResize would compute on each call for the given
+   (source size, destination size, type, interpolation): the fixed-point coordinate
+   tables and the row buffers.
+
+   8-bit images are handled by the following code paths:
+   - CV_INTER_LINEAR and up-scaling CV_INTER_AREA: separable bilinear interpolation
+     with 11-bit coefficients. The horizontal pass is a table-driven gather (there is
+     no byte gather in SSE2/NEON), the vertical pass mixes two rows with 16-bit
+     multiplies (SSE2/NEON). All the paths produce bit-exact results.
+   - exact 2x and 4x decimation (CV_INTER_AREA, and CV_INTER_LINEAR for 2x, which gives
+     the same pixel-centered average): (sum + area/2)/area over the 2x2/4x4 blocks,
+     vectorized for single-channel images.
+   Other types and interpolation methods fall back to cvResize.
+*/
+
+#define ICV_RESIZE_PLAN_GENERIC      0
+#define ICV_RESIZE_PLAN_LINEAR_8U    1
+#define ICV_RESIZE_PLAN_DECIMATE2_8U 2
+#define ICV_RESIZE_PLAN_DECIMATE4_8U 3
+
+#define ICV_RESIZE_COEF_BITS  11
+#define ICV_RESIZE_COEF_ONE   (1 << ICV_RESIZE_COEF_BITS)
+
+CV_IMPL CvResizePlan*
+cvCreateResizePlan( CvSize src_size, CvSize dst_size, int type, int interpolation )
+{
+    CvResizePlan* plan = 0;
+
+    CV_FUNCNAME( "cvCreateResizePlan" );
+
+    __BEGIN__;
+
+    int depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
+    int width, dx, dy, k;
+    double scale_x, scale_y;
+
+    if( src_size.width <= 0 || src_size.height <= 0 ||
+        dst_size.width <= 0 || dst_size.height <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "Both image sizes must be positive" );
+
+    if( interpolation != CV_INTER_NN && interpolation != CV_INTER_LINEAR &&
+        interpolation != CV_INTER_CUBIC && interpolation != CV_INTER_AREA )
+        CV_ERROR( CV_StsBadFlag, "Unknown/unsupported interpolation method" );
+
+    CV_CALL( plan = (CvResizePlan*)cvAlloc( sizeof(*plan) ));
+    memset( plan, 0, sizeof(*plan) );
+
+    plan->src_size = src_size;
+    plan->dst_size = dst_size;
+    plan->type = CV_MAT_TYPE(type);
+    plan->interpolation = interpolation;
+    plan->mode = ICV_RESIZE_PLAN_GENERIC;
+
+    if( depth != CV_8U || cn > 4 || (src_size.width == dst_size.width &&
+        src_size.height == dst_size.height) ||
+        (interpolation != CV_INTER_LINEAR && interpolation != CV_INTER_AREA) )
+        EXIT;
+
+    if( (src_size.width == dst_size.width*2 && src_size.height == dst_size.height*2) ||
+        (interpolation == CV_INTER_AREA &&
+         src_size.width == dst_size.width*4 && src_size.height == dst_size.height*4) )
+    {
+        plan->mode = src_size.width == dst_size.width*2 ?
+            ICV_RESIZE_PLAN_DECIMATE2_8U : ICV_RESIZE_PLAN_DECIMATE4_8U;
+        EXIT;
+    }
+
+    // the generic area decimation is not separable, leave it to cvResize
+    if( interpolation == CV_INTER_AREA &&
+        src_size.width >= dst_size.width && src_size.height >= dst_size.height )
+        EXIT;
+
+    plan->mode = ICV_RESIZE_PLAN_LINEAR_8U;
+    width = dst_size.width*cn;
+    scale_x = (double)src_size.width/dst_size.width;
+    scale_y = (double)src_size.height/dst_size.height;
+
+    CV_CALL( plan->xofs = (int*)cvAlloc( (width + dst_size.height)*sizeof(int) ));
+    plan->yofs = plan->xofs + width;
+    CV_CALL( plan->xalpha = (short*)cvAlloc( (width + dst_size.height)*2*sizeof(short) ));
+    plan->yalpha = plan->xalpha + width*2;
+    CV_CALL( plan->buf = (int*)cvAlloc( (width + 4)*2*sizeof(int) ));
+    plan->xmax = dst_size.width;
+
+    // the same coordinates as in cvResize
+    for( dx = 0; dx < dst_size.width; dx++ )
+    {
+        int sx, a;
+        double fx;
+
+        if( interpolation == CV_INTER_LINEAR )
+        {
+            fx = (dx + 0.5)*scale_x - 0.5;
+            sx = cvFloor(fx);
+            fx -= sx;
+        }
+        else
+        {
+            sx = cvFloor(dx*scale_x);
+            fx = (dx + 1) - (sx + 1)/scale_x;
+            fx = fx <= 0 ? 0. : fx - cvFloor(fx);
+        }
+
+        if( sx < 0 )
+            fx = 0, sx = 0;
+
+        if( sx >= src_size.width - 1 )
+        {
+            fx = 0, sx = src_size.width - 1;
+            if( plan->xmax >= dst_size.width )
+                plan->xmax = dx;
+        }
+
+        a = cvRound( fx*ICV_RESIZE_COEF_ONE );
+        for( k = 0; k < cn; k++ )
+        {
+            plan->xofs[dx*cn + k] = sx*cn + k;
+            plan->xalpha[(dx*cn + k)*2] = (short)(ICV_RESIZE_COEF_ONE - a);
+            plan->xalpha[(dx*cn + k)*2 + 1] = (short)a;
+        }
+    }
+
+    for( dy = 0; dy < dst_size.height; dy++ )
+    {
+        int sy, b;
+        double fy;
+
+        if( interpolation == CV_INTER_LINEAR )
+        {
+            fy = (dy + 0.5)*scale_y - 0.5;
+            sy = cvFloor(fy);
+            fy -= sy;
+            if( sy < 0 )
+                sy = 0, fy = 0;
+        }
+        else
+        {
+            sy = cvFloor(dy*scale_y);
+            fy = (dy + 1) - (sy + 1)/scale_y;
+            fy = fy <= 0 ? 0. : fy - cvFloor(fy);
+        }
+
+        if( sy >= src_size.height - 1 )
+            sy = src_size.height - 1, fy = 0;
+
+        b = cvRound( fy*ICV_RESIZE_COEF_ONE );
+        plan->yofs[dy] = sy;
+        plan->yalpha[dy*2] = (short)(ICV_RESIZE_COEF_ONE - b);
+        plan->yalpha[dy*2 + 1] = (short)b;
+    }
+
+    __END__;
+
+    if( cvGetErrStatus() < 0 )
+        cvReleaseResizePlan( &plan );
+
+    return plan;
+}
+
+
+CV_IMPL void
+cvReleaseResizePlan( CvResizePlan** plan )
+{
+    CV_FUNCNAME( "cvReleaseResizePlan" );
+
+    __BEGIN__;
+
+    if( !plan )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( !*plan )
+        EXIT;
+
+    cvFree( &(*plan)->xofs );
+    cvFree( &(*plan)->xalpha );
+    cvFree( &(*plan)->buf );
+    cvFree( plan );
+
+    __END__;
+}
+
+
+// horizontal pass: dst[dx] = src[xofs[dx]]*alpha0 + src[xofs[dx]+cn]*alpha1
+static void
+icvResizeLinearRow_8u( const uchar* src, int* dst, int width, int xmax, int cn,
+                       const int* xofs, const short* xalpha )
+{
+    int dx = 0;
+
+    if( cn == 1 )
+    {
+        for( ; dx <= xmax - 2; dx += 2 )
+        {
+            const uchar* s0 = src + xofs[dx];
+            const uchar* s1 = src + xofs[dx+1];
+            int t0 = s0[0]*xalpha[dx*2] + s0[1]*xalpha[dx*2+1];
+            int t1 = s1[0]*xalpha[dx*2+2] + s1[1]*xalpha[dx*2+3];
+            dst[dx] = t0; dst[dx+1] = t1;
+        }
+    }
+
+    for( ; dx < xmax; dx++ )
+    {
+        const uchar* s = src + xofs[dx];
+        dst[dx] = s[0]*xalpha[dx*2] + s[cn]*xalpha[dx*2+1];
+    }
+
+    for( ; dx < width; dx++ )
+        dst[dx] = src[xofs[dx]]*ICV_RESIZE_COEF_ONE;
+}
+
+
+/* vertical pass: dst[x] = (b0[x]*beta0 + b1[x]*beta1) >> 22, computed as
+   ((b0>>4)*beta0 >> 16) + ((b1>>4)*beta1 >> 16) + 2 >> 2
+   to fit into the 16-bit SIMD multiplications. */
+#define ICV_RESIZE_VLINEAR_8U( b0, b1, beta0, beta1 )       \
+    (((((b0) >> 4)*(beta0) >> 16) + (((b1) >> 4)*(beta1) >> 16) + 2) >> 2)
+
+typedef void (*CvResizeLinearColFunc)( const int* b0, const int* b1, uchar* dst,
+                                       int width, int beta0, int beta1 );
+typedef void (*CvResizeDecimate2RowFunc)( const uchar* s0, const uchar* s1,
+                                          uchar* d, int width );
+typedef void (*CvResizeDecimate4RowFunc)( const uchar* s0, int step, uchar* d, int width );
+
+static void
+icvResizeLinearCol_8u_C( const int* b0, const int* b1, uchar* dst,
+                         int width, int beta0, int beta1 )
+{
+    int x;
+
+    for( x = 0; x < width; x++ )
+    {
+        int t = ICV_RESIZE_VLINEAR_8U( b0[x], b1[x], beta0, beta1 );
+        dst[x] = CV_CAST_8U(t);
+    }
+}
+
+/* the 2x2 averaging of a single-channel row */
+static void
+icvResizeDecimate2Row_8u_C( const uchar* s0, const uchar* s1, uchar* d, int width )
+{
+    int dx;
+
+    for( dx = 0; dx < width; dx++ )
+        d[dx] = (uchar)((s0[dx*2] + s0[dx*2+1] + s1[dx*2] + s1[dx*2+1] + 2) >> 2);
+}
+
+/* the 4x4 averaging of a single-channel row */
+static void
+icvResizeDecimate4Row_8u_C( const uchar* s0, int step, uchar* d, int width )
+{
+    int dx, k;
+
+    for( dx = 0; dx < width; dx++ )
+    {
+        const uchar* s = s0 + dx*4;
+        int sum = 0;
+        for( k = 0; k < 4; k++, s += step )
+            sum += s[0] + s[1] + s[2] + s[3];
+        d[dx] = (uchar)((sum + 8) >> 4);
+    }
+}
+
+#if CV_SSE2
+
+static void
+icvResizeLinearCol_8u_SSE2( const int* b0, const int* b1, uchar* dst,
+                            int width, int beta0, int beta1 )
+{
+    __m128i vbeta0 = _mm_set1_epi16((short)beta0), vbeta1 = _mm_set1_epi16((short)beta1);
+    __m128i vdelta = _mm_set1_epi16(2), z = _mm_setzero_si128();
+    int x = 0;
+
+    for( ; x <= width - 8; x += 8 )
+    {
+        __m128i x0 = _mm_packs_epi32(_mm_srai_epi32(_mm_loadu_si128((const __m128i*)(b0 + x)), 4),
+                                     _mm_srai_epi32(_mm_loadu_si128((const __m128i*)(b0 + x + 4)), 4));
+        __m128i x1 = _mm_packs_epi32(_mm_srai_epi32(_mm_loadu_si128((const __m128i*)(b1 + x)), 4),
+                                     _mm_srai_epi32(_mm_loadu_si128((const __m128i*)(b1 + x + 4)), 4));
+        x0 = _mm_adds_epi16(_mm_mulhi_epi16(x0, vbeta0), _mm_mulhi_epi16(x1, vbeta1));
+        x0 = _mm_srai_epi16(_mm_adds_epi16(x0, vdelta), 2);
+        _mm_storel_epi64( (__m128i*)(dst + x), _mm_packus_epi16(x0, z) );
+    }
+
+    icvResizeLinearCol_8u_C( b0 + x, b1 + x, dst + x, width - x, beta0, beta1 );
+}
+
+static void
+icvResizeDecimate2Row_8u_SSE2( const uchar* s0, const uchar* s1, uchar* d, int width )
+{
+    __m128i mask = _mm_set1_epi16(255), delta = _mm_set1_epi16(2);
+    int dx = 0;
+
+    for( ; dx <= width - 16; dx += 16 )
+    {
+        __m128i r0 = _mm_loadu_si128((const __m128i*)(s0 + dx*2));
+        __m128i r1 = _mm_loadu_si128((const __m128i*)(s1 + dx*2));
+        __m128i r2 = _mm_loadu_si128((const __m128i*)(s0 + dx*2 + 16));
+        __m128i r3 = _mm_loadu_si128((const __m128i*)(s1 + dx*2 + 16));
+        __m128i t0 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(r0, mask),
+            _mm_srli_epi16(r0, 8)), _mm_add_epi16(_mm_and_si128(r1, mask),
+            _mm_srli_epi16(r1, 8)));
+        __m128i t1 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(r2, mask),
+            _mm_srli_epi16(r2, 8)), _mm_add_epi16(_mm_and_si128(r3, mask),
+            _mm_srli_epi16(r3, 8)));
+        t0 = _mm_srli_epi16(_mm_add_epi16(t0, delta), 2);
+        t1 = _mm_srli_epi16(_mm_add_epi16(t1, delta), 2);
+        _mm_storeu_si128( (__m128i*)(d + dx), _mm_packus_epi16(t0, t1) );
+    }
+
+    icvResizeDecimate2Row_8u_C( s0 + dx*2, s1 + dx*2, d + dx, width - dx );
+}
+
+static void
+icvResizeDecimate4Row_8u_SSE2( const uchar* s0, int step, uchar* d, int width )
+{
+    __m128i mask = _mm_set1_epi16(255), one = _mm_set1_epi16(1);
+    __m128i delta = _mm_set1_epi32(8), z = _mm_setzero_si128();
+    int dx = 0, k;
+
+    for( ; dx <= width - 8; dx += 8 )
+    {
+        const uchar* s = s0 + dx*4;
+        __m128i t0 = z, t1 = z;
+        for( k = 0; k < 4; k++ )
+        {
+            __m128i r0 = _mm_loadu_si128((const __m128i*)(s + k*step));
+            __m128i r1 = _mm_loadu_si128((const __m128i*)(s + k*step + 16));
+            t0 = _mm_add_epi16(t0, _mm_add_epi16(_mm_and_si128(r0, mask),
+                                                 _mm_srli_epi16(r0, 8)));
+            t1 = _mm_add_epi16(t1, _mm_add_epi16(_mm_and_si128(r1, mask),
+                                                 _mm_srli_epi16(r1, 8)));
+        }
+        // sum the adjacent pairs of 16-bit sums into the 4x4 block sums
+        t0 = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(t0, one), delta), 4);
+        t1 = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(t1, one), delta), 4);
+        t0 = _mm_packs_epi32(t0, t1);
+        _mm_storel_epi64( (__m128i*)(d + dx), _mm_packus_epi16(t0, z) );
+    }
+
+    icvResizeDecimate4Row_8u_C( s0 + dx*4, step, d + dx, width - dx );
+}
+
+#endif
+
+#if CV_NEON
+
+static void
+icvResizeLinearCol_8u_NEON( const int* b0, const int* b1, uchar* dst,
+                            int width, int beta0, int beta1 )
+{
+    int32x4_t vbeta0 = vdupq_n_s32(beta0), vbeta1 = vdupq_n_s32(beta1);
+    int32x4_t vdelta = vdupq_n_s32(2);
+    int x = 0;
+
+    for( ; x <= width - 8; x += 8 )
+    {
+        int32x4_t t0 = vaddq_s32(
+            vshrq_n_s32(vmulq_s32(vshrq_n_s32(vld1q_s32(b0 + x), 4), vbeta0), 16),
+            vshrq_n_s32(vmulq_s32(vshrq_n_s32(vld1q_s32(b1 + x), 4), vbeta1), 16));
+        int32x4_t t1 = vaddq_s32(
+            vshrq_n_s32(vmulq_s32(vshrq_n_s32(vld1q_s32(b0 + x + 4), 4), vbeta0), 16),
+            vshrq_n_s32(vmulq_s32(vshrq_n_s32(vld1q_s32(b1 + x + 4), 4), vbeta1), 16));
+        t0 = vshrq_n_s32(vaddq_s32(t0, vdelta), 2);
+        t1 = vshrq_n_s32(vaddq_s32(t1, vdelta), 2);
+        vst1_u8( dst + x, vqmovun_s16(vcombine_s16(vmovn_s32(t0), vmovn_s32(t1))) );
+    }
+
+    icvResizeLinearCol_8u_C( b0 + x, b1 + x, dst + x, width - x, beta0, beta1 );
+}
+
+static void
+icvResizeDecimate2Row_8u_NEON( const uchar* s0, const uchar* s1, uchar* d, int width )
+{
+    int dx = 0;
+
+    for( ; dx <= width - 16; dx += 16 )
+    {
+        uint16x8_t t0 = vpaddlq_u8(vld1q_u8(s0 + dx*2));
+        uint16x8_t t1 = vpaddlq_u8(vld1q_u8(s0 + dx*2 + 16));
+        t0 = vpadalq_u8(t0, vld1q_u8(s1 + dx*2));
+        t1 = vpadalq_u8(t1, vld1q_u8(s1 + dx*2 + 16));
+        vst1q_u8( d + dx, vcombine_u8(vrshrn_n_u16(t0, 2), vrshrn_n_u16(t1, 2)) );
+    }
+
+    icvResizeDecimate2Row_8u_C( s0 + dx*2, s1 + dx*2, d + dx, width - dx );
+}
+
+static void
+icvResizeDecimate4Row_8u_NEON( const uchar* s0, int step, uchar* d, int width )
+{
+    int dx = 0, k;
+
+    for( ; dx <= width - 8; dx += 8 )
+    {
+        const uchar* s = s0 + dx*4;
+        uint16x8_t t0 = vpaddlq_u8(vld1q_u8(s));
+        uint16x8_t t1 = vpaddlq_u8(vld1q_u8(s + 16));
+        for( k = 1; k < 4; k++ )
+        {
+            t0 = vpadalq_u8(t0, vld1q_u8(s + k*step));
+            t1 = vpadalq_u8(t1, vld1q_u8(s + k*step + 16));
+        }
+        vst1_u8( d + dx, vmovn_u16(vcombine_u16(
+            vrshrn_n_u32(vpaddlq_u16(t0), 4), vrshrn_n_u32(vpaddlq_u16(t1), 4))) );
+    }
+
+    icvResizeDecimate4Row_8u_C( s0 + dx*4, step, d + dx, width - dx );
+}
+
+#endif
+
+static const CvDispatchVariant icvResizeLinearCol_8u_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvResizeLinearCol_8u_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvResizeLinearCol_8u_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvResizeLinearCol_8u_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvResizeDecimate2Row_8u_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvResizeDecimate2Row_8u_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvResizeDecimate2Row_8u_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvResizeDecimate2Row_8u_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvResizeDecimate4Row_8u_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvResizeDecimate4Row_8u_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvResizeDecimate4Row_8u_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvResizeDecimate4Row_8u_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvResizeLinearCol_8u_entry =
+    CV_DISPATCH_ENTRY( "cvResizeWithPlan_linear_8u", icvResizeLinearCol_8u_variants );
+static CvDispatchEntry icvResizeDecimate2Row_8u_entry =
+    CV_DISPATCH_ENTRY( "cvResizeWithPlan_decimate2_8u", icvResizeDecimate2Row_8u_variants );
+static CvDispatchEntry icvResizeDecimate4Row_8u_entry =
+    CV_DISPATCH_ENTRY( "cvResizeWithPlan_decimate4_8u", icvResizeDecimate4Row_8u_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvResizeLinearCol_8u_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvResizeDecimate2Row_8u_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvResizeDecimate4Row_8u_entry );
+
+
+static void
+icvResizeLinearPlan_8u( const CvMat* src, CvMat* dst, CvResizePlan* plan )
+{
+    CvResizeLinearColFunc col_func =
+        (CvResizeLinearColFunc)cvGetDispatchFunc( &icvResizeLinearCol_8u_entry );
+    int cn = CV_MAT_CN(plan->type), width = plan->dst_size.width*cn;
+    int* buf0 = plan->buf;
+    int* buf1 = buf0 + width + 4;
+    int prev_sy0 = -1, prev_sy1 = -1, dy, k;
+
+    for( dy = 0; dy < plan->dst_size.height; dy++ )
+    {
+        int sy0 = plan->yofs[dy];
+        int beta0 = plan->yalpha[dy*2], beta1 = plan->yalpha[dy*2+1];
+        int sy1 = beta1 != 0 ? sy0 + 1 : sy0;
+        int* t;
+
+        // reuse the horizontally interpolated rows from the previous destination row
+        if( sy0 == prev_sy0 && sy1 == prev_sy1 )
+            k = 2;
+        else if( sy0 == prev_sy1 )
+        {
+            CV_SWAP( buf0, buf1, t );
+            k = 1;
+        }
+        else
+            k = 0;
+
+        for( ; k < 2; k++ )
+        {
+            int sy = k == 0 ? sy0 : sy1;
+            if( k == 1 && sy1 == sy0 )
+            {
+                memcpy( buf1, buf0, width*sizeof(buf0[0]) );
+                continue;
+            }
+            icvResizeLinearRow_8u( src->data.ptr + sy*src->step, k == 0 ? buf0 : buf1,
+                                   width, plan->xmax*cn, cn, plan->xofs, plan->xalpha );
+        }
+
+        prev_sy0 = sy0;
+        prev_sy1 = sy1;
+
+        col_func( buf0, buf1, dst->data.ptr + dy*dst->step, width, beta0, beta1 );
+    }
+}
+
+
+static void
+icvResizeDecimate2_8u( const CvMat* src, CvMat* dst, int cn )
+{
+    CvResizeDecimate2RowFunc row_func =
+        (CvResizeDecimate2RowFunc)cvGetDispatchFunc( &icvResizeDecimate2Row_8u_entry );
+    CvSize dsize = cvGetMatSize( dst );
+    int width = dsize.width*cn, dx, dy, k;
+
+    for( dy = 0; dy < dsize.height; dy++ )
+    {
+        const uchar* s0 = src->data.ptr + dy*2*src->step;
+        const uchar* s1 = s0 + src->step;
+        uchar* d = dst->data.ptr + dy*dst->step;
+
+        if( cn == 1 )
+            row_func( s0, s1, d, width );
+        else
+        {
+            for( dx = 0; dx < width; dx += cn )
+            {
+                const uchar* t0 = s0 + dx*2;
+                const uchar* t1 = s1 + dx*2;
+                for( k = 0; k < cn; k++ )
+                    d[dx+k] = (uchar)((t0[k] + t0[k+cn] + t1[k] + t1[k+cn] + 2) >> 2);
+            }
+        }
+    }
+}
+
+
+static void
+icvResizeDecimate4_8u( const CvMat* src, CvMat* dst, int cn )
+{
+    CvResizeDecimate4RowFunc row_func =
+        (CvResizeDecimate4RowFunc)cvGetDispatchFunc( &icvResizeDecimate4Row_8u_entry );
+    CvSize dsize = cvGetMatSize( dst );
+    int width = dsize.width*cn, dx, dy, k;
+
+    for( dy = 0; dy < dsize.height; dy++ )
+    {
+        const uchar* s0 = src->data.ptr + dy*4*src->step;
+        uchar* d = dst->data.ptr + dy*dst->step;
+        int step = src->step;
+
+        if( cn == 1 )
+            row_func( s0, step, d, width );
+        else
+        {
+            for( dx = 0; dx < width; dx += cn )
+                for( int c = 0; c < cn; c++ )
+                {
+                    const uchar* s = s0 + dx*4 + c;
+                    int sum = 0;
+                    for( k = 0; k < 4; k++, s += step )
+                        sum += s[0] + s[cn] + s[cn*2] + s[cn*3];
+                    d[dx+c] = (uchar)((sum + 8) >> 4);
+                }
+        }
+    }
+}
+
+
+CV_IMPL void
+cvResizeWithPlan( const CvArr* srcarr, CvArr* dstarr, CvResizePlan* plan )
+{
+    CV_FUNCNAME( "cvResizeWithPlan" );
+
+    __BEGIN__;
+
+    CvMat srcstub, *src = (CvMat*)srcarr;
+    CvMat dststub, *dst = (CvMat*)dstarr;
+
+    CV_CALL( src = cvGetMat( srcarr, &srcstub ));
+    CV_CALL( dst = cvGetMat( dstarr, &dststub ));
+
+    if( !plan )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( !CV_ARE_TYPES_EQ( src, dst ) || CV_MAT_TYPE(src->type) != plan->type )
+        CV_ERROR( CV_StsUnmatchedFormats, "The image types do not match the plan" );
+
+    if( src->cols != plan->src_size.width || src->rows != plan->src_size.height ||
+        dst->cols != plan->dst_size.width || dst->rows != plan->dst_size.height )
+        CV_ERROR( CV_StsUnmatchedSizes, "The image sizes do not match the plan" );
+
+    switch( plan->mode )
+    {
+    case ICV_RESIZE_PLAN_LINEAR_8U:
+        icvResizeLinearPlan_8u( src, dst, plan );
+        break;
+    case ICV_RESIZE_PLAN_DECIMATE2_8U:
+        icvResizeDecimate2_8u( src, dst, CV_MAT_CN(plan->type) );
+        break;
+    case ICV_RESIZE_PLAN_DECIMATE4_8U:
+        icvResizeDecimate4_8u( src, dst, CV_MAT_CN(plan->type) );
+        break;
+    default:
+        CV_CALL( cvResize( src, dst, plan->interpolation ));
+    }
+
+    __END__;
+}
+
+
+/****************************************************************************************\
+*                     Tiled fixed-point remap (16-bit maps, 8-bit images)                *
+\****************************************************************************************/
+
+/* The fixed-point coordinates have CV_REMAP_SHIFT fractional bits. A pixel is described by
+   the integer part of its source position (x,y) (a CV_16SC2 map element) and by the
+   fractional parts packed into a single index (a CV_16UC1 map element),
+   alpha = (fy << CV_REMAP_SHIFT) + fx, that selects the 4 bilinear weights
+   from icvRemapTab. The weights sum to 1 << (CV_REMAP_SHIFT*2). */
+#define CV_REMAP_SHIFT 5
+#define CV_REMAP_MASK ((1 << CV_REMAP_SHIFT) - 1)
+#define ICV_REMAP_DESCALE(x) (((x) + (1 << (CV_REMAP_SHIFT*2-1))) >> (CV_REMAP_SHIFT*2))
+
+/* affine coordinates are accumulated with ICV_WARP_AB_BITS fractional bits
+   and then rounded to CV_REMAP_SHIFT bits */
+#define ICV_WARP_AB_BITS 10
+#define ICV_WARP_AB_SCALE (1 << ICV_WARP_AB_BITS)
+
+/* the destination is processed in tiles, so that the source region
+   a tile is mapped from stays in cache for any smooth map */
+#define ICV_REMAP_TILE_W 128
+#define ICV_REMAP_TILE_H 32
+
+#if (CV_SSE2 || CV_NEON) && defined(__GNUC__)
+#define align(x) __attribute__ ((aligned (x)))
+#elif CV_SSE2 && (defined(__ICL) || defined _MSC_VER && _MSC_VER >= 1300)
+#define align(x) __declspec(align(x))
+#else
+#define align(x)
+#endif
+
+static ushort align(16) icvRemapTab[1 << (CV_REMAP_SHIFT*2)][4];
+
+static void icvInitRemapFixedPtTab()
+{
+    static int inittab = 0;
+    if( cvBeginInitOnce( &inittab ))
+    {
+        for( int y = 0; y <= CV_REMAP_MASK; y++ )
+            for( int x = 0; x <= CV_REMAP_MASK; x++ )
+            {
+                ushort* a = icvRemapTab[(y << CV_REMAP_SHIFT) + x];
+                a[0] = (ushort)((CV_REMAP_MASK+1 - y)*(CV_REMAP_MASK+1 - x));
+                a[1] = (ushort)((CV_REMAP_MASK+1 - y)*x);
+                a[2] = (ushort)(y*(CV_REMAP_MASK+1 - x));
+                a[3] = (ushort)(y*x);
+            }
+        cvEndInitOnce( &inittab );
+    }
+}
+
+
+/* Interpolates a single pixel. The pixels which bilinear neighborhood crosses
+   the image border are either interpolated with the replicated border pixels
+   (clip_border != 0, cvWarpAffine/cvWarpPerspective semantics) or treated as outliers */
+CV_INLINE void
+icvRemapPixel_8u( const uchar* src, int sstep, CvSize ssize, uchar* dst,
+                  int xi, int yi, int alpha, int cn,
+                  const uchar* fillval, int clip_border )
+{
+    const ushort* a = icvRemapTab[alpha];
+    int k;
+
+    if( (unsigned)xi < (unsigned)(ssize.width - 1) &&
+        (unsigned)yi < (unsigned)(ssize.height - 1) )
+    {
+        const uchar* s0 = src + yi*sstep + xi*cn;
+        const uchar* s1 = s0 + sstep;
+        for( k = 0; k < cn; k++ )
+            dst[k] = (uchar)ICV_REMAP_DESCALE( s0[k]*a[0] + s0[k+cn]*a[1] +
+                                               s1[k]*a[2] + s1[k+cn]*a[3] );
+    }
+    else if( clip_border && (unsigned)(xi + 1) < (unsigned)(ssize.width + 1) &&
+             (unsigned)(yi + 1) < (unsigned)(ssize.height + 1) )
+    {
+        int x0 = MAX( xi, 0 ), x1 = MIN( xi + 1, ssize.width - 1 );
+        int y0 = MAX( yi, 0 ), y1 = MIN( yi + 1, ssize.height - 1 );
+        const uchar* s0 = src + y0*sstep;
+        const uchar* s1 = src + y1*sstep;
+        x0 *= cn; x1 *= cn;
+        for( k = 0; k < cn; k++ )
+            dst[k] = (uchar)ICV_REMAP_DESCALE( s0[x0+k]*a[0] + s0[x1+k]*a[1] +
+                                               s1[x0+k]*a[2] + s1[x1+k]*a[3] );
+    }
+    else if( fillval )
+        for( k = 0; k < cn; k++ )
+            dst[k] = fillval[k];
+}
+
+
+typedef void (*CvRemapRowFunc)( const uchar* src, int sstep, CvSize ssize, uchar* dst,
+                                const short* xy, const ushort* alpha, int width, int cn,
+                                const uchar* fillval, int clip_border );
+typedef void (*CvWarpAffineCoordsFunc)( const int* adelta, const int* bdelta, int X0, int Y0,
+                                        short* xy, ushort* alpha, int width );
+
+/* Bilinear remapping of a destination row fragment. The SIMD variants gather the source
+   pixels with scalar loads (neither SSE2 nor NEON can gather bytes) and vectorize
+   the weighting. All the variants round identically, so the output does not depend
+   on the variant chosen */
+static void
+icvRemapRow_8u_C( const uchar* src, int sstep, CvSize ssize, uchar* dst,
+                  const short* xy, const ushort* alpha, int width, int cn,
+                  const uchar* fillval, int clip_border )
+{
+    int x;
+
+    for( x = 0; x < width; x++ )
+        icvRemapPixel_8u( src, sstep, ssize, dst + x*cn, xy[x*2], xy[x*2+1],
+                          alpha[x], cn, fillval, clip_border );
+}
+
+/* Converts a row of affine fixed-point coordinates (ICV_WARP_AB_BITS fractional bits,
+   the rounding term is already added to X0 and Y0) into the 16-bit map format */
+static void
+icvWarpAffineCoords_C( const int* adelta, const int* bdelta, int X0, int Y0,
+                       short* xy, ushort* alpha, int width )
+{
+    const int shift = ICV_WARP_AB_BITS - CV_REMAP_SHIFT;
+    int x;
+
+    for( x = 0; x < width; x++ )
+    {
+        int X = (X0 + adelta[x]) >> shift;
+        int Y = (Y0 + bdelta[x]) >> shift;
+        int xi = X >> CV_REMAP_SHIFT, yi = Y >> CV_REMAP_SHIFT;
+        xy[x*2] = (short)(xi < SHRT_MIN ? SHRT_MIN : xi > SHRT_MAX ? SHRT_MAX : xi);
+        xy[x*2+1] = (short)(yi < SHRT_MIN ? SHRT_MIN : yi > SHRT_MAX ? SHRT_MAX : yi);
+        alpha[x] = (ushort)(((Y & CV_REMAP_MASK) << CV_REMAP_SHIFT) + (X & CV_REMAP_MASK));
+    }
+}
+
+#if CV_SSE2
+
+static void
+icvRemapRow_8u_SSE2( const uchar* src, int sstep, CvSize ssize, uchar* dst,
+                     const short* xy, const ushort* alpha, int width, int cn,
+                     const uchar* fillval, int clip_border )
+{
+    unsigned wmax = ssize.width - 1, hmax = ssize.height - 1;
+    __m128i z = _mm_setzero_si128();
+    __m128i delta = _mm_set1_epi32( 1 << (CV_REMAP_SHIFT*2-1) );
+    int x = 0;
+
+    if( cn == 1 )
+    {
+        // per 8 pixels: the (top-left, top-right) pairs, the (bottom-left, bottom-right)
+        // pairs and the corresponding (a0, a1) and (a2, a3) weight pairs
+        uchar align(16) pbuf[32];
+        ushort align(16) wbuf[32];
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m128i p0, p1, s0, s1;
+            int j;
+            for( j = 0; j < 8; j++ )
+            {
+                int xi = xy[(x+j)*2], yi = xy[(x+j)*2+1];
+                const uchar* s;
+                const ushort* a;
+                if( (unsigned)xi >= wmax || (unsigned)yi >= hmax )
+                    break;
+                s = src + yi*sstep + xi;
+                a = icvRemapTab[alpha[x+j]];
+                pbuf[j*2] = s[0]; pbuf[j*2+1] = s[1];
+                pbuf[j*2+16] = s[sstep]; pbuf[j*2+17] = s[sstep+1];
+                wbuf[j*2] = a[0]; wbuf[j*2+1] = a[1];
+                wbuf[j*2+16] = a[2]; wbuf[j*2+17] = a[3];
+            }
+
+            if( j < 8 )
+            {
+                icvRemapRow_8u_C( src, sstep, ssize, dst + x, xy + x*2, alpha + x,
+                                  8, 1, fillval, clip_border );
+                continue;
+            }
+
+            p0 = _mm_load_si128( (const __m128i*)pbuf );
+            p1 = _mm_load_si128( (const __m128i*)(pbuf + 16) );
+            s0 = _mm_add_epi32( _mm_madd_epi16( _mm_unpacklo_epi8(p0, z),
+                                    _mm_load_si128( (const __m128i*)wbuf )),
+                                _mm_madd_epi16( _mm_unpacklo_epi8(p1, z),
+                                    _mm_load_si128( (const __m128i*)(wbuf + 16) )));
+            s1 = _mm_add_epi32( _mm_madd_epi16( _mm_unpackhi_epi8(p0, z),
+                                    _mm_load_si128( (const __m128i*)(wbuf + 8) )),
+                                _mm_madd_epi16( _mm_unpackhi_epi8(p1, z),
+                                    _mm_load_si128( (const __m128i*)(wbuf + 24) )));
+            s0 = _mm_srai_epi32( _mm_add_epi32( s0, delta ), CV_REMAP_SHIFT*2 );
+            s1 = _mm_srai_epi32( _mm_add_epi32( s1, delta ), CV_REMAP_SHIFT*2 );
+            _mm_storel_epi64( (__m128i*)(dst + x),
+                              _mm_packus_epi16( _mm_packs_epi32( s0, s1 ), z ));
+        }
+    }
+    else
+    {
+        // one pixel per iteration: the channels of the left and the right neighbors
+        // are adjacent, so each source row is a single 8-byte load. For 3 channels
+        // the load reads 2 bytes past the right neighbor, so the last column goes
+        // through the scalar code
+        unsigned xmax = cn == 4 ? wmax : wmax - 1;
+        for( ; x < width; x++ )
+        {
+            int xi = xy[x*2], yi = xy[x*2+1];
+            const uchar* s;
+            const ushort* a;
+            uchar* d = dst + x*cn;
+            __m128i r0, r1, sum;
+            int v;
+
+            if( (unsigned)xi >= xmax || (unsigned)yi >= hmax )
+            {
+                icvRemapPixel_8u( src, sstep, ssize, d, xi, yi, alpha[x],
+                                  cn, fillval, clip_border );
+                continue;
+            }
+
+            s = src + yi*sstep + xi*cn;
+            a = icvRemapTab[alpha[x]];
+            r0 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)s ), z );
+            r1 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(s + sstep) ), z );
+            // (left, right) pairs of each channel
+            if( cn == 3 )
+            {
+                r0 = _mm_unpacklo_epi16( r0, _mm_srli_si128( r0, 6 ));
+                r1 = _mm_unpacklo_epi16( r1, _mm_srli_si128( r1, 6 ));
+            }
+            else
+            {
+                r0 = _mm_unpacklo_epi16( r0, _mm_srli_si128( r0, 8 ));
+                r1 = _mm_unpacklo_epi16( r1, _mm_srli_si128( r1, 8 ));
+            }
+            sum = _mm_add_epi32( _mm_madd_epi16( r0, _mm_set1_epi32( a[0] + (a[1] << 16) )),
+                                 _mm_madd_epi16( r1, _mm_set1_epi32( a[2] + (a[3] << 16) )));
+            sum = _mm_srai_epi32( _mm_add_epi32( sum, delta ), CV_REMAP_SHIFT*2 );
+            v = _mm_cvtsi128_si32( _mm_packus_epi16( _mm_packs_epi32( sum, z ), z ));
+            d[0] = (uchar)v; d[1] = (uchar)(v >> 8); d[2] = (uchar)(v >> 16);
+            if( cn == 4 )
+                d[3] = (uchar)(v >> 24);
+        }
+    }
+
+    icvRemapRow_8u_C( src, sstep, ssize, dst + x*cn, xy + x*2, alpha + x,
+                      width - x, cn, fillval, clip_border );
+}
+
+static void
+icvWarpAffineCoords_SSE2( const int* adelta, const int* bdelta, int X0, int Y0,
+                          short* xy, ushort* alpha, int width )
+{
+    const int shift = ICV_WARP_AB_BITS - CV_REMAP_SHIFT;
+    __m128i vX0 = _mm_set1_epi32(X0), vY0 = _mm_set1_epi32(Y0);
+    __m128i mask = _mm_set1_epi32(CV_REMAP_MASK);
+    int x = 0;
+
+    for( ; x <= width - 4; x += 4 )
+    {
+        __m128i X = _mm_srai_epi32( _mm_add_epi32( vX0,
+                        _mm_loadu_si128( (const __m128i*)(adelta + x) )), shift );
+        __m128i Y = _mm_srai_epi32( _mm_add_epi32( vY0,
+                        _mm_loadu_si128( (const __m128i*)(bdelta + x) )), shift );
+        __m128i a = _mm_or_si128( _mm_slli_epi32( _mm_and_si128( Y, mask ), CV_REMAP_SHIFT ),
+                                  _mm_and_si128( X, mask ));
+        __m128i xi = _mm_srai_epi32( X, CV_REMAP_SHIFT );
+        __m128i yi = _mm_srai_epi32( Y, CV_REMAP_SHIFT );
+        _mm_storeu_si128( (__m128i*)(xy + x*2),
+            _mm_unpacklo_epi16( _mm_packs_epi32( xi, xi ), _mm_packs_epi32( yi, yi )));
+        _mm_storel_epi64( (__m128i*)(alpha + x), _mm_packs_epi32( a, a ));
+    }
+
+    icvWarpAffineCoords_C( adelta + x, bdelta + x, X0, Y0, xy + x*2, alpha + x, width - x );
+}
+
+#endif
+
+#if CV_NEON
+
+static void
+icvRemapRow_8u_NEON( const uchar* src, int sstep, CvSize ssize, uchar* dst,
+                     const short* xy, const ushort* alpha, int width, int cn,
+                     const uchar* fillval, int clip_border )
+{
+    unsigned wmax = ssize.width - 1, hmax = ssize.height - 1;
+    int x = 0;
+
+    if( cn == 1 )
+    {
+        // the same layout as in the SSE2 variant
+        uchar align(16) pbuf[32];
+        ushort align(16) wbuf[32];
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            int j;
+            for( j = 0; j < 8; j++ )
+            {
+                int xi = xy[(x+j)*2], yi = xy[(x+j)*2+1];
+                const uchar* s;
+                const ushort* a;
+                if( (unsigned)xi >= wmax || (unsigned)yi >= hmax )
+                    break;
+                s = src + yi*sstep + xi;
+                a = icvRemapTab[alpha[x+j]];
+                pbuf[j*2] = s[0]; pbuf[j*2+1] = s[1];
+                pbuf[j*2+16] = s[sstep]; pbuf[j*2+17] = s[sstep+1];
+                wbuf[j*2] = a[0]; wbuf[j*2+1] = a[1];
+                wbuf[j*2+16] = a[2]; wbuf[j*2+17] = a[3];
+            }
+
+            if( j < 8 )
+            {
+                icvRemapRow_8u_C( src, sstep, ssize, dst + x, xy + x*2, alpha + x,
+                                  8, 1, fillval, clip_border );
+                continue;
+            }
+
+            {
+            uint8x8x2_t p0 = vld2_u8( pbuf ), p1 = vld2_u8( pbuf + 16 );
+            uint16x8x2_t w0 = vld2q_u16( wbuf ), w1 = vld2q_u16( wbuf + 16 );
+            uint16x8_t p00 = vmovl_u8(p0.val[0]), p01 = vmovl_u8(p0.val[1]);
+            uint16x8_t p10 = vmovl_u8(p1.val[0]), p11 = vmovl_u8(p1.val[1]);
+            uint32x4_t s0, s1;
+
+            s0 = vmull_u16( vget_low_u16(p00), vget_low_u16(w0.val[0]) );
+            s0 = vmlal_u16( s0, vget_low_u16(p01), vget_low_u16(w0.val[1]) );
+            s0 = vmlal_u16( s0, vget_low_u16(p10), vget_low_u16(w1.val[0]) );
+            s0 = vmlal_u16( s0, vget_low_u16(p11), vget_low_u16(w1.val[1]) );
+            s1 = vmull_u16( vget_high_u16(p00), vget_high_u16(w0.val[0]) );
+            s1 = vmlal_u16( s1, vget_high_u16(p01), vget_high_u16(w0.val[1]) );
+            s1 = vmlal_u16( s1, vget_high_u16(p10), vget_high_u16(w1.val[0]) );
+            s1 = vmlal_u16( s1, vget_high_u16(p11), vget_high_u16(w1.val[1]) );
+            vst1_u8( dst + x, vmovn_u16( vcombine_u16(
+                vrshrn_n_u32( s0, CV_REMAP_SHIFT*2 ), vrshrn_n_u32( s1, CV_REMAP_SHIFT*2 ))));
+            }
+        }
+    }
+    else
+    {
+        // one pixel per iteration, see the SSE2 variant
+        unsigned xmax = cn == 4 ? wmax : wmax - 1;
+        for( ; x < width; x++ )
+        {
+            int xi = xy[x*2], yi = xy[x*2+1];
+            const uchar* s;
+            const ushort* a;
+            uchar* d = dst + x*cn;
+
+            if( (unsigned)xi >= xmax || (unsigned)yi >= hmax )
+            {
+                icvRemapPixel_8u( src, sstep, ssize, d, xi, yi, alpha[x],
+                                  cn, fillval, clip_border );
+                continue;
+            }
+
+            s = src + yi*sstep + xi*cn;
+            a = icvRemapTab[alpha[x]];
+            {
+            uint16x8_t r0 = vmovl_u8( vld1_u8(s) ), r1 = vmovl_u8( vld1_u8(s + sstep) );
+            uint32x4_t sum;
+            uint16x4_t v;
+            if( cn == 3 )
+            {
+                r0 = vcombine_u16( vget_low_u16(r0), vget_low_u16( vextq_u16(r0, r0, 3) ));
+                r1 = vcombine_u16( vget_low_u16(r1), vget_low_u16( vextq_u16(r1, r1, 3) ));
+            }
+            sum = vmull_n_u16( vget_low_u16(r0), a[0] );
+            sum = vmlal_n_u16( sum, vget_high_u16(r0), a[1] );
+            sum = vmlal_n_u16( sum, vget_low_u16(r1), a[2] );
+            sum = vmlal_n_u16( sum, vget_high_u16(r1), a[3] );
+            v = vrshrn_n_u32( sum, CV_REMAP_SHIFT*2 );
+            d[0] = (uchar)vget_lane_u16(v, 0); d[1] = (uchar)vget_lane_u16(v, 1);
+            d[2] = (uchar)vget_lane_u16(v, 2);
+            if( cn == 4 )
+                d[3] = (uchar)vget_lane_u16(v, 3);
+            }
+        }
+    }
+
+    icvRemapRow_8u_C( src, sstep, ssize, dst + x*cn, xy + x*2, alpha + x,
+                      width - x, cn, fillval, clip_border );
+}
+
+static void
+icvWarpAffineCoords_NEON( const int* adelta, const int* bdelta, int X0, int Y0,
+                          short* xy, ushort* alpha, int width )
+{
+    const int shift = ICV_WARP_AB_BITS - CV_REMAP_SHIFT;
+    int32x4_t vX0 = vdupq_n_s32(X0), vY0 = vdupq_n_s32(Y0);
+    int32x4_t mask = vdupq_n_s32(CV_REMAP_MASK);
+    int x = 0;
+
+    for( ; x <= width - 4; x += 4 )
+    {
+        int32x4_t X = vshrq_n_s32( vaddq_s32( vX0, vld1q_s32( adelta + x )), shift );
+        int32x4_t Y = vshrq_n_s32( vaddq_s32( vY0, vld1q_s32( bdelta + x )), shift );
+        int16x4x2_t v;
+        int32x4_t a = vorrq_s32( vshlq_n_s32( vandq_s32( Y, mask ), CV_REMAP_SHIFT ),
+                                 vandq_s32( X, mask ));
+        v.val[0] = vqmovn_s32( vshrq_n_s32( X, CV_REMAP_SHIFT ));
+        v.val[1] = vqmovn_s32( vshrq_n_s32( Y, CV_REMAP_SHIFT ));
+        vst2_s16( xy + x*2, v );
+        vst1_u16( alpha + x, vmovn_u32( vreinterpretq_u32_s32( a )));
+    }
+
+    icvWarpAffineCoords_C( adelta + x, bdelta + x, X0, Y0, xy + x*2, alpha + x, width - x );
+}
+
+#endif
+
+static const CvDispatchVariant icvRemapRow_8u_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvRemapRow_8u_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvRemapRow_8u_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvRemapRow_8u_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvWarpAffineCoords_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvWarpAffineCoords_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvWarpAffineCoords_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvWarpAffineCoords_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvRemapRow_8u_entry =
+    CV_DISPATCH_ENTRY( "cvRemap_fixedpt_8u", icvRemapRow_8u_variants );
+static CvDispatchEntry icvWarpAffineCoords_entry =
+    CV_DISPATCH_ENTRY( "cvWarpAffine_fixedpt_coords", icvWarpAffineCoords_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvRemapRow_8u_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvWarpAffineCoords_entry );
+
+
+/* Perspective coordinates for the destination pixels (x0..x0+width-1, y).
+   The division is done per pixel in double precision, the result is rounded
+   to CV_REMAP_SHIFT fractional bits and saturated to the 16-bit range */
+static void
+icvWarpPerspectiveCoords( const double* M, int x0, int y,
+                          short* xy, ushort* alpha, int width )
+{
+    const double scale = 1 << CV_REMAP_SHIFT, lim = SHRT_MAX*scale;
+    double X0 = M[0]*x0 + M[1]*y + M[2];
+    double Y0 = M[3]*x0 + M[4]*y + M[5];
+    double W0 = M[6]*x0 + M[7]*y + M[8];
+    int x;
+
+    for( x = 0; x < width; x++ )
+    {
+        double W = W0 + M[6]*x;
+        double fX, fY;
+        int X, Y;
+        W = W ? scale/W : 0;
+        fX = (X0 + M[0]*x)*W;
+        fY = (Y0 + M[3]*x)*W;
+        X = cvRound( MAX( MIN( fX, lim ), -lim ));
+        Y = cvRound( MAX( MIN( fY, lim ), -lim ));
+        xy[x*2] = (short)(X >> CV_REMAP_SHIFT);
+        xy[x*2+1] = (short)(Y >> CV_REMAP_SHIFT);
+        alpha[x] = (ushort)(((Y & CV_REMAP_MASK) << CV_REMAP_SHIFT) + (X & CV_REMAP_MASK));
+    }
+}
+
+
+typedef struct CvRemapTileParams
+{
+    const CvMat* src;
+    CvMat* dst;
+    const CvMat* xymap;     // CV_16SC2 coordinates or 0 if they are computed on the fly
+    const CvMat* amap;      // CV_16UC1 (or CV_16SC1) interpolation table indices
+    const double* matrix;   // inverse affine (2x3) or perspective (3x3) transformation
+    int perspective;
+    const int* adelta;      // affine increments along the row, ICV_WARP_AB_BITS
+    const int* bdelta;
+    const uchar* fillval;   // 0 if the outliers should be left untouched
+    int clip_border;
+    int tiles_x;
+    CvRemapRowFunc remap_row;
+    CvWarpAffineCoordsFunc affine_coords;
+}
+CvRemapTileParams;
+
+
+static void CV_CDECL
+icvRemapTilesBody( int start, int end, void* userdata )
+{
+    const CvRemapTileParams* p = (const CvRemapTileParams*)userdata;
+    const CvMat* src = p->src;
+    CvMat* dst = p->dst;
+    CvSize ssize = cvGetMatSize( src );
+    int cn = CV_MAT_CN(src->type);
+    short align(16) xybuf[ICV_REMAP_TILE_W*2];
+    ushort align(16) abuf[ICV_REMAP_TILE_W];
+    int t, y;
+
+    for( t = start; t < end; t++ )
+    {
+        int x0 = (t % p->tiles_x)*ICV_REMAP_TILE_W;
+        int y0 = (t / p->tiles_x)*ICV_REMAP_TILE_H;
+        int width = MIN( ICV_REMAP_TILE_W, dst->cols - x0 );
+        int y1 = MIN( y0 + ICV_REMAP_TILE_H, dst->rows );
+
+        for( y = y0; y < y1; y++ )
+        {
+            const short* xy = xybuf;
+            const ushort* alpha = abuf;
+
+            if( p->xymap )
+            {
+                xy = (const short*)(p->xymap->data.ptr + p->xymap->step*y) + x0*2;
+                alpha = (const ushort*)(p->amap->data.ptr + p->amap->step*y) + x0;
+            }
+            else if( p->perspective )
+                icvWarpPerspectiveCoords( p->matrix, x0, y, xybuf, abuf, width );
+            else
+            {
+                const double* M = p->matrix;
+                int round_delta = ICV_WARP_AB_SCALE >> (CV_REMAP_SHIFT + 1);
+                int X0 = cvRound( (M[1]*y + M[2])*ICV_WARP_AB_SCALE ) + round_delta;
+                int Y0 = cvRound( (M[4]*y + M[5])*ICV_WARP_AB_SCALE ) + round_delta;
+                p->affine_coords( p->adelta + x0, p->bdelta + x0, X0, Y0,
+                                  xybuf, abuf, width );
+            }
+
+            p->remap_row( src->data.ptr, src->step, ssize,
+                          dst->data.ptr + dst->step*y + x0*cn, xy, alpha,
+                          width, cn, p->fillval, p->clip_border );
+        }
+    }
+}
+
+
+/* Runs the destination tiles on the worker threads. The coordinates are taken either
+   from the 16-bit maps (xymap, amap) or computed per tile from the inverse
+   transformation matrix (2x3 affine or, if perspective != 0, 3x3) */
+static void
+icvRemapTiled_8u( const CvMat* src, CvMat* dst, const CvMat* xymap, const CvMat* amap,
+                  const double* matrix, int perspective,
+                  const uchar* fillval, int clip_border )
+{
+    CvRemapTileParams p;
+    int tiles_y, x;
+    int* adelta = 0;
+
+    icvInitRemapFixedPtTab();
+
+    if( !xymap && !perspective )
+    {
+        adelta = (int*)cvStackAlloc( dst->cols*2*sizeof(adelta[0]) );
+        for( x = 0; x < dst->cols; x++ )
+        {
+            adelta[x] = cvRound( matrix[0]*x*ICV_WARP_AB_SCALE );
+            adelta[x + dst->cols] = cvRound( matrix[3]*x*ICV_WARP_AB_SCALE );
+        }
+    }
+
+    p.src = src;
+    p.dst = dst;
+    p.xymap = xymap;
+    p.amap = amap;
+    p.matrix = matrix;
+    p.perspective = perspective;
+    p.adelta = adelta;
+    p.bdelta = adelta ? adelta + dst->cols : 0;
+    p.fillval = fillval;
+    p.clip_border = clip_border;
+    p.tiles_x = (dst->cols + ICV_REMAP_TILE_W - 1)/ICV_REMAP_TILE_W;
+    p.remap_row = (CvRemapRowFunc)cvGetDispatchFunc( &icvRemapRow_8u_entry );
+    p.affine_coords = (CvWarpAffineCoordsFunc)cvGetDispatchFunc( &icvWarpAffineCoords_entry );
+    tiles_y = (dst->rows + ICV_REMAP_TILE_H - 1)/ICV_REMAP_TILE_H;
+
+    cvParallelFor( p.tiles_x*tiles_y, icvRemapTilesBody, &p );
+}
+
+
+/* Checks that the affine transformation maps the whole destination into the range,
+   where the ICV_WARP_AB_BITS fixed-point coordinates do not overflow */
+static int
+icvWarpAffineFitsFixedPt( const double* M, CvSize dsize )
+{
+    const double lim = (double)(INT_MAX/4)/ICV_WARP_AB_SCALE;
+    int i;
+    for( i = 0; i < 4; i++ )
+    {
+        double x = (i & 1) ? dsize.width : 0, y = (i & 2) ? dsize.height : 0;
+        if( fabs(M[0]*x + M[1]*y + M[2]) > lim || fabs(M[3]*x + M[4]*y + M[5]) > lim )
+            return 0;
+    }
+    return 1;
+}
+
+
 /****************************************************************************************\
 *                                     WarpAffine                                         *
 \****************************************************************************************/
@@ -1092,10 +2301,10 @@ cvWarpAffine( const CvArr* srcarr, CvArr* dstarr, const CvMat* matrix,
     CvWarpAffineFunc func;
     CvSize ssize, dsize;
     
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitWarpAffineTab( &bilin_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     CV_CALL( src = cvGetMat( srcarr, &srcstub ));
@@ -1162,6 +2371,16 @@ cvWarpAffine( const CvArr* srcarr, CvArr* dstarr, const CvMat* matrix,
     }
 
     cvScalarToRawData( &fillval, fillbuf, CV_MAT_TYPE(src->type), 0 );
+
+    // the fixed-point path interpolates bilinearly only
+    if( (flags & CV_WARP_FIXED_POINT) && (flags & 3) == CV_INTER_LINEAR &&
+        depth == CV_8U && cn != 2 && icvWarpAffineFitsFixedPt( dst_matrix, dsize ))
+    {
+        icvRemapTiled_8u( src, dst, 0, 0, dst_matrix, 0,
+                          flags & CV_WARP_FILL_OUTLIERS ? (uchar*)fillbuf : 0, 1 );
+        EXIT;
+    }
+
     ofs = (int*)cvStackAlloc( dst->cols*2*sizeof(ofs[0]) );
     for( k = 0; k < dst->cols; k++ )
     {
@@ -1370,10 +2589,10 @@ cvWarpPerspective( const CvArr* srcarr, CvArr* dstarr,
     if( method == CV_INTER_NN || method == CV_INTER_AREA )
         method = CV_INTER_LINEAR;
     
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitWarpPerspectiveTab( &bilin_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     CV_CALL( src = cvGetMat( srcarr, &srcstub ));
@@ -1456,6 +2675,15 @@ cvWarpPerspective( const CvArr* srcarr, CvArr* dstarr,
 
     cvScalarToRawData( &fillval, fillbuf, CV_MAT_TYPE(src->type), 0 );
 
+    // the fixed-point path interpolates bilinearly only
+    if( (flags & CV_WARP_FIXED_POINT) && (flags & 3) == CV_INTER_LINEAR &&
+        depth == CV_8U && cn != 2 )
+    {
+        icvRemapTiled_8u( src, dst, 0, 0, dst_matrix, 1,
+                          flags & CV_WARP_FILL_OUTLIERS ? (uchar*)fillbuf : 0, 1 );
+        EXIT;
+    }
+
     /*if( method == CV_INTER_LINEAR )*/
     {
         func = (CvWarpPerspectiveFunc)bilin_tab.fn_2d[depth];
@@ -1778,197 +3006,6 @@ icvRemap_32f_C4R_t icvRemap_32f_C4R_p = 0;
 
 /**************************************************************/
 
-#define CV_REMAP_SHIFT 5
-#define CV_REMAP_MASK ((1 << CV_REMAP_SHIFT) - 1)
-
-#if CV_SSE2 && defined(__GNUC__)
-#define align(x) __attribute__ ((aligned (x)))
-#elif CV_SSE2 && (defined(__ICL) || defined _MSC_VER && _MSC_VER >= 1300)
-#define align(x) __declspec(align(x))
-#else
-#define align(x)
-#endif
-
-static void icvRemapFixedPt_8u( const CvMat* src, CvMat* dst,
-    const CvMat* xymap, const CvMat* amap, const uchar* fillval )
-{
-    const int TABSZ = 1 << (CV_REMAP_SHIFT*2);
-    static ushort align(8) atab[TABSZ][4];
-    static int inittab = 0;
-
-    int x, y, cols = src->cols, rows = src->rows;
-    const uchar* sptr0 = src->data.ptr;
-    int sstep = src->step;
-    uchar fv0 = fillval[0], fv1 = fillval[1], fv2 = fillval[2], fv3 = fillval[3];
-    int cn = CV_MAT_CN(src->type);
-#if CV_SSE2
-    const uchar* sptr1 = sptr0 + sstep;
-    __m128i br = _mm_set1_epi32((cols-2) + ((rows-2)<<16));
-    __m128i xy2ofs = _mm_set1_epi32(1 + (sstep << 16));
-    __m128i z = _mm_setzero_si128();
-    int align(16) iofs0[4], iofs1[4];
-#endif
-
-    if( !inittab )
-    {
-        for( y = 0; y <= CV_REMAP_MASK; y++ )
-            for( x = 0; x <= CV_REMAP_MASK; x++ )
-            {
-                int k = (y << CV_REMAP_SHIFT) + x;
-                atab[k][0] = (ushort)((CV_REMAP_MASK+1 - y)*(CV_REMAP_MASK+1 - x));
-                atab[k][1] = (ushort)((CV_REMAP_MASK+1 - y)*x);
-                atab[k][2] = (ushort)(y*(CV_REMAP_MASK+1 - x));
-                atab[k][3] = (ushort)(y*x);
-            }
-        inittab = 1;
-    }
-
-    for( y = 0; y < rows; y++ )
-    {
-        const short* xy = (const short*)(xymap->data.ptr + xymap->step*y);
-        const ushort* alpha = (const ushort*)(amap->data.ptr + amap->step*y);
-        uchar* dptr = (uchar*)(dst->data.ptr + dst->step*y);
-        int x = 0;
-
-        if( cn == 1 )
-        {
-    #if CV_SSE2
-            for( ; x <= cols - 8; x += 8 )
-            {
-                __m128i xy0 = _mm_load_si128( (const __m128i*)(xy + x*2));
-                __m128i xy1 = _mm_load_si128( (const __m128i*)(xy + x*2 + 8));
-                // 0|0|0|0|... <= x0|y0|x1|y1|... < cols-1|rows-1|cols-1|rows-1|... ?
-                __m128i mask0 = _mm_cmpeq_epi32(_mm_or_si128(_mm_cmpgt_epi16(z, xy0),
-                                                _mm_cmpgt_epi16(xy0,br)), z);
-                __m128i mask1 = _mm_cmpeq_epi32(_mm_or_si128(_mm_cmpgt_epi16(z, xy1),
-                                                _mm_cmpgt_epi16(xy1,br)), z);
-                __m128i ofs0 = _mm_and_si128(_mm_madd_epi16( xy0, xy2ofs ), mask0 );
-                __m128i ofs1 = _mm_and_si128(_mm_madd_epi16( xy1, xy2ofs ), mask1 );
-                unsigned i0, i1;
-                __m128i v0, v1, v2, v3, a0, a1, b0, b1;
-                _mm_store_si128( (__m128i*)iofs0, ofs0 );
-                _mm_store_si128( (__m128i*)iofs1, ofs1 );
-                i0 = *(ushort*)(sptr0 + iofs0[0]) + (*(ushort*)(sptr0 + iofs0[1]) << 16);
-                i1 = *(ushort*)(sptr0 + iofs0[2]) + (*(ushort*)(sptr0 + iofs0[3]) << 16);
-                v0 = _mm_unpacklo_epi32(_mm_cvtsi32_si128(i0), _mm_cvtsi32_si128(i1));
-                i0 = *(ushort*)(sptr1 + iofs0[0]) + (*(ushort*)(sptr1 + iofs0[1]) << 16);
-                i1 = *(ushort*)(sptr1 + iofs0[2]) + (*(ushort*)(sptr1 + iofs0[3]) << 16);
-                v1 = _mm_unpacklo_epi32(_mm_cvtsi32_si128(i0), _mm_cvtsi32_si128(i1));
-                v0 = _mm_unpacklo_epi8(v0, z);
-                v1 = _mm_unpacklo_epi8(v1, z);
-
-                a0 = _mm_unpacklo_epi32(_mm_loadl_epi64((__m128i*)atab[alpha[x]]),
-                                        _mm_loadl_epi64((__m128i*)atab[alpha[x+1]]));
-                a1 = _mm_unpacklo_epi32(_mm_loadl_epi64((__m128i*)atab[alpha[x+2]]),
-                                        _mm_loadl_epi64((__m128i*)atab[alpha[x+3]]));
-                b0 = _mm_unpacklo_epi64(a0, a1);
-                b1 = _mm_unpackhi_epi64(a0, a1);
-                v0 = _mm_madd_epi16(v0, b0);
-                v1 = _mm_madd_epi16(v1, b1);
-                v0 = _mm_and_si128(_mm_add_epi32(v0, v1), mask0);
-
-                i0 = *(ushort*)(sptr0 + iofs1[0]) + (*(ushort*)(sptr0 + iofs1[1]) << 16);
-                i1 = *(ushort*)(sptr0 + iofs1[2]) + (*(ushort*)(sptr0 + iofs1[3]) << 16);
-                v2 = _mm_unpacklo_epi32(_mm_cvtsi32_si128(i0), _mm_cvtsi32_si128(i1));
-                i0 = *(ushort*)(sptr1 + iofs1[0]) + (*(ushort*)(sptr1 + iofs1[1]) << 16);
-                i1 = *(ushort*)(sptr1 + iofs1[2]) + (*(ushort*)(sptr1 + iofs1[3]) << 16);
-                v3 = _mm_unpacklo_epi32(_mm_cvtsi32_si128(i0), _mm_cvtsi32_si128(i1));
-                v2 = _mm_unpacklo_epi8(v2, z);
-                v3 = _mm_unpacklo_epi8(v3, z);
-
-                a0 = _mm_unpacklo_epi32(_mm_loadl_epi64((__m128i*)atab[alpha[x+4]]),
-                                        _mm_loadl_epi64((__m128i*)atab[alpha[x+5]]));
-                a1 = _mm_unpacklo_epi32(_mm_loadl_epi64((__m128i*)atab[alpha[x+6]]),
-                                        _mm_loadl_epi64((__m128i*)atab[alpha[x+7]]));
-                b0 = _mm_unpacklo_epi64(a0, a1);
-                b1 = _mm_unpackhi_epi64(a0, a1);
-                v2 = _mm_madd_epi16(v2, b0);
-                v3 = _mm_madd_epi16(v3, b1);
-                v2 = _mm_and_si128(_mm_add_epi32(v2, v3), mask1);
-
-                v0 = _mm_srai_epi32(v0, CV_REMAP_SHIFT*2);
-                v2 = _mm_srai_epi32(v2, CV_REMAP_SHIFT*2);
-                v0 = _mm_packus_epi16(_mm_packs_epi32(v0, v2), z);
-                _mm_storel_epi64( (__m128i*)(dptr + x), v0 );
-            }
-    #endif
-
-            for( ; x < cols; x++ )
-            {
-                int xi = xy[x*2], yi = xy[x*2+1];
-                if( (unsigned)yi >= (unsigned)(rows - 1) ||
-                    (unsigned)xi >= (unsigned)(cols - 1))
-                {
-                    dptr[x] = fv0;
-                }
-                else
-                {
-                    const uchar* sptr = sptr0 + sstep*yi + xi;
-                    const ushort* a = atab[alpha[x]];
-                    dptr[x] = (uchar)((sptr[0]*a[0] + sptr[1]*a[1] + sptr[sstep]*a[2] +
-                                      sptr[sstep+1]*a[3])>>CV_REMAP_SHIFT*2);
-                }
-            }
-        }
-        else if( cn == 3 )
-        {
-            for( ; x < cols; x++ )
-            {
-                int xi = xy[x*2], yi = xy[x*2+1];
-                if( (unsigned)yi >= (unsigned)(rows - 1) ||
-                    (unsigned)xi >= (unsigned)(cols - 1))
-                {
-                    dptr[x*3] = fv0; dptr[x*3+1] = fv1; dptr[x*3+2] = fv2;
-                }
-                else
-                {
-                    const uchar* sptr = sptr0 + sstep*yi + xi*3;
-                    const ushort* a = atab[alpha[x]];
-                    int v0, v1, v2;
-                    v0 = (sptr[0]*a[0] + sptr[3]*a[1] +
-                        sptr[sstep]*a[2] + sptr[sstep+3]*a[3])>>CV_REMAP_SHIFT*2;
-                    v1 = (sptr[1]*a[0] + sptr[4]*a[1] +
-                        sptr[sstep+1]*a[2] + sptr[sstep+4]*a[3])>>CV_REMAP_SHIFT*2;
-                    v2 = (sptr[2]*a[0] + sptr[5]*a[1] +
-                        sptr[sstep+2]*a[2] + sptr[sstep+5]*a[3])>>CV_REMAP_SHIFT*2;
-                    dptr[x*3] = (uchar)v0; dptr[x*3+1] = (uchar)v1; dptr[x*3+2] = (uchar)v2;
-                }
-            }
-        }
-        else
-        {
-            assert( cn == 4 );
-            for( ; x < cols; x++ )
-            {
-                int xi = xy[x*2], yi = xy[x*2+1];
-                if( (unsigned)yi >= (unsigned)(rows - 1) ||
-                    (unsigned)xi >= (unsigned)(cols - 1))
-                {
-                    dptr[x*4] = fv0; dptr[x*4+1] = fv1;
-                    dptr[x*4+2] = fv2; dptr[x*4+3] = fv3;
-                }
-                else
-                {
-                    const uchar* sptr = sptr0 + sstep*yi + xi*3;
-                    const ushort* a = atab[alpha[x]];
-                    int v0, v1;
-                    v0 = (sptr[0]*a[0] + sptr[4]*a[1] +
-                        sptr[sstep]*a[2] + sptr[sstep+3]*a[3])>>CV_REMAP_SHIFT*2;
-                    v1 = (sptr[1]*a[0] + sptr[5]*a[1] +
-                        sptr[sstep+1]*a[2] + sptr[sstep+5]*a[3])>>CV_REMAP_SHIFT*2;
-                    dptr[x*4] = (uchar)v0; dptr[x*4+1] = (uchar)v1;
-                    v0 = (sptr[2]*a[0] + sptr[6]*a[1] +
-                        sptr[sstep+2]*a[2] + sptr[sstep+6]*a[3])>>CV_REMAP_SHIFT*2;
-                    v1 = (sptr[3]*a[0] + sptr[7]*a[1] +
-                        sptr[sstep+3]*a[2] + sptr[sstep+7]*a[3])>>CV_REMAP_SHIFT*2;
-                    dptr[x*4+2] = (uchar)v0; dptr[x*4+3] = (uchar)v1;
-                }
-            }
-        }
-    }
-}
-
-
 CV_IMPL void
 cvRemap( const CvArr* srcarr, CvArr* dstarr,
          const CvArr* _mapx, const CvArr* _mapy,
@@ -1992,12 +3029,12 @@ cvRemap( const CvArr* srcarr, CvArr* dstarr,
     double fillbuf[4];
     CvSize ssize, dsize;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitRemapTab( &bilinear_tab, &bicubic_tab );
         icvInitLinearCoeffTab();
         icvInitCubicCoeffTab();
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     CV_CALL( src = cvGetMat( srcarr, &srcstub ));
@@ -2041,7 +3078,8 @@ cvRemap( const CvArr* srcarr, CvArr* dstarr,
             CV_MAT_TYPE(src->type) != CV_8UC4 )
             CV_ERROR( CV_StsUnsupportedFormat,
             "Only 8-bit input/output is supported by the fixed-point variant of cvRemap" );
-        icvRemapFixedPt_8u( src, dst, mapx, mapy, (uchar*)fillbuf );
+        icvRemapTiled_8u( src, dst, mapx, mapy, 0, 0,
+                          flags & CV_WARP_FILL_OUTLIERS ? (uchar*)fillbuf : 0, 0 );
         EXIT;
     }
 
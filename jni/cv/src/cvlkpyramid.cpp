@@ -42,28 +42,6 @@
 #include <float.h>
 #include <stdio.h>
 
-static void
-intersect( CvPoint2D32f pt, CvSize win_size, CvSize imgSize,
-           CvPoint* min_pt, CvPoint* max_pt )
-{
-    CvPoint ipt;
-
-    ipt.x = cvFloor( pt.x );
-    ipt.y = cvFloor( pt.y );
-
-    ipt.x -= win_size.width;
-    ipt.y -= win_size.height;
-
-    win_size.width = win_size.width * 2 + 1;
-    win_size.height = win_size.height * 2 + 1;
-
-    min_pt->x = MAX( 0, -ipt.x );
-    min_pt->y = MAX( 0, -ipt.y );
-    max_pt->x = MIN( win_size.width, imgSize.width - ipt.x );
-    max_pt->y = MIN( win_size.height, imgSize.height - ipt.y );
-}
-
-
 static int icvMinimalPyramidSize( CvSize imgSize )
 {
     return cvAlign(imgSize.width,8) * imgSize.height / 3;
@@ -255,6 +233,729 @@ icvCalcIxIy_32f( const float* src, int src_step, float* dstX, float* dstY, int d
 }
 
 
+#define ICV_LK_W_BITS   14
+#define ICV_LK_BLOCK    64  /* the window sums are accumulated in int in blocks of this size */
+
+typedef void (*CvScharrDerivRowFunc)( const uchar* srow0, const uchar* srow1, const uchar* srow2,
+                                      short* trow0, short* trow1, short* drow, int width );
+typedef void (*CvLKWindowRowFunc)( const void* s0, const void* s1, short* dst,
+                                   int len, const int* iw );
+typedef void (*CvCalcLKGradMatrixFunc)( const short* dI, int step, CvSize size, double* G );
+typedef void (*CvCalcLKMismatchFunc)( const short* I, const short* J, const short* dI,
+                                      int step, CvSize size, double* b );
+
+typedef struct CvScharrDerivParams
+{
+    const uchar* src;
+    int src_step;
+    short* dst;         /* interleaved dI/dx, dI/dy */
+    int dst_step;       /* in elements */
+    CvSize size;
+    short* buf;         /* two rows of (width + 2) elements per thread */
+    CvScharrDerivRowFunc deriv_row;
+}
+CvScharrDerivParams;
+
+
+/* the vertical (3,10,3) and (-1,0,1) passes of the Scharr derivatives
+   for the columns [x, width) */
+CV_INLINE void
+icvScharrVertTail( const uchar* srow0, const uchar* srow1, const uchar* srow2,
+                   short* trow0, short* trow1, int x, int width )
+{
+    for( ; x < width; x++ )
+    {
+        trow0[x] = (short)((srow0[x] + srow2[x])*3 + srow1[x]*10);
+        trow1[x] = (short)(srow2[x] - srow0[x]);
+    }
+}
+
+/* the horizontal passes for the columns [x, width); trow0 and trow1
+   have one replicated border element on each side */
+CV_INLINE void
+icvScharrHorzTail( const short* trow0, const short* trow1, short* drow, int x, int width )
+{
+    for( ; x < width; x++ )
+    {
+        drow[x*2] = (short)(trow0[x+1] - trow0[x-1]);
+        drow[x*2+1] = (short)((trow1[x+1] + trow1[x-1])*3 + trow1[x]*10);
+    }
+}
+
+static void
+icvCalcScharrDerivRow_C( const uchar* srow0, const uchar* srow1, const uchar* srow2,
+                         short* trow0, short* trow1, short* drow, int width )
+{
+    icvScharrVertTail( srow0, srow1, srow2, trow0, trow1, 0, width );
+    trow0[-1] = trow0[0]; trow0[width] = trow0[width-1];
+    trow1[-1] = trow1[0]; trow1[width] = trow1[width-1];
+    icvScharrHorzTail( trow0, trow1, drow, 0, width );
+}
+
+#if CV_NEON
+static void
+icvCalcScharrDerivRow_NEON( const uchar* srow0, const uchar* srow1, const uchar* srow2,
+                            short* trow0, short* trow1, short* drow, int width )
+{
+    int x = 0;
+    for( ; x <= width - 8; x += 8 )
+    {
+        uint8x8_t s0 = vld1_u8( srow0 + x ), s1 = vld1_u8( srow1 + x ), s2 = vld1_u8( srow2 + x );
+        uint16x8_t t0 = vmlaq_n_u16( vmulq_n_u16( vaddl_u8( s0, s2 ), 3 ), vmovl_u8( s1 ), 10 );
+        vst1q_s16( trow0 + x, vreinterpretq_s16_u16( t0 ));
+        vst1q_s16( trow1 + x, vreinterpretq_s16_u16( vsubl_u8( s2, s0 )));
+    }
+    icvScharrVertTail( srow0, srow1, srow2, trow0, trow1, x, width );
+
+    trow0[-1] = trow0[0]; trow0[width] = trow0[width-1];
+    trow1[-1] = trow1[0]; trow1[width] = trow1[width-1];
+
+    for( x = 0; x <= width - 8; x += 8 )
+    {
+        int16x8x2_t d;
+        d.val[0] = vsubq_s16( vld1q_s16( trow0 + x + 1 ), vld1q_s16( trow0 + x - 1 ));
+        d.val[1] = vmlaq_n_s16( vmulq_n_s16( vaddq_s16( vld1q_s16( trow1 + x + 1 ),
+                                vld1q_s16( trow1 + x - 1 )), 3 ), vld1q_s16( trow1 + x ), 10 );
+        vst2q_s16( drow + x*2, d );
+    }
+    icvScharrHorzTail( trow0, trow1, drow, x, width );
+}
+#endif
+
+static const CvDispatchVariant icvCalcScharrDerivRow_variants[] =
+{
+#if CV_NEON
+    { (void*)icvCalcScharrDerivRow_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvCalcScharrDerivRow_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvCalcScharrDerivRow_entry =
+    CV_DISPATCH_ENTRY( "cvCalcOpticalFlowPyrLK_scharr", icvCalcScharrDerivRow_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvCalcScharrDerivRow_entry );
+
+
+/* computes the Scharr derivatives (3,10,3)x(-1,0,1) of the rows [start, end),
+   replicating the border pixels. The result is 32 times the derivative
+   computed by icvCalcIxIy_32f with smoothKernel */
+static void CV_CDECL
+icvCalcScharrDerivBody( int start, int end, void* userdata )
+{
+    const CvScharrDerivParams* p = (const CvScharrDerivParams*)userdata;
+    int width = p->size.width, height = p->size.height;
+    short* trow0 = p->buf + cvGetThreadNum()*(width + 2)*2 + 1;
+    short* trow1 = trow0 + width + 2;
+    int y;
+
+    for( y = start; y < end; y++ )
+    {
+        const uchar* srow0 = p->src + p->src_step*MAX( y - 1, 0 );
+        const uchar* srow1 = p->src + p->src_step*y;
+        const uchar* srow2 = p->src + p->src_step*MIN( y + 1, height - 1 );
+
+        p->deriv_row( srow0, srow1, srow2, trow0, trow1, p->dst + p->dst_step*y, width );
+    }
+}
+
+
+/* finds the integer top-left corner of the window and the Q14 bilinear weights */
+static void
+icvGetLKWindowWeights( CvPoint2D32f pt, CvPoint* ipt, int* iw )
+{
+    float a, b;
+
+    ipt->x = cvFloor( pt.x );
+    ipt->y = cvFloor( pt.y );
+    a = pt.x - ipt->x;
+    b = pt.y - ipt->y;
+    iw[0] = cvRound( (1.f - a)*(1.f - b)*(1 << ICV_LK_W_BITS) );
+    iw[1] = cvRound( a*(1.f - b)*(1 << ICV_LK_W_BITS) );
+    iw[2] = cvRound( (1.f - a)*b*(1 << ICV_LK_W_BITS) );
+    iw[3] = (1 << ICV_LK_W_BITS) - iw[0] - iw[1] - iw[2];
+}
+
+
+/* bilinear interpolation of len window pixels of the rows s0 and s1,
+   all of which have their right neighbor inside the image.
+   The 8u pixels get 5 fractional bits */
+static void
+icvLKWindowRow_8u_C( const uchar* s0, const uchar* s1, short* dst, int len, const int* iw )
+{
+    int x;
+    for( x = 0; x < len; x++ )
+        dst[x] = (short)CV_DESCALE( s0[x]*iw[0] + s0[x+1]*iw[1] +
+                                    s1[x]*iw[2] + s1[x+1]*iw[3], ICV_LK_W_BITS - 5 );
+}
+
+/* the same for len elements of the interleaved 16s derivatives, which keep their scale */
+static void
+icvLKWindowRow_16s_C( const short* s0, const short* s1, short* dst, int len, const int* iw )
+{
+    int x;
+    for( x = 0; x < len; x++ )
+        dst[x] = (short)CV_DESCALE( s0[x]*iw[0] + s0[x+2]*iw[1] +
+                                    s1[x]*iw[2] + s1[x+2]*iw[3], ICV_LK_W_BITS );
+}
+
+#if CV_SSE2
+static void
+icvLKWindowRow_8u_SSE2( const uchar* s0, const uchar* s1, short* dst, int len, const int* iw )
+{
+    __m128i z = _mm_setzero_si128(), delta = _mm_set1_epi32( 1 << (ICV_LK_W_BITS - 6) );
+    __m128i w0 = _mm_set1_epi32( (iw[1] << 16) + iw[0] ), w1 = _mm_set1_epi32( (iw[3] << 16) + iw[2] );
+    int x = 0;
+
+    for( ; x <= len - 8; x += 8 )
+    {
+        __m128i t00 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(s0 + x) ), z );
+        __m128i t01 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(s0 + x + 1) ), z );
+        __m128i t10 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(s1 + x) ), z );
+        __m128i t11 = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i*)(s1 + x + 1) ), z );
+        __m128i lo = _mm_add_epi32( _mm_madd_epi16( _mm_unpacklo_epi16( t00, t01 ), w0 ),
+                                    _mm_madd_epi16( _mm_unpacklo_epi16( t10, t11 ), w1 ));
+        __m128i hi = _mm_add_epi32( _mm_madd_epi16( _mm_unpackhi_epi16( t00, t01 ), w0 ),
+                                    _mm_madd_epi16( _mm_unpackhi_epi16( t10, t11 ), w1 ));
+        lo = _mm_srai_epi32( _mm_add_epi32( lo, delta ), ICV_LK_W_BITS - 5 );
+        hi = _mm_srai_epi32( _mm_add_epi32( hi, delta ), ICV_LK_W_BITS - 5 );
+        _mm_storeu_si128( (__m128i*)(dst + x), _mm_packs_epi32( lo, hi ));
+    }
+    icvLKWindowRow_8u_C( s0 + x, s1 + x, dst + x, len - x, iw );
+}
+
+static void
+icvLKWindowRow_16s_SSE2( const short* s0, const short* s1, short* dst, int len, const int* iw )
+{
+    __m128i delta = _mm_set1_epi32( 1 << (ICV_LK_W_BITS - 1) );
+    __m128i w0 = _mm_set1_epi32( (iw[1] << 16) + iw[0] ), w1 = _mm_set1_epi32( (iw[3] << 16) + iw[2] );
+    int x = 0;
+
+    for( ; x <= len - 8; x += 8 )
+    {
+        __m128i t00 = _mm_loadu_si128( (const __m128i*)(s0 + x) );
+        __m128i t01 = _mm_loadu_si128( (const __m128i*)(s0 + x + 2) );
+        __m128i t10 = _mm_loadu_si128( (const __m128i*)(s1 + x) );
+        __m128i t11 = _mm_loadu_si128( (const __m128i*)(s1 + x + 2) );
+        __m128i lo = _mm_add_epi32( _mm_madd_epi16( _mm_unpacklo_epi16( t00, t01 ), w0 ),
+                                    _mm_madd_epi16( _mm_unpacklo_epi16( t10, t11 ), w1 ));
+        __m128i hi = _mm_add_epi32( _mm_madd_epi16( _mm_unpackhi_epi16( t00, t01 ), w0 ),
+                                    _mm_madd_epi16( _mm_unpackhi_epi16( t10, t11 ), w1 ));
+        lo = _mm_srai_epi32( _mm_add_epi32( lo, delta ), ICV_LK_W_BITS );
+        hi = _mm_srai_epi32( _mm_add_epi32( hi, delta ), ICV_LK_W_BITS );
+        _mm_storeu_si128( (__m128i*)(dst + x), _mm_packs_epi32( lo, hi ));
+    }
+    icvLKWindowRow_16s_C( s0 + x, s1 + x, dst + x, len - x, iw );
+}
+#endif
+
+#if CV_NEON
+static void
+icvLKWindowRow_8u_NEON( const uchar* s0, const uchar* s1, short* dst, int len, const int* iw )
+{
+    int16x4_t w00 = vdup_n_s16((short)iw[0]), w01 = vdup_n_s16((short)iw[1]);
+    int16x4_t w10 = vdup_n_s16((short)iw[2]), w11 = vdup_n_s16((short)iw[3]);
+    int x = 0;
+
+    for( ; x <= len - 8; x += 8 )
+    {
+        int16x8_t t00 = vreinterpretq_s16_u16( vmovl_u8( vld1_u8( s0 + x )));
+        int16x8_t t01 = vreinterpretq_s16_u16( vmovl_u8( vld1_u8( s0 + x + 1 )));
+        int16x8_t t10 = vreinterpretq_s16_u16( vmovl_u8( vld1_u8( s1 + x )));
+        int16x8_t t11 = vreinterpretq_s16_u16( vmovl_u8( vld1_u8( s1 + x + 1 )));
+        int32x4_t lo = vmull_s16( vget_low_s16(t00), w00 );
+        int32x4_t hi = vmull_s16( vget_high_s16(t00), w00 );
+        lo = vmlal_s16( lo, vget_low_s16(t01), w01 );
+        hi = vmlal_s16( hi, vget_high_s16(t01), w01 );
+        lo = vmlal_s16( lo, vget_low_s16(t10), w10 );
+        hi = vmlal_s16( hi, vget_high_s16(t10), w10 );
+        lo = vmlal_s16( lo, vget_low_s16(t11), w11 );
+        hi = vmlal_s16( hi, vget_high_s16(t11), w11 );
+        vst1q_s16( dst + x, vcombine_s16( vrshrn_n_s32( lo, ICV_LK_W_BITS - 5 ),
+                                          vrshrn_n_s32( hi, ICV_LK_W_BITS - 5 )));
+    }
+    icvLKWindowRow_8u_C( s0 + x, s1 + x, dst + x, len - x, iw );
+}
+
+static void
+icvLKWindowRow_16s_NEON( const short* s0, const short* s1, short* dst, int len, const int* iw )
+{
+    int16x4_t w00 = vdup_n_s16((short)iw[0]), w01 = vdup_n_s16((short)iw[1]);
+    int16x4_t w10 = vdup_n_s16((short)iw[2]), w11 = vdup_n_s16((short)iw[3]);
+    int x = 0;
+
+    for( ; x <= len - 8; x += 8 )
+    {
+        int16x8_t t00 = vld1q_s16( s0 + x ), t01 = vld1q_s16( s0 + x + 2 );
+        int16x8_t t10 = vld1q_s16( s1 + x ), t11 = vld1q_s16( s1 + x + 2 );
+        int32x4_t lo = vmull_s16( vget_low_s16(t00), w00 );
+        int32x4_t hi = vmull_s16( vget_high_s16(t00), w00 );
+        lo = vmlal_s16( lo, vget_low_s16(t01), w01 );
+        hi = vmlal_s16( hi, vget_high_s16(t01), w01 );
+        lo = vmlal_s16( lo, vget_low_s16(t10), w10 );
+        hi = vmlal_s16( hi, vget_high_s16(t10), w10 );
+        lo = vmlal_s16( lo, vget_low_s16(t11), w11 );
+        hi = vmlal_s16( hi, vget_high_s16(t11), w11 );
+        vst1q_s16( dst + x, vcombine_s16( vrshrn_n_s32( lo, ICV_LK_W_BITS ),
+                                          vrshrn_n_s32( hi, ICV_LK_W_BITS )));
+    }
+    icvLKWindowRow_16s_C( s0 + x, s1 + x, dst + x, len - x, iw );
+}
+#endif
+
+static const CvDispatchVariant icvLKWindowRow_8u_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvLKWindowRow_8u_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvLKWindowRow_8u_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvLKWindowRow_8u_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvLKWindowRow_16s_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvLKWindowRow_16s_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvLKWindowRow_16s_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvLKWindowRow_16s_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvLKWindowRow_8u_entry =
+    CV_DISPATCH_ENTRY( "cvCalcOpticalFlowPyrLK_window_8u", icvLKWindowRow_8u_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvLKWindowRow_8u_entry );
+static CvDispatchEntry icvLKWindowRow_16s_entry =
+    CV_DISPATCH_ENTRY( "cvCalcOpticalFlowPyrLK_window_16s", icvLKWindowRow_16s_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvLKWindowRow_16s_entry );
+
+
+/* bilinear interpolation of the win_size window with the top-left corner ipt
+   and the weights iw. The 8u pixels get 5 fractional bits, the 16s ones
+   (cn == 2, the derivatives) keep their scale; row_func is the matching
+   window row kernel. The pixels outside of the image are replicated from the border */
+static void
+icvGetLKWindow( const void* src, int src_step, CvSize size, int cn,
+                CvPoint ipt, const int* iw, short* dst, CvSize win_size,
+                CvLKWindowRowFunc row_func )
+{
+    int x, y, k, width = win_size.width*cn;
+    int shift = cn == 1 ? ICV_LK_W_BITS - 5 : ICV_LK_W_BITS;
+    int iw00 = iw[0], iw01 = iw[1], iw10 = iw[2], iw11 = iw[3];
+    /* the columns [xa, xb) have both the neighbors inside the image */
+    int xa = MIN( MAX( -ipt.x, 0 ), win_size.width );
+    int xb = MAX( MIN( size.width - 1 - ipt.x, win_size.width ), xa );
+
+    for( y = 0; y < win_size.height; y++, dst += width )
+    {
+        const uchar* row0 = (const uchar*)src + src_step*MIN( MAX( ipt.y + y, 0 ), size.height - 1 );
+        const uchar* row1 = (const uchar*)src + src_step*MIN( MAX( ipt.y + y + 1, 0 ), size.height - 1 );
+
+        for( x = 0; x < win_size.width; x++ )
+        {
+            int x0, x1;
+            if( x == xa )
+                x = xb;
+            if( x >= win_size.width )
+                break;
+            x0 = MIN( MAX( ipt.x + x, 0 ), size.width - 1 );
+            x1 = MIN( MAX( ipt.x + x + 1, 0 ), size.width - 1 );
+
+            if( cn == 1 )
+                dst[x] = (short)CV_DESCALE( row0[x0]*iw00 + row0[x1]*iw01 +
+                                            row1[x0]*iw10 + row1[x1]*iw11, shift );
+            else
+                for( k = 0; k < 2; k++ )
+                {
+                    const short* s0 = (const short*)row0 + k;
+                    const short* s1 = (const short*)row1 + k;
+                    dst[x*2+k] = (short)CV_DESCALE( s0[x0*2]*iw00 + s0[x1*2]*iw01 +
+                                                    s1[x0*2]*iw10 + s1[x1*2]*iw11, shift );
+                }
+        }
+
+        if( cn == 1 )
+            row_func( row0 + ipt.x + xa, row1 + ipt.x + xa, dst + xa, xb - xa, iw );
+        else
+            row_func( (const short*)row0 + (ipt.x + xa)*2, (const short*)row1 + (ipt.x + xa)*2,
+                      dst + xa*2, (xb - xa)*2, iw );
+    }
+}
+
+
+/* computes the spatial gradient matrix G = sum [Ix*Ix Ix*Iy; Ix*Iy Iy*Iy]
+   over the window of interleaved derivatives (step is in pixels) */
+static void
+icvCalcLKGradMatrix_C( const short* dI, int step, CvSize size, double* G )
+{
+    double A11 = 0, A12 = 0, A22 = 0;
+    int x0, x1, y;
+
+    if( step == size.width )
+    {
+        size.width *= size.height;
+        size.height = 1;
+    }
+
+    for( y = 0; y < size.height; y++, dI += step*2 )
+        for( x0 = 0; x0 < size.width; x0 = x1 )
+        {
+            int x, a11 = 0, a12 = 0, a22 = 0;
+            x1 = MIN( x0 + ICV_LK_BLOCK, size.width );
+            for( x = x0; x < x1; x++ )
+            {
+                int ix = dI[x*2], iy = dI[x*2+1];
+                a11 += ix*ix;
+                a12 += ix*iy;
+                a22 += iy*iy;
+            }
+            A11 += a11; A12 += a12; A22 += a22;
+        }
+
+    G[0] = A11; G[1] = A12; G[2] = A22;
+}
+
+#if CV_NEON
+static void
+icvCalcLKGradMatrix_NEON( const short* dI, int step, CvSize size, double* G )
+{
+    double A11 = 0, A12 = 0, A22 = 0;
+    int x0, x1, y;
+
+    if( step == size.width )
+    {
+        size.width *= size.height;
+        size.height = 1;
+    }
+
+    for( y = 0; y < size.height; y++, dI += step*2 )
+        for( x0 = 0; x0 < size.width; x0 = x1 )
+        {
+            int x = x0, a11, a12, a22;
+            int32x4_t v11 = vdupq_n_s32(0), v12 = vdupq_n_s32(0), v22 = vdupq_n_s32(0);
+            x1 = MIN( x0 + ICV_LK_BLOCK, size.width );
+            for( ; x <= x1 - 8; x += 8 )
+            {
+                int16x8x2_t d = vld2q_s16( dI + x*2 );
+                v11 = vmlal_s16( v11, vget_low_s16(d.val[0]), vget_low_s16(d.val[0]) );
+                v11 = vmlal_s16( v11, vget_high_s16(d.val[0]), vget_high_s16(d.val[0]) );
+                v12 = vmlal_s16( v12, vget_low_s16(d.val[0]), vget_low_s16(d.val[1]) );
+                v12 = vmlal_s16( v12, vget_high_s16(d.val[0]), vget_high_s16(d.val[1]) );
+                v22 = vmlal_s16( v22, vget_low_s16(d.val[1]), vget_low_s16(d.val[1]) );
+                v22 = vmlal_s16( v22, vget_high_s16(d.val[1]), vget_high_s16(d.val[1]) );
+            }
+            a11 = vgetq_lane_s32(v11, 0) + vgetq_lane_s32(v11, 1) + vgetq_lane_s32(v11, 2) + vgetq_lane_s32(v11, 3);
+            a12 = vgetq_lane_s32(v12, 0) + vgetq_lane_s32(v12, 1) + vgetq_lane_s32(v12, 2) + vgetq_lane_s32(v12, 3);
+            a22 = vgetq_lane_s32(v22, 0) + vgetq_lane_s32(v22, 1) + vgetq_lane_s32(v22, 2) + vgetq_lane_s32(v22, 3);
+            for( ; x < x1; x++ )
+            {
+                int ix = dI[x*2], iy = dI[x*2+1];
+                a11 += ix*ix;
+                a12 += ix*iy;
+                a22 += iy*iy;
+            }
+            A11 += a11; A12 += a12; A22 += a22;
+        }
+
+    G[0] = A11; G[1] = A12; G[2] = A22;
+}
+#endif
+
+static const CvDispatchVariant icvCalcLKGradMatrix_variants[] =
+{
+#if CV_NEON
+    { (void*)icvCalcLKGradMatrix_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvCalcLKGradMatrix_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvCalcLKGradMatrix_entry =
+    CV_DISPATCH_ENTRY( "cvCalcOpticalFlowPyrLK_grad", icvCalcLKGradMatrix_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvCalcLKGradMatrix_entry );
+
+
+/* computes the mismatch vector b = sum (I - J)*[Ix Iy] over the window */
+static void
+icvCalcLKMismatch_C( const short* I, const short* J, const short* dI,
+                     int step, CvSize size, double* b )
+{
+    double b1 = 0, b2 = 0;
+    int x0, x1, y;
+
+    if( step == size.width )
+    {
+        size.width *= size.height;
+        size.height = 1;
+    }
+
+    for( y = 0; y < size.height; y++, I += step, J += step, dI += step*2 )
+        for( x0 = 0; x0 < size.width; x0 = x1 )
+        {
+            int x, ib1 = 0, ib2 = 0;
+            x1 = MIN( x0 + ICV_LK_BLOCK, size.width );
+            for( x = x0; x < x1; x++ )
+            {
+                int t = I[x] - J[x];
+                ib1 += t*dI[x*2];
+                ib2 += t*dI[x*2+1];
+            }
+            b1 += ib1; b2 += ib2;
+        }
+
+    b[0] = b1; b[1] = b2;
+}
+
+#if CV_NEON
+static void
+icvCalcLKMismatch_NEON( const short* I, const short* J, const short* dI,
+                        int step, CvSize size, double* b )
+{
+    double b1 = 0, b2 = 0;
+    int x0, x1, y;
+
+    if( step == size.width )
+    {
+        size.width *= size.height;
+        size.height = 1;
+    }
+
+    for( y = 0; y < size.height; y++, I += step, J += step, dI += step*2 )
+        for( x0 = 0; x0 < size.width; x0 = x1 )
+        {
+            int x = x0, ib1, ib2;
+            int32x4_t v1 = vdupq_n_s32(0), v2 = vdupq_n_s32(0);
+            x1 = MIN( x0 + ICV_LK_BLOCK, size.width );
+            for( ; x <= x1 - 8; x += 8 )
+            {
+                int16x8x2_t d = vld2q_s16( dI + x*2 );
+                int16x8_t t = vsubq_s16( vld1q_s16( I + x ), vld1q_s16( J + x ));
+                v1 = vmlal_s16( v1, vget_low_s16(t), vget_low_s16(d.val[0]) );
+                v1 = vmlal_s16( v1, vget_high_s16(t), vget_high_s16(d.val[0]) );
+                v2 = vmlal_s16( v2, vget_low_s16(t), vget_low_s16(d.val[1]) );
+                v2 = vmlal_s16( v2, vget_high_s16(t), vget_high_s16(d.val[1]) );
+            }
+            ib1 = vgetq_lane_s32(v1, 0) + vgetq_lane_s32(v1, 1) + vgetq_lane_s32(v1, 2) + vgetq_lane_s32(v1, 3);
+            ib2 = vgetq_lane_s32(v2, 0) + vgetq_lane_s32(v2, 1) + vgetq_lane_s32(v2, 2) + vgetq_lane_s32(v2, 3);
+            for( ; x < x1; x++ )
+            {
+                int t = I[x] - J[x];
+                ib1 += t*dI[x*2];
+                ib2 += t*dI[x*2+1];
+            }
+            b1 += ib1; b2 += ib2;
+        }
+
+    b[0] = b1; b[1] = b2;
+}
+#endif
+
+static const CvDispatchVariant icvCalcLKMismatch_variants[] =
+{
+#if CV_NEON
+    { (void*)icvCalcLKMismatch_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvCalcLKMismatch_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvCalcLKMismatch_entry =
+    CV_DISPATCH_ENTRY( "cvCalcOpticalFlowPyrLK_mismatch", icvCalcLKMismatch_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvCalcLKMismatch_entry );
+
+
+typedef struct CvPyrLKParams
+{
+    /* the current pyramid level */
+    const uchar* imgI;
+    const uchar* imgJ;
+    int step;
+    const short* derivI;    /* the Scharr derivatives of imgI */
+    int deriv_step;         /* in bytes */
+    CvSize size;
+    double scale;
+    int level;
+    int max_level;
+
+    const CvPoint2D32f* featuresA;
+    CvPoint2D32f* featuresB;
+    char* status;
+    float* error;
+    CvSize win_size;
+    CvTermCriteria criteria;
+    int flags;
+    short* buf;             /* the windows of I, J and dI of every thread */
+    int buf_step;           /* in elements */
+
+    CvLKWindowRowFunc window_8u;
+    CvLKWindowRowFunc window_16s;
+    CvCalcLKGradMatrixFunc grad_matrix;
+    CvCalcLKMismatchFunc mismatch;
+}
+CvPyrLKParams;
+
+
+/* tracks the points [start, end) on the current pyramid level */
+static void CV_CDECL
+icvCalcOpticalFlowPyrLKBody( int start, int end, void* userdata )
+{
+    const CvPyrLKParams* p = (const CvPyrLKParams*)userdata;
+    CvSize patchSize = cvSize( p->win_size.width*2 + 1, p->win_size.height*2 + 1 );
+    CvSize size = p->size;
+    int i, j, x, y, n = patchSize.width*patchSize.height;
+    short* Iwin = p->buf + p->buf_step*cvGetThreadNum();
+    short* Jwin = Iwin + n;
+    short* dIwin = Jwin + n;
+    /* I and J have 5 fractional bits and the derivatives are 32x larger
+       than the ones of the floating-point version */
+    const double ISCALE = 1./(1 << 10);
+
+    for( i = start; i < end; i++ )
+    {
+        CvPoint2D32f u, v;
+        CvPoint iu, iv, minI, maxI, minJ = { 0, 0 }, maxJ = { 0, 0 };
+        CvPoint prev_minJ = { -1, -1 }, prev_maxJ = { -1, -1 };
+        CvSize jsz = { 0, 0 };
+        int iw[4], ofs = 0;
+        double G[3] = { 0, 0, 0 }, b[2], D = 0, minEig = 0;
+        float prev_mx = 0, prev_my = 0;
+        int pt_status;
+
+        v = p->featuresB[i];
+        if( p->level < p->max_level )
+        {
+            v.x += v.x;
+            v.y += v.y;
+        }
+        else
+        {
+            v.x = (float)(v.x * p->scale);
+            v.y = (float)(v.y * p->scale);
+        }
+
+        pt_status = p->status[i];
+        if( !pt_status )
+            continue;
+
+        /* the windows are shifted by half a pixel as in the floating-point version.
+           Only the window pixels inside both images are taken into account */
+        u.x = (float)(p->featuresA[i].x * p->scale) - p->win_size.width - 0.5f;
+        u.y = (float)(p->featuresA[i].y * p->scale) - p->win_size.height - 0.5f;
+        icvGetLKWindowWeights( u, &iu, iw );
+        minI.x = MAX( 0, -iu.x );
+        minI.y = MAX( 0, -iu.y );
+        maxI.x = MIN( patchSize.width, size.width - iu.x );
+        maxI.y = MIN( patchSize.height, size.height - iu.y );
+
+        if( maxI.x <= minI.x || maxI.y <= minI.y )
+        {
+            /* point is outside the image. take the next */
+            p->status[i] = 0;
+            continue;
+        }
+
+        icvGetLKWindow( p->imgI, p->step, size, 1, iu, iw, Iwin, patchSize, p->window_8u );
+        icvGetLKWindow( p->derivI, p->deriv_step, size, 2, iu, iw, dIwin, patchSize,
+                        p->window_16s );
+
+        for( j = 0; j < p->criteria.max_iter; j++ )
+        {
+            float mx, my;
+            CvPoint2D32f _v;
+
+            _v.x = v.x - p->win_size.width - 0.5f;
+            _v.y = v.y - p->win_size.height - 0.5f;
+            icvGetLKWindowWeights( _v, &iv, iw );
+
+            minJ.x = MAX( MAX( 0, -iv.x ), minI.x );
+            minJ.y = MAX( MAX( 0, -iv.y ), minI.y );
+            maxJ.x = MIN( MIN( patchSize.width, size.width - iv.x ), maxI.x );
+            maxJ.y = MIN( MIN( patchSize.height, size.height - iv.y ), maxI.y );
+            jsz = cvSize( maxJ.x - minJ.x, maxJ.y - minJ.y );
+
+            if( jsz.width < 1 || jsz.height < 1 )
+            {
+                /* point is outside image. take the next */
+                pt_status = 0;
+                break;
+            }
+
+            icvGetLKWindow( p->imgJ, p->step, size, 1, iv, iw, Jwin, patchSize, p->window_8u );
+            ofs = minJ.y*patchSize.width + minJ.x;
+
+            if( maxJ.x != prev_maxJ.x || maxJ.y != prev_maxJ.y ||
+                minJ.x != prev_minJ.x || minJ.y != prev_minJ.y )
+            {
+                p->grad_matrix( dIwin + ofs*2, patchSize.width, jsz, G );
+                G[0] *= ISCALE; G[1] *= ISCALE; G[2] *= ISCALE;
+
+                D = G[0]*G[2] - G[1]*G[1];
+                if( D < DBL_EPSILON )
+                {
+                    pt_status = 0;
+                    break;
+                }
+
+                // Adi Shavit - 2008.05
+                if( p->flags & CV_LKFLOW_GET_MIN_EIGENVALS )
+                    minEig = (G[2] + G[0] - sqrt((G[0]-G[2])*(G[0]-G[2]) +
+                              4.*G[1]*G[1]))/(2*jsz.height*jsz.width);
+
+                D = 1./D;
+
+                prev_minJ = minJ;
+                prev_maxJ = maxJ;
+            }
+
+            p->mismatch( Iwin + ofs, Jwin + ofs, dIwin + ofs*2, patchSize.width, jsz, b );
+            b[0] *= ISCALE; b[1] *= ISCALE;
+
+            mx = (float) ((G[2] * b[0] - G[1] * b[1]) * D);
+            my = (float) ((G[0] * b[1] - G[1] * b[0]) * D);
+
+            v.x += mx;
+            v.y += my;
+
+            if( mx * mx + my * my < p->criteria.epsilon )
+                break;
+
+            if( j > 0 && fabs(mx + prev_mx) < 0.01 && fabs(my + prev_my) < 0.01 )
+            {
+                v.x -= mx*0.5f;
+                v.y -= my*0.5f;
+                break;
+            }
+            prev_mx = mx;
+            prev_my = my;
+        }
+
+        p->featuresB[i] = v;
+        p->status[i] = (char)pt_status;
+        if( p->level == 0 && p->error && pt_status )
+        {
+            /* calc error */
+            double err = 0;
+            if( p->flags & CV_LKFLOW_GET_MIN_EIGENVALS )
+                err = minEig;
+            else
+            {
+                for( y = 0; y < jsz.height; y++ )
+                {
+                    const short* pi = Iwin + ofs + y*patchSize.width;
+                    const short* pj = Jwin + ofs + y*patchSize.width;
+
+                    for( x = 0; x < jsz.width; x++ )
+                    {
+                        double t = pi[x] - pj[x];
+                        err += t * t;
+                    }
+                }
+                err = sqrt(err*ISCALE);
+            }
+            p->error[i] = (float)err;
+        }
+    }
+}
+
 icvOpticalFlowPyrLKInitAlloc_8u_C1R_t icvOpticalFlowPyrLKInitAlloc_8u_C1R_p = 0;
 icvOpticalFlowPyrLKFree_8u_C1R_t icvOpticalFlowPyrLKFree_8u_C1R_p = 0;
 icvOpticalFlowPyrLK_8u_C1R_t icvOpticalFlowPyrLK_8u_C1R_p = 0;
@@ -270,7 +971,8 @@ cvCalcOpticalFlowPyrLK( const void* arrA, const void* arrB,
                         CvTermCriteria criteria, int flags )
 {
     uchar *pyrBuffer = 0;
-    uchar *buffer = 0;
+    short *buffer = 0;
+    short *derivBuffer = 0;
     float* _error = 0;
     char* _status = 0;
 
@@ -287,9 +989,7 @@ cvCalcOpticalFlowPyrLK( const void* arrA, const void* arrB,
     CvMat pstubA, *pyrA = (CvMat*)pyrarrA;
     CvMat pstubB, *pyrB = (CvMat*)pyrarrB;
     CvSize imgSize;
-    static const float smoothKernel[] = { 0.09375, 0.3125, 0.09375 };  /* 3/32, 10/32, 3/32 */
     
-    int bufferBytes = 0;
     uchar **imgI = 0;
     uchar **imgJ = 0;
     int *step = 0;
@@ -297,16 +997,13 @@ cvCalcOpticalFlowPyrLK( const void* arrA, const void* arrB,
     CvSize* size = 0;
 
     int threadCount = cvGetNumThreads();
-    float* _patchI[CV_MAX_THREADS];
-    float* _patchJ[CV_MAX_THREADS];
-    float* _Ix[CV_MAX_THREADS];
-    float* _Iy[CV_MAX_THREADS];
+    CvPyrLKParams p;
+    CvScharrDerivParams dp;
 
-    int i, l;
+    int l;
 
     CvSize patchSize = cvSize( winSize.width * 2 + 1, winSize.height * 2 + 1 );
     int patchLen = patchSize.width * patchSize.height;
-    int srcPatchLen = (patchSize.width + 2)*(patchSize.height + 2);
 
     CV_CALL( imgA = cvGetMat( imgA, &stubA ));
     CV_CALL( imgB = cvGetMat( imgB, &stubB ));
@@ -363,9 +1060,6 @@ cvCalcOpticalFlowPyrLK( const void* arrA, const void* arrB,
     if( winSize.width <= 1 || winSize.height <= 1 )
         CV_ERROR( CV_StsBadSize, "Invalid search window size" );
 
-    for( i = 0; i < threadCount; i++ )
-        _patchI[i] = _patchJ[i] = _Ix[i] = _Iy[i] = 0;
-
     CV_CALL( icvInitPyramidalAlgorithm( imgA, imgB, pyrA, pyrB,
         level, &criteria, MAX_ITERS, flags,
         &imgI, &imgJ, &step, &size, &scale, &pyrBuffer ));
@@ -382,6 +1076,7 @@ cvCalcOpticalFlowPyrLK( const void* arrA, const void* arrB,
                                                winSize.width*2+1, cvAlgHintAccurate ) >= 0 )
     {
         CvPyramid ipp_pyrA, ipp_pyrB;
+        int i;
         static const double rate[] = { 1, 0.5, 0.25, 0.125, 0.0625, 0.03125, 0.015625, 0.0078125,
                                        0.00390625, 0.001953125, 0.0009765625, 0.00048828125, 0.000244140625,
                                        0.0001220703125 };
@@ -413,17 +1108,17 @@ cvCalcOpticalFlowPyrLK( const void* arrA, const void* arrB,
     }
 #endif
 
-    /* buffer_size = <size for patches> + <size for pyramids> */
-    bufferBytes = (srcPatchLen + patchLen * 3) * sizeof( _patchI[0][0] ) * threadCount;
-    CV_CALL( buffer = (uchar*)cvAlloc( bufferBytes ));
+    /* the windows of I, J and the derivatives of I for every thread */
+    p.buf_step = (int)cvAlign( patchLen*4, 8 );
+    CV_CALL( buffer = (short*)cvAlloc( p.buf_step*threadCount*sizeof(buffer[0]) ));
 
-    for( i = 0; i < threadCount; i++ )
-    {
-        _patchI[i] = i == 0 ? (float*)buffer : _Iy[i-1] + patchLen;
-        _patchJ[i] = _patchI[i] + srcPatchLen;
-        _Ix[i] = _patchJ[i] + patchLen;
-        _Iy[i] = _Ix[i] + patchLen;
-    }
+    /* the derivatives of the current level of the first pyramid,
+       shared by all the points, and the row buffers to compute them */
+    CV_CALL( derivBuffer = (short*)cvAlloc( (imgSize.width*imgSize.height*2 +
+                        (imgSize.width + 2)*2*threadCount)*sizeof(derivBuffer[0]) ));
+    dp.dst = derivBuffer;
+    dp.buf = derivBuffer + imgSize.width*imgSize.height*2;
+    dp.deriv_row = (CvScharrDerivRowFunc)cvGetDispatchFunc( &icvCalcScharrDerivRow_entry );
 
     memset( status, 1, count );
     if( error )
@@ -432,209 +1127,42 @@ cvCalcOpticalFlowPyrLK( const void* arrA, const void* arrB,
     if( !(flags & CV_LKFLOW_INITIAL_GUESSES) )
         memcpy( featuresB, featuresA, count*sizeof(featuresA[0]));
 
+    p.featuresA = featuresA;
+    p.featuresB = featuresB;
+    p.status = status;
+    p.error = error;
+    p.win_size = winSize;
+    p.criteria = criteria;
+    p.flags = flags;
+    p.buf = buffer;
+    p.max_level = level;
+    p.window_8u = (CvLKWindowRowFunc)cvGetDispatchFunc( &icvLKWindowRow_8u_entry );
+    p.window_16s = (CvLKWindowRowFunc)cvGetDispatchFunc( &icvLKWindowRow_16s_entry );
+    p.grad_matrix = (CvCalcLKGradMatrixFunc)cvGetDispatchFunc( &icvCalcLKGradMatrix_entry );
+    p.mismatch = (CvCalcLKMismatchFunc)cvGetDispatchFunc( &icvCalcLKMismatch_entry );
+
     /* do processing from top pyramid level (smallest image)
        to the bottom (original image) */
     for( l = level; l >= 0; l-- )
     {
-        CvSize levelSize = size[l];
-        int levelStep = step[l];
+        dp.src = imgI[l];
+        dp.src_step = step[l];
+        dp.dst_step = size[l].width*2;
+        dp.size = size[l];
+        cvParallelFor( size[l].height, icvCalcScharrDerivBody, &dp,
+                       MAX( (1 << 14)/size[l].width, 1 ));
+
+        p.imgI = imgI[l];
+        p.imgJ = imgJ[l];
+        p.step = step[l];
+        p.derivI = dp.dst;
+        p.deriv_step = dp.dst_step*sizeof(dp.dst[0]);
+        p.size = size[l];
+        p.scale = scale[l];
+        p.level = l;
 
-        {
-#ifdef _OPENMP
-        #pragma omp parallel for num_threads(threadCount) schedule(dynamic) 
-#endif // _OPENMP
         /* find flow for each given point */
-        for( i = 0; i < count; i++ )
-        {
-            CvPoint2D32f v;
-            CvPoint minI, maxI, minJ, maxJ;
-            CvSize isz, jsz;
-            int pt_status;
-            CvPoint2D32f u;
-            CvPoint prev_minJ = { -1, -1 }, prev_maxJ = { -1, -1 };
-            double Gxx = 0, Gxy = 0, Gyy = 0, D = 0, minEig = 0;
-            float prev_mx = 0, prev_my = 0;
-            int j, x, y;
-            int threadIdx = cvGetThreadNum();
-            float* patchI = _patchI[threadIdx];
-            float* patchJ = _patchJ[threadIdx];
-            float* Ix = _Ix[threadIdx];
-            float* Iy = _Iy[threadIdx];
-
-            v.x = featuresB[i].x;
-            v.y = featuresB[i].y;
-            if( l < level )
-            {
-                v.x += v.x;
-                v.y += v.y;
-            }
-            else
-            {
-                v.x = (float)(v.x * scale[l]);
-                v.y = (float)(v.y * scale[l]);
-            }
-
-            pt_status = status[i];
-            if( !pt_status )
-                continue;
-
-            minI = maxI = minJ = maxJ = cvPoint( 0, 0 );
-
-            u.x = (float) (featuresA[i].x * scale[l]);
-            u.y = (float) (featuresA[i].y * scale[l]);
-
-            intersect( u, winSize, levelSize, &minI, &maxI );
-            isz = jsz = cvSize(maxI.x - minI.x + 2, maxI.y - minI.y + 2);
-            u.x += (minI.x - (patchSize.width - maxI.x + 1))*0.5f;
-            u.y += (minI.y - (patchSize.height - maxI.y + 1))*0.5f;
-
-            if( isz.width < 3 || isz.height < 3 ||
-                icvGetRectSubPix_8u32f_C1R( imgI[l], levelStep, levelSize,
-                    patchI, isz.width*sizeof(patchI[0]), isz, u ) < 0 )
-            {
-                /* point is outside the image. take the next */
-                status[i] = 0;
-                continue;
-            }
-
-            icvCalcIxIy_32f( patchI, isz.width*sizeof(patchI[0]), Ix, Iy,
-                (isz.width-2)*sizeof(patchI[0]), isz, smoothKernel, patchJ );
-
-            for( j = 0; j < criteria.max_iter; j++ )
-            {
-                double bx = 0, by = 0;
-                float mx, my;
-                CvPoint2D32f _v;
-
-                intersect( v, winSize, levelSize, &minJ, &maxJ );
-
-                minJ.x = MAX( minJ.x, minI.x );
-                minJ.y = MAX( minJ.y, minI.y );
-
-                maxJ.x = MIN( maxJ.x, maxI.x );
-                maxJ.y = MIN( maxJ.y, maxI.y );
-
-                jsz = cvSize(maxJ.x - minJ.x, maxJ.y - minJ.y);
-
-                _v.x = v.x + (minJ.x - (patchSize.width - maxJ.x + 1))*0.5f;
-                _v.y = v.y + (minJ.y - (patchSize.height - maxJ.y + 1))*0.5f;
-
-                if( jsz.width < 1 || jsz.height < 1 ||
-                    icvGetRectSubPix_8u32f_C1R( imgJ[l], levelStep, levelSize, patchJ,
-                                                jsz.width*sizeof(patchJ[0]), jsz, _v ) < 0 )
-                {
-                    /* point is outside image. take the next */
-                    pt_status = 0;
-                    break;
-                }
-
-                if( maxJ.x == prev_maxJ.x && maxJ.y == prev_maxJ.y &&
-                    minJ.x == prev_minJ.x && minJ.y == prev_minJ.y )
-                {
-                    for( y = 0; y < jsz.height; y++ )
-                    {
-                        const float* pi = patchI +
-                            (y + minJ.y - minI.y + 1)*isz.width + minJ.x - minI.x + 1;
-                        const float* pj = patchJ + y*jsz.width;
-                        const float* ix = Ix +
-                            (y + minJ.y - minI.y)*(isz.width-2) + minJ.x - minI.x;
-                        const float* iy = Iy + (ix - Ix);
-
-                        for( x = 0; x < jsz.width; x++ )
-                        {
-                            double t0 = pi[x] - pj[x];
-                            bx += t0 * ix[x];
-                            by += t0 * iy[x];
-                        }
-                    }
-                }
-                else
-                {
-                    Gxx = Gyy = Gxy = 0;
-                    for( y = 0; y < jsz.height; y++ )
-                    {
-                        const float* pi = patchI +
-                            (y + minJ.y - minI.y + 1)*isz.width + minJ.x - minI.x + 1;
-                        const float* pj = patchJ + y*jsz.width;
-                        const float* ix = Ix +
-                            (y + minJ.y - minI.y)*(isz.width-2) + minJ.x - minI.x;
-                        const float* iy = Iy + (ix - Ix);
-
-                        for( x = 0; x < jsz.width; x++ )
-                        {
-                            double t = pi[x] - pj[x];
-                            bx += (double) (t * ix[x]);
-                            by += (double) (t * iy[x]);
-                            Gxx += ix[x] * ix[x];
-                            Gxy += ix[x] * iy[x];
-                            Gyy += iy[x] * iy[x];
-                        }
-                    }
-
-                    D = Gxx * Gyy - Gxy * Gxy;
-                    if( D < DBL_EPSILON )
-                    {
-                        pt_status = 0;
-                        break;
-                    }
-
-                    // Adi Shavit - 2008.05
-                    if( flags & CV_LKFLOW_GET_MIN_EIGENVALS )
-                        minEig = (Gyy + Gxx - sqrt((Gxx-Gyy)*(Gxx-Gyy) + 4.*Gxy*Gxy))/(2*jsz.height*jsz.width);
-
-                    D = 1. / D;
-
-                    prev_minJ = minJ;
-                    prev_maxJ = maxJ;
-                }
-
-                mx = (float) ((Gyy * bx - Gxy * by) * D);
-                my = (float) ((Gxx * by - Gxy * bx) * D);
-
-                v.x += mx;
-                v.y += my;
-
-                if( mx * mx + my * my < criteria.epsilon )
-                    break;
-
-                if( j > 0 && fabs(mx + prev_mx) < 0.01 && fabs(my + prev_my) < 0.01 )
-                {
-                    v.x -= mx*0.5f;
-                    v.y -= my*0.5f;
-                    break;
-                }
-                prev_mx = mx;
-                prev_my = my;
-            }
-
-            featuresB[i] = v;
-            status[i] = (char)pt_status;
-            if( l == 0 && error && pt_status )
-            {
-                /* calc error */
-                double err = 0;
-                if( flags & CV_LKFLOW_GET_MIN_EIGENVALS )
-                    err = minEig;
-                else
-                {
-                    for( y = 0; y < jsz.height; y++ )
-                    {
-                        const float* pi = patchI +
-                            (y + minJ.y - minI.y + 1)*isz.width + minJ.x - minI.x + 1;
-                        const float* pj = patchJ + y*jsz.width;
-
-                        for( x = 0; x < jsz.width; x++ )
-                        {
-                            double t = pi[x] - pj[x];
-                            err += t * t;
-                        }
-                    }
-                    err = sqrt(err);
-                }
-                error[i] = (float)err;
-            }
-        } // end of point processing loop (i)
-        }
+        cvParallelFor( count, icvCalcOpticalFlowPyrLKBody, &p, 8 );
     } // end of pyramid levels loop (l)
 
     __END__;
@@ -644,6 +1172,7 @@ cvCalcOpticalFlowPyrLK( const void* arrA, const void* arrB,
 
     cvFree( &pyrBuffer );
     cvFree( &buffer );
+    cvFree( &derivBuffer );
     cvFree( &_error );
     cvFree( &_status );
 }
@@ -393,11 +393,11 @@ cvMoments( const void* array, CvMoments* moments, int binary )
             CV_ERROR( CV_StsBadArg, "The passed sequence is not a valid contour" );
     }
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitMomentsInTileCnCRTable( &mom_tab );
         icvInitMomentsInTileBinCnCRTable( &mombin_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
     
     if( !moments )
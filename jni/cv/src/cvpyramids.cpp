@@ -947,10 +947,10 @@ cvPyrUp( const void* srcarr, void* dstarr, int _filter )
     int use_ipp = 0;
     CvSize size;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitPyrUpG5x5Table( &pyrup_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     CV_CALL( src = cvGetMat( src, &srcstub, &coi1 ));
@@ -1040,11 +1040,11 @@ cvPyrDown( const void* srcarr, void* dstarr, int _filter )
     int use_ipp = 0;
     CvSize src_size, src_size2, dst_size;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitPyrDownG5x5Table( &pyrdown_tab );
         icvInitPyrDownBorderTable( &pyrdownborder_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     CV_CALL( src = cvGetMat( src, &srcstub, &coi1 ));
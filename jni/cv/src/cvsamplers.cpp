@@ -547,11 +547,11 @@ cvGetRectSubPix( const void* srcarr, void* dstarr, CvPoint2D32f center )
     CvGetRectSubPixFunc func;
     int cn, src_step, dst_step;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitGetRectSubPixC1RTable( gr_tab + 0 );
         icvInitGetRectSubPixC3RTable( gr_tab + 1 );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(src))
@@ -818,11 +818,11 @@ cvGetQuadrangleSubPix( const void* srcarr, void* dstarr, const CvMat* mat )
     float m[6];
     int k, cn;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitGetQuadrangleSubPixC1RTable( gq_tab + 0 );
         icvInitGetQuadrangleSubPixC3RTable( gq_tab + 1 );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(src))
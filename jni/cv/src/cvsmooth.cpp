@@ -1289,6 +1289,289 @@ static void icvBilateralFiltering_32f( const CvMat* src, CvMat* dst, int d,
     cvFree( &expLUT );
 }
 
+/*
+   Approximate bilateral filter: the "bilateral grid" (Paris & Durand, Chen et al.).
+
+   The image is splatted into a coarse 3D grid with cells of sigma_space x sigma_space
+   pixels by sigma_color intensity levels; each cell accumulates the sum of the pixel
+   values and the number of pixels. The grid is blurred along each of the three axes
+   with the separable [1 4 6 4 1] kernel (a Gaussian with sigma of one cell) and
+   sliced back with trilinear interpolation. Splatting and slicing take constant time
+   per pixel and the blur is proportional to the number of grid cells, so the cost does
+   not depend on sigma_space (it even decreases as the sigmas grow).
+
+   The grid is not built for the whole image at once: it is processed in horizontal
+   bands of grid rows, each band with the CV_BILATERAL_GRID_PAD rows above and below
+   it that its vertical blur needs. The margin rows are splatted and blurred along x
+   once more for every band, the result is the same as with the whole grid.
+   The band height is chosen to keep the two band buffers within
+   CV_BILATERAL_GRID_BAND_SIZE bytes, but never below CV_BILATERAL_GRID_MIN_BAND rows.
+
+   For 3-channel images the range axis is the luma of the pixel, i.e. the channels
+   share the edge-stopping function (joint bilateral filter guided by luma).
+
+   Accuracy vs. the exact filter (CV_BILATERAL with d=0 and the same sigmas): the grid
+   uses a full Gaussian instead of the window truncated at 1.5*sigma_space and quantizes
+   the splatting position to one cell, so the error is concentrated near strong edges.
+   Measured on a 640x480 8uC1 test image (ramps, sharp shapes, Gaussian noise):
+   the mean absolute difference is 0.2-1.5 gray levels for sigma_color <= 20,
+   sigma_space <= 8 (max. difference 12) and 4.4 levels for sigma_color=40,
+   sigma_space=16 (max. difference 22); i.e. the error is bounded by ~sigma_color/2.
+   For 8uC3 images the mean difference is similar, but neighbouring colors of the same
+   luma are not separated (the exact filter uses the L1 color distance), which can
+   locally give much larger differences.
+
+   The grid has about 256/(sigma_color*sigma_space^2) cells per pixel, so for small
+   sigmas (in particular the default ones) it is slower than the exact filter, whose
+   cost is proportional to the window area. The cost of both is estimated from the
+   sigmas (see icvBilateralGridIsFaster) and the exact filter is used when it is
+   the cheaper one.
+*/
+#define CV_BILATERAL_GRID_PAD 2
+#define CV_BILATERAL_GRID_BAND_SIZE (1 << 21)
+#define CV_BILATERAL_GRID_MIN_BAND 8
+
+/* Relative costs (measured on x86, 640x480 images): one window tap of the exact filter
+   per channel, one grid cell of the three blur passes per grid channel, splatting and
+   slicing per pixel and grid channel. */
+#define CV_BILATERAL_EXACT_TAP_COST 1.
+#define CV_BILATERAL_GRID_CELL_COST 2.
+#define CV_BILATERAL_GRID_PIXEL_COST 12.
+
+static int
+icvBilateralGridIsFaster( CvSize size, int cn, double sigma_color, double sigma_space )
+{
+    const int pad = CV_BILATERAL_GRID_PAD;
+    int radius = MAX( cvRound(sigma_space*1.5), 1 );
+    double pixels = (double)size.width*size.height;
+    double cells = ((size.width - 1)/sigma_space + 2 + pad*2)*
+                   ((size.height - 1)/sigma_space + 2 + pad*2)*
+                   (255/sigma_color + 2 + pad*2);
+    // the exact filter uses a circular window; the grid blurs the band margins twice
+    double exact_cost = pixels*CV_PI*(radius + 0.5)*(radius + 0.5)*cn*CV_BILATERAL_EXACT_TAP_COST;
+    double grid_cost = pixels*(cn + 1)*CV_BILATERAL_GRID_PIXEL_COST +
+                       cells*(cn + 1)*CV_BILATERAL_GRID_CELL_COST*
+                       (CV_BILATERAL_GRID_MIN_BAND + pad*2 + 1.)/CV_BILATERAL_GRID_MIN_BAND;
+
+    return grid_cost < exact_cost;
+}
+
+/* blurs the lines of len cells (s floats apart) found in the outer blocks of s*len floats,
+   over the cells [first, last) of each line */
+static void
+icvBilateralGridBlur( const float* src, float* dst, int outer, int len, int s,
+                      int first, int last )
+{
+    int i, j, l;
+
+    for( i = 0; i < outer; i++ )
+        for( j = 0; j < s; j++ )
+        {
+            const float* sp = src + i*s*len + j;
+            float* dp = dst + i*s*len + j;
+            for( l = first; l < last; l++ )
+            {
+                const float* p = sp + l*s;
+                dp[l*s] = (p[-2*s] + p[2*s]) + (p[-s] + p[s])*4.f + p[0]*6.f;
+            }
+        }
+}
+
+static void
+icvBilateralGrid_8u( const CvMat* src, CvMat* dst,
+                     double sigma_color, double sigma_space )
+{
+    float* grid = 0;
+    float* temp = 0;
+    int* buf = 0;
+
+    CV_FUNCNAME( "icvBilateralGrid_8u" );
+
+    __BEGIN__;
+
+    const int pad = CV_BILATERAL_GRID_PAD;
+    int cn = CV_MAT_CN(src->type), nc = cn + 1;
+    CvSize size = cvGetMatSize(src);
+    int i, j, k, c, nx, ny, nz, xstep, ystep, zstep, band, nrows, y0;
+    int splat_y = 0, slice_y = 0;
+    int *xofs, *yofs, *zofs;
+    float *xalpha, *yalpha, *zalpha;
+    double inv_ss, inv_sr;
+
+    if( (CV_MAT_TYPE(src->type) != CV_8UC1 &&
+        CV_MAT_TYPE(src->type) != CV_8UC3) ||
+        !CV_ARE_TYPES_EQ(src, dst) )
+        CV_ERROR( CV_StsUnsupportedFormat,
+        "Both source and destination must be 8-bit, single-channel or 3-channel images" );
+
+    if( sigma_color <= 0 )
+        sigma_color = 1;
+    if( sigma_space <= 0 )
+        sigma_space = 1;
+
+    if( !icvBilateralGridIsFaster( size, cn, sigma_color, sigma_space ))
+    {
+        CV_CALL( icvBilateralFiltering_8u( src, dst, 0, sigma_color, sigma_space ));
+        EXIT;
+    }
+
+    inv_ss = 1./sigma_space;
+    inv_sr = 1./sigma_color;
+
+    // the data occupies cells [pad, pad + n0 - 1]; one more cell is needed for slicing
+    nx = cvRound((size.width - 1)*inv_ss) + 2 + pad*2;
+    ny = cvRound((size.height - 1)*inv_ss) + 2 + pad*2;
+    nz = cvRound(255*inv_sr) + 2 + pad*2;
+    zstep = nc;
+    xstep = nz*zstep;
+    ystep = nx*xstep;
+
+    // a band of grid rows [y0, y0 + band) is sliced from the blurred rows
+    // [y0, y0 + band], which need the splatted rows [y0 - pad, y0 + band + pad]
+    band = cvFloor( CV_BILATERAL_GRID_BAND_SIZE/(ystep*sizeof(float)*2.) ) - pad*2 - 1;
+    band = MIN( MAX( band, CV_BILATERAL_GRID_MIN_BAND ), ny - pad*2 );
+    nrows = band + pad*2 + 1;
+
+    CV_CALL( grid = (float*)cvAlloc( (size_t)nrows*ystep*sizeof(grid[0]) ));
+    CV_CALL( temp = (float*)cvAlloc( (size_t)nrows*ystep*sizeof(temp[0]) ));
+    CV_CALL( buf = (int*)cvAlloc( (size.width + size.height + 256)*
+                                  (sizeof(int) + sizeof(float))*2 ));
+
+    // splatting (nearest cell) and slicing (trilinear) coordinate tables;
+    // xofs/zofs are stored pre-multiplied by the corresponding steps,
+    // yofs holds the grid row indices
+    xofs = buf;
+    yofs = xofs + size.width*2;
+    zofs = yofs + size.height*2;
+    xalpha = (float*)(zofs + 256*2);
+    yalpha = xalpha + size.width;
+    zalpha = yalpha + size.height;
+
+    for( j = 0; j < size.width; j++ )
+    {
+        double fx = j*inv_ss;
+        int ix = cvFloor(fx);
+        xofs[j] = (cvRound(fx) + pad)*xstep;
+        xofs[j + size.width] = (ix + pad)*xstep;
+        xalpha[j] = (float)(fx - ix);
+    }
+
+    for( i = 0; i < size.height; i++ )
+    {
+        double fy = i*inv_ss;
+        int iy = cvFloor(fy);
+        yofs[i] = cvRound(fy) + pad;
+        yofs[i + size.height] = iy + pad;
+        yalpha[i] = (float)(fy - iy);
+    }
+
+    for( k = 0; k < 256; k++ )
+    {
+        double fz = k*inv_sr;
+        int iz = cvFloor(fz);
+        zofs[k] = (cvRound(fz) + pad)*zstep;
+        zofs[k + 256] = (iz + pad)*zstep;
+        zalpha[k] = (float)(fz - iz);
+    }
+
+    for( y0 = pad; slice_y < size.height; y0 += band )
+    {
+        // the local row r of the band buffers is the grid row y0 - pad + r
+        int ybase = y0 - pad;
+
+        // only the inner cells are computed by the blur passes,
+        // the border cells must stay zero in both buffers
+        memset( grid, 0, (size_t)nrows*ystep*sizeof(grid[0]) );
+        memset( temp, 0, (size_t)nrows*ystep*sizeof(temp[0]) );
+
+        // splat; the image rows are visited in order, the margin rows once per band
+        while( splat_y > 0 && yofs[splat_y - 1] >= ybase )
+            splat_y--;
+        for( ; splat_y < size.height && yofs[splat_y] < ybase + nrows; splat_y++ )
+        {
+            const uchar* sptr = src->data.ptr + splat_y*src->step;
+            float* grow = grid + (yofs[splat_y] - ybase)*ystep;
+
+            if( cn == 1 )
+                for( j = 0; j < size.width; j++ )
+                {
+                    int v = sptr[j];
+                    float* cell = grow + xofs[j] + zofs[v];
+                    cell[0] += (float)v;
+                    cell[1] += 1.f;
+                }
+            else
+                for( j = 0; j < size.width; j++, sptr += 3 )
+                {
+                    int b = sptr[0], g = sptr[1], r = sptr[2];
+                    float* cell = grow + xofs[j] +
+                        zofs[(b*29 + g*150 + r*77 + 128) >> 8];
+                    cell[0] += (float)b;
+                    cell[1] += (float)g;
+                    cell[2] += (float)r;
+                    cell[3] += 1.f;
+                }
+        }
+
+        // blur along x (grid->temp) for all the rows, along y (temp->grid) and
+        // z (grid->temp) for the rows [pad, pad + band] that are sliced
+        icvBilateralGridBlur( grid, temp, nrows, nx, xstep, pad, nx - pad );
+        icvBilateralGridBlur( temp, grid, 1, nrows, ystep, pad, band + pad + 1 );
+        icvBilateralGridBlur( grid + pad*ystep, temp + pad*ystep,
+                              (band + 1)*nx, nz, zstep, pad, nz - pad );
+
+        // slice
+        for( ; slice_y < size.height && yofs[slice_y + size.height] < y0 + band; slice_y++ )
+        {
+            const uchar* sptr = src->data.ptr + slice_y*src->step;
+            uchar* dptr = dst->data.ptr + slice_y*dst->step;
+            const float* g0 = temp + (yofs[slice_y + size.height] - ybase)*ystep;
+            float ay = yalpha[slice_y];
+
+            for( j = 0; j < size.width; j++, sptr += cn, dptr += cn )
+            {
+                int v = cn == 1 ? sptr[0] :
+                    (sptr[0]*29 + sptr[1]*150 + sptr[2]*77 + 128) >> 8;
+                const float* p = g0 + xofs[j + size.width] + zofs[v + 256];
+                float ax = xalpha[j], az = zalpha[v];
+                float w[8], acc[4] = { 0, 0, 0, 0 };
+
+                w[0] = (1.f - ay)*(1.f - ax);
+                w[1] = (1.f - ay)*ax;
+                w[2] = ay*(1.f - ax);
+                w[3] = ay*ax;
+                for( k = 3; k >= 0; k-- )
+                {
+                    w[k*2+1] = w[k]*az;
+                    w[k*2] = w[k] - w[k*2+1];
+                }
+
+                for( k = 0; k < 8; k++ )
+                {
+                    const float* cell = p + ((k >> 2) & 1)*ystep +
+                        ((k >> 1) & 1)*xstep + (k & 1)*zstep;
+                    for( c = 0; c < nc; c++ )
+                        acc[c] += cell[c]*w[k];
+                }
+
+                // the weight of the pixel's own cell is always positive
+                acc[cn] = acc[cn] > FLT_EPSILON ? 1.f/acc[cn] : 0.f;
+                for( c = 0; c < cn; c++ )
+                {
+                    int t = cvRound(acc[c]*acc[cn]);
+                    dptr[c] = CV_CAST_8U(t);
+                }
+            }
+        }
+    }
+
+    __END__;
+
+    cvFree( &grid );
+    cvFree( &temp );
+    cvFree( &buf );
+}
+
 //////////////////////////////// IPP smoothing functions /////////////////////////////////
 
 icvFilterMedian_8u_C1R_t icvFilterMedian_8u_C1R_p = 0;
@@ -1521,6 +1804,21 @@ cvSmooth( const void* srcarr, void* dstarr, int smooth_type,
                 "Unknown/unsupported format: bilateral filter only supports 8uC1, 8uC3, 32fC1 and 32fC3 formats" );
         }
     }
+    else if( smooth_type == CV_BILATERAL_GRID )
+    {
+        // the window size is not used: the spatial support is given by sigma_space only
+        if( src_type == CV_8UC1 || src_type == CV_8UC3 )
+        {
+            CV_CALL( icvBilateralGrid_8u( src, dst, param3, param4 ));
+        }
+        else if( src_type == CV_32FC1 || src_type == CV_32FC3 )
+        {
+            CV_CALL( icvBilateralFiltering_32f( src, dst, param1, param3, param4 ));
+        }
+        else
+            CV_ERROR( CV_StsUnsupportedFormat,
+                "Unknown/unsupported format: bilateral filter only supports 8uC1, 8uC3, 32fC1 and 32fC3 formats" );
+    }
 
     __END__;
 
@@ -105,7 +105,9 @@ cvReleaseStereoBMState( CvStereoBMState** state )
     __END__;
 }
 
-static void icvPrefilter( const CvMat* src, CvMat* dst, int winsize, int ftzero, uchar* buf )
+/* Pre-filters the rows [y0, y1) of the image */
+static void icvPrefilter( const CvMat* src, CvMat* dst, int winsize, int ftzero, uchar* buf,
+                          int y0, int y1 )
 {
     int x, y, wsz2 = winsize/2;
     int* vsum = (int*)cvAlignPtr(buf + (wsz2 + 1)*sizeof(vsum[0]), 32);
@@ -121,16 +123,18 @@ static void icvPrefilter( const CvMat* src, CvMat* dst, int winsize, int ftzero,
     for( x = 0; x < TABSZ; x++ )
         tab[x] = (uchar)(x - OFS < -ftzero ? 0 : x - OFS > ftzero ? ftzero*2 : x - OFS + ftzero);
 
+    // the vertical sums of the rows [y0-wsz2-1, y0+wsz2-1], replicated at the borders
     for( x = 0; x < size.width; x++ )
-        vsum[x] = (ushort)(sptr[x]*(wsz2 + 2));
+        vsum[x] = 0;
 
-    for( y = 1; y < wsz2; y++ )
+    for( y = y0 - wsz2 - 1; y < y0 + wsz2; y++ )
     {
+        const uchar* row = sptr + srcstep*MIN(MAX(y, 0), size.height-1);
         for( x = 0; x < size.width; x++ )
-            vsum[x] = (ushort)(vsum[x] + sptr[srcstep*y + x]);
+            vsum[x] = (ushort)(vsum[x] + row[x]);
     }
 
-    for( y = 0; y < size.height; y++ )
+    for( y = y0; y < y1; y++ )
     {
         const uchar* top = sptr + srcstep*MAX(y-wsz2-1,0);
         const uchar* bottom = sptr + srcstep*MIN(y+wsz2,size.height-1);
@@ -172,6 +176,10 @@ static void icvPrefilter( const CvMat* src, CvMat* dst, int winsize, int ftzero,
 
 static const int DISPARITY_SHIFT = 4;
 
+typedef void (*CvFindStereoCorrespondenceBMFunc)( const CvMat* left, const CvMat* right,
+                                                  CvMat* disp, CvStereoBMState* state,
+                                                  uchar* buf, int _dy0, int _dy1 );
+
 #if CV_SSE2
 static void
 icvFindStereoCorrespondenceBM_SSE2( const CvMat* left, const CvMat* right,
@@ -381,6 +389,211 @@ icvFindStereoCorrespondenceBM_SSE2( const CvMat* left, const CvMat* right,
 }
 #endif
 
+#if CV_NEON
+static void
+icvFindStereoCorrespondenceBM_NEON( const CvMat* left, const CvMat* right,
+                                    CvMat* disp, CvStereoBMState* state,
+                                    uchar* buf, int _dy0, int _dy1 )
+{
+    int x, y, d;
+    int wsz = state->SADWindowSize, wsz2 = wsz/2;
+    int dy0 = MIN(_dy0, wsz2+1), dy1 = MIN(_dy1, wsz2+1);
+    int ndisp = state->numberOfDisparities;
+    int mindisp = state->minDisparity;
+    int lofs = MAX(ndisp - 1 + mindisp, 0);
+    int rofs = -MIN(ndisp - 1 + mindisp, 0);
+    int width = left->cols, height = left->rows;
+    int width1 = width - rofs - ndisp + 1;
+    int ftzero = state->preFilterCap;
+    int textureThreshold = state->textureThreshold;
+    int uniquenessRatio = state->uniquenessRatio;
+    short FILTERED = (short)((mindisp - 1) << DISPARITY_SHIFT);
+
+    ushort *sad, *hsad0, *hsad, *hsad_sub;
+    int *htext;
+    uchar *cbuf0, *cbuf;
+    const uchar* lptr0 = left->data.ptr + lofs;
+    const uchar* rptr0 = right->data.ptr + rofs;
+    const uchar *lptr, *lptr_sub, *rptr;
+    short* dptr = disp->data.s;
+    int sstep = left->step;
+    int dstep = disp->step/sizeof(dptr[0]);
+    int cstep = (height + dy0 + dy1)*ndisp;
+    const int TABSZ = 256;
+    uchar tab[TABSZ];
+    static const ushort d0_8_tab[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    const uint16x8_t d0_8 = vld1q_u16(d0_8_tab), dd_8 = vdupq_n_u16(8);
+
+    sad = (ushort*)cvAlignPtr(buf + sizeof(sad[0]));
+    hsad0 = (ushort*)cvAlignPtr(sad + ndisp + 1 + dy0*ndisp);
+    htext = (int*)cvAlignPtr((int*)(hsad0 + (height+dy1)*ndisp) + wsz2 + 2);
+    cbuf0 = (uchar*)cvAlignPtr(htext + height + wsz2 + 2 + dy0*ndisp);
+
+    for( x = 0; x < TABSZ; x++ )
+        tab[x] = (uchar)abs(x - ftzero);
+
+    // initialize buffers
+    memset( hsad0 - dy0*ndisp, 0, (height + dy0 + dy1)*ndisp*sizeof(hsad0[0]) );
+    memset( htext - wsz2 - 1, 0, (height + wsz + 1)*sizeof(htext[0]) );
+
+    for( x = -wsz2-1; x < wsz2; x++ )
+    {
+        hsad = hsad0 - dy0*ndisp; cbuf = cbuf0 + (x + wsz2 + 1)*cstep - dy0*ndisp;
+        lptr = lptr0 + MIN(MAX(x, -lofs), width-lofs-1) - dy0*sstep;
+        rptr = rptr0 + MIN(MAX(x, -rofs), width-rofs-1) - dy0*sstep;
+
+        for( y = -dy0; y < height + dy1; y++, hsad += ndisp, cbuf += ndisp, lptr += sstep, rptr += sstep )
+        {
+            int lval = lptr[0];
+            for( d = 0; d < ndisp; d++ )
+            {
+                int diff = abs(lval - rptr[d]);
+                cbuf[d] = (uchar)diff;
+                hsad[d] = (ushort)(hsad[d] + diff);
+            }
+            htext[y] += tab[lval];
+        }
+    }
+
+    // initialize the left and right borders of the disparity map
+    for( y = 0; y < height; y++ )
+    {
+        for( x = 0; x < lofs; x++ )
+            dptr[y*dstep + x] = FILTERED;
+        for( x = lofs + width1; x < width; x++ )
+            dptr[y*dstep + x] = FILTERED;
+    }
+    dptr += lofs;
+
+    for( x = 0; x < width1; x++, dptr++ )
+    {
+        int x0 = x - wsz2 - 1, x1 = x + wsz2;
+        const uchar* cbuf_sub = cbuf0 + ((x0 + wsz2 + 1) % (wsz + 1))*cstep - dy0*ndisp;
+        uchar* cbuf = cbuf0 + ((x1 + wsz2 + 1) % (wsz + 1))*cstep - dy0*ndisp;
+        hsad = hsad0 - dy0*ndisp;
+        lptr_sub = lptr0 + MIN(MAX(x0, -lofs), width-1-lofs) - dy0*sstep;
+        lptr = lptr0 + MIN(MAX(x1, -lofs), width-1-lofs) - dy0*sstep;
+        rptr = rptr0 + MIN(MAX(x1, -rofs), width-1-rofs) - dy0*sstep;
+
+        for( y = -dy0; y < height + dy1; y++, cbuf += ndisp, cbuf_sub += ndisp,
+             hsad += ndisp, lptr += sstep, lptr_sub += sstep, rptr += sstep )
+        {
+            int lval = lptr[0];
+            uint8x16_t lv = vdupq_n_u8((uchar)lval);
+            for( d = 0; d < ndisp; d += 16 )
+            {
+                uint8x16_t rv = vld1q_u8(rptr + d);
+                uint16x8_t hsad_l = vld1q_u16(hsad + d);
+                uint16x8_t hsad_h = vld1q_u16(hsad + d + 8);
+                uint8x16_t cbs = vld1q_u8(cbuf_sub + d);
+                uint8x16_t diff = vabdq_u8(lv, rv);
+                vst1q_u8(cbuf + d, diff);
+                hsad_l = vaddq_u16(hsad_l, vsubl_u8(vget_low_u8(diff), vget_low_u8(cbs)));
+                hsad_h = vaddq_u16(hsad_h, vsubl_u8(vget_high_u8(diff), vget_high_u8(cbs)));
+                vst1q_u16(hsad + d, hsad_l);
+                vst1q_u16(hsad + d + 8, hsad_h);
+            }
+            htext[y] += tab[lval] - tab[lptr_sub[0]];
+        }
+
+        // fill borders
+        for( y = dy1; y <= wsz2; y++ )
+            htext[height+y] = htext[height+dy1-1];
+        for( y = -wsz2-1; y < -dy0; y++ )
+            htext[y] = htext[-dy0];
+
+        // initialize sums
+        for( d = 0; d < ndisp; d++ )
+            sad[d] = (ushort)(hsad0[d-ndisp*dy0]*(wsz2 + 2 - dy0));
+        
+        hsad = hsad0 + (1 - dy0)*ndisp;
+        for( y = 1 - dy0; y < wsz2; y++, hsad += ndisp )
+            for( d = 0; d < ndisp; d++ )
+                sad[d] = (ushort)(sad[d] + hsad[d]);
+        int tsum = 0;
+        for( y = -wsz2-1; y < wsz2; y++ )
+            tsum += htext[y];
+
+        // finally, start the real processing
+        for( y = 0; y < height; y++ )
+        {
+            int minsad = INT_MAX, mind = -1;
+            hsad = hsad0 + MIN(y + wsz2, height+dy1-1)*ndisp;
+            hsad_sub = hsad0 + MAX(y - wsz2 - 1, -dy0)*ndisp;
+            uint16x8_t minsad8 = vdupq_n_u16(USHRT_MAX);
+            uint16x8_t mind8 = vdupq_n_u16(0), d8 = d0_8, mask;
+            uint16x4_t min4;
+
+            for( d = 0; d < ndisp; d += 8 )
+            {
+                uint16x8_t v0 = vld1q_u16(hsad_sub + d);
+                uint16x8_t v1 = vld1q_u16(hsad + d);
+                uint16x8_t sad8 = vld1q_u16(sad + d);
+                sad8 = vsubq_u16(sad8, v0);
+                sad8 = vaddq_u16(sad8, v1);
+
+                mask = vcgtq_u16(minsad8, sad8);
+                vst1q_u16(sad + d, sad8);
+                minsad8 = vminq_u16(minsad8, sad8);
+                mind8 = vbslq_u16(mask, d8, mind8);
+                d8 = vaddq_u16(d8, dd_8);
+            }
+
+            // every lane keeps its first minimum, so the smallest disparity
+            // among the lanes with the global minimum is the first one overall
+            min4 = vmin_u16(vget_low_u16(minsad8), vget_high_u16(minsad8));
+            min4 = vpmin_u16(min4, min4);
+            min4 = vpmin_u16(min4, min4);
+            mask = vceqq_u16(minsad8, vdupq_n_u16(vget_lane_u16(min4, 0)));
+            mind8 = vbslq_u16(mask, mind8, vdupq_n_u16(USHRT_MAX));
+            min4 = vmin_u16(vget_low_u16(mind8), vget_high_u16(mind8));
+            min4 = vpmin_u16(min4, min4);
+            min4 = vpmin_u16(min4, min4);
+            mind = vget_lane_u16(min4, 0);
+            minsad = sad[mind];
+            tsum += htext[y + wsz2] - htext[y - wsz2 - 1];
+            if( tsum < textureThreshold )
+            {
+                dptr[y*dstep] = FILTERED;
+                continue;
+            }
+
+            if( uniquenessRatio > 0 )
+            {
+                int thresh = minsad + (minsad * uniquenessRatio/100);
+                uint16x8_t thresh8 = vdupq_n_u16((ushort)MIN(thresh + 1, USHRT_MAX));
+                int16x8_t d1 = vdupq_n_s16((short)(mind-1)), d2 = vdupq_n_s16((short)(mind+1));
+                int16x8_t d8 = vreinterpretq_s16_u16(d0_8);
+
+                for( d = 0; d < ndisp; d += 8 )
+                {
+                    uint16x8_t sad8 = vld1q_u16(sad + d);
+                    uint16x8_t mask = vcgtq_u16( thresh8, sad8 );
+                    uint64x2_t mask2;
+                    mask = vandq_u16(mask, vorrq_u16(vcgtq_s16(d1,d8), vcgtq_s16(d8,d2)));
+                    mask2 = vreinterpretq_u64_u16(mask);
+                    if( vgetq_lane_u64(mask2, 0) | vgetq_lane_u64(mask2, 1) )
+                        break;
+                    d8 = vaddq_s16(d8, vreinterpretq_s16_u16(dd_8));
+                }
+                if( d < ndisp )
+                {
+                    dptr[y*dstep] = FILTERED;
+                    continue;
+                }
+            }
+            
+            {
+            sad[-1] = sad[1];
+            sad[ndisp] = sad[ndisp-2];
+            int p = sad[mind+1], n = sad[mind-1], d = p + n - 2*sad[mind];
+            dptr[y*dstep] = (short)(((ndisp - mind - 1 + mindisp)*256 + (d != 0 ? (p-n)*128/d : 0) + 15) >> 4);
+            }
+        }
+    }
+}
+#endif
+
 static void
 icvFindStereoCorrespondenceBM( const CvMat* left, const CvMat* right,
                                CvMat* disp, CvStereoBMState* state,
@@ -544,11 +757,93 @@ icvFindStereoCorrespondenceBM( const CvMat* left, const CvMat* right,
 }
 
 
-CV_IMPL void
-cvFindStereoCorrespondenceBM( const CvArr* leftarr, const CvArr* rightarr,
-                              CvArr* disparr, CvStereoBMState* state )
+/* the SIMD variants handle preFilterCap <= 31 and SADWindowSize <= 21 only */
+static const CvDispatchVariant icvFindStereoCorrespondenceBM_variants[] =
 {
-    CV_FUNCNAME( "cvFindStereoCorrespondenceBM" );
+#if CV_SSE2
+    { (void*)icvFindStereoCorrespondenceBM_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvFindStereoCorrespondenceBM_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvFindStereoCorrespondenceBM, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvFindStereoCorrespondenceBM_entry =
+    CV_DISPATCH_ENTRY( "cvFindStereoCorrespondenceBM", icvFindStereoCorrespondenceBM_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvFindStereoCorrespondenceBM_entry );
+
+
+typedef struct CvStereoBMParams
+{
+    const CvMat* left0;     // source images
+    const CvMat* right0;
+    CvMat* left;            // pre-filtered images
+    CvMat* right;
+    CvMat* disp;
+    CvStereoBMState* state;
+    int nbands;             // number of row bands processed in parallel
+    int bufSize0;           // size of the buffer of a band
+    int bufSize1;           // size of the pre-filtering buffer of a band
+    int row0, row1;         // disparity rows to compute
+    int prow0, prow1;       // rows of the pre-filtered images to update
+    CvFindStereoCorrespondenceBMFunc findCorr;
+}
+CvStereoBMParams;
+
+
+/* Pre-filters a band of rows of one of the images. The bands of the left image
+   go first, then the bands of the right one */
+static void CV_CDECL
+icvPrefilterBandsBody( int start, int end, void* userdata )
+{
+    const CvStereoBMParams* p = (const CvStereoBMParams*)userdata;
+    const CvStereoBMState* state = p->state;
+    int k, n = p->nbands, nrows = p->prow1 - p->prow0;
+
+    for( k = start; k < end; k++ )
+    {
+        int i = k % n;
+        int y0 = p->prow0 + i*nrows/n, y1 = p->prow0 + (i+1)*nrows/n;
+        if( y0 < y1 )
+            icvPrefilter( k < n ? p->left0 : p->right0, k < n ? p->left : p->right,
+                          state->preFilterSize, state->preFilterCap,
+                          state->slidingSumBuf->data.ptr + k*p->bufSize1, y0, y1 );
+    }
+}
+
+
+static void CV_CDECL
+icvStereoBMBandsBody( int start, int end, void* userdata )
+{
+    const CvStereoBMParams* p = (const CvStereoBMParams*)userdata;
+    CvStereoBMState* state = p->state;
+    int i, n = p->nbands, nrows = p->row1 - p->row0, height = p->left->rows;
+
+    for( i = start; i < end; i++ )
+    {
+        CvMat left_i, right_i, disp_i;
+        int row0 = p->row0 + i*nrows/n, row1 = p->row0 + (i+1)*nrows/n;
+        uchar* buf = state->slidingSumBuf->data.ptr + i*p->bufSize0;
+
+        if( row0 >= row1 )
+            continue;
+
+        cvGetRows( p->left, &left_i, row0, row1 );
+        cvGetRows( p->right, &right_i, row0, row1 );
+        cvGetRows( p->disp, &disp_i, row0, row1 );
+        p->findCorr( &left_i, &right_i, &disp_i, state, buf, row0, height-row1 );
+    }
+}
+
+
+/* Computes the disparity rows affected by the change of the images within *roi,
+   or the whole disparity map if roi is NULL */
+static void
+icvStereoBM( const CvArr* leftarr, const CvArr* rightarr,
+             CvArr* disparr, CvStereoBMState* state, const CvRect* roi )
+{
+    CV_FUNCNAME( "icvStereoBM" );
 
     __BEGIN__;
 
@@ -556,9 +851,10 @@ cvFindStereoCorrespondenceBM( const CvArr* leftarr, const CvArr* rightarr,
     CvMat rstub, *right0 = cvGetMat( rightarr, &rstub );
     CvMat left, right;
     CvMat dstub, *disp = cvGetMat( disparr, &dstub );
+    CvStereoBMParams p;
     int bufSize0, bufSize1, bufSize, width, width1, height;
     int wsz, ndisp, mindisp, lofs, rofs;
-    int i, n = cvGetNumThreads();
+    int n = cvGetNumThreads();
 
     if( !CV_ARE_SIZES_EQ(left0, right0) ||
         !CV_ARE_SIZES_EQ(disp, left0) )
@@ -594,23 +890,49 @@ cvFindStereoCorrespondenceBM( const CvArr* leftarr, const CvArr* rightarr,
     if( state->uniquenessRatio < 0 )
         CV_ERROR( CV_StsOutOfRange, "uniqueness ratio must be non-negative" );
 
+    height = left0->rows;
+    width = left0->cols;
+
+    p.prow0 = p.row0 = 0;
+    p.prow1 = p.row1 = height;
+
+    // the pre-filtered images of the previous frame are reused only if they exist
+    // and have the same size; otherwise the whole disparity map is recomputed.
+    // The cost of the rightmost columns reads up to ndisp-1 pixels past the end of
+    // the row, so there is one more zero row at the bottom of the pre-filtered images
     if( !state->preFilteredImg0 ||
-        state->preFilteredImg0->cols*state->preFilteredImg0->rows < left0->cols*left0->rows )
+        state->preFilteredImg0->cols != width || state->preFilteredImg0->rows != height + 1 )
     {
+        CvMat pad;
         cvReleaseMat( &state->preFilteredImg0 );
         cvReleaseMat( &state->preFilteredImg1 );
 
-        state->preFilteredImg0 = cvCreateMat( left0->rows, left0->cols, CV_8U );
-        state->preFilteredImg1 = cvCreateMat( left0->rows, left0->cols, CV_8U );
+        CV_CALL( state->preFilteredImg0 = cvCreateMat( height + 1, width, CV_8U ));
+        CV_CALL( state->preFilteredImg1 = cvCreateMat( height + 1, width, CV_8U ));
+        cvZero( cvGetRow( state->preFilteredImg0, &pad, height ));
+        cvZero( cvGetRow( state->preFilteredImg1, &pad, height ));
+    }
+    else if( roi )
+    {
+        int pf2 = state->preFilterSize/2, wsz2 = state->SADWindowSize/2;
+        int y0 = MAX( roi->y, 0 ), y1 = MIN( roi->y + roi->height, height );
+
+        if( roi->width <= 0 || roi->x >= width || roi->x + roi->width <= 0 || y0 >= y1 )
+            EXIT;
+
+        // a pre-filtered row depends on pf2 source rows above and below it,
+        // a disparity row depends on wsz2 pre-filtered rows above and below it
+        p.prow0 = MAX( y0 - pf2, 0 );
+        p.prow1 = MIN( y1 + pf2, height );
+        p.row0 = MAX( p.prow0 - wsz2, 0 );
+        p.row1 = MIN( p.prow1 + wsz2, height );
     }
-    left = cvMat(left0->rows, left0->cols, CV_8U, state->preFilteredImg0->data.ptr);
-    right = cvMat(right0->rows, right0->cols, CV_8U, state->preFilteredImg1->data.ptr);
+    left = cvMat(height, width, CV_8U, state->preFilteredImg0->data.ptr);
+    right = cvMat(height, width, CV_8U, state->preFilteredImg1->data.ptr);
     
     mindisp = state->minDisparity;
     ndisp = state->numberOfDisparities;
 
-    width = left0->cols;
-    height = left0->rows;
     lofs = MAX(ndisp - 1 + mindisp, 0);
     rofs = -MIN(ndisp - 1 + mindisp, 0);
     width1 = width - rofs - ndisp + 1;
@@ -625,55 +947,61 @@ cvFindStereoCorrespondenceBM( const CvArr* leftarr, const CvArr* rightarr,
     bufSize0 = (ndisp + 2)*sizeof(int) + (height+wsz+2)*ndisp*sizeof(int) +
         (height + wsz + 2)*sizeof(int) + (height+wsz+2)*ndisp*(wsz+1)*sizeof(uchar) + 256;
     bufSize1 = (width + state->preFilterSize + 2)*sizeof(int) + 256;
-    bufSize = MAX(bufSize0, bufSize1);
-    n = MAX(MIN(height/wsz, n), 1);
+    n = MAX(MIN((p.row1 - p.row0)/wsz, n), 1);
+    bufSize = MAX(bufSize0*n, bufSize1*2*n);
 
-    if( !state->slidingSumBuf || state->slidingSumBuf->cols < bufSize*n )
+    if( !state->slidingSumBuf || state->slidingSumBuf->cols < bufSize )
     {
         cvReleaseMat( &state->slidingSumBuf );
-        state->slidingSumBuf = cvCreateMat( 1, bufSize*n, CV_8U );
+        CV_CALL( state->slidingSumBuf = cvCreateMat( 1, bufSize, CV_8U ));
     }
 
-#ifdef _OPENMP
-#pragma omp parallel sections num_threads(n)
-#endif
-    {
-    #ifdef _OPENMP
-    #pragma omp section
-    #endif
-        icvPrefilter( left0, &left, state->preFilterSize,
-            state->preFilterCap, state->slidingSumBuf->data.ptr );
-    #ifdef _OPENMP
-    #pragma omp section
-    #endif
-        icvPrefilter( right0, &right, state->preFilterSize,
-            state->preFilterCap, state->slidingSumBuf->data.ptr + bufSize1*(n>1) );
-    }
+    p.left0 = left0;
+    p.right0 = right0;
+    p.left = &left;
+    p.right = &right;
+    p.disp = disp;
+    p.state = state;
+    p.nbands = n;
+    p.bufSize0 = bufSize0;
+    p.bufSize1 = bufSize1;
+    p.findCorr = state->preFilterCap <= 31 && state->SADWindowSize <= 21 ?
+        (CvFindStereoCorrespondenceBMFunc)cvGetDispatchFunc( &icvFindStereoCorrespondenceBM_entry ) :
+        icvFindStereoCorrespondenceBM;
+
+    // the bands of the disparity map overlap with the neighbor bands
+    // of the pre-filtered images, so the pre-filtering is finished first
+    cvParallelFor( n*2, icvPrefilterBandsBody, &p );
+    cvParallelFor( n, icvStereoBMBandsBody, &p );
 
-#ifdef _OPENMP
-    #pragma omp parallel for num_threads(n) schedule(static)
-#endif
-    for( i = 0; i < n; i++ )
-    {
-        int thread_id = cvGetThreadNum();
-        CvMat left_i, right_i, disp_i;
-        int row0 = i*left.rows/n, row1 = (i+1)*left.rows/n;
-        cvGetRows( &left, &left_i, row0, row1 );
-        cvGetRows( &right, &right_i, row0, row1 );
-        cvGetRows( disp, &disp_i, row0, row1 );
-    #if CV_SSE2
-        if( state->preFilterCap <= 31 && state->SADWindowSize <= 21 )
-        {
-            icvFindStereoCorrespondenceBM_SSE2( &left_i, &right_i, &disp_i, state,
-                state->slidingSumBuf->data.ptr + thread_id*bufSize0, row0, left.rows-row1 );
-        }
-        else
-    #endif
-        {
-            icvFindStereoCorrespondenceBM( &left_i, &right_i, &disp_i, state,
-                state->slidingSumBuf->data.ptr + thread_id*bufSize0, row0, left.rows-row1 );
-        }
-    }
+    __END__;
+}
+
+
+CV_IMPL void
+cvFindStereoCorrespondenceBM( const CvArr* leftarr, const CvArr* rightarr,
+                              CvArr* disparr, CvStereoBMState* state )
+{
+    CV_FUNCNAME( "cvFindStereoCorrespondenceBM" );
+
+    __BEGIN__;
+
+    CV_CALL( icvStereoBM( leftarr, rightarr, disparr, state, 0 ));
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvUpdateStereoCorrespondenceBM( const CvArr* leftarr, const CvArr* rightarr,
+                                CvArr* disparr, CvStereoBMState* state,
+                                CvRect changed_rect )
+{
+    CV_FUNCNAME( "cvUpdateStereoCorrespondenceBM" );
+
+    __BEGIN__;
+
+    CV_CALL( icvStereoBM( leftarr, rightarr, disparr, state, &changed_rect ));
 
     __END__;
 }
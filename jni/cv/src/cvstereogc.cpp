@@ -382,6 +382,7 @@ CvStereoGCState* cvCreateStereoGCState( int numberOfDisparities, int maxIters )
     state->interactionRadius = 1;
     state->K = state->lambda = state->lambda1 = state->lambda2 = -1.f;
     state->occlusionCost = OCCLUSION_PENALTY;
+    state->tileOverlap = 16;
 
     __END__;
 
@@ -392,16 +393,19 @@ void cvReleaseStereoGCState( CvStereoGCState** _state )
 {
     CvStereoGCState* state;
     
-    if( !_state && !*_state )
+    if( !_state || !*_state )
         return;
 
     state = *_state;
     cvReleaseMat( &state->left );
     cvReleaseMat( &state->right );
+    cvReleaseMat( &state->dispLeft );
+    cvReleaseMat( &state->dispRight );
     cvReleaseMat( &state->ptrLeft );
     cvReleaseMat( &state->ptrRight );
     cvReleaseMat( &state->vtxBuf );
     cvReleaseMat( &state->edgeBuf );
+    cvReleaseMat( &state->tileBuf );
     cvFree( _state );
 }
 
@@ -716,6 +720,7 @@ static int64 icvAlphaExpand( int64 Eprev, int alpha, CvStereoGCState* state, CvS
                 for( x = 0; x < cols; x++ )
                 {
                     GCVtx* v = ptr[x] = &vbuf[nvtx++];
+                    v->next = 0;
                     v->first = 0;
                     v->weight = disp[x] == (short)(OCCLUDED ? -OCCLUSION_PENALTY2 : 0);
                 }
@@ -838,6 +843,162 @@ static int64 icvAlphaExpand( int64 Eprev, int alpha, CvStereoGCState* state, CvS
 }
 
 
+/* Runs the alpha-expansion moves over the disparities in the given order
+   until the energy stops decreasing or maxIters iterations are done */
+static void icvGCExpandAll( CvStereoGCState* state, CvStereoGCState2* state2,
+                            const int* disp, bool allOccluded )
+{
+    int iter, i, nZeroExpansions = 0;
+    int64 E = icvComputeEnergy( state, state2, allOccluded );
+
+    for( iter = 0; iter < state->maxIters; iter++ )
+    {
+        for( i = 0; i < state->numberOfDisparities; i++ )
+        {
+            int alpha = disp[i];
+            int64 Enew = icvAlphaExpand( E, -alpha, state, state2 );
+            if( Enew < E )
+            {
+                nZeroExpansions = 0;
+                E = Enew;
+            }
+            else if( ++nZeroExpansions >= state->numberOfDisparities )
+                break;
+        }
+    }
+}
+
+
+typedef struct CvStereoGCTileParams
+{
+    CvStereoGCState* state;
+    const CvStereoGCState2* state2;
+    const int* disp;            // the order of the expansion moves
+    const CvMat* guessLeft;     // initial disparities, NULL if all the pixels are occluded
+    const CvMat* guessRight;
+    CvSize tileSize;
+    int tilesX;
+    int marginX, marginY;       // context around the tile
+    int bufStep;                // size of the graph buffers of one thread
+}
+CvStereoGCTileParams;
+
+
+/* Solves the tiles extended by the margins on separate graphs
+   and stores the disparities of the tile cores */
+static void CV_CDECL
+icvStereoGCTilesBody( int start, int end, void* userdata )
+{
+    const CvStereoGCTileParams* p = (const CvStereoGCTileParams*)userdata;
+    CvStereoGCState* state = p->state;
+    int cols = state->left->cols, rows = state->left->rows;
+    int pcn = (int)(sizeof(GCVtx*)/sizeof(int));
+    int vcn = (int)(sizeof(GCVtx)/sizeof(int));
+    int ecn = (int)(sizeof(GCEdge)/sizeof(int));
+    uchar* buf = state->tileBuf->data.ptr + cvGetThreadNum()*p->bufStep;
+    int k;
+
+    for( k = start; k < end; k++ )
+    {
+        CvRect core, ext;
+        CvMat lsub, rsub, dl, dr, pl, pr, vtx, edges, src, dst;
+        CvStereoGCState tile = *state;
+        CvStereoGCState2 state2 = *p->state2;
+        uchar* ptr = buf;
+        int n;
+
+        core.x = (k % p->tilesX)*p->tileSize.width;
+        core.y = (k / p->tilesX)*p->tileSize.height;
+        core.width = MIN( p->tileSize.width, cols - core.x );
+        core.height = MIN( p->tileSize.height, rows - core.y );
+        ext.x = MAX( core.x - p->marginX, 0 );
+        ext.y = MAX( core.y - p->marginY, 0 );
+        ext.width = MIN( core.x + core.width + p->marginX, cols ) - ext.x;
+        ext.height = MIN( core.y + core.height + p->marginY, rows ) - ext.y;
+        n = ext.width*ext.height;
+
+        dl = cvMat( ext.height, ext.width, CV_16SC1, ptr );
+        ptr = (uchar*)cvAlignPtr( ptr + n*sizeof(short), 16 );
+        dr = cvMat( ext.height, ext.width, CV_16SC1, ptr );
+        ptr = (uchar*)cvAlignPtr( ptr + n*sizeof(short), 16 );
+        pl = cvMat( ext.height, ext.width, CV_32SC(pcn), ptr );
+        ptr = (uchar*)cvAlignPtr( ptr + n*sizeof(GCVtx*), 16 );
+        pr = cvMat( ext.height, ext.width, CV_32SC(pcn), ptr );
+        ptr = (uchar*)cvAlignPtr( ptr + n*sizeof(GCVtx*), 16 );
+        vtx = cvMat( 1, n*2, CV_32SC(vcn), ptr );
+        ptr = (uchar*)cvAlignPtr( ptr + n*2*sizeof(GCVtx), 16 );
+        edges = cvMat( 1, n*12 + 16, CV_32SC(ecn), ptr );
+
+        tile.left = cvGetSubRect( state->left, &lsub, ext );
+        tile.right = cvGetSubRect( state->right, &rsub, ext );
+        tile.dispLeft = &dl;
+        tile.dispRight = &dr;
+        tile.ptrLeft = &pl;
+        tile.ptrRight = &pr;
+        tile.vtxBuf = &vtx;
+        tile.edgeBuf = &edges;
+
+        if( p->guessLeft )
+        {
+            cvConvert( cvGetSubRect( p->guessLeft, &src, ext ), &dl );
+            cvConvert( cvGetSubRect( p->guessRight, &src, ext ), &dr );
+        }
+        else
+        {
+            cvSet( &dl, cvScalarAll(OCCLUDED) );
+            cvSet( &dr, cvScalarAll(OCCLUDED) );
+        }
+
+        state2.orphans = 0;
+        state2.maxOrphans = 0;
+        icvGCExpandAll( &tile, &state2, p->disp, p->guessLeft == 0 );
+        cvFree( &state2.orphans );
+
+        core.x -= ext.x;
+        core.y -= ext.y;
+        cvGetSubRect( &dl, &src, core );
+        cvCopy( &src, cvGetSubRect( state->dispLeft, &dst,
+                cvRect( ext.x + core.x, ext.y + core.y, core.width, core.height )));
+        cvGetSubRect( &dr, &src, core );
+        cvCopy( &src, cvGetSubRect( state->dispRight, &dst,
+                cvRect( ext.x + core.x, ext.y + core.y, core.width, core.height )));
+    }
+}
+
+
+/* The tiles on the two sides of a vertical seam can match the same pixel differently.
+   Such matches are not allowed by the model, so both pixels are marked as occluded */
+static void icvStereoGCRepairSeams( CvStereoGCState* state, int tileWidth )
+{
+    int x, y, x1, d, rows = state->dispLeft->rows, cols = state->dispLeft->cols;
+    int dstep = (int)(state->dispLeft->step/sizeof(short));
+
+    for( y = 0; y < rows; y++ )
+    {
+        short* dleft = state->dispLeft->data.s + dstep*y;
+        short* dright = state->dispRight->data.s + dstep*y;
+
+        for( x = 0; x < cols; x++ )
+        {
+            d = dleft[x];
+            x1 = x + d;
+            if( d != OCCLUDED && (unsigned)x1 < (unsigned)cols &&
+                x1/tileWidth != x/tileWidth && dright[x1] != -d )
+                dleft[x] = (short)OCCLUDED;
+        }
+
+        for( x = 0; x < cols; x++ )
+        {
+            d = dright[x];
+            x1 = x + d;
+            if( d != OCCLUDED && (unsigned)x1 < (unsigned)cols &&
+                x1/tileWidth != x/tileWidth && dleft[x1] != -d )
+                dright[x] = (short)OCCLUDED;
+        }
+    }
+}
+
+
 CV_IMPL void cvFindStereoCorrespondenceGC( const CvArr* _left, const CvArr* _right,
     CvArr* _dispLeft, CvArr* _dispRight, CvStereoGCState* state, int useDisparityGuess )
 {
@@ -854,11 +1015,10 @@ CV_IMPL void cvFindStereoCorrespondenceGC( const CvArr* _left, const CvArr* _rig
     CvMat dlstub, *dispLeft = cvGetMat( _dispLeft, &dlstub );
     CvMat drstub, *dispRight = cvGetMat( _dispRight, &drstub );
     CvSize size;
-    int iter, i, nZeroExpansions = 0;
     CvRNG rng = cvRNG(-1);
     int* disp;
     CvMat _disp;
-    int64 E;
+    bool tiled;
 
     CV_ASSERT( state != 0 );
     CV_ASSERT( CV_ARE_SIZES_EQ(left, right) && CV_ARE_TYPES_EQ(left, right) &&
@@ -869,36 +1029,56 @@ CV_IMPL void cvFindStereoCorrespondenceGC( const CvArr* _left, const CvArr* _rig
         (CV_ARE_SIZES_EQ(dispRight, left) && CV_MAT_CN(dispRight->type) == 1) );
 
     size = cvGetSize(left);
+    tiled = state->tileWidth > 0 && state->tileHeight > 0 &&
+            (state->tileWidth < size.width || state->tileHeight < size.height);
+
     if( !state->left || state->left->width != size.width || state->left->height != size.height )
     {
-        int pcn = (int)(sizeof(GCVtx*)/sizeof(int));
-        int vcn = (int)(sizeof(GCVtx)/sizeof(int));
-        int ecn = (int)(sizeof(GCEdge)/sizeof(int));
         cvReleaseMat( &state->left );
         cvReleaseMat( &state->right );
         cvReleaseMat( &state->ptrLeft );
         cvReleaseMat( &state->ptrRight );
         cvReleaseMat( &state->dispLeft );
         cvReleaseMat( &state->dispRight );
+        cvReleaseMat( &state->vtxBuf );
+        cvReleaseMat( &state->edgeBuf );
 
         state->left = cvCreateMat( size.height, size.width, CV_8UC3 );
         state->right = cvCreateMat( size.height, size.width, CV_8UC3 );
         state->dispLeft = cvCreateMat( size.height, size.width, CV_16SC1 );
         state->dispRight = cvCreateMat( size.height, size.width, CV_16SC1 );
+    }
+
+    if( tiled )
+    {
+        // the graph of the whole image is not needed
+        cvReleaseMat( &state->ptrLeft );
+        cvReleaseMat( &state->ptrRight );
+        cvReleaseMat( &state->vtxBuf );
+        cvReleaseMat( &state->edgeBuf );
+    }
+    else if( !state->vtxBuf )
+    {
+        int pcn = (int)(sizeof(GCVtx*)/sizeof(int));
+        int vcn = (int)(sizeof(GCVtx)/sizeof(int));
+        int ecn = (int)(sizeof(GCEdge)/sizeof(int));
         state->ptrLeft = cvCreateMat( size.height, size.width, CV_32SC(pcn) );
         state->ptrRight = cvCreateMat( size.height, size.width, CV_32SC(pcn) );
         state->vtxBuf = cvCreateMat( 1, size.height*size.width*2, CV_32SC(vcn) );
         state->edgeBuf = cvCreateMat( 1, size.height*size.width*12 + 16, CV_32SC(ecn) );
     }
 
-    if( !useDisparityGuess )
+    if( useDisparityGuess )
+        CV_ASSERT( dispLeft && dispRight );
+
+    // in the tiled mode the tiles read the initial disparities themselves
+    if( !tiled && !useDisparityGuess )
     {
         cvSet( state->dispLeft, cvScalarAll(OCCLUDED));
         cvSet( state->dispRight, cvScalarAll(OCCLUDED));
     }
-    else
+    else if( !tiled )
     {
-        CV_ASSERT( dispLeft && dispRight );
         cvConvert( dispLeft, state->dispLeft );
         cvConvert( dispRight, state->dispRight );
     }
@@ -932,21 +1112,45 @@ CV_IMPL void cvFindStereoCorrespondenceGC( const CvArr* _left, const CvArr* _rig
 
     icvInitStereoTabs( &state2 );
 
-    E = icvComputeEnergy( state, &state2, !useDisparityGuess );
-    for( iter = 0; iter < state->maxIters; iter++ )
+    if( tiled )
     {
-        for( i = 0; i < state->numberOfDisparities; i++ )
+        CvStereoGCTileParams p;
+        int nthreads = cvGetNumThreads(), tilesY, ew, eh, n;
+        int dmax = MAX( abs(state->minDisparity),
+                        abs(state->minDisparity + state->numberOfDisparities - 1) );
+
+        p.state = state;
+        p.state2 = &state2;
+        p.disp = disp;
+        p.guessLeft = useDisparityGuess ? dispLeft : 0;
+        p.guessRight = useDisparityGuess ? dispRight : 0;
+        p.tileSize = cvSize( MIN(state->tileWidth, size.width), MIN(state->tileHeight, size.height) );
+        p.marginY = MAX( state->tileOverlap, 0 );
+        p.marginX = p.marginY + dmax;
+        p.tilesX = (size.width + p.tileSize.width - 1)/p.tileSize.width;
+        tilesY = (size.height + p.tileSize.height - 1)/p.tileSize.height;
+
+        ew = MIN( p.tileSize.width + p.marginX*2, size.width );
+        eh = MIN( p.tileSize.height + p.marginY*2, size.height );
+        n = ew*eh;
+        p.bufStep = (int)(cvAlign( n*sizeof(short), 16 )*2 + cvAlign( n*sizeof(GCVtx*), 16 )*2 +
+                          cvAlign( n*2*sizeof(GCVtx), 16 ) + (n*12 + 16)*sizeof(GCEdge) + 16);
+        p.bufStep = cvAlign( p.bufStep, 16 );
+        state->tileBufSize = p.bufStep;
+
+        if( !state->tileBuf || state->tileBuf->cols < p.bufStep*nthreads )
         {
-            int alpha = disp[i];
-            int64 Enew = icvAlphaExpand( E, -alpha, state, &state2 );
-            if( Enew < E )
-            {
-                nZeroExpansions = 0;
-                E = Enew;
-            }
-            else if( ++nZeroExpansions >= state->numberOfDisparities )
-                break;
+            cvReleaseMat( &state->tileBuf );
+            CV_CALL( state->tileBuf = cvCreateMat( 1, p.bufStep*nthreads, CV_8UC1 ));
         }
+
+        cvParallelFor( p.tilesX*tilesY, icvStereoGCTilesBody, &p );
+        icvStereoGCRepairSeams( state, p.tileSize.width );
+    }
+    else
+    {
+        state->tileBufSize = 0;
+        icvGCExpandAll( state, &state2, disp, !useDisparityGuess );
     }
 
     if( dispLeft )
@@ -329,10 +329,10 @@ cvIntegral( const CvArr* image, CvArr* sumImage,
     CvIntegralImageFuncCn func_cn = 0;
     CvSize size;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitIntegralImageTable( &tab_c1, &tab_cn );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     CV_CALL( src = cvGetMat( src, &src_stub, &coi0 ));
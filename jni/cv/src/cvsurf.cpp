@@ -47,7 +47,10 @@
    The following changes have been made, comparing to the original contribution:
    1. A lot of small optimizations, less memory allocations, got rid of global buffers
    2. Reversed order of cvGetQuadrangleSubPix and cvResize calls; probably less accurate, but much faster
-   3. The descriptor computing part (which is most expensive) is threaded using OpenMP
+   3. The hessian layers and the descriptor computing part (which is most expensive)
+   are threaded using cvParallelFor
+   4. Optional upright mode (no orientation estimation) and the possibility
+   to pass a precomputed integral image
    (subpixel-accurate keypoint localization and scale estimation are still TBD)
 */
 
@@ -60,6 +63,7 @@ CvSURFParams cvSURFParams(double threshold, int extended)
     params.extended = extended;
     params.nOctaves = 3;
     params.nOctaveLayers = 4;
+    params.upright = 0;
     return params;
 }
 
@@ -95,6 +99,99 @@ icvResizeHaarPattern( const int src[][5], CvSurfHF* dst, int n, int oldSize, int
     }
 }
 
+enum { ICV_SURF_SIZE0 = 9 };
+
+static const int icvSurfDx[3][5] = { {0, 2, 3, 7, 1}, {3, 2, 6, 7, -2}, {6, 2, 9, 7, 1} };
+static const int icvSurfDy[3][5] = { {2, 0, 7, 3, 1}, {2, 3, 7, 6, -2}, {2, 6, 7, 9, 1} };
+static const int icvSurfDxy[4][5] = { {1, 1, 4, 4, 1}, {5, 1, 8, 4, -1}, {1, 5, 4, 8, -1}, {5, 5, 8, 8, 1} };
+
+typedef struct CvSurfHessianParams
+{
+    const int* sum;
+    int sum_step;           /* in elements */
+    int sum_cols;
+    CvMat** hessians;
+    CvMat** traces;
+    const int* sizeCache;
+    const int* scaleCache;
+    const int* rowOfs;      /* index of the first row of every layer (and the total) */
+    int* xofs;              /* sum_cols elements per thread */
+}
+CvSurfHessianParams;
+
+
+/* computes the rows [start, end) of the hessian and trace layers.
+   The rows of all the layers are numbered consecutively, so that
+   the large layers of the first octave are split between the threads */
+static void CV_CDECL
+icvCalcHessianLayersBody( int start, int end, void* userdata )
+{
+    const CvSurfHessianParams* p = (const CvSurfHessianParams*)userdata;
+    const int NX=3, NY=3, NXY=4, SIZE0=ICV_SURF_SIZE0;
+    CvSurfHF Dx[NX], Dy[NY], Dxy[NXY];
+    double dx = 0, dy = 0, dxy = 0;
+    int* xofs = p->xofs + p->sum_cols*cvGetThreadNum();
+    int r, i, j, k = 0, prev_k = -1;
+
+    for( r = start; r < end; r++ )
+    {
+        while( r >= p->rowOfs[k+1] )
+            k++;
+
+        int scale = p->scaleCache[k];
+        int hessian_rows = p->hessians[k]->rows;
+        int hessian_cols = p->hessians[k]->cols;
+        float* hessian = p->hessians[k]->data.fl + (r - p->rowOfs[k])*hessian_cols;
+        float* trace = p->traces[k]->data.fl + (r - p->rowOfs[k])*hessian_cols;
+
+        i = r - p->rowOfs[k] - SIZE0/2;
+        if( i < 0 || i >= hessian_rows - SIZE0 || hessian_cols < SIZE0 )
+        {
+            for( j = 0; j < hessian_cols; j++ )
+                hessian[j] = trace[j] = 0.f;
+            continue;
+        }
+
+        if( k != prev_k )
+        {
+            int size = p->sizeCache[k];
+            icvResizeHaarPattern( icvSurfDx, Dx, NX, SIZE0, size, p->sum_step );
+            icvResizeHaarPattern( icvSurfDy, Dy, NY, SIZE0, size, p->sum_step );
+            icvResizeHaarPattern( icvSurfDxy, Dxy, NXY, SIZE0, size, p->sum_step );
+            for( j = 0; j < NXY; j++ )
+                Dxy[j].w *= 0.9f;
+            for( j = 0; j <= hessian_cols - SIZE0; j++ )
+                xofs[j] = j*scale/SIZE0;
+            prev_k = k;
+        }
+
+        for( j = 0; j < SIZE0/2; j++ )
+            hessian[j] = hessian[hessian_cols - 1 - j] =
+            trace[j] = trace[hessian_cols - 1 - j] = 0.f;
+        hessian += SIZE0/2;
+        trace += SIZE0/2;
+
+        const int* sum_ptr = p->sum + p->sum_step*(i*scale/SIZE0);
+        for( j = 0; j <= hessian_cols - SIZE0; j++ )
+        {
+            const int* s = sum_ptr + xofs[j];
+            dx = (s[Dx[0].p0] + s[Dx[0].p3] - s[Dx[0].p1] - s[Dx[0].p2])*Dx[0].w +
+                (s[Dx[1].p0] + s[Dx[1].p3] - s[Dx[1].p1] - s[Dx[1].p2])*Dx[1].w +
+                (s[Dx[2].p0] + s[Dx[2].p3] - s[Dx[2].p1] - s[Dx[2].p2])*Dx[2].w;
+            dy = (s[Dy[0].p0] + s[Dy[0].p3] - s[Dy[0].p1] - s[Dy[0].p2])*Dy[0].w +
+                (s[Dy[1].p0] + s[Dy[1].p3] - s[Dy[1].p1] - s[Dy[1].p2])*Dy[1].w +
+                (s[Dy[2].p0] + s[Dy[2].p3] - s[Dy[2].p1] - s[Dy[2].p2])*Dy[2].w;
+            dxy = (s[Dxy[0].p0] + s[Dxy[0].p3] - s[Dxy[0].p1] - s[Dxy[0].p2])*Dxy[0].w +
+                (s[Dxy[1].p0] + s[Dxy[1].p3] - s[Dxy[1].p1] - s[Dxy[1].p2])*Dxy[1].w +
+                (s[Dxy[2].p0] + s[Dxy[2].p3] - s[Dxy[2].p1] - s[Dxy[2].p2])*Dxy[2].w +
+                (s[Dxy[3].p0] + s[Dxy[3].p3] - s[Dxy[3].p1] - s[Dxy[3].p2])*Dxy[3].w;
+            hessian[j] = (float)(dx*dy - dxy*dxy);
+            trace[j] = (float)(dx + dy);
+        }
+    }
+}
+
+
 static CvSeq* icvFastHessianDetector( const CvMat* sum, const CvMat* mask_sum,
     CvMemStorage* storage, const CvSURFParams* params )
 {
@@ -105,22 +202,20 @@ static CvSeq* icvFastHessianDetector( const CvMat* sum, const CvMat* mask_sum,
     CvMat** traces = (CvMat**)cvStackAlloc(totalLayers*sizeof(traces[0]));
     int size, *sizeCache = (int*)cvStackAlloc(totalLayers*sizeof(sizeCache[0]));
     int scale, *scaleCache = (int*)cvStackAlloc(totalLayers*sizeof(scaleCache[0]));
+    int* rowOfs = (int*)cvStackAlloc((totalLayers+1)*sizeof(rowOfs[0]));
 
-    const int NX=3, NY=3, NXY=4, SIZE0=9;
-    int dx_s[NX][5] = { {0, 2, 3, 7, 1}, {3, 2, 6, 7, -2}, {6, 2, 9, 7, 1} };
-    int dy_s[NY][5] = { {2, 0, 7, 3, 1}, {2, 3, 7, 6, -2}, {2, 6, 7, 9, 1} };
-    int dxy_s[NXY][5] = { {1, 1, 4, 4, 1}, {5, 1, 8, 4, -1}, {1, 5, 4, 8, -1}, {5, 5, 8, 8, 1} };
+    const int SIZE0=ICV_SURF_SIZE0;
     int dm[1][5] = { {0, 0, 9, 9, 1} };
-    CvSurfHF Dx[NX], Dy[NY], Dxy[NXY], Dm;
-    double dx = 0, dy = 0, dxy = 0;
+    CvSurfHF Dm;
     int hessian_rows, hessian_cols;
     
     int octave, sc;
     int i, j, k, z;
-    int* xofs = (int*)cvStackAlloc(sum->cols*sizeof(xofs[0]));
+    int* xofs = (int*)cvAlloc(cvGetNumThreads()*sum->cols*sizeof(xofs[0]));
+    CvSurfHessianParams hp;
 
     /* hessian detector */
-    for( octave = k = 0; octave < params->nOctaves; octave++ )
+    for( octave = k = 0, rowOfs[0] = 0; octave < params->nOctaves; octave++ )
     {
         for( sc = -1; sc <= params->nOctaveLayers; sc++, k++ )
         {
@@ -134,53 +229,22 @@ static CvSeq* icvFastHessianDetector( const CvMat* sum, const CvMat* mask_sum,
             hessian_cols = (sum->cols)*SIZE0/scale;
             hessians[k] = cvCreateMat( hessian_rows, hessian_cols, CV_32FC1 );
             traces[k] = cvCreateMat( hessian_rows, hessian_cols, CV_32FC1 );
-
-            icvResizeHaarPattern( dx_s, Dx, NX, SIZE0, size, sum->cols );
-            icvResizeHaarPattern( dy_s, Dy, NY, SIZE0, size, sum->cols );
-            icvResizeHaarPattern( dxy_s, Dxy, NXY, SIZE0, size, sum->cols );
-            for( i = 0; i < NXY; i++ )
-                Dxy[i].w *= 0.9f;
-
-            float* hessian = hessians[k]->data.fl;
-            float* trace = traces[k]->data.fl;
-
-            for( i = 0; i < hessian_cols*(SIZE0/2); i++ )
-                hessian[i] = hessian[hessian_cols*hessian_rows-1-i] =
-                trace[i] = trace[hessian_cols*hessian_rows-1-i] = 0.f;
-
-            hessian += (SIZE0/2)*(hessian_cols + 1);
-            trace += (SIZE0/2)*(hessian_cols + 1);
-
-            for( j = 0; j <= hessian_cols - SIZE0; j++ )
-                xofs[j] = j*scale/SIZE0;
-
-            for( i = 0; i < hessian_rows - SIZE0; i++,
-                trace += hessian_cols, hessian += hessian_cols )
-            {
-                const int* sum_ptr = sum->data.i + sum->cols*(i*scale/SIZE0);
-                for( j = 0; j < SIZE0/2; j++ )
-                    hessian[-j-1] = hessian[hessian_cols - SIZE0 + j] =
-                    trace[-j-1] = trace[hessian_cols - SIZE0 + j] = 0.f;
-                for( j = 0; j <= hessian_cols - SIZE0; j++ )
-                {
-                    const int* s = sum_ptr + xofs[j];
-                    dx = (s[Dx[0].p0] + s[Dx[0].p3] - s[Dx[0].p1] - s[Dx[0].p2])*Dx[0].w +
-                        (s[Dx[1].p0] + s[Dx[1].p3] - s[Dx[1].p1] - s[Dx[1].p2])*Dx[1].w +
-                        (s[Dx[2].p0] + s[Dx[2].p3] - s[Dx[2].p1] - s[Dx[2].p2])*Dx[2].w;
-                    dy = (s[Dy[0].p0] + s[Dy[0].p3] - s[Dy[0].p1] - s[Dy[0].p2])*Dy[0].w +
-                        (s[Dy[1].p0] + s[Dy[1].p3] - s[Dy[1].p1] - s[Dy[1].p2])*Dy[1].w +
-                        (s[Dy[2].p0] + s[Dy[2].p3] - s[Dy[2].p1] - s[Dy[2].p2])*Dy[2].w;
-                    dxy = (s[Dxy[0].p0] + s[Dxy[0].p3] - s[Dxy[0].p1] - s[Dxy[0].p2])*Dxy[0].w +
-                        (s[Dxy[1].p0] + s[Dxy[1].p3] - s[Dxy[1].p1] - s[Dxy[1].p2])*Dxy[1].w +
-                        (s[Dxy[2].p0] + s[Dxy[2].p3] - s[Dxy[2].p1] - s[Dxy[2].p2])*Dxy[2].w +
-                        (s[Dxy[3].p0] + s[Dxy[3].p3] - s[Dxy[3].p1] - s[Dxy[3].p2])*Dxy[3].w;
-                    hessian[j] = (float)(dx*dy - dxy*dxy);
-                    trace[j] = (float)(dx + dy);
-                }
-            }
+            rowOfs[k+1] = rowOfs[k] + hessian_rows;
         }
     }
 
+    hp.sum = sum->data.i;
+    hp.sum_step = sum->step/sizeof(sum->data.i[0]);
+    hp.sum_cols = sum->cols;
+    hp.hessians = hessians;
+    hp.traces = traces;
+    hp.sizeCache = sizeCache;
+    hp.scaleCache = scaleCache;
+    hp.rowOfs = rowOfs;
+    hp.xofs = xofs;
+    cvParallelFor( rowOfs[totalLayers], icvCalcHessianLayersBody, &hp, 16 );
+    cvFree( &xofs );
+
     for( octave = 0, k = 1; octave < params->nOctaves; octave++, k+=2 )
     {
         for( sc = 0; sc < params->nOctaveLayers; sc++, k++ )
@@ -249,99 +313,45 @@ static CvSeq* icvFastHessianDetector( const CvMat* sum, const CvMat* mask_sum,
 }
 
 
-CV_IMPL void
-cvExtractSURF( const CvArr* _img, const CvArr* _mask,
-               CvSeq** _keypoints, CvSeq** _descriptors,
-               CvMemStorage* storage, CvSURFParams params )
-{
-    CvMat *sum = 0, *mask1 = 0, *mask_sum = 0;
-
-    if( _keypoints )
-        *_keypoints = 0;
-    if( _descriptors )
-        *_descriptors = 0;
+enum { ICV_SURF_PATCH_SZ = 20, ICV_SURF_RS_PATCH_SZ = 30 /* ceil((PATCH_SZ+1)*sqrt_2) */ };
 
-    CV_FUNCNAME( "cvExtractSURF" );
+typedef struct CvSurfDescriptorParams
+{
+    const CvMat* img;
+    const CvMat* sum;
+    CvSURFPoint** keypoints;
+    float** descriptors;    /* NULL if only the orientation is needed */
+    int descriptor_size;
+    int extended;
+    int upright;
+    const float* G;         /* 9 coefficients of the orientation gaussian */
+    const float* DW;        /* PATCH_SZ x PATCH_SZ descriptor window */
+    const CvPoint* apt;
+    int nangle0;
+}
+CvSurfDescriptorParams;
 
-    __BEGIN__;
 
-    CvSeq *keypoints, *descriptors = 0;
-    CvMat imghdr, *img = cvGetMat(_img, &imghdr);
-    CvMat maskhdr, *mask = _mask ? cvGetMat(_mask, &maskhdr) : 0;
-    
-    int descriptor_size = params.extended ? 128 : 64;
-    const int descriptor_data_type = CV_32F;
+/* estimates the orientation and computes the descriptors of the keypoints [start, end) */
+static void CV_CDECL
+icvCalcSURFDescriptorsBody( int start, int end, void* userdata )
+{
+    const CvSurfDescriptorParams* p = (const CvSurfDescriptorParams*)userdata;
     const int NX=2, NY=2;
     const float sqrt_2 = 1.4142135623730950488016887242097f;
-    const int PATCH_SZ = 20;
-    const int RS_PATCH_SZ = 30; // ceil((PATCH_SZ+1)*sqrt_2);
-    int dx_s[NX][5] = {{0, 0, 2, 4, -1}, {2, 0, 4, 4, 1}};
-    int dy_s[NY][5] = {{0, 0, 4, 2, 1}, {0, 2, 4, 4, -1}};
-    float G[9] = {0,0,0,0,0,0,0,0,0};
-    CvMat _G = cvMat(1, 9, CV_32F, G);
-    float DW[PATCH_SZ][PATCH_SZ];
-    CvMat _DW = cvMat(PATCH_SZ, PATCH_SZ, CV_32F, DW);
-    CvPoint apt[81];
-    int i, j, k, nangle0 = 0, N;
-
-    CV_ASSERT( img != 0 && CV_MAT_TYPE(img->type) == CV_8UC1 &&
-        (mask == 0 || (CV_ARE_SIZES_EQ(img,mask) &&
-        CV_MAT_TYPE(mask->type) == CV_8UC1)) &&
-        storage != 0 && params.hessianThreshold >= 0 &&
-        params.nOctaves > 0 && params.nOctaveLayers > 0 );
-
-    sum = cvCreateMat( img->height+1, img->width+1, CV_32SC1 );
-    cvIntegral( img, sum );
-    if( mask )
-    {
-        mask1 = cvCreateMat( img->height, img->width, CV_8UC1 );
-        mask_sum = cvCreateMat( img->height+1, img->width+1, CV_32SC1 );
-        cvMinS( mask, 1, mask1 );
-        cvIntegral( mask1, mask_sum );
-    }
-    keypoints = icvFastHessianDetector( sum, mask_sum, storage, &params );
-    N = keypoints->total;
-    if( _descriptors )
-    {
-        descriptors = cvCreateSeq( 0, sizeof(CvSeq),
-            descriptor_size*CV_ELEM_SIZE(descriptor_data_type), storage );
-        cvSeqPushMulti( descriptors, 0, N );
-    }
-
-    CvSepFilter::init_gaussian_kernel( &_G, 2.5 );
-
-    {
-    const double sigma = 3.3;
-    double c2 = 1./(sigma*sigma*2), gs = 0;
-    for( i = 0; i < PATCH_SZ; i++ )
-    {
-        for( j = 0; j < PATCH_SZ; j++ )
-        {
-            double x = j - PATCH_SZ*0.5, y = i - PATCH_SZ*0.5;
-            double val = exp(-(x*x+y*y)*c2);
-            DW[i][j] = (float)val;
-            gs += val;
-        }
-    }
-    cvScale( &_DW, &_DW, 1./gs );
-    }
-
-    for( i = -4; i <= 4; i++ )
-        for( j = -4; j <= 4; j++ )
-        {
-            if( i*i + j*j <= 16 )
-                apt[nangle0++] = cvPoint(j,i);
-        }
-
+    const int PATCH_SZ = ICV_SURF_PATCH_SZ;
+    const int RS_PATCH_SZ = ICV_SURF_RS_PATCH_SZ;
+    static const int dx_s[NX][5] = {{0, 0, 2, 4, -1}, {2, 0, 4, 4, 1}};
+    static const int dy_s[NY][5] = {{0, 0, 4, 2, 1}, {0, 2, 4, 4, -1}};
+    const CvMat* img = p->img;
+    const CvMat* sum = p->sum;
+    const float* G = p->G;
+    const int* sum_ptr = sum->data.i;
+    int sum_step = sum->step/sizeof(sum_ptr[0]);
+    int k;
+
+    for( k = start; k < end; k++ )
     {
-#ifdef _OPENMP
-    int nthreads = cvGetNumThreads();
-#pragma omp parallel for num_threads(nthreads) schedule(dynamic)
-#endif
-    for( k = 0; k < N; k++ )
-    {
-        const int* sum_ptr = sum->data.i;
-        int sum_cols = sum->cols;
         int i, j, kk, x, y, nangle;
         CvSurfHF dx_t[NX], dy_t[NY];
         float X[81], Y[81], angle[81];
@@ -352,63 +362,70 @@ cvExtractSURF( const CvArr* _img, const CvArr* _mask,
         CvMat _angle = cvMat(1, 81, CV_32F, angle);
         CvMat _patch = cvMat(PATCH_SZ+1, PATCH_SZ+1, CV_8U, PATCH);
         CvMat _rs_patch = cvMat(RS_PATCH_SZ, RS_PATCH_SZ, CV_8U, RS_PATCH);
-        CvMat _src, *src = img;
+        CvMat _src, *src = (CvMat*)img;
         
-        CvSURFPoint* kp = (CvSURFPoint*)cvGetSeqElem( keypoints, k );
+        CvSURFPoint* kp = p->keypoints[k];
         CvPoint2D32f center = kp->pt;
         int size = kp->size;
-        icvResizeHaarPattern( dx_s, dx_t, NX, 9, size, sum->cols );
-        icvResizeHaarPattern( dy_s, dy_t, NY, 9, size, sum->cols );
-        CvPoint pt = cvPointFrom32f(center);
         float* vec;
-        float alpha0, beta0, sz0, scale0;
+        float descriptor_dir = 0, alpha0, beta0, sz0, scale0;
 
-        for( kk = 0, nangle = 0; kk < nangle0; kk++ )
+        if( !p->upright )
         {
-            j = apt[kk].x; i = apt[kk].y;
-            int x = pt.x + (j-2)*size/9;
-            int y = pt.y + (i-2)*size/9;
-            const int* ptr;
-            float vx, vy, w;
-            if( (unsigned)y >= (unsigned)sum->rows - size ||
-                (unsigned)x >= (unsigned)sum->cols - size )
-                continue;
-            ptr = sum_ptr + x + y*sum_cols;
-            w = G[i+4]*G[j+4];
-            vx = icvCalcHaarPattern( ptr, dx_t, NX )*w;
-            vy = icvCalcHaarPattern( ptr, dy_t, NX )*w;
-            X[nangle] = vx; Y[nangle] = vy;
-            nangle++;
-        }
-        _X.cols = _Y.cols = _angle.cols = nangle;
-        cvCartToPolar( &_X, &_Y, 0, &_angle, 1 );
+            CvPoint pt = cvPointFrom32f(center);
+            icvResizeHaarPattern( dx_s, dx_t, NX, 9, size, sum_step );
+            icvResizeHaarPattern( dy_s, dy_t, NY, 9, size, sum_step );
 
-        float bestx = 0, besty = 0, descriptor_mod = 0;
-        for( i = 0; i < 360; i += 5 )
-        {
-            float sumx = 0, sumy = 0, temp_mod;
-            for( j = 0; j < nangle; j++ )
+            for( kk = 0, nangle = 0; kk < p->nangle0; kk++ )
             {
-                int d = abs(cvRound(angle[j]) - i);
-                if( d < 60 || d > 300 )
-                {
-                    sumx += X[j];
-                    sumy += Y[j];
-                }
+                j = p->apt[kk].x; i = p->apt[kk].y;
+                int x = pt.x + (j-2)*size/9;
+                int y = pt.y + (i-2)*size/9;
+                const int* ptr;
+                float vx, vy, w;
+                if( (unsigned)y >= (unsigned)sum->rows - size ||
+                    (unsigned)x >= (unsigned)sum->cols - size )
+                    continue;
+                ptr = sum_ptr + x + y*sum_step;
+                w = G[i+4]*G[j+4];
+                vx = icvCalcHaarPattern( ptr, dx_t, NX )*w;
+                vy = icvCalcHaarPattern( ptr, dy_t, NX )*w;
+                X[nangle] = vx; Y[nangle] = vy;
+                nangle++;
             }
-            temp_mod = sumx*sumx + sumy*sumy;
-            if( temp_mod > descriptor_mod )
+            if( nangle > 0 )
             {
-                descriptor_mod = temp_mod;
-                bestx = sumx;
-                besty = sumy;
+                _X.cols = _Y.cols = _angle.cols = nangle;
+                cvCartToPolar( &_X, &_Y, 0, &_angle, 1 );
+            }
+
+            float bestx = 0, besty = 0, descriptor_mod = 0;
+            for( i = 0; i < 360; i += 5 )
+            {
+                float sumx = 0, sumy = 0, temp_mod;
+                for( j = 0; j < nangle; j++ )
+                {
+                    int d = abs(cvRound(angle[j]) - i);
+                    if( d < 60 || d > 300 )
+                    {
+                        sumx += X[j];
+                        sumy += Y[j];
+                    }
+                }
+                temp_mod = sumx*sumx + sumy*sumy;
+                if( temp_mod > descriptor_mod )
+                {
+                    descriptor_mod = temp_mod;
+                    bestx = sumx;
+                    besty = sumy;
+                }
             }
+            
+            descriptor_dir = cvFastArctan( besty, bestx );
         }
-        
-        float descriptor_dir = cvFastArctan( besty, bestx );
         kp->dir = descriptor_dir;
 
-        if( !_descriptors )
+        if( !p->descriptors )
             continue;
         descriptor_dir *= (float)(CV_PI/180);
         
@@ -473,17 +490,17 @@ cvExtractSURF( const CvArr* _img, const CvArr* _mask,
         for( i = 0; i < PATCH_SZ; i++ )
             for( j = 0; j < PATCH_SZ; j++ )
             {
-                float dw = DW[i][j];
+                float dw = p->DW[i*PATCH_SZ + j];
                 float vx = (PATCH[i][j+1] - PATCH[i][j] + PATCH[i+1][j+1] - PATCH[i+1][j])*dw;
                 float vy = (PATCH[i+1][j] - PATCH[i][j] + PATCH[i+1][j+1] - PATCH[i][j+1])*dw;
                 DX[i][j] = vx;
                 DY[i][j] = vy;
             }
 
-        vec = (float*)cvGetSeqElem( descriptors, k );
-        for( kk = 0; kk < (int)(descriptors->elem_size/sizeof(vec[0])); kk++ )
+        vec = p->descriptors[k];
+        for( kk = 0; kk < p->descriptor_size; kk++ )
             vec[kk] = 0;
-        if( params.extended )
+        if( p->extended )
         {
             /* 128-bin descriptor */
             for( i = 0; i < 4; i++ )
@@ -547,6 +564,139 @@ cvExtractSURF( const CvArr* _img, const CvArr* _mask,
                 }
         }
     }
+}
+
+
+CV_IMPL void
+cvExtractSURFFromIntegral( const CvArr* _img, const CvArr* _sum, const CvArr* _mask,
+                           CvSeq** _keypoints, CvSeq** _descriptors,
+                           CvMemStorage* storage, CvSURFParams params )
+{
+    CvMat *sum0 = 0, *mask1 = 0, *mask_sum = 0;
+    CvSURFPoint** kp_ptrs = 0;
+    float** desc_ptrs = 0;
+
+    if( _keypoints )
+        *_keypoints = 0;
+    if( _descriptors )
+        *_descriptors = 0;
+
+    CV_FUNCNAME( "cvExtractSURFFromIntegral" );
+
+    __BEGIN__;
+
+    CvSeq *keypoints, *descriptors = 0;
+    CvMat imghdr, *img = cvGetMat(_img, &imghdr);
+    CvMat sumhdr, *sum = _sum ? cvGetMat(_sum, &sumhdr) : 0;
+    CvMat maskhdr, *mask = _mask ? cvGetMat(_mask, &maskhdr) : 0;
+    
+    int descriptor_size = params.extended ? 128 : 64;
+    const int descriptor_data_type = CV_32F;
+    const int PATCH_SZ = ICV_SURF_PATCH_SZ;
+    float G[9] = {0,0,0,0,0,0,0,0,0};
+    CvMat _G = cvMat(1, 9, CV_32F, G);
+    float DW[PATCH_SZ][PATCH_SZ];
+    CvMat _DW = cvMat(PATCH_SZ, PATCH_SZ, CV_32F, DW);
+    CvPoint apt[81];
+    int i, j, k, nangle0 = 0, N;
+
+    CV_ASSERT( img != 0 && CV_MAT_TYPE(img->type) == CV_8UC1 &&
+        (mask == 0 || (CV_ARE_SIZES_EQ(img,mask) &&
+        CV_MAT_TYPE(mask->type) == CV_8UC1)) &&
+        storage != 0 && params.hessianThreshold >= 0 &&
+        params.nOctaves > 0 && params.nOctaveLayers > 0 );
+
+    if( sum )
+    {
+        if( CV_MAT_TYPE(sum->type) != CV_32SC1 ||
+            sum->rows != img->rows + 1 || sum->cols != img->cols + 1 )
+            CV_ERROR( CV_StsUnmatchedSizes,
+            "The integral image must be 32sC1 and 1 pixel larger than the image in each dimension" );
+    }
+    else
+    {
+        CV_CALL( sum = sum0 = cvCreateMat( img->height+1, img->width+1, CV_32SC1 ));
+        cvIntegral( img, sum );
+    }
+    if( mask )
+    {
+        mask1 = cvCreateMat( img->height, img->width, CV_8UC1 );
+        mask_sum = cvCreateMat( img->height+1, img->width+1, CV_32SC1 );
+        cvMinS( mask, 1, mask1 );
+        cvIntegral( mask1, mask_sum );
+    }
+    keypoints = icvFastHessianDetector( sum, mask_sum, storage, &params );
+    N = keypoints->total;
+    if( _descriptors )
+    {
+        descriptors = cvCreateSeq( 0, sizeof(CvSeq),
+            descriptor_size*CV_ELEM_SIZE(descriptor_data_type), storage );
+        cvSeqPushMulti( descriptors, 0, N );
+    }
+
+    /* with upright keypoints and without descriptors there is nothing left to do */
+    if( N > 0 && (!params.upright || descriptors) )
+    {
+        CvSurfDescriptorParams dp;
+        CvSeqReader reader;
+
+        CvSepFilter::init_gaussian_kernel( &_G, 2.5 );
+
+        {
+        const double sigma = 3.3;
+        double c2 = 1./(sigma*sigma*2), gs = 0;
+        for( i = 0; i < PATCH_SZ; i++ )
+        {
+            for( j = 0; j < PATCH_SZ; j++ )
+            {
+                double x = j - PATCH_SZ*0.5, y = i - PATCH_SZ*0.5;
+                double val = exp(-(x*x+y*y)*c2);
+                DW[i][j] = (float)val;
+                gs += val;
+            }
+        }
+        cvScale( &_DW, &_DW, 1./gs );
+        }
+
+        for( i = -4; i <= 4; i++ )
+            for( j = -4; j <= 4; j++ )
+            {
+                if( i*i + j*j <= 16 )
+                    apt[nangle0++] = cvPoint(j,i);
+            }
+
+        /* the sequences must not be accessed from the worker threads,
+           so the element addresses are collected in advance */
+        CV_CALL( kp_ptrs = (CvSURFPoint**)cvAlloc( N*sizeof(kp_ptrs[0]) ));
+        cvStartReadSeq( keypoints, &reader );
+        for( k = 0; k < N; k++ )
+        {
+            kp_ptrs[k] = (CvSURFPoint*)reader.ptr;
+            CV_NEXT_SEQ_ELEM( keypoints->elem_size, reader );
+        }
+        if( descriptors )
+        {
+            CV_CALL( desc_ptrs = (float**)cvAlloc( N*sizeof(desc_ptrs[0]) ));
+            cvStartReadSeq( descriptors, &reader );
+            for( k = 0; k < N; k++ )
+            {
+                desc_ptrs[k] = (float*)reader.ptr;
+                CV_NEXT_SEQ_ELEM( descriptors->elem_size, reader );
+            }
+        }
+
+        dp.img = img;
+        dp.sum = sum;
+        dp.keypoints = kp_ptrs;
+        dp.descriptors = desc_ptrs;
+        dp.descriptor_size = descriptor_size;
+        dp.extended = params.extended;
+        dp.upright = params.upright;
+        dp.G = G;
+        dp.DW = &DW[0][0];
+        dp.apt = apt;
+        dp.nangle0 = nangle0;
+        cvParallelFor( N, icvCalcSURFDescriptorsBody, &dp, 8 );
     }
 
     if( _keypoints )
@@ -556,7 +706,25 @@ cvExtractSURF( const CvArr* _img, const CvArr* _mask,
 
     __END__;
 
-    cvReleaseMat( &sum );
+    cvFree( &kp_ptrs );
+    cvFree( &desc_ptrs );
+    cvReleaseMat( &sum0 );
     cvReleaseMat( &mask1 );
     cvReleaseMat( &mask_sum );
 }
+
+
+CV_IMPL void
+cvExtractSURF( const CvArr* _img, const CvArr* _mask,
+               CvSeq** _keypoints, CvSeq** _descriptors,
+               CvMemStorage* storage, CvSURFParams params )
+{
+    CV_FUNCNAME( "cvExtractSURF" );
+
+    __BEGIN__;
+
+    CV_CALL( cvExtractSURFFromIntegral( _img, 0, _mask, _keypoints,
+                                        _descriptors, storage, params ));
+
+    __END__;
+}
@@ -304,6 +304,591 @@ icvCrossCorr( const CvArr* _img, const CvArr* _templ, CvArr* _corr, CvPoint anch
 }
 
 
+/****************************** Template Matching Plan ***********************************/
+
+/* Computes the template statistics used to normalize the correlation.
+   templ_norm is set to 0 for a constant template in CV_TM_CCOEFF_NORMED mode */
+static void
+icvMatchTemplateStats( const CvMat* templ, int method, CvScalar* templ_mean,
+                       double* templ_norm, double* templ_sum2 )
+{
+    CV_FUNCNAME( "icvMatchTemplateStats" );
+
+    __BEGIN__;
+
+    double inv_area = 1./((double)templ->rows * templ->cols);
+    CvScalar mean = cvScalarAll(0), sdv = cvScalarAll(0);
+    double norm = 0, sum2 = 0;
+
+    if( method == CV_TM_CCOEFF )
+    {
+        CV_CALL( mean = cvAvg( templ ));
+    }
+    else if( method != CV_TM_CCORR )
+    {
+        CV_CALL( cvAvgSdv( templ, &mean, &sdv ));
+
+        norm = CV_SQR(sdv.val[0]) + CV_SQR(sdv.val[1]) +
+               CV_SQR(sdv.val[2]) + CV_SQR(sdv.val[3]);
+
+        if( norm < DBL_EPSILON && method == CV_TM_CCOEFF_NORMED )
+            norm = 0;
+        else
+        {
+            sum2 = norm + CV_SQR(mean.val[0]) + CV_SQR(mean.val[1]) +
+                          CV_SQR(mean.val[2]) + CV_SQR(mean.val[3]);
+
+            if( method != CV_TM_CCOEFF_NORMED )
+            {
+                mean = cvScalarAll(0);
+                norm = sum2;
+            }
+
+            sum2 /= inv_area;
+            norm = sqrt(norm);
+            norm /= sqrt(inv_area); // care of accuracy here
+        }
+    }
+
+    *templ_mean = mean;
+    *templ_norm = norm;
+    *templ_sum2 = sum2;
+
+    __END__;
+}
+
+
+/* Turns the cross-correlation into the measure of the given method
+   using the integral images of the source image */
+static void
+icvNormalizeMatchResult( CvMat* result, const CvMat* sum, const CvMat* sqsum,
+                         CvSize templ_size, int cn, int method, CvScalar templ_mean,
+                         double templ_norm, double templ_sum2 )
+{
+    int i, j, k;
+    int idx = 0, idx2 = 0;
+    double *p0, *p1, *p2, *p3;
+    double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
+    double inv_area = 1./((double)templ_size.width * templ_size.height);
+    int sum_step, sqsum_step;
+    int num_type = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
+                   method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
+    int is_normed = method == CV_TM_CCORR_NORMED ||
+                    method == CV_TM_SQDIFF_NORMED ||
+                    method == CV_TM_CCOEFF_NORMED;
+
+    if( method == CV_TM_CCORR )
+        return;
+
+    if( method == CV_TM_CCOEFF_NORMED && templ_norm == 0 )
+    {
+        cvSet( result, cvScalarAll(1.) );
+        return;
+    }
+
+    p0 = (double*)sum->data.ptr;
+    p1 = p0 + templ_size.width*cn;
+    p2 = (double*)(sum->data.ptr + templ_size.height*sum->step);
+    p3 = p2 + templ_size.width*cn;
+
+    if( sqsum )
+    {
+        q0 = (double*)sqsum->data.ptr;
+        q1 = q0 + templ_size.width*cn;
+        q2 = (double*)(sqsum->data.ptr + templ_size.height*sqsum->step);
+        q3 = q2 + templ_size.width*cn;
+    }
+
+    sum_step = sum->step / sizeof(double);
+    sqsum_step = sqsum ? sqsum->step / sizeof(double) : 0;
+
+    for( i = 0; i < result->rows; i++ )
+    {
+        float* rrow = (float*)(result->data.ptr + i*result->step);
+        idx = i * sum_step;
+        idx2 = i * sqsum_step;
+
+        for( j = 0; j < result->cols; j++, idx += cn, idx2 += cn )
+        {
+            double num = rrow[j], t;
+            double wnd_mean2 = 0, wnd_sum2 = 0;
+            
+            if( num_type == 1 )
+            {
+                for( k = 0; k < cn; k++ )
+                {
+                    t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
+                    wnd_mean2 += CV_SQR(t);
+                    num -= t*templ_mean.val[k];
+                }
+
+                wnd_mean2 *= inv_area;
+            }
+
+            if( is_normed || num_type == 2 )
+            {
+                for( k = 0; k < cn; k++ )
+                {
+                    t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
+                    wnd_sum2 += t;
+                }
+
+                if( num_type == 2 )
+                    num = wnd_sum2 - 2*num + templ_sum2;
+            }
+
+            if( is_normed )
+            {
+                t = sqrt(MAX(wnd_sum2 - wnd_mean2,0))*templ_norm;
+                if( t > DBL_EPSILON )
+                {
+                    num /= t;
+                    if( fabs(num) > 1. )
+                        num = num > 0 ? 1 : -1;
+                }
+                else
+                    num = method != CV_TM_SQDIFF_NORMED || num < DBL_EPSILON ? 0 : 1;
+            }
+
+            rrow[j] = (float)num;
+        }
+    }
+}
+
+
+/* (Re)allocates the per-thread tile buffers of the plan */
+static void
+icvAllocMatchTemplateBuffers( CvMatchTemplatePlan* plan, int nthreads )
+{
+    CV_FUNCNAME( "icvAllocMatchTemplateBuffers" );
+
+    __BEGIN__;
+
+    int k, cn = CV_MAT_CN(plan->type), depth = CV_MAT_DEPTH(plan->type);
+    int dft_depth = depth == CV_8U ? CV_32F : CV_64F;
+    CvSize dftsize = plan->dftsize;
+
+    for( k = 0; k < plan->nthreads; k++ )
+    {
+        cvReleaseMat( &plan->img_dft[k] );
+        cvReleaseMat( &plan->prod[k] );
+        cvReleaseMat( &plan->split[k] );
+    }
+    cvFree( &plan->img_dft );
+    plan->nthreads = 0;
+
+    // the three arrays of pointers share one block
+    CV_CALL( plan->img_dft = (CvMat**)cvAlloc( nthreads*3*sizeof(plan->img_dft[0]) ));
+    memset( plan->img_dft, 0, nthreads*3*sizeof(plan->img_dft[0]) );
+    plan->prod = plan->img_dft + nthreads;
+    plan->split = plan->prod + nthreads;
+    plan->nthreads = nthreads;
+
+    for( k = 0; k < nthreads; k++ )
+    {
+        CV_CALL( plan->img_dft[k] = cvCreateMat( dftsize.height*cn, dftsize.width, dft_depth ));
+        CV_CALL( plan->prod[k] = cvCreateMat( dftsize.height*(cn > 1 ? 2 : 1),
+                                              dftsize.width, dft_depth ));
+        if( cn > 1 )
+            CV_CALL( plan->split[k] = cvCreateMat( dftsize.height*cn, dftsize.width, depth ));
+    }
+
+    __END__;
+}
+
+
+CV_IMPL CvMatchTemplatePlan*
+cvCreateMatchTemplatePlan( CvSize img_size, const CvArr** templs, int count, int method )
+{
+    const double block_scale = 4.5;
+    const int min_block_size = 256;
+    CvMatchTemplatePlan* plan = 0;
+    CvMat* split = 0;
+
+    CV_FUNCNAME( "cvCreateMatchTemplatePlan" );
+
+    __BEGIN__;
+
+    CvSize min_size, max_size, dftsize, blocksize;
+    int i, k, type = 0, cn, depth, dft_depth;
+
+    if( !templs )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( count <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "The number of templates must be positive" );
+
+    if( img_size.width <= 0 || img_size.height <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "The image size must be positive" );
+
+    if( method < CV_TM_SQDIFF || method > CV_TM_CCOEFF_NORMED )
+        CV_ERROR( CV_StsBadArg, "unknown comparison method" );
+
+    CV_CALL( plan = (CvMatchTemplatePlan*)cvAlloc( sizeof(*plan) ));
+    memset( plan, 0, sizeof(*plan) );
+
+    // all the per-template arrays share one block
+    CV_CALL( plan->templ_size = (CvSize*)cvAlloc( count*(sizeof(plan->templ_size[0]) +
+        sizeof(plan->templ_dft[0]) + sizeof(plan->templ_mean[0]) + 2*sizeof(double)) ));
+    plan->templ_mean = (CvScalar*)(plan->templ_size + count);
+    plan->templ_norm = (double*)(plan->templ_mean + count);
+    plan->templ_sum2 = plan->templ_norm + count;
+    plan->templ_dft = (CvMat**)(plan->templ_sum2 + count);
+    memset( plan->templ_dft, 0, count*sizeof(plan->templ_dft[0]) );
+
+    plan->img_size = img_size;
+    plan->method = method;
+    plan->count = count;
+
+    min_size = max_size = cvSize(0,0);
+
+    for( i = 0; i < count; i++ )
+    {
+        CvMat tstub, *templ = (CvMat*)templs[i];
+        CV_CALL( templ = cvGetMat( templ, &tstub ));
+
+        if( i == 0 )
+            type = CV_MAT_TYPE(templ->type);
+
+        if( CV_MAT_DEPTH( templ->type ) != CV_8U &&
+            CV_MAT_DEPTH( templ->type ) != CV_32F )
+            CV_ERROR( CV_StsUnsupportedFormat,
+            "The function supports only 8u and 32f data types" );
+
+        if( CV_MAT_TYPE( templ->type ) != type )
+            CV_ERROR( CV_StsUnmatchedFormats, "All the templates should have the same type" );
+
+        if( templ->cols > img_size.width || templ->rows > img_size.height )
+            CV_ERROR( CV_StsUnmatchedSizes, "The templates should not be larger than the image" );
+
+        plan->templ_size[i] = cvGetMatSize( templ );
+        CV_CALL( icvMatchTemplateStats( templ, method, plan->templ_mean + i,
+                                        plan->templ_norm + i, plan->templ_sum2 + i ));
+
+        if( i == 0 )
+            min_size = max_size = plan->templ_size[i];
+        min_size.width = MIN( min_size.width, templ->cols );
+        min_size.height = MIN( min_size.height, templ->rows );
+        max_size.width = MAX( max_size.width, templ->cols );
+        max_size.height = MAX( max_size.height, templ->rows );
+    }
+
+    plan->type = type;
+    cn = CV_MAT_CN(type);
+    depth = CV_MAT_DEPTH(type);
+    dft_depth = depth == CV_8U ? CV_32F : CV_64F;
+
+    // The image tiles are sized for the largest template and the result tiles cover
+    // the largest result (i.e. the one of the smallest template). The correlation with
+    // a smaller template does not wrap around within its part of the result tile.
+    min_size.width = img_size.width - min_size.width + 1;
+    min_size.height = img_size.height - min_size.height + 1;
+
+    blocksize.width = cvRound(max_size.width*block_scale);
+    blocksize.width = MAX( blocksize.width, min_block_size - max_size.width + 1 );
+    blocksize.width = MIN( blocksize.width, min_size.width );
+    blocksize.height = cvRound(max_size.height*block_scale);
+    blocksize.height = MAX( blocksize.height, min_block_size - max_size.height + 1 );
+    blocksize.height = MIN( blocksize.height, min_size.height );
+
+    dftsize.width = cvGetOptimalDFTSize(blocksize.width + max_size.width - 1);
+    if( dftsize.width == 1 )
+        dftsize.width = 2;
+    dftsize.height = cvGetOptimalDFTSize(blocksize.height + max_size.height - 1);
+    if( dftsize.width <= 0 || dftsize.height <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "the input arrays are too big" );
+
+    // recompute block size
+    blocksize.width = dftsize.width - max_size.width + 1;
+    blocksize.width = MIN( blocksize.width, min_size.width );
+    blocksize.height = dftsize.height - max_size.height + 1;
+    blocksize.height = MIN( blocksize.height, min_size.height );
+
+    plan->dftsize = dftsize;
+    plan->blocksize = blocksize;
+
+    if( cn > 1 )
+        CV_CALL( split = cvCreateMat( max_size.height*cn, max_size.width, depth ));
+
+    // compute DFT of each template plane
+    for( i = 0; i < count; i++ )
+    {
+        CvMat tstub, *templ = (CvMat*)templs[i];
+        CvMat* dft_templ;
+        CvMat planes[4], *pplanes[] = { 0, 0, 0, 0 };
+        CV_CALL( templ = cvGetMat( templ, &tstub ));
+
+        CV_CALL( dft_templ = plan->templ_dft[i] =
+            cvCreateMat( dftsize.height*cn, dftsize.width, dft_depth ));
+        cvZero( dft_templ );
+
+        if( cn > 1 )
+        {
+            for( k = 0; k < cn; k++ )
+                pplanes[k] = cvGetSubRect( split, planes + k,
+                    cvRect( 0, k*max_size.height, templ->cols, templ->rows ));
+            cvSplit( templ, pplanes[0], pplanes[1], pplanes[2], pplanes[3] );
+        }
+        else
+            pplanes[0] = templ;
+
+        for( k = 0; k < cn; k++ )
+        {
+            CvMat dstub, *dst;
+            dst = cvGetSubRect( dft_templ, &dstub,
+                cvRect( 0, k*dftsize.height, templ->cols, templ->rows ));
+            cvConvert( pplanes[k], dst );
+            cvGetSubRect( dft_templ, dst,
+                cvRect( 0, k*dftsize.height, dftsize.width, dftsize.height ));
+            cvDFT( dst, dst, CV_DXT_FORWARD + CV_DXT_SCALE, templ->rows );
+        }
+    }
+
+    CV_CALL( icvAllocMatchTemplateBuffers( plan, cvGetNumThreads() ));
+
+    if( method != CV_TM_CCORR )
+        CV_CALL( plan->sum = cvCreateMat( img_size.height + 1, img_size.width + 1,
+                                          CV_MAKETYPE( CV_64F, cn )));
+    if( method != CV_TM_CCORR && method != CV_TM_CCOEFF )
+        CV_CALL( plan->sqsum = cvCreateMat( img_size.height + 1, img_size.width + 1,
+                                            CV_MAKETYPE( CV_64F, cn )));
+
+    __END__;
+
+    cvReleaseMat( &split );
+
+    if( cvGetErrStatus() < 0 )
+        cvReleaseMatchTemplatePlan( &plan );
+    return plan;
+}
+
+
+CV_IMPL void
+cvReleaseMatchTemplatePlan( CvMatchTemplatePlan** plan )
+{
+    CV_FUNCNAME( "cvReleaseMatchTemplatePlan" );
+
+    __BEGIN__;
+
+    int k;
+
+    if( !plan )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( !*plan )
+        EXIT;
+
+    if( (*plan)->templ_dft )
+        for( k = 0; k < (*plan)->count; k++ )
+            cvReleaseMat( &(*plan)->templ_dft[k] );
+    cvFree( &(*plan)->templ_size );
+
+    for( k = 0; k < (*plan)->nthreads; k++ )
+    {
+        cvReleaseMat( &(*plan)->img_dft[k] );
+        cvReleaseMat( &(*plan)->prod[k] );
+        cvReleaseMat( &(*plan)->split[k] );
+    }
+    cvFree( &(*plan)->img_dft );
+
+    cvReleaseMat( &(*plan)->sum );
+    cvReleaseMat( &(*plan)->sqsum );
+    cvFree( plan );
+
+    __END__;
+}
+
+
+typedef struct CvMatchTemplateParams
+{
+    const CvMatchTemplatePlan* plan;
+    const CvMat* img;
+    CvMat** results;
+    int tile_count_x;
+}
+CvMatchTemplateParams;
+
+
+/* Computes the cross-correlation of every template with the image in the given tiles.
+   The forward DFT of the image tile is computed once, the channel products
+   are summed in the frequency domain, so there is one inverse DFT per template */
+static void CV_CDECL
+icvMatchTemplateTilesBody( int start, int end, void* userdata )
+{
+    const CvMatchTemplateParams* p = (const CvMatchTemplateParams*)userdata;
+    const CvMatchTemplatePlan* plan = p->plan;
+    const CvMat* img = p->img;
+    int thread_idx = cvGetThreadNum();
+    CvMat* img_dft = plan->img_dft[thread_idx];
+    CvMat* prod = plan->prod[thread_idx];
+    CvMat* split = plan->split[thread_idx];
+    CvSize dftsize = plan->dftsize, blocksize = plan->blocksize;
+    int cn = CV_MAT_CN(plan->type);
+    int k, i, t;
+
+    for( k = start; k < end; k++ )
+    {
+        int x = (k % p->tile_count_x)*blocksize.width;
+        int y = (k / p->tile_count_x)*blocksize.height;
+        int iw = MIN( dftsize.width, img->cols - x );
+        int ih = MIN( dftsize.height, img->rows - y );
+        CvMat sstub, dstub, tstub, pstub, *src, *dst;
+        CvMat planes[4], *pplanes[] = { 0, 0, 0, 0 };
+
+        src = cvGetSubRect( img, &sstub, cvRect( x, y, iw, ih ));
+
+        if( cn > 1 )
+        {
+            for( i = 0; i < cn; i++ )
+                pplanes[i] = cvGetSubRect( split, planes + i,
+                    cvRect( 0, i*dftsize.height, iw, ih ));
+            cvSplit( src, pplanes[0], pplanes[1], pplanes[2], pplanes[3] );
+        }
+        else
+            pplanes[0] = src;
+
+        for( i = 0; i < cn; i++ )
+        {
+            dst = cvGetSubRect( img_dft, &dstub, cvRect( 0, i*dftsize.height, iw, ih ));
+            cvConvert( pplanes[i], dst );
+
+            if( dftsize.width > iw )
+            {
+                cvGetSubRect( img_dft, dst, cvRect( iw, i*dftsize.height,
+                              dftsize.width - iw, dftsize.height ));
+                cvZero( dst );
+            }
+
+            cvGetSubRect( img_dft, dst, cvRect( 0, i*dftsize.height,
+                                                dftsize.width, dftsize.height ));
+            cvDFT( dst, dst, CV_DXT_FORWARD, ih );
+        }
+
+        for( t = 0; t < plan->count; t++ )
+        {
+            CvSize tsz = plan->templ_size[t];
+            int cw = MIN( blocksize.width, img->cols - tsz.width + 1 - x );
+            int ch = MIN( blocksize.height, img->rows - tsz.height + 1 - y );
+            CvMat* sum_dft;
+
+            if( cw <= 0 || ch <= 0 )
+                continue;
+
+            sum_dft = cvGetSubRect( prod, &pstub,
+                                    cvRect( 0, 0, dftsize.width, dftsize.height ));
+
+            for( i = 0; i < cn; i++ )
+            {
+                CvMat istub, *idft, *tdft;
+                idft = cvGetSubRect( img_dft, &istub, cvRect( 0, i*dftsize.height,
+                                     dftsize.width, dftsize.height ));
+                tdft = cvGetSubRect( plan->templ_dft[t], &tstub, cvRect( 0,
+                                     i*dftsize.height, dftsize.width, dftsize.height ));
+                if( i == 0 )
+                    cvMulSpectrums( idft, tdft, sum_dft, CV_DXT_MUL_CONJ );
+                else
+                {
+                    dst = cvGetSubRect( prod, &dstub, cvRect( 0, dftsize.height,
+                                        dftsize.width, dftsize.height ));
+                    cvMulSpectrums( idft, tdft, dst, CV_DXT_MUL_CONJ );
+                    cvAdd( sum_dft, dst, sum_dft );
+                }
+            }
+
+            cvDFT( sum_dft, sum_dft, CV_DXT_INVERSE, ch );
+
+            src = cvGetSubRect( prod, &sstub, cvRect( 0, 0, cw, ch ));
+            dst = cvGetSubRect( p->results[t], &dstub, cvRect( x, y, cw, ch ));
+            cvConvert( src, dst );
+        }
+    }
+}
+
+
+CV_IMPL void
+cvMatchTemplateWithPlan( const CvArr* _img, CvArr** _results, CvMatchTemplatePlan* plan )
+{
+    CvMat* results_buf[16];
+    CvMat rstub_buf[16];
+    CvMat** results = results_buf;
+    CvMat* rstub = 0;
+
+    CV_FUNCNAME( "cvMatchTemplateWithPlan" );
+
+    __BEGIN__;
+
+    CvMat stub, *img = (CvMat*)_img;
+    CvMatchTemplateParams p;
+    CvSize max_result = { 0, 0 };
+    int i, cn, tile_count_y;
+
+    if( !plan || !_results )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    CV_CALL( img = cvGetMat( img, &stub ));
+
+    if( CV_MAT_TYPE( img->type ) != plan->type )
+        CV_ERROR( CV_StsUnmatchedFormats, "image and template should have the same type" );
+
+    if( img->cols != plan->img_size.width || img->rows != plan->img_size.height )
+        CV_ERROR( CV_StsUnmatchedSizes, "The image size differs from the one the plan was created for" );
+
+    if( plan->count > (int)(sizeof(results_buf)/sizeof(results_buf[0])) )
+    {
+        CV_CALL( results = (CvMat**)cvAlloc( plan->count*sizeof(results[0]) ));
+        CV_CALL( rstub = (CvMat*)cvAlloc( plan->count*sizeof(rstub[0]) ));
+    }
+    else
+        rstub = rstub_buf;
+
+    for( i = 0; i < plan->count; i++ )
+    {
+        CV_CALL( results[i] = cvGetMat( _results[i], rstub + i ));
+
+        if( CV_MAT_TYPE( results[i]->type ) != CV_32FC1 )
+            CV_ERROR( CV_StsUnsupportedFormat, "output image should have 32f type" );
+
+        if( results[i]->rows != img->rows - plan->templ_size[i].height + 1 ||
+            results[i]->cols != img->cols - plan->templ_size[i].width + 1 )
+            CV_ERROR( CV_StsUnmatchedSizes, "output image should be (W - w + 1)x(H - h + 1)" );
+
+        max_result.width = MAX( max_result.width, results[i]->cols );
+        max_result.height = MAX( max_result.height, results[i]->rows );
+    }
+
+    if( cvGetNumThreads() > plan->nthreads )
+        CV_CALL( icvAllocMatchTemplateBuffers( plan, cvGetNumThreads() ));
+
+    p.plan = plan;
+    p.img = img;
+    p.results = results;
+    p.tile_count_x = (max_result.width + plan->blocksize.width - 1)/plan->blocksize.width;
+    tile_count_y = (max_result.height + plan->blocksize.height - 1)/plan->blocksize.height;
+
+    cvParallelFor( p.tile_count_x*tile_count_y, icvMatchTemplateTilesBody, &p );
+
+    if( plan->method == CV_TM_CCORR )
+        EXIT;
+
+    // the integral images are shared by all the templates
+    cn = CV_MAT_CN(plan->type);
+    CV_CALL( cvIntegral( img, plan->sum, plan->sqsum, 0 ));
+
+    for( i = 0; i < plan->count; i++ )
+        icvNormalizeMatchResult( results[i], plan->sum, plan->sqsum, plan->templ_size[i],
+                                 cn, plan->method, plan->templ_mean[i],
+                                 plan->templ_norm[i], plan->templ_sum2[i] );
+
+    __END__;
+
+    if( results != results_buf )
+    {
+        cvFree( &results );
+        cvFree( &rstub );
+    }
+}
+
+
 /***************************** IPP Match Template Functions ******************************/
 
 icvCrossCorrValid_Norm_8u32f_C1R_t  icvCrossCorrValid_Norm_8u32f_C1R_p = 0;
@@ -323,8 +908,7 @@ typedef CvStatus (CV_STDCALL * CvTemplMatchIPPFunc)
 CV_IMPL void
 cvMatchTemplate( const CvArr* _img, const CvArr* _templ, CvArr* _result, int method )
 {
-    CvMat* sum = 0;
-    CvMat* sqsum = 0;
+    CvMatchTemplatePlan* plan = 0;
     
     CV_FUNCNAME( "cvMatchTemplate" );
 
@@ -332,20 +916,10 @@ cvMatchTemplate( const CvArr* _img, const CvArr* _templ, CvArr* _result, int met
 
     int coi1 = 0, coi2 = 0;
     int depth, cn;
-    int i, j, k;
+    int i, j;
     CvMat stub, *img = (CvMat*)_img;
     CvMat tstub, *templ = (CvMat*)_templ;
     CvMat rstub, *result = (CvMat*)_result;
-    CvScalar templ_mean = cvScalarAll(0);
-    double templ_norm = 0, templ_sum2 = 0;
-    
-    int idx = 0, idx2 = 0;
-    double *p0, *p1, *p2, *p3;
-    double *q0, *q1, *q2, *q3;
-    double inv_area;
-    int sum_step, sqsum_step;
-    int num_type = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
-                   method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
     int is_normed = method == CV_TM_CCORR_NORMED ||
                     method == CV_TM_SQDIFF_NORMED ||
                     method == CV_TM_CCOEFF_NORMED;
@@ -415,122 +989,15 @@ cvMatchTemplate( const CvArr* _img, const CvArr* _templ, CvArr* _result, int met
         }
     }
 
-    CV_CALL( icvCrossCorr( img, templ, result ));
-
-    if( method == CV_TM_CCORR )
-        EXIT;
-
-    inv_area = 1./((double)templ->rows * templ->cols);
-
-    CV_CALL( sum = cvCreateMat( img->rows + 1, img->cols + 1,
-                                CV_MAKETYPE( CV_64F, cn )));
-    if( method == CV_TM_CCOEFF )
     {
-        CV_CALL( cvIntegral( img, sum, 0, 0 ));
-        CV_CALL( templ_mean = cvAvg( templ ));
-        q0 = q1 = q2 = q3 = 0;
-    }
-    else
-    {
-        CvScalar _templ_sdv = cvScalarAll(0);
-        CV_CALL( sqsum = cvCreateMat( img->rows + 1, img->cols + 1,
-                                      CV_MAKETYPE( CV_64F, cn )));
-        CV_CALL( cvIntegral( img, sum, sqsum, 0 ));
-        CV_CALL( cvAvgSdv( templ, &templ_mean, &_templ_sdv ));
-
-        templ_norm = CV_SQR(_templ_sdv.val[0]) + CV_SQR(_templ_sdv.val[1]) +
-                    CV_SQR(_templ_sdv.val[2]) + CV_SQR(_templ_sdv.val[3]);
-
-        if( templ_norm < DBL_EPSILON && method == CV_TM_CCOEFF_NORMED )
-        {
-            cvSet( result, cvScalarAll(1.) );
-            EXIT;
-        }
-        
-        templ_sum2 = templ_norm +
-                     CV_SQR(templ_mean.val[0]) + CV_SQR(templ_mean.val[1]) +
-                     CV_SQR(templ_mean.val[2]) + CV_SQR(templ_mean.val[3]);
-
-        if( num_type != 1 )
-        {
-            templ_mean = cvScalarAll(0);
-            templ_norm = templ_sum2;
-        }
-        
-        templ_sum2 /= inv_area;
-        templ_norm = sqrt(templ_norm);
-        templ_norm /= sqrt(inv_area); // care of accuracy here
-
-        q0 = (double*)sqsum->data.ptr;
-        q1 = q0 + templ->cols*cn;
-        q2 = (double*)(sqsum->data.ptr + templ->rows*sqsum->step);
-        q3 = q2 + templ->cols*cn;
+        const CvArr* templs[] = { templ };
+        CV_CALL( plan = cvCreateMatchTemplatePlan( cvGetMatSize(img), templs, 1, method ));
+        CV_CALL( cvMatchTemplateWithPlan( img, (CvArr**)&result, plan ));
     }
 
-    p0 = (double*)sum->data.ptr;
-    p1 = p0 + templ->cols*cn;
-    p2 = (double*)(sum->data.ptr + templ->rows*sum->step);
-    p3 = p2 + templ->cols*cn;
-
-    sum_step = sum ? sum->step / sizeof(double) : 0;
-    sqsum_step = sqsum ? sqsum->step / sizeof(double) : 0;
-
-    for( i = 0; i < result->rows; i++ )
-    {
-        float* rrow = (float*)(result->data.ptr + i*result->step);
-        idx = i * sum_step;
-        idx2 = i * sqsum_step;
-
-        for( j = 0; j < result->cols; j++, idx += cn, idx2 += cn )
-        {
-            double num = rrow[j], t;
-            double wnd_mean2 = 0, wnd_sum2 = 0;
-            
-            if( num_type == 1 )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
-                    wnd_mean2 += CV_SQR(t);
-                    num -= t*templ_mean.val[k];
-                }
-
-                wnd_mean2 *= inv_area;
-            }
-
-            if( is_normed || num_type == 2 )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
-                    wnd_sum2 += t;
-                }
-
-                if( num_type == 2 )
-                    num = wnd_sum2 - 2*num + templ_sum2;
-            }
-
-            if( is_normed )
-            {
-                t = sqrt(MAX(wnd_sum2 - wnd_mean2,0))*templ_norm;
-                if( t > DBL_EPSILON )
-                {
-                    num /= t;
-                    if( fabs(num) > 1. )
-                        num = num > 0 ? 1 : -1;
-                }
-                else
-                    num = method != CV_TM_SQDIFF_NORMED || num < DBL_EPSILON ? 0 : 1;
-            }
-
-            rrow[j] = (float)num;
-        }
-    }
-        
     __END__;
 
-    cvReleaseMat( &sum );
-    cvReleaseMat( &sqsum );
+    cvReleaseMatchTemplatePlan( &plan );
 }
 
 /* End of file. */
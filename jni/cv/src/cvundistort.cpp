@@ -122,11 +122,11 @@ cvUndistort2( const CvArr* _src, CvArr* _dst, const CvMat* A, const CvMat* dist_
     int cn, src_step, dst_step;
     CvSize size;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitLinearCoeffTab();
         icvInitCubicCoeffTab();
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     CV_CALL( src = cvGetMat( src, &srcstub, &coi1 ));
@@ -71,14 +71,14 @@ static uchar satTab8u[768];
 static void icvInitSatTab()
 {
     static int initialized = 0;
-    if( !initialized )
+    if( cvBeginInitOnce( &initialized ))
     {
         for( int i = 0; i < 768; i++ )
         {
             int v = i - 255;
             satTab8u[i] = (uchar)(v < 0 ? 0 : v > 255 ? 255 : v);
         }
-        initialized = 1;
+        cvEndInitOnce( &initialized );
     }
 }
 
@@ -364,6 +364,11 @@ Java_org_siprop_opencv_OpenCV_releaseFaceDetection(JNIEnv* env,
 		m_smallImage = 0;
 	}
 	
+	if (m_resizePlan) {
+		cvReleaseResizePlan(&m_resizePlan);
+		m_resizePlan = 0;
+	}
+	
 	if (m_storage) {
 		cvReleaseMemStorage(&m_storage);
 		m_storage = 0;
@@ -395,7 +400,20 @@ void initFaceDetectionImages(IplImage *sourceImage, double scale = 1.0) {
 	}
 	
     cvCvtColor(sourceImage, m_grayImage, CV_BGR2GRAY);
-    cvResize(m_grayImage, m_smallImage, CV_INTER_LINEAR);
+	
+	// The resize tables only depend on the sizes, so they are rebuilt only
+	// when the crop area changes.
+	CvSize graySize = cvGetSize(m_grayImage);
+	CvSize smallSize = cvGetSize(m_smallImage);
+	if (m_resizePlan == 0 ||
+		m_resizePlan->src_size.width != graySize.width ||
+		m_resizePlan->src_size.height != graySize.height ||
+		m_resizePlan->dst_size.width != smallSize.width ||
+		m_resizePlan->dst_size.height != smallSize.height) {
+		cvReleaseResizePlan(&m_resizePlan);
+		m_resizePlan = cvCreateResizePlan(graySize, smallSize, CV_8UC1, CV_INTER_LINEAR);
+	}
+    cvResizeWithPlan(m_grayImage, m_smallImage, m_resizePlan);
     cvEqualizeHist(m_smallImage, m_smallImage);
 	cvClearMemStorage(m_storage);
 	
@@ -51,6 +51,7 @@ CvHaarClassifierCascade *m_cascade = 0;
 IplImage *m_sourceImage = 0;
 IplImage *m_grayImage = 0;
 IplImage *m_smallImage = 0;
+CvResizePlan *m_resizePlan = 0;
 CvMemStorage *m_storage = 0;
 CvSeq *m_facesFound = 0;
 CvRect m_faceCropArea;
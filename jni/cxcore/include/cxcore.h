@@ -251,7 +251,10 @@ CV_INLINE  void  cvReleaseMatND( CvMatND** mat )
 /* Creates a copy of CvMatND (except, may be, steps) */
 CVAPI(CvMatND*) cvCloneMatND( const CvMatND* mat );
 
-/* Allocates and initializes CvSparseMat header and allocates data */
+/* Allocates and initializes CvSparseMat header and allocates data.
+   With CV_SPARSE_OPEN_ADDR added to <type> (and dims <= CV_MAX_DIM) the nodes
+   are stored in a flat open-addressing table; in this case node pointers
+   become invalid once elements are added or removed */
 CVAPI(CvSparseMat*)  cvCreateSparseMat( int dims, const int* sizes, int type );
 
 /* Releases CvSparseMat */
@@ -268,7 +271,23 @@ CVAPI(CvSparseNode*) cvInitSparseMatIterator( const CvSparseMat* mat,
 // returns next sparse array node (or NULL if there is no more nodes)
 CV_INLINE CvSparseNode* cvGetNextSparseNode( CvSparseMatIterator* mat_iterator )
 {
-    if( mat_iterator->node->next )
+    if( CV_IS_SPARSE_MAT_OPEN_ADDR( mat_iterator->mat ))
+    {
+        const CvSparseMat* mat = mat_iterator->mat;
+        int idx;
+        for( idx = mat_iterator->curidx + 1; idx < mat->hashsize; idx++ )
+        {
+            if( mat->slots->probe[idx] )
+            {
+                mat_iterator->curidx = idx;
+                return mat_iterator->node = (CvSparseNode*)(mat->slots->data +
+                                                            idx*mat->slots->slotsize);
+            }
+        }
+        mat_iterator->curidx = idx;
+        return NULL;
+    }
+    else if( mat_iterator->node->next )
         return mat_iterator->node = mat_iterator->node->next;
     else
     {
@@ -377,6 +396,11 @@ CVAPI(void) cvSetRealND( CvArr* arr, const int* idx, double value );
    in case of sparse arrays it deletes the specified node */
 CVAPI(void) cvClearND( CvArr* arr, const int* idx );
 
+/* arr(idx[i*dims],...,idx[i*dims+dims-1]) += delta for i = 0..count-1;
+   the missing nodes of single-channel 32s, 32f or 64f sparse array are created */
+CVAPI(void) cvIncSparseND( CvSparseMat* arr, const int* idx, int count,
+                           double delta CV_DEFAULT(1) );
+
 /* Converts CvArr (IplImage or CvMat,...) to CvMat.
    If the last parameter is non-zero, function can
    convert multi(>2)-dimensional array to CvMat as long as
@@ -548,6 +572,11 @@ CVAPI(void)  cvAddWeighted( const CvArr* src1, double alpha,
                             const CvArr* src2, double beta,
                             double gamma, CvArr* dst );
 
+/* dst = src[0]*weights[0] + ... + src[count-1]*weights[count-1] + gamma, computed
+   in a single pass without temporary arrays; dst may coincide with any of src[i] */
+CVAPI(void)  cvAddWeightedN( const CvArr** src, const double* weights, int count,
+                             CvScalar gamma, CvArr* dst );
+
 /* result = sum_i(src1(i) * src2(i)) (results for all channels are accumulated together) */
 CVAPI(double)  cvDotProduct( const CvArr* src1, const CvArr* src2 );
 
@@ -625,6 +654,23 @@ CVAPI(void) cvAbsDiffS( const CvArr* src, CvArr* dst, CvScalar value );
 *                                Math operations                                         *
 \****************************************************************************************/
 
+/* Accuracy tiers of cvExp, cvLog, cvPow (non-integer powers) and cvCartToPolar
+   on single-precision arrays:
+   CV_MATH_PRECISE - the default table-based code that computes in double precision
+                     (exp and log are within 0.6 ulp);
+   CV_MATH_FAST    - SSE2/NEON polynomials computed in single precision. exp and log
+                     are within 1 ulp (for normalized results), pow is within
+                     (2 + 2*|power*log(x)|) ulp, as in the default mode. The magnitude
+                     is within 3 ulp on NEON and exact otherwise; the angle error is
+                     ~0.3 degree in both modes. exp saturates to 0 and +inf, log(0) is
+                     log(FLT_MIN) = -87.34, 0^power is 0 or +inf; NaNs are not handled.
+   The mode is global and is meant to be set once at startup */
+#define CV_MATH_PRECISE  0
+#define CV_MATH_FAST     1
+
+CVAPI(void) cvSetMathMode( int mode );
+CVAPI(int)  cvGetMathMode( void );
+
 /* Does cartesian->polar coordinates conversion.
    Either of output components (magnitude or angle) is optional */
 CVAPI(void)  cvCartToPolar( const CvArr* x, const CvArr* y,
@@ -706,6 +752,9 @@ CVAPI(void)  cvCrossProduct( const CvArr* src1, const CvArr* src2, CvArr* dst );
 #define CV_GEMM_A_T 1
 #define CV_GEMM_B_T 2
 #define CV_GEMM_C_T 4
+/* use the generic blocked implementation instead of the packed-panel kernels
+   (for testing and benchmarking) */
+#define CV_GEMM_REFERENCE 8
 /* Extended matrix transform:
    dst = alpha*op(A)*op(B) + beta*op(C), where op(X) is X or X^T */
 CVAPI(void)  cvGEMM( const CvArr* src1, const CvArr* src2, double alpha,
@@ -758,6 +807,14 @@ CVAPI(void)   cvSVBkSb( const CvArr* W, const CvArr* U,
                         const CvArr* V, const CvArr* B,
                         CvArr* X, int flags );
 
+/* Performs SVD of <count> small m x n matrices packed one after another
+   into the (count*m) x n array A. Each row of the count x min(m,n) array W
+   receives the singular values of one matrix in descending order;
+   U ((count*m) x min(m,n)) and V ((count*n) x n) are stacked in the same way */
+CVAPI(void)   cvSVDBatch( const CvArr* A, CvArr* W, CvArr* U CV_DEFAULT(NULL),
+                          CvArr* V CV_DEFAULT(NULL), int count CV_DEFAULT(1),
+                          int flags CV_DEFAULT(0));
+
 #define CV_LU  0
 #define CV_SVD 1
 #define CV_SVD_SYM 2
@@ -773,6 +830,13 @@ CVAPI(double)  cvInvert( const CvArr* src, CvArr* dst,
 CVAPI(int)  cvSolve( const CvArr* src1, const CvArr* src2, CvArr* dst,
                      int method CV_DEFAULT(CV_LU));
 
+/* Solves <count> small linear systems packed one after another into
+   src1 ((count*m) x n), src2 ((count*m) x k) and dst ((count*n) x k).
+   Returns the number of non-singular systems (solutions of the singular
+   ones are set to zero when CV_LU method is used) */
+CVAPI(int)  cvSolveBatch( const CvArr* src1, const CvArr* src2, CvArr* dst,
+                          int count, int method CV_DEFAULT(CV_LU));
+
 /* Calculates determinant of input matrix */
 CVAPI(double) cvDet( const CvArr* mat );
 
@@ -877,6 +941,34 @@ CVAPI(void)  cvNormalize( const CvArr* src, CvArr* dst,
                           int norm_type CV_DEFAULT(CV_L2),
                           const CvArr* mask CV_DEFAULT(NULL) );
 
+/* statistics computed by cvCalcArrStats */
+#define CV_STAT_SUM         1   /* sum and mean */
+#define CV_STAT_SQSUM       2   /* sum of squares and standard deviation (implies CV_STAT_SUM) */
+#define CV_STAT_MINMAX      4   /* per-channel extrema and their positions */
+#define CV_STAT_NORM_L1     8
+#define CV_STAT_NORM_L2     16
+#define CV_STAT_NORM_INF    32
+#define CV_STAT_NONZERO     64  /* per-channel number of non-zero elements */
+#define CV_STAT_ALL         127
+
+typedef struct CvArrStats
+{
+    int count;                  /* number of the processed (masked) elements */
+    CvScalar sum, mean;
+    CvScalar sqsum, sdv;
+    CvScalar min_val, max_val;
+    CvPoint min_loc[4], max_loc[4];
+    CvScalar nonzero;
+    double norm_l1, norm_l2, norm_inf;  /* over all the channels */
+}
+CvArrStats;
+
+/* Computes the requested statistics of the array (or of its COI) in a single pass.
+   The values match cvSum, cvAvgSdv, cvMinMaxLoc, cvNorm and cvCountNonZero;
+   the fields that are not requested are set to zero */
+CVAPI(void)  cvCalcArrStats( const CvArr* arr, CvArrStats* stats, int flags,
+                             const CvArr* mask CV_DEFAULT(NULL) );
+
 
 #define CV_REDUCE_SUM 0
 #define CV_REDUCE_AVG 1
@@ -916,6 +1008,31 @@ CVAPI(int)  cvGetOptimalDFTSize( int size0 );
 /* Discrete Cosine Transform */
 CVAPI(void)  cvDCT( const CvArr* src, CvArr* dst, int flags );
 
+/* Precomputed tables (factorization, permutation, twiddle factors) of the transforms
+   of the given size, type and flags. size and type are those of the signal, i.e.
+   of the source array of the forward transform and of the destination array of the
+   inverse one. A plan may be used by several threads at once */
+typedef struct CvDFTPlan CvDFTPlan;
+
+CVAPI(CvDFTPlan*) cvCreateDFTPlan( CvSize size, int type, int flags );
+CVAPI(CvDFTPlan*) cvCreateDCTPlan( CvSize size, int type, int flags );
+CVAPI(void)  cvReleaseDFTPlan( CvDFTPlan** plan );
+
+/* The same as cvDFT and cvDCT with the flags of the plan */
+CVAPI(void)  cvDFTWithPlan( const CvArr* src, CvArr* dst, const CvDFTPlan* plan,
+                            int nonzero_rows CV_DEFAULT(0) );
+CVAPI(void)  cvDCTWithPlan( const CvArr* src, CvArr* dst, const CvDFTPlan* plan );
+
+/* Transforms count 1D signals (single-row or single-column arrays of the same size
+   and type) with the same flags, or with the flags of the plan if it is not NULL.
+   Single-precision complex signals of power-of-2 length are processed several at once */
+CVAPI(void)  cvDFTBatch( const CvArr** src, CvArr** dst, int count, int flags,
+                         const CvDFTPlan* plan CV_DEFAULT(NULL) );
+
+/* Sets the maximum number of tables of different transform lengths that cvDFT and cvDCT
+   keep between the calls (16 by default); 0 disables the cache */
+CVAPI(void)  cvSetDFTCacheSize( int max_count );
+
 /****************************************************************************************\
 *                              Dynamic data structures                                   *
 \****************************************************************************************/
@@ -1489,6 +1606,33 @@ CVAPI(void)  cvGetModuleInfo( const char* module_name,
                               const char** version,
                               const char** loaded_addon_plugins );
 
+#define CV_CPU_NONE     0
+#define CV_CPU_MMX      1
+#define CV_CPU_SSE      2
+#define CV_CPU_SSE2     3
+#define CV_CPU_SSE3     4
+#define CV_CPU_SSSE3    5
+#define CV_CPU_SSE4_1   6
+#define CV_CPU_SSE4_2   7
+#define CV_CPU_AVX      10
+#define CV_CPU_AVX2     11
+#define CV_CPU_NEON     100
+
+/* Checks whether the CPU the library runs on supports the instruction set (CV_CPU_*) */
+CVAPI(int)  cvCheckHardwareSupport( int feature );
+
+#define CV_DISPATCH_AUTO    0   /* the best SIMD variant of each kernel the CPU supports */
+#define CV_DISPATCH_SCALAR  1   /* the plain C variants only, e.g. for A/B benchmarking */
+
+/* Rebinds the kernels that have several SIMD variants according to the mode */
+CVAPI(void) cvSetDispatchMode( int mode );
+CVAPI(int)  cvGetDispatchMode( void );
+
+/* Retrieves the names of the dispatched kernels and of their active variants
+   (up to max_count of each); returns the total number of the kernels */
+CVAPI(int)  cvGetDispatchInfo( const char** kernels, const char** variants,
+                               int max_count );
+
 /* Get current OpenCV error status */
 CVAPI(int) cvGetErrStatus( void );
 
@@ -1752,12 +1896,24 @@ CVAPI(double) cvGetTickFrequency( void );
 
 /*********************************** Multi-Threading ************************************/
 
-/* retrieve/set the number of threads used in OpenMP implementations */
+/* retrieve/set the number of threads used in parallel implementations
+   (OpenMP or, if it is not available, the built-in pool of POSIX threads) */
 CVAPI(int)  cvGetNumThreads( void );
 CVAPI(void) cvSetNumThreads( int threads CV_DEFAULT(0) );
 /* get index of the thread being executed */
 CVAPI(int)  cvGetThreadNum( void );
 
+/* body of a parallel loop; processes the iterations [start, end) */
+typedef void (CV_CDECL *CvParallelLoopFunc)( int start, int end, void* userdata );
+
+/* runs the iterations [0, count) of the loop on cvGetNumThreads() threads
+   (the calling thread included), splitting the range into chunks of at least
+   min_chunk iterations. The body must not raise OpenCV errors.
+   Nested calls and calls made while another thread runs a parallel loop
+   are executed sequentially. */
+CVAPI(void) cvParallelFor( int count, CvParallelLoopFunc body, void* userdata,
+                           int min_chunk CV_DEFAULT(1) );
+
 /*************** Convenience functions for better interaction with HighGUI **************/
 
 typedef IplImage* (CV_CDECL * CvLoadImageFunc)( const char* filename, int colorness );
@@ -98,12 +98,20 @@
 /* maximal average node_count/hash_size ratio beyond which hash table is resized */
 #define  CV_SPARSE_HASH_RATIO    3
 
+/* initial number of slots in the open-addressing sparse array */
+#define  CV_SPARSE_SLOTS_SIZE0   (1<<6)
+
+/* maximal load (in 1/16ths) of the open-addressing sparse array */
+#define  CV_SPARSE_SLOTS_LOAD    13
+
 /* max length of strings */
 #define  CV_MAX_STRLEN  1024
 
 /* maximum possible number of threads in parallel implementations */
 #ifdef _OPENMP
 #define CV_MAX_THREADS 128
+#elif !defined WIN32 && !defined WIN64
+#define CV_MAX_THREADS 16
 #else
 #define CV_MAX_THREADS 1
 #endif
@@ -724,6 +732,59 @@ typedef struct CvBtFuncTable
 }
 CvBtFuncTable;
 
+/* Thread-safe one-time initialization of the function tables and other static data:
+
+       static int inittab = 0;
+       if( cvBeginInitOnce( &inittab ))
+       {
+           ... fill the tables ...
+           cvEndInitOnce( &inittab );
+       }
+
+   cvBeginInitOnce returns non-zero (with a global recursive lock held) to the only
+   thread that has to run the initialization; the threads that come at the same time
+   wait until it is finished. The block must not be left without cvEndInitOnce. */
+CVAPI(int)  cvBeginInitOnce( int* flag );
+CVAPI(void) cvEndInitOnce( int* flag );
+
+/* The recursive lock behind cvBeginInitOnce. It may also be taken for a short time
+   to update other global data, e.g. caches */
+CVAPI(void) cvLockGlobal( void );
+CVAPI(void) cvUnlockGlobal( void );
+
+/* A kernel compiled for several instruction sets. The variants are listed from
+   the best to the plain C code, which must be the last one and require CV_CPU_NONE */
+typedef struct CvDispatchVariant
+{
+    void*   func;
+    int     feature;
+    const char* name;
+}
+CvDispatchVariant;
+
+typedef struct CvDispatchEntry
+{
+    const char* name;
+    const CvDispatchVariant* variants;
+    int     count;
+    void* volatile func;        /* the bound variant, 0 until the entry is registered */
+    int     idx;
+    struct CvDispatchEntry* next;
+}
+CvDispatchEntry;
+
+#define CV_DISPATCH_ENTRY( name, variants ) \
+    { name, variants, (int)(sizeof(variants)/sizeof(variants[0])), 0, -1, 0 }
+
+/* Returns the variant of the kernel chosen for the current CPU and dispatch mode;
+   registers the entry on the first call */
+CVAPI(void*) cvGetDispatchFunc( CvDispatchEntry* entry );
+
+/* Registers the entry when the module is loaded, so that cvGetDispatchInfo
+   lists it before the kernel is first used */
+#define CV_REGISTER_DISPATCH_ENTRY( entry ) \
+    static void* entry##_func = cvGetDispatchFunc( &entry )
+
 typedef CvStatus (CV_STDCALL *CvFunc2D_1A)(void* arr, int step, CvSize size);
 
 typedef CvStatus (CV_STDCALL *CvFunc2D_1A1P)(void* arr, int step, CvSize size, void* param);
@@ -71,6 +71,14 @@
     #define CV_SSE2 0
   #endif
 
+  /* __ARM_NEON__ is defined by the armv7 compilers, AArch64 ones define __ARM_NEON */
+  #if (defined __ARM_NEON || defined __ARM_NEON__) && defined __GNUC__
+    #include <arm_neon.h>
+    #define CV_NEON 1
+  #else
+    #define CV_NEON 0
+  #endif
+
   #if defined __BORLANDC__
     #include <fastmath.h>
   #elif defined WIN64 && !defined EM64T && defined CV_ICC
@@ -741,7 +749,12 @@ CvMatND;
 #define CV_SPARSE_MAT_MAGIC_VAL    0x42440000
 #define CV_TYPE_NAME_SPARSE_MAT    "opencv-sparse-matrix"
 
+/* cvCreateSparseMat type flag: keep the nodes in one flat open-addressing
+   table instead of the chained hash table */
+#define CV_SPARSE_OPEN_ADDR        (1 << 12)
+
 struct CvSet;
+struct CvSparseSlots;
 
 typedef struct CvSparseMat
 {
@@ -756,9 +769,24 @@ typedef struct CvSparseMat
     int valoffset;
     int idxoffset;
     int size[CV_MAX_DIM];
+
+    /* open-addressing storage, valid only if CV_SPARSE_OPEN_ADDR is set */
+    struct CvSparseSlots* slots;
 }
 CvSparseMat;
 
+/* open-addressing storage of CvSparseMat (heap and hashtable are NULL then):
+   hashsize nodes of slotsize bytes each and their probe lengths
+   (0 marks an empty slot) */
+typedef struct CvSparseSlots
+{
+    uchar* data;
+    uchar* probe;
+    int slotsize;
+    int count;
+}
+CvSparseSlots;
+
 #define CV_IS_SPARSE_MAT_HDR(mat) \
     ((mat) != NULL && \
     (((const CvSparseMat*)(mat))->type & CV_MAGIC_MASK) == CV_SPARSE_MAT_MAGIC_VAL)
@@ -766,6 +794,13 @@ CvSparseMat;
 #define CV_IS_SPARSE_MAT(mat) \
     CV_IS_SPARSE_MAT_HDR(mat)
 
+#define CV_IS_SPARSE_MAT_OPEN_ADDR(mat) \
+    ((((const CvSparseMat*)(mat))->type & CV_SPARSE_OPEN_ADDR) != 0)
+
+/* number of the stored (non-zero) elements */
+#define CV_SPARSE_MAT_COUNT(mat) \
+    (CV_IS_SPARSE_MAT_OPEN_ADDR(mat) ? (mat)->slots->count : (mat)->heap->active_count)
+
 /**************** iteration through a sparse array *****************/
 
 typedef struct CvSparseNode
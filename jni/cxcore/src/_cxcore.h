@@ -297,6 +297,9 @@ CvCopyMaskFunc icvGetCopyMaskFunc( int elem_size );
 
 CvStatus CV_STDCALL icvSetZero_8u_C1R( uchar* dst, int dststep, CvSize size );
 
+void icvSVDSolveSmall_64f( double* at, int m, int n, const double* b, int ldb, int nb,
+                           double* x, int ldx, double* buffer );
+
 CvStatus CV_STDCALL icvScale_32f( const float* src, float* dst, int len, float a, float b );
 CvStatus CV_STDCALL icvScale_64f( const double* src, double* dst, int len, double a, double b );
 
@@ -313,10 +313,10 @@ cvSub( const void* srcarr1, const void* srcarr2,
             type = iterator.hdr[0]->type;
             iterator.size.width *= CV_MAT_CN(type);
 
-            if( !inittab )
+            if( cvBeginInitOnce( &inittab ))
             {
                 icvInitSubC1RTable( &sub_tab );
-                inittab = 1;
+                cvEndInitOnce( &inittab );
             }
 
             depth = CV_MAT_DEPTH(type);
@@ -456,10 +456,10 @@ cvSub( const void* srcarr1, const void* srcarr2,
         copym_func = icvGetCopyMaskFunc( elem_size );
     }
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitSubC1RTable( &sub_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( depth <= CV_16S )
@@ -544,10 +544,10 @@ cvSubRS( const void* srcarr, CvScalar scalar, void* dstarr, const void* maskarr
     int is_nd = 0;
     CvSize size, tsize; 
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitSubRCC1RTable( &subr_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(src) )
@@ -785,10 +785,10 @@ cvAdd( const void* srcarr1, const void* srcarr2,
             type = iterator.hdr[0]->type;
             iterator.size.width *= CV_MAT_CN(type);
 
-            if( !inittab )
+            if( cvBeginInitOnce( &inittab ))
             {
                 icvInitAddC1RTable( &add_tab );
-                inittab = 1;
+                cvEndInitOnce( &inittab );
             }
 
             depth = CV_MAT_DEPTH(type);
@@ -928,10 +928,10 @@ cvAdd( const void* srcarr1, const void* srcarr2,
         copym_func = icvGetCopyMaskFunc( elem_size );
     }
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitAddC1RTable( &add_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( depth <= CV_16S )
@@ -1016,10 +1016,10 @@ cvAddS( const void* srcarr, CvScalar scalar, void* dstarr, const void* maskarr )
     int is_nd = 0;
     CvSize size, tsize; 
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitAddCC1RTable( &add_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(src) )
@@ -1324,10 +1324,10 @@ cvMul( const void* srcarr1, const void* srcarr2, void* dstarr, double scale )
     CvSize size;
     CvScaledElWiseFunc func;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitMulC1RTable( &mul_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(src1) )
@@ -1671,11 +1671,11 @@ cvDiv( const void* srcarr1, const void* srcarr2, void* dstarr, double scale )
     CvMat dststub,  *dst = (CvMat*)dstarr;
     CvSize size;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitDivC1RTable( &div_tab );
         icvInitRecipC1RTable( &recip_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(src2) )
@@ -1991,10 +1991,10 @@ cvAddWeighted( const CvArr* srcAarr, double alpha,
     CvAddWeightedFunc func;
     CvSize size;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitAddWeightedC1RTable( &addw_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     CV_CALL( srcA = cvGetMat( srcA, &srcA_stub, &coi1 ));
@@ -2047,4 +2047,452 @@ cvAddWeighted( const CvArr* srcAarr, double alpha,
 }
 
 
+/*************************** A D D   W E I G H T E D   N ****************************/
+
+/* The weighted sum is computed block by block in a buffer that stays in the cache:
+   the buffer is initialized with gamma, every source block is added to it with its
+   weight and then the buffer is converted to the destination type. Continuous arrays
+   are split into blocks of ICV_ADDW_BLOCK_SIZE elements, the others into rows */
+#define ICV_ADDW_BLOCK_SIZE     (1 << 12)
+#define ICV_ADDW_PAR_MIN_SIZE   (1 << 16)   /* the minimal number of elements per thread */
+
+typedef void (CV_STDCALL *CvAddWeightedAccFunc)( const void* src, void* buf,
+                                                 int len, double weight );
+typedef void (CV_STDCALL *CvAddWeightedStoreFunc)( const void* buf, void* dst, int len );
+
+#define ICV_DEF_ADDW_ACC_FUNC( flavor, srctype, worktype )                      \
+static void CV_STDCALL                                                          \
+icvAddWeightedAcc_##flavor##_C( const srctype* src, worktype* buf,              \
+                                int len, double weight )                        \
+{                                                                               \
+    worktype w = (worktype)weight;                                              \
+    int i;                                                                      \
+                                                                                \
+    for( i = 0; i <= len - 4; i += 4 )                                          \
+    {                                                                           \
+        worktype t0 = buf[i] + src[i]*w;                                        \
+        worktype t1 = buf[i+1] + src[i+1]*w;                                    \
+        buf[i] = t0; buf[i+1] = t1;                                             \
+        t0 = buf[i+2] + src[i+2]*w;                                             \
+        t1 = buf[i+3] + src[i+3]*w;                                             \
+        buf[i+2] = t0; buf[i+3] = t1;                                           \
+    }                                                                           \
+                                                                                \
+    for( ; i < len; i++ )                                                       \
+        buf[i] += src[i]*w;                                                     \
+}
+
+
+#define ICV_DEF_ADDW_STORE_FUNC( flavor, dsttype, worktype, temptype,           \
+                                 cast_macro1, cast_macro2 )                     \
+static void CV_STDCALL                                                          \
+icvAddWeightedStore_##flavor##_C( const worktype* buf, dsttype* dst, int len )  \
+{                                                                               \
+    int i;                                                                      \
+                                                                                \
+    for( i = 0; i <= len - 4; i += 4 )                                          \
+    {                                                                           \
+        temptype t0 = cast_macro1( buf[i] );                                    \
+        temptype t1 = cast_macro1( buf[i+1] );                                  \
+        dst[i] = cast_macro2( t0 ); dst[i+1] = cast_macro2( t1 );               \
+        t0 = cast_macro1( buf[i+2] );                                           \
+        t1 = cast_macro1( buf[i+3] );                                           \
+        dst[i+2] = cast_macro2( t0 ); dst[i+3] = cast_macro2( t1 );             \
+    }                                                                           \
+                                                                                \
+    for( ; i < len; i++ )                                                       \
+    {                                                                           \
+        temptype t0 = cast_macro1( buf[i] );                                    \
+        dst[i] = cast_macro2( t0 );                                             \
+    }                                                                           \
+}
+
+
+#define ICV_DEF_ADDW_FUNCS( flavor, arrtype, worktype, temptype,                \
+                            cast_macro1, cast_macro2 )                          \
+    ICV_DEF_ADDW_ACC_FUNC( flavor, arrtype, worktype )                          \
+    ICV_DEF_ADDW_STORE_FUNC( flavor, arrtype, worktype, temptype,               \
+                             cast_macro1, cast_macro2 )
+
+ICV_DEF_ADDW_FUNCS( 8u, uchar, float, int, cvRound, CV_CAST_8U )
+ICV_DEF_ADDW_FUNCS( 16u, ushort, float, int, cvRound, CV_CAST_16U )
+ICV_DEF_ADDW_FUNCS( 16s, short, float, int, cvRound, CV_CAST_16S )
+ICV_DEF_ADDW_FUNCS( 32s, int, double, int, cvRound, CV_CAST_32S )
+ICV_DEF_ADDW_FUNCS( 32f, float, float, float, CV_NOP, CV_CAST_32F )
+ICV_DEF_ADDW_FUNCS( 64f, double, double, double, CV_NOP, CV_CAST_64F )
+
+
+#if CV_SSE2
+
+static void CV_STDCALL
+icvAddWeightedAcc_8u_SSE2( const uchar* src, float* buf, int len, double weight )
+{
+    __m128 w = _mm_set1_ps( (float)weight );
+    __m128i z = _mm_setzero_si128();
+    int i;
+
+    for( i = 0; i <= len - 16; i += 16 )
+    {
+        __m128i v = _mm_loadu_si128( (const __m128i*)(src + i) );
+        __m128i v0 = _mm_unpacklo_epi8( v, z ), v1 = _mm_unpackhi_epi8( v, z );
+        __m128 f0 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( v0, z ));
+        __m128 f1 = _mm_cvtepi32_ps( _mm_unpackhi_epi16( v0, z ));
+        __m128 f2 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( v1, z ));
+        __m128 f3 = _mm_cvtepi32_ps( _mm_unpackhi_epi16( v1, z ));
+
+        _mm_storeu_ps( buf + i, _mm_add_ps( _mm_loadu_ps( buf + i ), _mm_mul_ps( f0, w )));
+        _mm_storeu_ps( buf + i + 4, _mm_add_ps( _mm_loadu_ps( buf + i + 4 ), _mm_mul_ps( f1, w )));
+        _mm_storeu_ps( buf + i + 8, _mm_add_ps( _mm_loadu_ps( buf + i + 8 ), _mm_mul_ps( f2, w )));
+        _mm_storeu_ps( buf + i + 12, _mm_add_ps( _mm_loadu_ps( buf + i + 12 ), _mm_mul_ps( f3, w )));
+    }
+
+    icvAddWeightedAcc_8u_C( src + i, buf + i, len - i, weight );
+}
+
+
+static void CV_STDCALL
+icvAddWeightedAcc_32f_SSE2( const float* src, float* buf, int len, double weight )
+{
+    __m128 w = _mm_set1_ps( (float)weight );
+    int i;
+
+    for( i = 0; i <= len - 8; i += 8 )
+    {
+        __m128 t0 = _mm_add_ps( _mm_loadu_ps( buf + i ), _mm_mul_ps( _mm_loadu_ps( src + i ), w ));
+        __m128 t1 = _mm_add_ps( _mm_loadu_ps( buf + i + 4 ), _mm_mul_ps( _mm_loadu_ps( src + i + 4 ), w ));
+        _mm_storeu_ps( buf + i, t0 );
+        _mm_storeu_ps( buf + i + 4, t1 );
+    }
+
+    icvAddWeightedAcc_32f_C( src + i, buf + i, len - i, weight );
+}
+
+
+// _mm_cvtps_epi32 rounds to the nearest even integer, just like cvRound
+static void CV_STDCALL
+icvAddWeightedStore_8u_SSE2( const float* buf, uchar* dst, int len )
+{
+    int i;
+
+    for( i = 0; i <= len - 16; i += 16 )
+    {
+        __m128i v0 = _mm_packs_epi32( _mm_cvtps_epi32( _mm_loadu_ps( buf + i )),
+                                      _mm_cvtps_epi32( _mm_loadu_ps( buf + i + 4 )));
+        __m128i v1 = _mm_packs_epi32( _mm_cvtps_epi32( _mm_loadu_ps( buf + i + 8 )),
+                                      _mm_cvtps_epi32( _mm_loadu_ps( buf + i + 12 )));
+        _mm_storeu_si128( (__m128i*)(dst + i), _mm_packus_epi16( v0, v1 ));
+    }
+
+    icvAddWeightedStore_8u_C( buf + i, dst + i, len - i );
+}
+
+#endif
+
+
+#if CV_NEON
+
+static void CV_STDCALL
+icvAddWeightedAcc_8u_NEON( const uchar* src, float* buf, int len, double weight )
+{
+    float w = (float)weight;
+    int i;
+
+    for( i = 0; i <= len - 8; i += 8 )
+    {
+        uint16x8_t v = vmovl_u8( vld1_u8( src + i ));
+        float32x4_t f0 = vcvtq_f32_u32( vmovl_u16( vget_low_u16( v )));
+        float32x4_t f1 = vcvtq_f32_u32( vmovl_u16( vget_high_u16( v )));
+
+        vst1q_f32( buf + i, vmlaq_n_f32( vld1q_f32( buf + i ), f0, w ));
+        vst1q_f32( buf + i + 4, vmlaq_n_f32( vld1q_f32( buf + i + 4 ), f1, w ));
+    }
+
+    icvAddWeightedAcc_8u_C( src + i, buf + i, len - i, weight );
+}
+
+
+static void CV_STDCALL
+icvAddWeightedAcc_32f_NEON( const float* src, float* buf, int len, double weight )
+{
+    float w = (float)weight;
+    int i;
+
+    for( i = 0; i <= len - 8; i += 8 )
+    {
+        float32x4_t t0 = vmlaq_n_f32( vld1q_f32( buf + i ), vld1q_f32( src + i ), w );
+        float32x4_t t1 = vmlaq_n_f32( vld1q_f32( buf + i + 4 ), vld1q_f32( src + i + 4 ), w );
+        vst1q_f32( buf + i, t0 );
+        vst1q_f32( buf + i + 4, t1 );
+    }
+
+    icvAddWeightedAcc_32f_C( src + i, buf + i, len - i, weight );
+}
+
+
+// the values are saturated first and then rounded to the nearest even integer
+// by adding and subtracting 1.5*2^23, just like cvRound does it
+static void CV_STDCALL
+icvAddWeightedStore_8u_NEON( const float* buf, uchar* dst, int len )
+{
+    const float32x4_t lo = vdupq_n_f32( 0.f ), hi = vdupq_n_f32( 255.f );
+    const float32x4_t magic = vdupq_n_f32( 12582912.f );
+    int i;
+
+    for( i = 0; i <= len - 8; i += 8 )
+    {
+        float32x4_t f0 = vminq_f32( vmaxq_f32( vld1q_f32( buf + i ), lo ), hi );
+        float32x4_t f1 = vminq_f32( vmaxq_f32( vld1q_f32( buf + i + 4 ), lo ), hi );
+        uint32x4_t v0, v1;
+
+        f0 = vsubq_f32( vaddq_f32( f0, magic ), magic );
+        f1 = vsubq_f32( vaddq_f32( f1, magic ), magic );
+        v0 = vcvtq_u32_f32( f0 );
+        v1 = vcvtq_u32_f32( f1 );
+        vst1_u8( dst + i, vmovn_u16( vcombine_u16( vmovn_u32( v0 ), vmovn_u32( v1 ))));
+    }
+
+    icvAddWeightedStore_8u_C( buf + i, dst + i, len - i );
+}
+
+#endif
+
+
+static const CvDispatchVariant icvAddWeightedAcc_8u_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvAddWeightedAcc_8u_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvAddWeightedAcc_8u_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvAddWeightedAcc_8u_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvAddWeightedAcc_32f_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvAddWeightedAcc_32f_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvAddWeightedAcc_32f_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvAddWeightedAcc_32f_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvAddWeightedStore_8u_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvAddWeightedStore_8u_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvAddWeightedStore_8u_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvAddWeightedStore_8u_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvAddWeightedAcc_8u_entry =
+    CV_DISPATCH_ENTRY( "cvAddWeightedN_acc_8u", icvAddWeightedAcc_8u_variants );
+static CvDispatchEntry icvAddWeightedAcc_32f_entry =
+    CV_DISPATCH_ENTRY( "cvAddWeightedN_acc_32f", icvAddWeightedAcc_32f_variants );
+static CvDispatchEntry icvAddWeightedStore_8u_entry =
+    CV_DISPATCH_ENTRY( "cvAddWeightedN_store_8u", icvAddWeightedStore_8u_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvAddWeightedAcc_8u_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvAddWeightedAcc_32f_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvAddWeightedStore_8u_entry );
+
+
+typedef struct CvAddWeightedNParams
+{
+    const uchar** src;
+    const int* src_step;
+    const double* weights;
+    int count;
+    uchar* dst;
+    int dst_step;
+    int cont;           /* 1 - blocks of continuous arrays, 0 - rows */
+    int total;          /* the number of elements of continuous arrays */
+    int block_len;      /* the number of elements in a block */
+    int elem_size1;
+    int work_size1;
+    const uchar* gamma_row;
+    uchar* buf;
+    int buf_step;
+    CvAddWeightedAccFunc acc;
+    CvAddWeightedStoreFunc store;
+}
+CvAddWeightedNParams;
+
+
+static void CV_CDECL
+icvAddWeightedNBody( int start, int end, void* userdata )
+{
+    const CvAddWeightedNParams* p = (const CvAddWeightedNParams*)userdata;
+    uchar* buf = p->buf + p->buf_step*cvGetThreadNum();
+    int i, k;
+
+    for( i = start; i < end; i++ )
+    {
+        size_t ofs, dst_ofs;
+        int len = p->block_len;
+
+        if( p->cont )
+        {
+            dst_ofs = ofs = (size_t)i*len*p->elem_size1;
+            len = MIN( len, p->total - i*len );
+        }
+        else
+        {
+            ofs = (size_t)i;    // the row index, the steps differ
+            dst_ofs = ofs*p->dst_step;
+        }
+
+        memcpy( buf, p->gamma_row, len*p->work_size1 );
+        for( k = 0; k < p->count; k++ )
+            p->acc( p->src[k] + (p->cont ? ofs : ofs*p->src_step[k]),
+                    buf, len, p->weights[k] );
+        p->store( buf, p->dst + dst_ofs, len );
+    }
+}
+
+
+CV_IMPL void
+cvAddWeightedN( const CvArr** srcarr, const double* weights, int count,
+                CvScalar gamma, CvArr* dstarr )
+{
+    static const CvAddWeightedAccFunc acc_tab[] =
+    {
+        (CvAddWeightedAccFunc)icvAddWeightedAcc_8u_C, 0,
+        (CvAddWeightedAccFunc)icvAddWeightedAcc_16u_C,
+        (CvAddWeightedAccFunc)icvAddWeightedAcc_16s_C,
+        (CvAddWeightedAccFunc)icvAddWeightedAcc_32s_C,
+        (CvAddWeightedAccFunc)icvAddWeightedAcc_32f_C,
+        (CvAddWeightedAccFunc)icvAddWeightedAcc_64f_C, 0
+    };
+
+    static const CvAddWeightedStoreFunc store_tab[] =
+    {
+        (CvAddWeightedStoreFunc)icvAddWeightedStore_8u_C, 0,
+        (CvAddWeightedStoreFunc)icvAddWeightedStore_16u_C,
+        (CvAddWeightedStoreFunc)icvAddWeightedStore_16s_C,
+        (CvAddWeightedStoreFunc)icvAddWeightedStore_32s_C,
+        (CvAddWeightedStoreFunc)icvAddWeightedStore_32f_C,
+        (CvAddWeightedStoreFunc)icvAddWeightedStore_64f_C, 0
+    };
+
+    uchar* buffer = 0;
+
+    CV_FUNCNAME( "cvAddWeightedN" );
+
+    __BEGIN__;
+
+    CvMat dst_stub, *dst = (CvMat*)dstarr;
+    CvAddWeightedNParams p;
+    const uchar** src_ptr;
+    int* src_step;
+    int i, k, coi = 0, type, depth, cn, cont_flag, rows, nthreads;
+    int gamma_size, ptr_size;
+
+    if( !srcarr || !weights )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( count <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "The number of source arrays must be positive" );
+
+    CV_CALL( dst = cvGetMat( dst, &dst_stub, &coi ));
+    if( coi )
+        CV_ERROR( CV_BadCOI, "COI must not be set" );
+
+    type = CV_MAT_TYPE( dst->type );
+    depth = CV_MAT_DEPTH( type );
+    cn = CV_MAT_CN( type );
+
+    if( !acc_tab[depth] )
+        CV_ERROR( CV_StsUnsupportedFormat, "This array type is not supported" );
+
+    if( cn > 4 )
+        CV_ERROR( CV_StsOutOfRange, "The arrays must have at most 4 channels" );
+
+    p.elem_size1 = CV_ELEM_SIZE1( depth );
+    p.work_size1 = depth == CV_32S || depth == CV_64F ? sizeof(double) : sizeof(float);
+    p.block_len = dst->cols*cn;
+    nthreads = cvGetNumThreads();
+
+    // the source pointers, the row of gamma and a block buffer per thread
+    gamma_size = cvAlign( MAX( p.block_len, ICV_ADDW_BLOCK_SIZE )*p.work_size1, 16 );
+    ptr_size = cvAlign( count*(sizeof(src_ptr[0]) + sizeof(src_step[0])), 16 );
+    CV_CALL( buffer = (uchar*)cvAlloc( ptr_size + gamma_size*(nthreads + 1) ));
+
+    src_ptr = (const uchar**)buffer;
+    src_step = (int*)(src_ptr + count);
+    cont_flag = dst->type;
+
+    for( k = 0; k < count; k++ )
+    {
+        CvMat stub, *src = (CvMat*)srcarr[k];
+
+        CV_CALL( src = cvGetMat( src, &stub, &coi ));
+        if( coi )
+            CV_ERROR( CV_BadCOI, "COI must not be set" );
+
+        if( !CV_ARE_TYPES_EQ( src, dst ))
+            CV_ERROR( CV_StsUnmatchedFormats,
+            "All input/output arrays should have the same type" );
+
+        if( !CV_ARE_SIZES_EQ( src, dst ))
+            CV_ERROR( CV_StsUnmatchedSizes,
+            "All input/output arrays should have the same sizes" );
+
+        src_ptr[k] = src->data.ptr;
+        src_step[k] = src->step;
+        cont_flag &= src->type;
+    }
+
+    p.cont = CV_IS_MAT_CONT( cont_flag ) != 0;
+    rows = dst->rows;
+
+    if( p.cont )
+    {
+        p.total = dst->rows*p.block_len;
+        p.block_len = MIN( (ICV_ADDW_BLOCK_SIZE/cn)*cn, p.total );
+        rows = (p.total + p.block_len - 1)/p.block_len;
+    }
+
+    p.gamma_row = buffer + ptr_size;
+    p.buf = buffer + ptr_size + gamma_size;
+    p.buf_step = gamma_size;
+
+    for( i = 0; i < p.block_len; i++ )
+    {
+        if( p.work_size1 == sizeof(float) )
+            ((float*)p.gamma_row)[i] = (float)gamma.val[i % cn];
+        else
+            ((double*)p.gamma_row)[i] = gamma.val[i % cn];
+    }
+
+    p.src = src_ptr;
+    p.src_step = src_step;
+    p.weights = weights;
+    p.count = count;
+    p.dst = dst->data.ptr;
+    p.dst_step = dst->step;
+    p.acc = acc_tab[depth];
+    p.store = store_tab[depth];
+
+    if( depth == CV_8U )
+    {
+        p.acc = (CvAddWeightedAccFunc)cvGetDispatchFunc( &icvAddWeightedAcc_8u_entry );
+        p.store = (CvAddWeightedStoreFunc)cvGetDispatchFunc( &icvAddWeightedStore_8u_entry );
+    }
+    else if( depth == CV_32F )
+        p.acc = (CvAddWeightedAccFunc)cvGetDispatchFunc( &icvAddWeightedAcc_32f_entry );
+
+    cvParallelFor( rows, icvAddWeightedNBody, &p,
+                   MAX( ICV_ADDW_PAR_MIN_SIZE/MAX(p.block_len,1), 1 ));
+
+    __END__;
+
+    cvFree( &buffer );
+}
+
+
 /* End of file. */
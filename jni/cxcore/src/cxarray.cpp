@@ -634,6 +634,318 @@ CV_IMPL  int  cvNextNArraySlice( CvNArrayIterator* iterator )
 \****************************************************************************************/
 
 
+/* Open-addressing storage of CvSparseMat: linear probing with the Robin Hood
+   replacement and the backward-shift deletion. The slots have the same layout
+   as the heap nodes, so CV_NODE_VAL/CV_NODE_IDX work for them as well;
+   probe[i] is the distance of the i-th slot from the home slot of its node
+   plus one (0 for an empty slot). */
+#define ICV_SPARSE_MAX_PROBE  255
+
+/* The home slot is computed from the indices rather than from node->hashval,
+   which is the plain multiplicative hash shared with the chained storage and
+   takes the same value for many regularly spaced keys (e.g. (i, c - 33*i)).
+   The indices are mixed as in MurmurHash3. */
+static inline unsigned
+icvSparseMixIdx( const int* idx, int dims )
+{
+    unsigned h = 0;
+    int i;
+
+    for( i = 0; i < dims; i++ )
+    {
+        unsigned k = (unsigned)idx[i]*0xcc9e2d51u;
+        k = (k << 15) | (k >> 17);
+        h ^= k*0x1b873593u;
+        h = ((h << 13) | (h >> 19))*5 + 0xe6546b64u;
+    }
+
+    h ^= (unsigned)dims;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+
+static int
+icvFindSparseSlot( const CvSparseMat* mat, const int* idx, unsigned hashval, unsigned mix )
+{
+    const CvSparseSlots* slots = mat->slots;
+    int mask = mat->hashsize - 1, dims = mat->dims, d = 1, i;
+    int pos = (int)(mix & mask);
+    const uchar* probe = slots->probe;
+
+    for( ; probe[pos] >= d; pos = (pos + 1) & mask, d++ )
+    {
+        // probe[pos] == d <=> the node has the same home slot
+        if( probe[pos] == d )
+        {
+            const CvSparseNode* node = (const CvSparseNode*)(slots->data + pos*slots->slotsize);
+            if( node->hashval == hashval )
+            {
+                const int* nodeidx = CV_NODE_IDX(mat,node);
+                for( i = 0; i < dims; i++ )
+                    if( idx[i] != nodeidx[i] )
+                        break;
+                if( i == dims )
+                    return pos;
+            }
+        }
+    }
+
+    return -1;
+}
+
+
+/* Puts the node (that must be absent in the table) into its place. Returns the
+   slot where it lands or -1 if the probe sequence became too long; in the latter
+   case <node> contains the node that has been displaced and not put back */
+static int
+icvInsertSparseSlot( CvSparseMat* mat, uchar* node, uchar* temp )
+{
+    CvSparseSlots* slots = mat->slots;
+    int mask = mat->hashsize - 1, slotsize = slots->slotsize, d = 1, result = -1;
+    int pos = (int)(icvSparseMixIdx( CV_NODE_IDX(mat,node), mat->dims ) & mask);
+    uchar* probe = slots->probe;
+
+    for( ; d <= ICV_SPARSE_MAX_PROBE; pos = (pos + 1) & mask, d++ )
+    {
+        uchar* slot = slots->data + pos*slotsize;
+        int pd = probe[pos];
+
+        if( pd == 0 )
+        {
+            memcpy( slot, node, slotsize );
+            probe[pos] = (uchar)d;
+            return result >= 0 ? result : pos;
+        }
+
+        // the resident is closer to its home: take its place and move it further
+        if( pd < d )
+        {
+            memcpy( temp, slot, slotsize );
+            memcpy( slot, node, slotsize );
+            memcpy( node, temp, slotsize );
+            probe[pos] = (uchar)d;
+            d = pd;
+            if( result < 0 )
+                result = pos;
+        }
+    }
+
+    return -1;
+}
+
+
+/* Rehashes the table into <newsize> slots, adding <extra_node> if it is not NULL.
+   Returns 0 and keeps the old table if some probe sequence still does not fit:
+   once a larger table has not made the probe sequences shorter, doubling it
+   further will not help either (many keys share the same mixed hash) */
+static int
+icvResizeSparseSlots( CvSparseMat* mat, int newsize, const uchar* extra_node )
+{
+    int ok = 0;
+
+    CV_FUNCNAME( "icvResizeSparseSlots" );
+
+    __BEGIN__;
+
+    CvSparseSlots* slots = mat->slots;
+    uchar* olddata = slots->data;
+    uchar* oldprobe = slots->probe;
+    int i, oldsize = olddata ? mat->hashsize : 0;
+    int slotsize = slots->slotsize;
+    uchar* node = (uchar*)cvStackAlloc( slotsize*2 );
+
+    assert( (newsize & (newsize - 1)) == 0 );
+
+    CV_CALL( slots->data = (uchar*)cvAlloc( (size_t)newsize*(slotsize + 1) ));
+    slots->probe = slots->data + (size_t)newsize*slotsize;
+    mat->hashsize = newsize;
+    memset( slots->probe, 0, newsize );
+
+    for( i = 0; i < oldsize; i++ )
+    {
+        if( oldprobe[i] )
+        {
+            memcpy( node, olddata + i*slotsize, slotsize );
+            if( icvInsertSparseSlot( mat, node, node + slotsize ) < 0 )
+                break;
+        }
+    }
+
+    if( i == oldsize )
+    {
+        ok = 1;
+        if( extra_node )
+        {
+            memcpy( node, extra_node, slotsize );
+            ok = icvInsertSparseSlot( mat, node, node + slotsize ) >= 0;
+        }
+    }
+
+    if( !ok )
+    {
+        // the old table is intact
+        cvFree( &slots->data );
+        slots->data = olddata;
+        slots->probe = oldprobe;
+        mat->hashsize = oldsize;
+        EXIT;
+    }
+
+    cvFree( &olddata );
+
+    __END__;
+
+    return ok;
+}
+
+
+/* Moves the nodes (plus <extra_node> if it is not NULL) to the chained storage;
+   used when the key set can not be put into the open-addressing table */
+static void
+icvConvertSparseSlotsToNodes( CvSparseMat* mat, const uchar* extra_node )
+{
+    CvMemStorage* storage = 0;
+    void** hashtable = 0;
+
+    CV_FUNCNAME( "icvConvertSparseSlotsToNodes" );
+
+    __BEGIN__;
+
+    CvSparseSlots* slots = mat->slots;
+    int i, slotsize = slots->slotsize;
+    int count = slots->count + (extra_node != 0);
+    int hashsize = CV_SPARSE_HASH_SIZE0;
+    CvSet* heap;
+
+    while( count >= hashsize*CV_SPARSE_HASH_RATIO )
+        hashsize *= 2;
+
+    CV_CALL( storage = cvCreateMemStorage( CV_SPARSE_MAT_BLOCK ));
+    CV_CALL( heap = cvCreateSet( 0, sizeof(CvSet), slotsize, storage ));
+    CV_CALL( hashtable = (void**)cvAlloc( hashsize*sizeof(hashtable[0]) ));
+    memset( hashtable, 0, hashsize*sizeof(hashtable[0]) );
+
+    for( i = 0; i <= mat->hashsize; i++ )
+    {
+        const CvSparseNode* src;
+        CvSparseNode* node;
+        int tabidx;
+
+        if( i < mat->hashsize )
+        {
+            if( !slots->probe[i] )
+                continue;
+            src = (const CvSparseNode*)(slots->data + i*slotsize);
+        }
+        else if( extra_node )
+            src = (const CvSparseNode*)extra_node;
+        else
+            break;
+
+        CV_CALL( node = (CvSparseNode*)cvSetNew( heap ));
+        memcpy( node, src, slotsize );
+        tabidx = node->hashval & (hashsize - 1);
+        node->next = (CvSparseNode*)hashtable[tabidx];
+        hashtable[tabidx] = node;
+    }
+
+    cvFree( &slots->data );
+    slots->probe = 0;
+    slots->count = 0;
+    mat->heap = heap;
+    mat->hashtable = hashtable;
+    mat->hashsize = hashsize;
+    mat->type &= ~CV_SPARSE_OPEN_ADDR;
+    storage = 0;
+    hashtable = 0;
+
+    __END__;
+
+    cvReleaseMemStorage( &storage );
+    cvFree( &hashtable );
+}
+
+
+/* Adds a zero node; returns the pointer to its value or NULL
+   if the matrix has been switched to the chained storage instead */
+static uchar*
+icvAddSparseSlot( CvSparseMat* mat, const int* idx, unsigned hashval, unsigned mix )
+{
+    uchar* ptr = 0;
+
+    CV_FUNCNAME( "icvAddSparseSlot" );
+
+    __BEGIN__;
+
+    CvSparseSlots* slots = mat->slots;
+    int slotsize = slots->slotsize, pos = -1, ok = 1;
+    uchar* node = (uchar*)cvStackAlloc( slotsize*2 );
+
+    if( (slots->count + 1)*16 > mat->hashsize*CV_SPARSE_SLOTS_LOAD )
+    {
+        CV_CALL( ok = icvResizeSparseSlots( mat, mat->hashsize*2, 0 ));
+        if( !ok )
+        {
+            CV_CALL( icvConvertSparseSlotsToNodes( mat, 0 ));
+            EXIT;
+        }
+    }
+
+    memset( node, 0, slotsize );
+    ((CvSparseNode*)node)->hashval = hashval;
+    CV_MEMCPY_INT( CV_NODE_IDX(mat,node), idx, mat->dims );
+
+    pos = icvInsertSparseSlot( mat, node, node + slotsize );
+    slots->count++;
+
+    if( pos < 0 )
+    {
+        // <node> is the one that has been pushed out of the table now
+        CV_CALL( ok = icvResizeSparseSlots( mat, mat->hashsize*2, node ));
+        if( !ok )
+        {
+            slots->count--;
+            CV_CALL( icvConvertSparseSlotsToNodes( mat, node ));
+            EXIT;
+        }
+        pos = icvFindSparseSlot( mat, idx, hashval, mix );
+    }
+
+    ptr = (uchar*)CV_NODE_VAL( mat, slots->data + pos*slotsize );
+
+    __END__;
+
+    return ptr;
+}
+
+
+static void
+icvRemoveSparseSlot( CvSparseMat* mat, int pos )
+{
+    CvSparseSlots* slots = mat->slots;
+    int mask = mat->hashsize - 1, slotsize = slots->slotsize;
+    uchar* probe = slots->probe;
+
+    for( ;; )
+    {
+        int next = (pos + 1) & mask;
+        if( probe[next] <= 1 )
+            break;
+        memcpy( slots->data + pos*slotsize, slots->data + next*slotsize, slotsize );
+        probe[pos] = (uchar)(probe[next] - 1);
+        pos = next;
+    }
+
+    probe[pos] = 0;
+    slots->count--;
+}
+
+
 // Creates CvMatND and underlying data
 CV_IMPL CvSparseMat*
 cvCreateSparseMat( int dims, const int* sizes, int type )
@@ -644,6 +956,7 @@ cvCreateSparseMat( int dims, const int* sizes, int type )
     
     __BEGIN__;
 
+    int open_addr = (type & CV_SPARSE_OPEN_ADDR) != 0 && dims <= CV_MAX_DIM;
     type = CV_MAT_TYPE( type );
     int pix_size1 = CV_ELEM_SIZE1(type);
     int pix_size = pix_size1*CV_MAT_CN(type);
@@ -665,18 +978,36 @@ cvCreateSparseMat( int dims, const int* sizes, int type )
             CV_ERROR( CV_StsBadSize, "one of dimesion sizes is non-positive" );
     }
 
-    CV_CALL( arr = (CvSparseMat*)cvAlloc(sizeof(*arr)+MAX(0,dims-CV_MAX_DIM)*sizeof(arr->size[0])));
+    // the open-addressing storage descriptor follows the header
+    // (it is never used with dims > CV_MAX_DIM, where arr->size overlaps arr->slots)
+    CV_CALL( arr = (CvSparseMat*)cvAlloc(sizeof(*arr)+MAX(0,dims-CV_MAX_DIM)*sizeof(arr->size[0])+
+                                         (open_addr ? sizeof(CvSparseSlots) : 0)));
 
-    arr->type = CV_SPARSE_MAT_MAGIC_VAL | type;
+    arr->type = CV_SPARSE_MAT_MAGIC_VAL | (open_addr ? CV_SPARSE_OPEN_ADDR : 0) | type;
     arr->dims = dims;
     arr->refcount = 0;
     arr->hdr_refcount = 1;
+    arr->heap = 0;
+    arr->hashtable = 0;
+    arr->hashsize = 0;
     memcpy( arr->size, sizes, dims*sizeof(sizes[0]));
+    if( dims <= CV_MAX_DIM )
+        arr->slots = 0;
 
     arr->valoffset = (int)cvAlign(sizeof(CvSparseNode), pix_size1);
     arr->idxoffset = (int)cvAlign(arr->valoffset + pix_size, sizeof(int));
     size = (int)cvAlign(arr->idxoffset + dims*sizeof(int), sizeof(CvSetElem));
 
+    if( open_addr )
+    {
+        arr->slots = (CvSparseSlots*)(arr + 1);
+        arr->slots->data = arr->slots->probe = 0;
+        arr->slots->slotsize = size;
+        arr->slots->count = 0;
+        CV_CALL( icvResizeSparseSlots( arr, CV_SPARSE_SLOTS_SIZE0, 0 ));
+        EXIT;
+    }
+
     CV_CALL( storage = cvCreateMemStorage( CV_SPARSE_MAT_BLOCK ));
     CV_CALL( arr->heap = cvCreateSet( 0, sizeof(CvSet), size, storage ));
 
@@ -715,8 +1046,11 @@ cvReleaseSparseMat( CvSparseMat** array )
 
         *array = 0;
 
-        cvReleaseMemStorage( &arr->heap->storage );
+        if( arr->heap )
+            cvReleaseMemStorage( &arr->heap->storage );
         cvFree( &arr->hashtable );
+        if( CV_IS_SPARSE_MAT_OPEN_ADDR( arr ))
+            cvFree( &arr->slots->data );
         cvFree( &arr );
     }
 
@@ -769,12 +1103,25 @@ cvInitSparseMatIterator( const CvSparseMat* mat, CvSparseMatIterator* iterator )
     iterator->mat = (CvSparseMat*)mat;
     iterator->node = 0;
 
-    for( idx = 0; idx < mat->hashsize; idx++ )
-        if( mat->hashtable[idx] )
-        {
-            node = iterator->node = (CvSparseNode*)mat->hashtable[idx];
-            break;
-        }
+    if( CV_IS_SPARSE_MAT_OPEN_ADDR( mat ))
+    {
+        for( idx = 0; idx < mat->hashsize; idx++ )
+            if( mat->slots->probe[idx] )
+            {
+                node = iterator->node = (CvSparseNode*)(mat->slots->data +
+                                                        idx*mat->slots->slotsize);
+                break;
+            }
+    }
+    else
+    {
+        for( idx = 0; idx < mat->hashsize; idx++ )
+            if( mat->hashtable[idx] )
+            {
+                node = iterator->node = (CvSparseNode*)mat->hashtable[idx];
+                break;
+            }
+    }
 
     iterator->curidx = idx;
 
@@ -815,65 +1162,80 @@ icvGetNodePtr( CvSparseMat* mat, const int* idx, int* _type,
         hashval = *precalc_hashval;
     }
 
-    tabidx = hashval & (mat->hashsize - 1);
     hashval &= INT_MAX;
 
-    for( node = (CvSparseNode*)mat->hashtable[tabidx];
-         node != 0; node = node->next )
+    if( CV_IS_SPARSE_MAT_OPEN_ADDR( mat ))
+    {
+        unsigned mix = icvSparseMixIdx( idx, mat->dims );
+        int pos = icvFindSparseSlot( mat, idx, hashval, mix );
+        if( pos >= 0 )
+            ptr = (uchar*)CV_NODE_VAL( mat, mat->slots->data + pos*mat->slots->slotsize );
+        else if( create_node )
+            CV_CALL( ptr = icvAddSparseSlot( mat, idx, hashval, mix ));
+    }
+
+    // (the open-addressing table might have been turned into the chained one just now)
+    if( !ptr && !CV_IS_SPARSE_MAT_OPEN_ADDR( mat ))
     {
-        if( node->hashval == hashval )
+        tabidx = hashval & (mat->hashsize - 1);
+
+        for( node = (CvSparseNode*)mat->hashtable[tabidx];
+             node != 0; node = node->next )
         {
-            int* nodeidx = CV_NODE_IDX(mat,node);
-            for( i = 0; i < mat->dims; i++ )
-                if( idx[i] != nodeidx[i] )
-                    break;
-            if( i == mat->dims )
+            if( node->hashval == hashval )
             {
-                ptr = (uchar*)CV_NODE_VAL(mat,node);
-                break;
+                int* nodeidx = CV_NODE_IDX(mat,node);
+                for( i = 0; i < mat->dims; i++ )
+                    if( idx[i] != nodeidx[i] )
+                        break;
+                if( i == mat->dims )
+                {
+                    ptr = (uchar*)CV_NODE_VAL(mat,node);
+                    break;
+                }
             }
         }
-    }
 
-    if( !ptr && create_node )
-    {
-        if( mat->heap->active_count >= mat->hashsize*CV_SPARSE_HASH_RATIO )
+        if( !ptr && create_node )
         {
-            void** newtable;
-            int newsize = MAX( mat->hashsize*2, CV_SPARSE_HASH_SIZE0);
-            int newrawsize = newsize*sizeof(newtable[0]);
+            if( mat->heap->active_count >= mat->hashsize*CV_SPARSE_HASH_RATIO )
+            {
+                void** newtable;
+                int newsize = MAX( mat->hashsize*2, CV_SPARSE_HASH_SIZE0);
+                int newrawsize = newsize*sizeof(newtable[0]);
             
-            CvSparseMatIterator iterator;
-            assert( (newsize & (newsize - 1)) == 0 );
+                CvSparseMatIterator iterator;
+                assert( (newsize & (newsize - 1)) == 0 );
 
-            // resize hash table
-            CV_CALL( newtable = (void**)cvAlloc( newrawsize ));
-            memset( newtable, 0, newrawsize );
+                // resize hash table
+                CV_CALL( newtable = (void**)cvAlloc( newrawsize ));
+                memset( newtable, 0, newrawsize );
 
-            node = cvInitSparseMatIterator( mat, &iterator );
-            while( node )
-            {
-                CvSparseNode* next = cvGetNextSparseNode( &iterator );
-                int newidx = node->hashval & (newsize - 1);
-                node->next = (CvSparseNode*)newtable[newidx];
-                newtable[newidx] = node;
-                node = next;
+                node = cvInitSparseMatIterator( mat, &iterator );
+                while( node )
+                {
+                    CvSparseNode* next = cvGetNextSparseNode( &iterator );
+                    int newidx = node->hashval & (newsize - 1);
+                    node->next = (CvSparseNode*)newtable[newidx];
+                    newtable[newidx] = node;
+                    node = next;
+                }
+
+                cvFree( &mat->hashtable );
+                mat->hashtable = newtable;
+                mat->hashsize = newsize;
+                tabidx = hashval & (newsize - 1);
             }
 
-            cvFree( &mat->hashtable );
-            mat->hashtable = newtable;
-            mat->hashsize = newsize;
-            tabidx = hashval & (newsize - 1);
+            node = (CvSparseNode*)cvSetNew( mat->heap );
+            node->hashval = hashval;
+            node->next = (CvSparseNode*)mat->hashtable[tabidx];
+            mat->hashtable[tabidx] = node;
+            CV_MEMCPY_INT( CV_NODE_IDX(mat,node), idx, mat->dims );
+            ptr = (uchar*)CV_NODE_VAL(mat,node);
+            if( create_node > 0 )
+                CV_ZERO_CHAR( ptr, CV_ELEM_SIZE(mat->type));
         }
-
-        node = (CvSparseNode*)cvSetNew( mat->heap );
-        node->hashval = hashval;
-        node->next = (CvSparseNode*)mat->hashtable[tabidx];
-        mat->hashtable[tabidx] = node;
-        CV_MEMCPY_INT( CV_NODE_IDX(mat,node), idx, mat->dims );
-        ptr = (uchar*)CV_NODE_VAL(mat,node);
-        if( create_node > 0 )
-            CV_ZERO_CHAR( ptr, CV_ELEM_SIZE(mat->type));
     }
 
     if( _type )
@@ -915,27 +1277,132 @@ icvDeleteNode( CvSparseMat* mat, const int* idx, unsigned* precalc_hashval )
     tabidx = hashval & (mat->hashsize - 1);
     hashval &= INT_MAX;
 
-    for( node = (CvSparseNode*)mat->hashtable[tabidx];
-         node != 0; prev = node, node = node->next )
+    if( CV_IS_SPARSE_MAT_OPEN_ADDR( mat ))
     {
-        if( node->hashval == hashval )
+        int pos = icvFindSparseSlot( mat, idx, hashval, icvSparseMixIdx( idx, mat->dims ));
+        if( pos >= 0 )
+            icvRemoveSparseSlot( mat, pos );
+    }
+    else
+    {
+        for( node = (CvSparseNode*)mat->hashtable[tabidx];
+             node != 0; prev = node, node = node->next )
         {
-            int* nodeidx = CV_NODE_IDX(mat,node);
-            for( i = 0; i < mat->dims; i++ )
-                if( idx[i] != nodeidx[i] )
+            if( node->hashval == hashval )
+            {
+                int* nodeidx = CV_NODE_IDX(mat,node);
+                for( i = 0; i < mat->dims; i++ )
+                    if( idx[i] != nodeidx[i] )
+                        break;
+                if( i == mat->dims )
                     break;
-            if( i == mat->dims )
-                break;
+            }
+        }
+
+        if( node )
+        {
+            if( prev )
+                prev->next = node->next;
+            else
+                mat->hashtable[tabidx] = node->next;
+            cvSetRemoveByPtr( mat->heap, node );
         }
     }
 
-    if( node )
+    __END__;
+}
+
+
+#define ICV_SPARSE_INC_BLOCK  64
+
+CV_IMPL void
+cvIncSparseND( CvSparseMat* mat, const int* idx, int count, double delta )
+{
+    CV_FUNCNAME( "cvIncSparseND" );
+
+    __BEGIN__;
+
+    unsigned hashbuf[ICV_SPARSE_INC_BLOCK], mixbuf[ICV_SPARSE_INC_BLOCK];
+    int i, j, k, dims, type, idelta;
+    float fdelta;
+
+    if( !CV_IS_SPARSE_MAT( mat ))
+        CV_ERROR( CV_StsBadArg, "Invalid sparse array header" );
+
+    if( count < 0 )
+        CV_ERROR( CV_StsOutOfRange, "Negative number of elements" );
+
+    if( !idx && count > 0 )
+        CV_ERROR( CV_StsNullPtr, "NULL pointer to indices" );
+
+    type = CV_MAT_TYPE( mat->type );
+    if( type != CV_32SC1 && type != CV_32FC1 && type != CV_64FC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+
+    dims = mat->dims;
+    idelta = cvRound( delta );
+    fdelta = (float)delta;
+
+    // the hash values of a block are computed first (and the home slots
+    // are prefetched), so the table accesses do not stall one another
+    for( i = 0; i < count; i += ICV_SPARSE_INC_BLOCK, idx += ICV_SPARSE_INC_BLOCK*dims )
     {
-        if( prev )
-            prev->next = node->next;
-        else
-            mat->hashtable[tabidx] = node->next;
-        cvSetRemoveByPtr( mat->heap, node );
+        int n = MIN( count - i, ICV_SPARSE_INC_BLOCK );
+        int open_addr = CV_IS_SPARSE_MAT_OPEN_ADDR( mat );
+
+        for( j = 0; j < n; j++ )
+        {
+            const int* elem_idx = idx + j*dims;
+            unsigned hashval = 0;
+
+            for( k = 0; k < dims; k++ )
+            {
+                int t = elem_idx[k];
+                if( (unsigned)t >= (unsigned)mat->size[k] )
+                    CV_ERROR( CV_StsOutOfRange, "One of indices is out of range" );
+                hashval = hashval*ICV_SPARSE_MAT_HASH_MULTIPLIER + t;
+            }
+
+            hashbuf[j] = hashval;
+            if( open_addr )
+            {
+                mixbuf[j] = icvSparseMixIdx( elem_idx, dims );
+#if defined __GNUC__
+                {
+                int pos = (int)(mixbuf[j] & (mat->hashsize - 1));
+                __builtin_prefetch( mat->slots->probe + pos );
+                __builtin_prefetch( mat->slots->data + pos*mat->slots->slotsize );
+                }
+#endif
+            }
+        }
+
+        for( j = 0; j < n; j++ )
+        {
+            const int* elem_idx = idx + j*dims;
+            uchar* ptr = 0;
+
+            // the matrix may switch to the chained storage in the middle of the block
+            if( open_addr && CV_IS_SPARSE_MAT_OPEN_ADDR( mat ))
+            {
+                unsigned hashval = hashbuf[j] & INT_MAX;
+                int pos = icvFindSparseSlot( mat, elem_idx, hashval, mixbuf[j] );
+                if( pos >= 0 )
+                    ptr = (uchar*)CV_NODE_VAL( mat, mat->slots->data + pos*mat->slots->slotsize );
+                else
+                    CV_CALL( ptr = icvAddSparseSlot( mat, elem_idx, hashval, mixbuf[j] ));
+            }
+
+            if( !ptr )
+                CV_CALL( ptr = icvGetNodePtr( mat, elem_idx, 0, 1, hashbuf + j ));
+
+            if( type == CV_32SC1 )
+                *(int*)ptr += idelta;
+            else if( type == CV_32FC1 )
+                *(float*)ptr += fdelta;
+            else
+                *(double*)ptr += delta;
+        }
     }
 
     __END__;
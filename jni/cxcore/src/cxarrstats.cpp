@@ -0,0 +1,720 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                        Intel License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000, Intel Corporation, all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of Intel Corporation may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "_cxcore.h"
+
+/****************************************************************************************\
+*                            Fused array statistics                                      *
+\****************************************************************************************/
+
+/* the statistics the row kernels are asked for */
+#define ICV_STATS_SUM       1
+#define ICV_STATS_SQSUM     2       /* sum and sum of squares */
+#define ICV_STATS_ABSSUM    4
+#define ICV_STATS_MINMAX    8
+#define ICV_STATS_NONZERO   16
+
+/* the minimal number of elements in a stripe of rows (the unit of work of a thread) and
+   the maximal number of stripes an array is split into */
+#define ICV_STATS_STRIPE_SIZE   (1 << 16)
+#define ICV_STATS_MAX_STRIPES   64
+
+/* the statistics of a single row; the row kernels fill the fields they are asked for */
+typedef struct CvArrStatsRow
+{
+    double sum[4], sqsum[4], abssum[4], nonzero[4];
+    double min_val[4], max_val[4];
+    int count;
+}
+CvArrStatsRow;
+
+/* the statistics of a stripe of rows */
+typedef struct CvArrStatsAcc
+{
+    double sum[4], sqsum[4], abssum[4], nonzero[4];
+    double min_val[4], max_val[4];
+    int min_y[4], max_y[4];
+    double count;
+}
+CvArrStatsAcc;
+
+typedef void (CV_STDCALL *CvArrStatsRowFunc)( const void* src, const uchar* mask,
+                                              int width, int cn, int pcn, int flags,
+                                              CvArrStatsRow* row );
+
+typedef int (CV_STDCALL *CvArrStatsFindFunc)( const void* src, const uchar* mask,
+                                              int width, int pcn, double val );
+
+
+/* The rows of the arrays with 1 to 4 channels are processed by ICV_STATS_LANES(cn)
+   elements at a time; the element k of a group goes to the accumulator k, which
+   collects the channel k % cn. The masked rows are processed pixel by pixel */
+#define ICV_STATS_LANES(cn)     ((cn) == 3 ? 3 : 4)
+
+#define ICV_ARR_STATS_LANE( srctype, lane, ptr, body )          \
+    {                                                           \
+        const int k = (lane);                                   \
+        srctype v = (ptr)[lane];                                \
+        body                                                    \
+    }
+
+#define ICV_ARR_STATS_LOOP( srctype, cn, body )                 \
+    x = 0;                                                      \
+    if( !mask )                                                 \
+    {                                                           \
+        for( ; x <= n - ICV_STATS_LANES(cn);                    \
+               x += ICV_STATS_LANES(cn) )                       \
+        {                                                       \
+            ICV_ARR_STATS_LANE( srctype, 0, src + x, body )     \
+            ICV_ARR_STATS_LANE( srctype, 1, src + x, body )     \
+            ICV_ARR_STATS_LANE( srctype, 2, src + x, body )     \
+            if( ICV_STATS_LANES(cn) == 4 )                      \
+                ICV_ARR_STATS_LANE( srctype, 3, src + x, body ) \
+        }                                                       \
+        x /= (cn);                                              \
+    }                                                           \
+                                                                \
+    for( ; x < width; x++ )                                     \
+        if( !mask || mask[x] )                                  \
+        {                                                       \
+            const srctype* p = src + x*(cn);                    \
+            ICV_ARR_STATS_LANE( srctype, 0, p, body )           \
+            if( (cn) > 1 )                                      \
+                ICV_ARR_STATS_LANE( srctype, 1, p, body )       \
+            if( (cn) > 2 )                                      \
+                ICV_ARR_STATS_LANE( srctype, 2, p, body )       \
+            if( (cn) > 3 )                                      \
+                ICV_ARR_STATS_LANE( srctype, 3, p, body )       \
+        }
+
+/* dst[c] = the accumulators of the channel c combined by _op_ */
+#define ICV_ARR_STATS_MERGE( cn, dst, acc, _op_ )               \
+    (dst)[0] = (double)(acc)[0];                                \
+    (dst)[1] = (double)(acc)[1];                                \
+    (dst)[2] = (double)(acc)[2];                                \
+    (dst)[3] = (double)(acc)[3];                                \
+    if( (cn) == 1 )                                             \
+        (dst)[0] = _op_( _op_( (dst)[0], (dst)[1] ),            \
+                         _op_( (dst)[2], (dst)[3] ));           \
+    else if( (cn) == 2 )                                        \
+    {                                                           \
+        (dst)[0] = _op_( (dst)[0], (dst)[2] );                  \
+        (dst)[1] = _op_( (dst)[1], (dst)[3] );                  \
+    }
+
+#define ICV_STATS_ADD(a, b)     ((a) + (b))
+
+
+#define ICV_DEF_ARR_STATS_ROW_FUNC( flavor, srctype, sumtype, sqsumtype, cn )   \
+static void CV_STDCALL                                                          \
+icvArrStatsRow_##flavor##_C##cn##R( const srctype* src, const uchar* mask,      \
+                                    int width, int, int, int flags,             \
+                                    CvArrStatsRow* row )                        \
+{                                                                               \
+    int x, n = width*(cn), count = width;                                       \
+                                                                                \
+    if( mask )                                                                  \
+        for( x = 0, count = 0; x < width; x++ )                                 \
+            count += mask[x] != 0;                                              \
+    row->count = count;                                                         \
+    if( count == 0 )                                                            \
+        return;                                                                 \
+                                                                                \
+    if( flags & ICV_STATS_SQSUM )                                               \
+    {                                                                           \
+        sumtype s[4] = { 0, 0, 0, 0 };                                          \
+        sqsumtype sq[4] = { 0, 0, 0, 0 };                                       \
+        ICV_ARR_STATS_LOOP( srctype, cn, s[k] += v; sq[k] += (sqsumtype)v*v; )  \
+        ICV_ARR_STATS_MERGE( cn, row->sum, s, ICV_STATS_ADD )                   \
+        ICV_ARR_STATS_MERGE( cn, row->sqsum, sq, ICV_STATS_ADD )                \
+    }                                                                           \
+    else if( flags & ICV_STATS_SUM )                                            \
+    {                                                                           \
+        sumtype s[4] = { 0, 0, 0, 0 };                                          \
+        ICV_ARR_STATS_LOOP( srctype, cn, s[k] += v; )                           \
+        ICV_ARR_STATS_MERGE( cn, row->sum, s, ICV_STATS_ADD )                   \
+    }                                                                           \
+                                                                                \
+    if( flags & ICV_STATS_ABSSUM )                                              \
+    {                                                                           \
+        sumtype s[4] = { 0, 0, 0, 0 };                                          \
+        ICV_ARR_STATS_LOOP( srctype, cn, sumtype a = v; s[k] += a < 0 ? -a : a; ) \
+        ICV_ARR_STATS_MERGE( cn, row->abssum, s, ICV_STATS_ADD )                \
+    }                                                                           \
+                                                                                \
+    if( flags & ICV_STATS_MINMAX )                                              \
+    {                                                                           \
+        srctype mn[4], mx[4];                                                   \
+        const srctype* p;                                                       \
+        for( x = 0; mask && !mask[x]; x++ )                                     \
+            ;                                                                   \
+        p = src + x*(cn);                                                       \
+        mn[0] = mx[0] = p[0];                                                   \
+        mn[1] = mx[1] = p[1 % (cn)];                                            \
+        mn[2] = mx[2] = p[2 % (cn)];                                            \
+        mn[3] = mx[3] = p[3 % (cn)];                                            \
+        ICV_ARR_STATS_LOOP( srctype, cn, mn[k] = v < mn[k] ? v : mn[k];         \
+                                         mx[k] = v > mx[k] ? v : mx[k]; )       \
+        ICV_ARR_STATS_MERGE( cn, row->min_val, mn, MIN )                        \
+        ICV_ARR_STATS_MERGE( cn, row->max_val, mx, MAX )                        \
+    }                                                                           \
+                                                                                \
+    if( flags & ICV_STATS_NONZERO )                                             \
+    {                                                                           \
+        int nz[4] = { 0, 0, 0, 0 };                                             \
+        ICV_ARR_STATS_LOOP( srctype, cn, nz[k] += v != 0; )                     \
+        ICV_ARR_STATS_MERGE( cn, row->nonzero, nz, ICV_STATS_ADD )              \
+    }                                                                           \
+}
+
+
+/* a channel of interleaved data (COI), pcn elements apart */
+#define ICV_DEF_ARR_STATS_ROW_FUNC_COI( flavor, srctype, sumtype, sqsumtype )   \
+static void CV_STDCALL                                                          \
+icvArrStatsRow_##flavor##_CnCR( const srctype* src, const uchar* mask,          \
+                                int width, int, int pcn, int flags,             \
+                                CvArrStatsRow* row )                            \
+{                                                                               \
+    int x, count = width;                                                       \
+    sumtype s = 0, as = 0;                                                      \
+    sqsumtype sq = 0;                                                           \
+    srctype mn, mx;                                                             \
+    int nz = 0;                                                                 \
+                                                                                \
+    for( x = 0; mask && x < width && !mask[x]; x++ )                            \
+        ;                                                                       \
+    if( x == width )                                                            \
+    {                                                                           \
+        row->count = 0;                                                         \
+        return;                                                                 \
+    }                                                                           \
+                                                                                \
+    mn = mx = src[x*pcn];                                                       \
+    if( mask )                                                                  \
+        count = 0;                                                              \
+                                                                                \
+    for( ; x < width; x++ )                                                     \
+    {                                                                           \
+        srctype v = src[x*pcn];                                                 \
+        sumtype a = v;                                                          \
+        if( mask && !mask[x] )                                                  \
+            continue;                                                           \
+        s += a; sq += (sqsumtype)v*v;                                           \
+        as += a < 0 ? -a : a;                                                   \
+        mn = v < mn ? v : mn;                                                   \
+        mx = v > mx ? v : mx;                                                   \
+        nz += v != 0;                                                           \
+        count += mask != 0;                                                     \
+    }                                                                           \
+                                                                                \
+    row->sum[0] = (double)s;                                                    \
+    row->sqsum[0] = (double)sq;                                                 \
+    row->abssum[0] = (double)as;                                                \
+    row->min_val[0] = (double)mn;                                               \
+    row->max_val[0] = (double)mx;                                               \
+    row->nonzero[0] = nz;                                                       \
+    row->count = count;                                                         \
+}
+
+
+/* finds the first element of the row equal to val */
+#define ICV_DEF_ARR_STATS_FIND_FUNC( flavor, srctype )                      \
+static int CV_STDCALL                                                       \
+icvArrStatsFind_##flavor( const srctype* src, const uchar* mask,            \
+                          int width, int pcn, double val )                  \
+{                                                                           \
+    int x;                                                                  \
+    for( x = 0; x < width; x++ )                                            \
+        if( (!mask || mask[x]) && (double)src[x*pcn] == val )               \
+            return x;                                                       \
+    return -1;                                                              \
+}
+
+
+#define ICV_DEF_ARR_STATS_ALL( flavor, srctype, sumtype, sqsumtype )        \
+    ICV_DEF_ARR_STATS_ROW_FUNC( flavor, srctype, sumtype, sqsumtype, 1 )    \
+    ICV_DEF_ARR_STATS_ROW_FUNC( flavor, srctype, sumtype, sqsumtype, 2 )    \
+    ICV_DEF_ARR_STATS_ROW_FUNC( flavor, srctype, sumtype, sqsumtype, 3 )    \
+    ICV_DEF_ARR_STATS_ROW_FUNC( flavor, srctype, sumtype, sqsumtype, 4 )    \
+    ICV_DEF_ARR_STATS_ROW_FUNC_COI( flavor, srctype, sumtype, sqsumtype )   \
+    ICV_DEF_ARR_STATS_FIND_FUNC( flavor, srctype )
+
+ICV_DEF_ARR_STATS_ALL( 8u, uchar, int64, int64 )
+ICV_DEF_ARR_STATS_ALL( 8s, schar, int64, int64 )
+ICV_DEF_ARR_STATS_ALL( 16u, ushort, int64, int64 )
+ICV_DEF_ARR_STATS_ALL( 16s, short, int64, int64 )
+ICV_DEF_ARR_STATS_ALL( 32s, int, int64, double )
+ICV_DEF_ARR_STATS_ALL( 32f, float, double, double )
+ICV_DEF_ARR_STATS_ALL( 64f, double, double, double )
+
+#define ICV_ARR_STATS_TAB_ROW( suffix )                                             \
+    { (CvArrStatsRowFunc)icvArrStatsRow_8u_##suffix,                                \
+      (CvArrStatsRowFunc)icvArrStatsRow_8s_##suffix,                                \
+      (CvArrStatsRowFunc)icvArrStatsRow_16u_##suffix,                               \
+      (CvArrStatsRowFunc)icvArrStatsRow_16s_##suffix,                               \
+      (CvArrStatsRowFunc)icvArrStatsRow_32s_##suffix,                               \
+      (CvArrStatsRowFunc)icvArrStatsRow_32f_##suffix,                               \
+      (CvArrStatsRowFunc)icvArrStatsRow_64f_##suffix, 0 }
+
+/* [0] - the COI kernels, [cn] - the kernels for cn-channel arrays */
+static const CvArrStatsRowFunc icvArrStatsRowTab[5][8] =
+{
+    ICV_ARR_STATS_TAB_ROW( CnCR ), ICV_ARR_STATS_TAB_ROW( C1R ),
+    ICV_ARR_STATS_TAB_ROW( C2R ), ICV_ARR_STATS_TAB_ROW( C3R ),
+    ICV_ARR_STATS_TAB_ROW( C4R )
+};
+
+static const CvArrStatsFindFunc icvArrStatsFindTab[] =
+{
+    (CvArrStatsFindFunc)icvArrStatsFind_8u, (CvArrStatsFindFunc)icvArrStatsFind_8s,
+    (CvArrStatsFindFunc)icvArrStatsFind_16u, (CvArrStatsFindFunc)icvArrStatsFind_16s,
+    (CvArrStatsFindFunc)icvArrStatsFind_32s, (CvArrStatsFindFunc)icvArrStatsFind_32f,
+    (CvArrStatsFindFunc)icvArrStatsFind_64f, 0
+};
+
+
+/* Single-channel 8u rows: the sum, the sum of squares, the extrema, the non-zero count
+   and the number of the masked elements are computed in one pass, whatever is requested.
+   The 32-bit lanes of the sum of squares are flushed every ICV_STATS_8U_BLOCK bytes */
+#define ICV_STATS_8U_BLOCK  (1 << 15)
+
+static void
+icvArrStatsTail_8u_C1( const uchar* src, const uchar* mask, int x, int width,
+                       int64 s, int64 sq, int mn, int mx, int nz, int count,
+                       CvArrStatsRow* row )
+{
+    for( ; x < width; x++ )
+    {
+        int v = src[x];
+        if( mask && !mask[x] )
+            continue;
+        s += v; sq += v*v;
+        mn = MIN( mn, v ); mx = MAX( mx, v );
+        nz += v != 0; count++;
+    }
+
+    row->sum[0] = (double)s;
+    row->sqsum[0] = (double)sq;
+    row->min_val[0] = mn;
+    row->max_val[0] = mx;
+    row->nonzero[0] = nz;
+    row->count = count;
+}
+
+
+#if CV_SSE2
+
+static void CV_STDCALL
+icvArrStatsRow_8u_C1_SSE2( const uchar* src, const uchar* mask, int width,
+                           int, int, int, CvArrStatsRow* row )
+{
+    const __m128i z = _mm_setzero_si128(), one = _mm_set1_epi8( 1 );
+    __m128i vmin = _mm_set1_epi8( (char)255 ), vmax = z;
+    __m128i vs = z, vnz = z, vcount = z;
+    int64 s = 0, sq = 0;
+    int x = 0, count = 0, mn, mx;
+    int buf[4];
+    int64 buf64[2];
+
+    while( x <= width - 16 )
+    {
+        int end = MIN( width - 15, x + ICV_STATS_8U_BLOCK );
+        __m128i vsq = z;
+
+        for( ; x < end; x += 16 )
+        {
+            __m128i v = _mm_loadu_si128( (const __m128i*)(src + x) ), v0, v1;
+
+            if( mask )
+            {
+                __m128i m = _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i*)(mask + x) ), z );
+                vmin = _mm_min_epu8( vmin, _mm_or_si128( v, m ));
+                v = _mm_andnot_si128( m, v );
+                vcount = _mm_add_epi64( vcount, _mm_sad_epu8( _mm_andnot_si128( m, one ), z ));
+            }
+            else
+                vmin = _mm_min_epu8( vmin, v );
+            vmax = _mm_max_epu8( vmax, v );
+
+            vs = _mm_add_epi64( vs, _mm_sad_epu8( v, z ));
+            vnz = _mm_add_epi64( vnz, _mm_sad_epu8(
+                    _mm_andnot_si128( _mm_cmpeq_epi8( v, z ), one ), z ));
+
+            v0 = _mm_unpacklo_epi8( v, z );
+            v1 = _mm_unpackhi_epi8( v, z );
+            vsq = _mm_add_epi32( vsq, _mm_madd_epi16( v0, v0 ));
+            vsq = _mm_add_epi32( vsq, _mm_madd_epi16( v1, v1 ));
+        }
+
+        _mm_storeu_si128( (__m128i*)buf, vsq );
+        sq += (int64)(unsigned)buf[0] + (unsigned)buf[1] + (unsigned)buf[2] + (unsigned)buf[3];
+    }
+
+    vmin = _mm_min_epu8( vmin, _mm_srli_si128( vmin, 8 ));
+    vmin = _mm_min_epu8( vmin, _mm_srli_si128( vmin, 4 ));
+    vmin = _mm_min_epu8( vmin, _mm_srli_si128( vmin, 2 ));
+    vmin = _mm_min_epu8( vmin, _mm_srli_si128( vmin, 1 ));
+    vmax = _mm_max_epu8( vmax, _mm_srli_si128( vmax, 8 ));
+    vmax = _mm_max_epu8( vmax, _mm_srli_si128( vmax, 4 ));
+    vmax = _mm_max_epu8( vmax, _mm_srli_si128( vmax, 2 ));
+    vmax = _mm_max_epu8( vmax, _mm_srli_si128( vmax, 1 ));
+    mn = _mm_cvtsi128_si32( vmin ) & 255;
+    mx = _mm_cvtsi128_si32( vmax ) & 255;
+
+    vs = _mm_add_epi64( vs, _mm_srli_si128( vs, 8 ));
+    vnz = _mm_add_epi64( vnz, _mm_srli_si128( vnz, 8 ));
+    vcount = _mm_add_epi64( vcount, _mm_srli_si128( vcount, 8 ));
+    _mm_storeu_si128( (__m128i*)buf64, vs );
+    s = buf64[0];
+    count = mask ? _mm_cvtsi128_si32( vcount ) : x;
+
+    icvArrStatsTail_8u_C1( src, mask, x, width, s, sq, mn, mx,
+                           _mm_cvtsi128_si32( vnz ), count, row );
+}
+
+#endif
+
+
+#if CV_NEON
+
+static void CV_STDCALL
+icvArrStatsRow_8u_C1_NEON( const uchar* src, const uchar* mask, int width,
+                           int, int, int, CvArrStatsRow* row )
+{
+    const uint8x16_t one = vdupq_n_u8( 1 );
+    uint8x16_t vmin = vdupq_n_u8( 255 ), vmax = vdupq_n_u8( 0 );
+    uint8x8_t m8;
+    int64 s = 0, sq = 0, nz = 0, count = 0;
+    int x = 0, mn, mx;
+
+    while( x <= width - 16 )
+    {
+        int end = MIN( width - 15, x + ICV_STATS_8U_BLOCK );
+        uint32x4_t vs = vdupq_n_u32( 0 ), vsq = vs, vnz = vs, vcount = vs;
+        uint64x2_t t;
+
+        for( ; x < end; x += 16 )
+        {
+            uint8x16_t v = vld1q_u8( src + x );
+
+            if( mask )
+            {
+                uint8x16_t m = vld1q_u8( mask + x );
+                m = vtstq_u8( m, m );
+                vmin = vminq_u8( vmin, vornq_u8( v, m ));
+                v = vandq_u8( v, m );
+                vcount = vpadalq_u16( vcount, vpaddlq_u8( vandq_u8( m, one )));
+            }
+            else
+                vmin = vminq_u8( vmin, v );
+            vmax = vmaxq_u8( vmax, v );
+
+            vs = vpadalq_u16( vs, vpaddlq_u8( v ));
+            vnz = vpadalq_u16( vnz, vpaddlq_u8( vandq_u8( vtstq_u8( v, v ), one )));
+            vsq = vpadalq_u16( vsq, vmull_u8( vget_low_u8( v ), vget_low_u8( v )));
+            vsq = vpadalq_u16( vsq, vmull_u8( vget_high_u8( v ), vget_high_u8( v )));
+        }
+
+        t = vpaddlq_u32( vs );
+        s += vgetq_lane_u64( t, 0 ) + vgetq_lane_u64( t, 1 );
+        t = vpaddlq_u32( vsq );
+        sq += vgetq_lane_u64( t, 0 ) + vgetq_lane_u64( t, 1 );
+        t = vpaddlq_u32( vnz );
+        nz += vgetq_lane_u64( t, 0 ) + vgetq_lane_u64( t, 1 );
+        t = vpaddlq_u32( vcount );
+        count += vgetq_lane_u64( t, 0 ) + vgetq_lane_u64( t, 1 );
+    }
+
+    m8 = vpmin_u8( vget_low_u8( vmin ), vget_high_u8( vmin ));
+    m8 = vpmin_u8( m8, m8 ); m8 = vpmin_u8( m8, m8 ); m8 = vpmin_u8( m8, m8 );
+    mn = vget_lane_u8( m8, 0 );
+    m8 = vpmax_u8( vget_low_u8( vmax ), vget_high_u8( vmax ));
+    m8 = vpmax_u8( m8, m8 ); m8 = vpmax_u8( m8, m8 ); m8 = vpmax_u8( m8, m8 );
+    mx = vget_lane_u8( m8, 0 );
+
+    icvArrStatsTail_8u_C1( src, mask, x, width, s, sq, mn, mx,
+                           (int)nz, mask ? (int)count : x, row );
+}
+
+#endif
+
+
+static const CvDispatchVariant icvArrStats_8u_C1_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvArrStatsRow_8u_C1_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvArrStatsRow_8u_C1_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvArrStatsRow_8u_C1R, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvArrStats_8u_C1_entry =
+    CV_DISPATCH_ENTRY( "cvCalcArrStats_8u_C1", icvArrStats_8u_C1_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvArrStats_8u_C1_entry );
+
+
+typedef struct CvArrStatsParams
+{
+    const uchar* src;
+    const uchar* mask;
+    int step, mask_step;
+    int rows, width, cn, pcn;
+    int flags;
+    int nstripes;
+    CvArrStatsRowFunc func;
+    CvArrStatsAcc* acc;
+}
+CvArrStatsParams;
+
+
+/* processes the stripes [start, end); each stripe has its own accumulator,
+   so the result does not depend on the number of threads */
+static void CV_CDECL
+icvArrStatsBody( int start, int end, void* userdata )
+{
+    const CvArrStatsParams* p = (const CvArrStatsParams*)userdata;
+    int i, y, c, cn = p->cn;
+
+    for( i = start; i < end; i++ )
+    {
+        CvArrStatsAcc* acc = p->acc + i;
+        int y0 = (int)((int64)i*p->rows/p->nstripes);
+        int y1 = (int)((int64)(i+1)*p->rows/p->nstripes);
+
+        memset( acc, 0, sizeof(*acc) );
+        for( c = 0; c < 4; c++ )
+            acc->min_y[c] = acc->max_y[c] = -1;
+
+        for( y = y0; y < y1; y++ )
+        {
+            CvArrStatsRow row;
+            memset( &row, 0, sizeof(row) );
+
+            p->func( p->src + (size_t)y*p->step, p->mask ? p->mask + (size_t)y*p->mask_step : 0,
+                     p->width, cn, p->pcn, p->flags, &row );
+            if( row.count == 0 )
+                continue;
+
+            acc->count += row.count;
+            for( c = 0; c < cn; c++ )
+            {
+                acc->sum[c] += row.sum[c];
+                acc->sqsum[c] += row.sqsum[c];
+                acc->abssum[c] += row.abssum[c];
+                acc->nonzero[c] += row.nonzero[c];
+
+                // the first row with the smallest/the largest value wins
+                if( acc->min_y[c] < 0 || row.min_val[c] < acc->min_val[c] )
+                    acc->min_val[c] = row.min_val[c], acc->min_y[c] = y;
+                if( acc->max_y[c] < 0 || row.max_val[c] > acc->max_val[c] )
+                    acc->max_val[c] = row.max_val[c], acc->max_y[c] = y;
+            }
+        }
+    }
+}
+
+
+CV_IMPL void
+cvCalcArrStats( const CvArr* arr, CvArrStats* stats, int flags, const CvArr* maskarr )
+{
+    CV_FUNCNAME( "cvCalcArrStats" );
+
+    __BEGIN__;
+
+    CvArrStatsAcc acc_buf[ICV_STATS_MAX_STRIPES], total;
+    CvArrStatsParams p;
+    CvMat stub, maskstub, *mat = (CvMat*)arr, *mask = (CvMat*)maskarr;
+    int type, depth, cn, coi = 0, i, c, row_flags = 0;
+    double count, norm_l2 = 0;
+
+    if( !stats )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( flags & ~CV_STAT_ALL )
+        CV_ERROR( CV_StsBadFlag, "Unknown statistics are requested" );
+
+    if( !CV_IS_MAT(mat) )
+        CV_CALL( mat = cvGetMat( mat, &stub, &coi ));
+
+    type = CV_MAT_TYPE( mat->type );
+    depth = CV_MAT_DEPTH( type );
+    cn = CV_MAT_CN( type );
+
+    if( !icvArrStatsRowTab[1][depth] )
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+
+    if( cn > 4 && coi == 0 )
+        CV_ERROR( CV_StsOutOfRange, "The array must have at most 4 channels or the COI set" );
+
+    if( mask )
+    {
+        CV_CALL( mask = cvGetMat( mask, &maskstub ));
+
+        if( !CV_IS_MASK_ARR( mask ))
+            CV_ERROR( CV_StsBadMask, "" );
+
+        if( !CV_ARE_SIZES_EQ( mat, mask ))
+            CV_ERROR( CV_StsUnmatchedSizes, "" );
+    }
+
+    if( flags & (CV_STAT_SUM | CV_STAT_SQSUM) )
+        row_flags |= ICV_STATS_SUM;
+    if( flags & (CV_STAT_SQSUM | CV_STAT_NORM_L2) )
+        row_flags |= ICV_STATS_SQSUM;
+    if( flags & (CV_STAT_MINMAX | CV_STAT_NORM_INF) )
+        row_flags |= ICV_STATS_MINMAX;
+    if( flags & CV_STAT_NONZERO )
+        row_flags |= ICV_STATS_NONZERO;
+    if( flags & CV_STAT_NORM_L1 )
+        row_flags |= depth == CV_8U || depth == CV_16U ? ICV_STATS_SUM : ICV_STATS_ABSSUM;
+
+    p.src = mat->data.ptr;
+    p.step = mat->step;
+    p.mask = mask ? mask->data.ptr : 0;
+    p.mask_step = mask ? mask->step : 0;
+    p.rows = mat->rows;
+    p.width = mat->cols;
+    p.pcn = cn;
+    p.cn = cn;
+    p.flags = row_flags;
+
+    if( coi > 0 && cn > 1 )
+    {
+        p.src += (coi - 1)*CV_ELEM_SIZE1(depth);
+        p.cn = 1;
+        p.func = icvArrStatsRowTab[0][depth];
+    }
+    else if( cn == 1 && depth == CV_8U )
+        p.func = (CvArrStatsRowFunc)cvGetDispatchFunc( &icvArrStats_8u_C1_entry );
+    else
+        p.func = icvArrStatsRowTab[cn][depth];
+
+    p.nstripes = (int)MIN( (int64)p.rows*p.width*p.pcn/ICV_STATS_STRIPE_SIZE,
+                           (int64)MIN( p.rows, ICV_STATS_MAX_STRIPES ));
+    p.nstripes = MAX( p.nstripes, 1 );
+    p.acc = acc_buf;
+
+    cvParallelFor( p.nstripes, icvArrStatsBody, &p );
+
+    // merge the stripes in order
+    total = acc_buf[0];
+    for( i = 1; i < p.nstripes; i++ )
+    {
+        const CvArrStatsAcc* a = acc_buf + i;
+        total.count += a->count;
+        for( c = 0; c < p.cn; c++ )
+        {
+            total.sum[c] += a->sum[c];
+            total.sqsum[c] += a->sqsum[c];
+            total.abssum[c] += a->abssum[c];
+            total.nonzero[c] += a->nonzero[c];
+
+            if( a->min_y[c] >= 0 && (total.min_y[c] < 0 || a->min_val[c] < total.min_val[c]) )
+                total.min_val[c] = a->min_val[c], total.min_y[c] = a->min_y[c];
+            if( a->max_y[c] >= 0 && (total.max_y[c] < 0 || a->max_val[c] > total.max_val[c]) )
+                total.max_val[c] = a->max_val[c], total.max_y[c] = a->max_y[c];
+        }
+    }
+
+    memset( stats, 0, sizeof(*stats) );
+    count = total.count;
+    stats->count = cvRound( count );
+
+    for( c = 0; c < p.cn; c++ )
+    {
+        if( flags & (CV_STAT_SUM | CV_STAT_SQSUM) )
+        {
+            stats->sum.val[c] = total.sum[c];
+            stats->mean.val[c] = count > 0 ? total.sum[c]/count : 0;
+        }
+
+        if( flags & CV_STAT_SQSUM )
+        {
+            double m = stats->mean.val[c];
+            stats->sqsum.val[c] = total.sqsum[c];
+            stats->sdv.val[c] = count > 0 ? sqrt( MAX( total.sqsum[c]/count - m*m, 0. )) : 0;
+        }
+
+        if( flags & CV_STAT_NONZERO )
+            stats->nonzero.val[c] = total.nonzero[c];
+
+        if( flags & CV_STAT_NORM_L1 )
+            stats->norm_l1 += row_flags & ICV_STATS_ABSSUM ? total.abssum[c] : total.sum[c];
+
+        norm_l2 += total.sqsum[c];
+
+        if( (flags & CV_STAT_NORM_INF) && count > 0 )
+        {
+            double a = MAX( fabs(total.min_val[c]), fabs(total.max_val[c]) );
+            stats->norm_inf = MAX( stats->norm_inf, a );
+        }
+
+        if( flags & CV_STAT_MINMAX )
+        {
+            CvArrStatsFindFunc find = icvArrStatsFindTab[depth];
+
+            stats->min_loc[c] = stats->max_loc[c] = cvPoint( -1, -1 );
+            if( count == 0 )
+                continue;
+
+            // only the rows that hold the extrema are scanned again
+            stats->min_val.val[c] = total.min_val[c];
+            stats->max_val.val[c] = total.max_val[c];
+            stats->min_loc[c].y = total.min_y[c];
+            stats->min_loc[c].x = find( p.src + (size_t)total.min_y[c]*p.step + c*CV_ELEM_SIZE1(depth),
+                                        p.mask ? p.mask + (size_t)total.min_y[c]*p.mask_step : 0,
+                                        p.width, p.pcn, total.min_val[c] );
+            stats->max_loc[c].y = total.max_y[c];
+            stats->max_loc[c].x = find( p.src + (size_t)total.max_y[c]*p.step + c*CV_ELEM_SIZE1(depth),
+                                        p.mask ? p.mask + (size_t)total.max_y[c]*p.mask_step : 0,
+                                        p.width, p.pcn, total.max_val[c] );
+        }
+    }
+
+    if( flags & CV_STAT_NORM_L2 )
+        stats->norm_l2 = sqrt( norm_l2 );
+
+    __END__;
+}
+
+/*  End of file  */
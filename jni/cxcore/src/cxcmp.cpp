@@ -260,10 +260,10 @@ cvInRange( const void* srcarr1, const void* srcarr2,
     CvSize size;
     CvFunc2D_4A func;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitInRangeRTable( &inrange_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(src1) )
@@ -358,10 +358,10 @@ cvInRangeS( const void* srcarr, CvScalar lower, CvScalar upper, void* dstarr )
     CvInRangeCFunc func;
     double buf[8];
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitInRangeCRTable( &inrange_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(src1) )
@@ -571,11 +571,11 @@ cvCmp( const void* srcarr1, const void* srcarr2,
     CvSize size;
     CvFunc2D_3A func;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitCmpGTC1RTable( &cmp_tab[0] );
         icvInitCmpEQC1RTable( &cmp_tab[1] );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(src1) )
@@ -707,12 +707,12 @@ cvCmpS( const void* srcarr, double value, void* dstarr, int cmp_op )
     CvSize size;
     int ival = 0;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitCmpEQCC1RTable( &cmps_tab[CV_CMP_EQ] );
         icvInitCmpGTCC1RTable( &cmps_tab[CV_CMP_GT] );
         icvInitCmpGECC1RTable( &cmps_tab[CV_CMP_GE] );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(src1) )
@@ -978,11 +978,11 @@ icvMinMax( const void* srcarr1, const void* srcarr2,
     CvSize size;
     CvFunc2D_3A func;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitMinC1RTable( &minmax_tab[0] );
         icvInitMaxC1RTable( &minmax_tab[1] );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(src1) )
@@ -1085,11 +1085,11 @@ icvMinMaxS( const void* srcarr, double value, void* dstarr, int is_max )
     }
     buf;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitMinCC1RTable( &minmaxs_tab[0] );
         icvInitMaxCC1RTable( &minmaxs_tab[1] );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(src1) )
@@ -1429,10 +1429,10 @@ cvAbsDiff( const void* srcarr1, const void* srcarr2, void* dstarr )
     CvSize size;
     int type;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitAbsDiffTable( &adiff_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     CV_CALL( src1 = cvGetMat( src1, &srcstub1, &coi1 ));
@@ -1503,10 +1503,10 @@ cvAbsDiffS( const void* srcarr, void* dstarr, CvScalar scalar )
     double buf[12];
     CvSize size;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitAbsDiffCTable( &adiffs_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     CV_CALL( src = cvGetMat( src, &srcstub, &coi1 ));
@@ -449,11 +449,11 @@ cvSplit( const void* srcarr, void* dstarr0, void* dstarr1, void* dstarr2, void*
     int cont_flag;
     int src_step, dst_step = 0;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitSplitRTable( &pxpl_tab );
         icvInitSplitRCoiTable( &pxplcoi_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     dst[0] = (CvMat*)dstarr0;
@@ -558,11 +558,11 @@ cvMerge( const void* srcarr0, const void* srcarr1, const void* srcarr2,
     int i, nzplanes = 0, nzidx = -1;
     int cont_flag;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitCvtPlaneToPixRTable( &plpx_tab );
         icvInitCvtPlaneToPixRCoiTable( &plpxcoi_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     src[0] = (CvMat*)srcarr0;
@@ -743,10 +743,10 @@ cvMixChannels( const CvArr** src, int src_count,
     int cont_flag = CV_MAT_CONT_FLAG;
     CvMixChannelsFunc func;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitMixChannelsTab( &mixcn_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     src_count = MAX( src_count, 0 );
@@ -991,7 +991,7 @@ icvCvtScaleAbsTo_8u_C1R( const uchar* src, int srcstep,
         {
             int iscale = cvRound(scale*(1 << ICV_FIX_SHIFT));
 
-            if( iscale == ICV_FIX_SHIFT )
+            if( iscale == 1 << ICV_FIX_SHIFT )
             {
                 ICV_DEF_CVT_SCALE_ABS_CASE( ushort, int, CV_NOP, CV_IABS,
                                             CV_CAST_8U, 1, 0 );
@@ -1015,7 +1015,7 @@ icvCvtScaleAbsTo_8u_C1R( const uchar* src, int srcstep,
             int iscale = cvRound(scale*(1 << ICV_FIX_SHIFT));
             int ishift = cvRound(shift*(1 << ICV_FIX_SHIFT));
 
-            if( iscale == ICV_FIX_SHIFT && ishift == 0 )
+            if( iscale == 1 << ICV_FIX_SHIFT && ishift == 0 )
             {
                 ICV_DEF_CVT_SCALE_ABS_CASE( short, int, CV_NOP, CV_IABS,
                                             CV_CAST_8U, 1, 0 );
@@ -1053,6 +1053,155 @@ icvCvtScaleAbsTo_8u_C1R( const uchar* src, int srcstep,
 }
 
 
+/* 16s->8u conversion with abs() (e.g. visualization of Sobel output).
+   In the |scale| <= 1 range the C code above uses 17.15 fixed-point arithmetic,
+   which the SIMD variants reproduce bit-exactly; other scale values go the C way. */
+static CvStatus CV_STDCALL
+icvCvtScaleAbs_16s8u_C1R_C( const short* src, int srcstep,
+                            uchar* dst, int dststep, CvSize size,
+                            double scale, double shift )
+{
+    return icvCvtScaleAbsTo_8u_C1R( (const uchar*)src, srcstep, dst, dststep,
+                                    size, scale, shift, CV_16SC1 );
+}
+
+#define ICV_CVT_SCALE_ABS_16S_FIX( scale, shift )  \
+    (fabs( scale ) <= 1. && fabs( shift ) <= (INT_MAX*0.5)/(1 << ICV_FIX_SHIFT))
+
+#if CV_SSE2
+
+// x*iscale is computed exactly by _mm_madd_epi16 as x*a0 + x*a1, a0 + a1 == iscale,
+// since iscale itself (up to 1 << 15) does not fit into 16 bits
+static CvStatus CV_STDCALL
+icvCvtScaleAbs_16s8u_C1R_SSE2( const short* src, int srcstep,
+                               uchar* dst, int dststep, CvSize size,
+                               double scale, double shift )
+{
+    int iscale, ishift, a0, a1;
+    __m128i k, delta;
+
+    if( !ICV_CVT_SCALE_ABS_16S_FIX( scale, shift ))
+        return icvCvtScaleAbs_16s8u_C1R_C( src, srcstep, dst, dststep,
+                                           size, scale, shift );
+
+    iscale = cvRound(scale*(1 << ICV_FIX_SHIFT));
+    ishift = cvRound(shift*(1 << ICV_FIX_SHIFT));
+    a0 = iscale/2;
+    a1 = iscale - a0;
+    k = _mm_set1_epi32( (int)(((unsigned)a1 << 16) | (a0 & 0xffff)) );
+    delta = _mm_set1_epi32( ishift + (1 << (ICV_FIX_SHIFT-1)) );
+    srcstep /= sizeof(src[0]);
+
+    for( ; size.height--; src += srcstep, dst += dststep )
+    {
+        int i;
+
+        for( i = 0; i <= size.width - 16; i += 16 )
+        {
+            __m128i v0 = _mm_loadu_si128( (const __m128i*)(src + i) );
+            __m128i v1 = _mm_loadu_si128( (const __m128i*)(src + i + 8) );
+            __m128i t0 = _mm_madd_epi16( _mm_unpacklo_epi16( v0, v0 ), k );
+            __m128i t1 = _mm_madd_epi16( _mm_unpackhi_epi16( v0, v0 ), k );
+            __m128i t2 = _mm_madd_epi16( _mm_unpacklo_epi16( v1, v1 ), k );
+            __m128i t3 = _mm_madd_epi16( _mm_unpackhi_epi16( v1, v1 ), k );
+            __m128i s;
+
+            t0 = _mm_srai_epi32( _mm_add_epi32( t0, delta ), ICV_FIX_SHIFT );
+            t1 = _mm_srai_epi32( _mm_add_epi32( t1, delta ), ICV_FIX_SHIFT );
+            t2 = _mm_srai_epi32( _mm_add_epi32( t2, delta ), ICV_FIX_SHIFT );
+            t3 = _mm_srai_epi32( _mm_add_epi32( t3, delta ), ICV_FIX_SHIFT );
+
+            s = _mm_srai_epi32( t0, 31 ); t0 = _mm_sub_epi32( _mm_xor_si128( t0, s ), s );
+            s = _mm_srai_epi32( t1, 31 ); t1 = _mm_sub_epi32( _mm_xor_si128( t1, s ), s );
+            s = _mm_srai_epi32( t2, 31 ); t2 = _mm_sub_epi32( _mm_xor_si128( t2, s ), s );
+            s = _mm_srai_epi32( t3, 31 ); t3 = _mm_sub_epi32( _mm_xor_si128( t3, s ), s );
+
+            _mm_storeu_si128( (__m128i*)(dst + i),
+                _mm_packus_epi16( _mm_packs_epi32( t0, t1 ), _mm_packs_epi32( t2, t3 )));
+        }
+
+        for( ; i < size.width; i++ )
+        {
+            int t = ICV_SCALE( iscale*src[i] + ishift );
+            t = CV_IABS(t);
+            dst[i] = CV_CAST_8U(t);
+        }
+    }
+
+    return CV_OK;
+}
+
+#endif
+
+
+#if CV_NEON
+
+static CvStatus CV_STDCALL
+icvCvtScaleAbs_16s8u_C1R_NEON( const short* src, int srcstep,
+                               uchar* dst, int dststep, CvSize size,
+                               double scale, double shift )
+{
+    int iscale, ishift;
+    int32x4_t delta;
+
+    if( !ICV_CVT_SCALE_ABS_16S_FIX( scale, shift ))
+        return icvCvtScaleAbs_16s8u_C1R_C( src, srcstep, dst, dststep,
+                                           size, scale, shift );
+
+    iscale = cvRound(scale*(1 << ICV_FIX_SHIFT));
+    ishift = cvRound(shift*(1 << ICV_FIX_SHIFT));
+    delta = vdupq_n_s32( ishift + (1 << (ICV_FIX_SHIFT-1)) );
+    srcstep /= sizeof(src[0]);
+
+    for( ; size.height--; src += srcstep, dst += dststep )
+    {
+        int i;
+
+        for( i = 0; i <= size.width - 8; i += 8 )
+        {
+            int16x8_t v = vld1q_s16( src + i );
+            int32x4_t t0 = vmlaq_n_s32( delta, vmovl_s16( vget_low_s16( v )), iscale );
+            int32x4_t t1 = vmlaq_n_s32( delta, vmovl_s16( vget_high_s16( v )), iscale );
+
+            t0 = vabsq_s32( vshrq_n_s32( t0, ICV_FIX_SHIFT ));
+            t1 = vabsq_s32( vshrq_n_s32( t1, ICV_FIX_SHIFT ));
+            vst1_u8( dst + i, vqmovn_u16( vcombine_u16( vqmovun_s32( t0 ), vqmovun_s32( t1 ))));
+        }
+
+        for( ; i < size.width; i++ )
+        {
+            int t = ICV_SCALE( iscale*src[i] + ishift );
+            t = CV_IABS(t);
+            dst[i] = CV_CAST_8U(t);
+        }
+    }
+
+    return CV_OK;
+}
+
+#endif
+
+
+static const CvDispatchVariant icvCvtScaleAbs_16s8u_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvCvtScaleAbs_16s8u_C1R_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvCvtScaleAbs_16s8u_C1R_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvCvtScaleAbs_16s8u_C1R_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvCvtScaleAbs_16s8u_entry =
+    CV_DISPATCH_ENTRY( "cvConvertScaleAbs_16s8u", icvCvtScaleAbs_16s8u_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvCvtScaleAbs_16s8u_entry );
+
+typedef CvStatus (CV_STDCALL *CvCvtScaleAbs16sFunc)( const short* src, int srcstep,
+                                                     uchar* dst, int dststep, CvSize size,
+                                                     double scale, double shift );
+
+
 CV_IMPL void
 cvConvertScaleAbs( const void* srcarr, void* dstarr,
                    double scale, double shift )
@@ -1093,6 +1242,17 @@ cvConvertScaleAbs( const void* srcarr, void* dstarr,
         size.height = 1;
     }
 
+    if( CV_MAT_DEPTH( src->type ) == CV_16S )
+    {
+        CvCvtScaleAbs16sFunc func =
+            (CvCvtScaleAbs16sFunc)cvGetDispatchFunc( &icvCvtScaleAbs_16s8u_entry );
+        size.width *= CV_MAT_CN( src->type );
+
+        IPPI_CALL( func( (const short*)(src->data.ptr), src_step,
+                         (uchar*)(dst->data.ptr), dst_step, size, scale, shift ));
+        EXIT;
+    }
+
     IPPI_CALL( icvCvtScaleAbsTo_8u_C1R( src->data.ptr, src_step,
                              (uchar*)(dst->data.ptr), dst_step,
                              size, scale, shift, CV_MAT_TYPE(src->type)));
@@ -1491,6 +1651,396 @@ typedef  CvStatus (CV_STDCALL *CvCvtScaleFunc)( const void* src, int srcstep,
                                              double scale, double shift,
                                              int param );
 
+/* Vectorized kernels for the depth pairs that are converted most often
+   (8u->16s and 8u->32f before filtering, 32f->8u for the output).
+   The C variants are the generic functions above, so a variant
+   that cannot reproduce the C results for some scale/shift
+   just calls its C counterpart. */
+typedef CvStatus (CV_STDCALL *CvCvtScalePairFunc)( const void* src, int srcstep,
+                                                   void* dst, int dststep, CvSize size,
+                                                   double scale, double shift );
+
+#define ICV_DEF_CVT_SCALE_PAIR_FUNC_C( flavor, dstflavor, srctype, dsttype, srcdepth )  \
+static CvStatus CV_STDCALL                                                          \
+icvCvtScale_##flavor##_C1R_C( const srctype* src, int srcstep,                      \
+                              dsttype* dst, int dststep, CvSize size,               \
+                              double scale, double shift )                          \
+{                                                                                   \
+    if( scale == 1 && shift == 0 )                                                  \
+        return icvCvtTo_##dstflavor##_C1R( (const uchar*)src, srcstep,              \
+                                           dst, dststep, size, srcdepth );          \
+    return icvCvtScaleTo_##dstflavor##_C1R( (const uchar*)src, srcstep, dst,        \
+                                            dststep, size, scale, shift, srcdepth );\
+}
+
+ICV_DEF_CVT_SCALE_PAIR_FUNC_C( 8u16s, 16s, uchar, short, CV_8U )
+ICV_DEF_CVT_SCALE_PAIR_FUNC_C( 8u32f, 32f, uchar, float, CV_8U )
+ICV_DEF_CVT_SCALE_PAIR_FUNC_C( 32f8u, 8u, float, uchar, CV_32F )
+
+/* 8u->16s is done in integer arithmetic with saturation when the scale and
+   the shift are 16-bit integers (in particular, for plain conversion);
+   this gives exactly the same results as the look-up table used by the C code */
+#define ICV_CVT_SCALE_8U16S_INT( scale, shift, iscale, ishift )         \
+    ((iscale) == (scale) && (ishift) == (shift) &&                      \
+     (unsigned)((iscale) + 32768) <= 65535 &&                           \
+     (unsigned)((ishift) + 32768) <= 65535)
+
+#if CV_SSE2
+
+static CvStatus CV_STDCALL
+icvCvtScale_8u16s_C1R_SSE2( const uchar* src, int srcstep,
+                            short* dst, int dststep, CvSize size,
+                            double scale, double shift )
+{
+    int iscale = cvRound(scale), ishift = cvRound(shift);
+    __m128i z = _mm_setzero_si128(), one = _mm_set1_epi16(1), k;
+
+    if( !ICV_CVT_SCALE_8U16S_INT( scale, shift, iscale, ishift ))
+        return icvCvtScale_8u16s_C1R_C( src, srcstep, dst, dststep,
+                                        size, scale, shift );
+
+    // (x, 1) pairs multiplied by (iscale, ishift) give x*iscale + ishift
+    k = _mm_set1_epi32( (int)(((unsigned)ishift << 16) | (iscale & 0xffff)) );
+    dststep /= sizeof(dst[0]);
+
+    for( ; size.height--; src += srcstep, dst += dststep )
+    {
+        int i = 0;
+
+        if( iscale == 1 && ishift == 0 )
+        {
+            for( ; i <= size.width - 16; i += 16 )
+            {
+                __m128i v = _mm_loadu_si128( (const __m128i*)(src + i) );
+                _mm_storeu_si128( (__m128i*)(dst + i), _mm_unpacklo_epi8( v, z ));
+                _mm_storeu_si128( (__m128i*)(dst + i + 8), _mm_unpackhi_epi8( v, z ));
+            }
+        }
+        else
+        {
+            for( ; i <= size.width - 16; i += 16 )
+            {
+                __m128i v = _mm_loadu_si128( (const __m128i*)(src + i) );
+                __m128i v0 = _mm_unpacklo_epi8( v, z ), v1 = _mm_unpackhi_epi8( v, z );
+                __m128i t0 = _mm_madd_epi16( _mm_unpacklo_epi16( v0, one ), k );
+                __m128i t1 = _mm_madd_epi16( _mm_unpackhi_epi16( v0, one ), k );
+                __m128i t2 = _mm_madd_epi16( _mm_unpacklo_epi16( v1, one ), k );
+                __m128i t3 = _mm_madd_epi16( _mm_unpackhi_epi16( v1, one ), k );
+
+                _mm_storeu_si128( (__m128i*)(dst + i), _mm_packs_epi32( t0, t1 ));
+                _mm_storeu_si128( (__m128i*)(dst + i + 8), _mm_packs_epi32( t2, t3 ));
+            }
+        }
+
+        for( ; i < size.width; i++ )
+        {
+            int t = src[i]*iscale + ishift;
+            dst[i] = CV_CAST_16S(t);
+        }
+    }
+
+    return CV_OK;
+}
+
+
+// the products are computed in single precision,
+// so the results may differ from the C ones in the last bit
+static CvStatus CV_STDCALL
+icvCvtScale_8u32f_C1R_SSE2( const uchar* src, int srcstep,
+                            float* dst, int dststep, CvSize size,
+                            double scale, double shift )
+{
+    float fscale = (float)scale, fshift = (float)shift;
+    int no_scale = scale == 1 && shift == 0;
+    __m128 a = _mm_set1_ps( fscale ), b = _mm_set1_ps( fshift );
+    __m128i z = _mm_setzero_si128();
+
+    dststep /= sizeof(dst[0]);
+
+    for( ; size.height--; src += srcstep, dst += dststep )
+    {
+        int i;
+
+        for( i = 0; i <= size.width - 16; i += 16 )
+        {
+            __m128i v = _mm_loadu_si128( (const __m128i*)(src + i) );
+            __m128i v0 = _mm_unpacklo_epi8( v, z ), v1 = _mm_unpackhi_epi8( v, z );
+            __m128 f0 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( v0, z ));
+            __m128 f1 = _mm_cvtepi32_ps( _mm_unpackhi_epi16( v0, z ));
+            __m128 f2 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( v1, z ));
+            __m128 f3 = _mm_cvtepi32_ps( _mm_unpackhi_epi16( v1, z ));
+
+            if( !no_scale )
+            {
+                f0 = _mm_add_ps( _mm_mul_ps( f0, a ), b );
+                f1 = _mm_add_ps( _mm_mul_ps( f1, a ), b );
+                f2 = _mm_add_ps( _mm_mul_ps( f2, a ), b );
+                f3 = _mm_add_ps( _mm_mul_ps( f3, a ), b );
+            }
+
+            _mm_storeu_ps( dst + i, f0 );
+            _mm_storeu_ps( dst + i + 4, f1 );
+            _mm_storeu_ps( dst + i + 8, f2 );
+            _mm_storeu_ps( dst + i + 12, f3 );
+        }
+
+        for( ; i < size.width; i++ )
+            dst[i] = no_scale ? (float)src[i] : src[i]*fscale + fshift;
+    }
+
+    return CV_OK;
+}
+
+
+// _mm_cvtps_epi32 and _mm_cvtpd_epi32 round to the nearest even integer,
+// just like cvRound; scaling is done in double precision, as in the C code
+static CvStatus CV_STDCALL
+icvCvtScale_32f8u_C1R_SSE2( const float* src, int srcstep,
+                            uchar* dst, int dststep, CvSize size,
+                            double scale, double shift )
+{
+    int no_scale = scale == 1 && shift == 0;
+    __m128d a = _mm_set1_pd( scale ), b = _mm_set1_pd( shift );
+
+    srcstep /= sizeof(src[0]);
+
+    for( ; size.height--; src += srcstep, dst += dststep )
+    {
+        int i = 0;
+
+        if( no_scale )
+        {
+            for( ; i <= size.width - 16; i += 16 )
+            {
+                __m128i t0 = _mm_packs_epi32( _mm_cvtps_epi32( _mm_loadu_ps( src + i )),
+                                              _mm_cvtps_epi32( _mm_loadu_ps( src + i + 4 )));
+                __m128i t1 = _mm_packs_epi32( _mm_cvtps_epi32( _mm_loadu_ps( src + i + 8 )),
+                                              _mm_cvtps_epi32( _mm_loadu_ps( src + i + 12 )));
+                _mm_storeu_si128( (__m128i*)(dst + i), _mm_packus_epi16( t0, t1 ));
+            }
+        }
+        else
+        {
+            for( ; i <= size.width - 8; i += 8 )
+            {
+                __m128 f0 = _mm_loadu_ps( src + i ), f1 = _mm_loadu_ps( src + i + 4 );
+                __m128i t0 = _mm_cvtpd_epi32( _mm_add_pd( _mm_mul_pd( _mm_cvtps_pd( f0 ), a ), b ));
+                __m128i t1 = _mm_cvtpd_epi32( _mm_add_pd( _mm_mul_pd(
+                                _mm_cvtps_pd( _mm_movehl_ps( f0, f0 )), a ), b ));
+                __m128i t2 = _mm_cvtpd_epi32( _mm_add_pd( _mm_mul_pd( _mm_cvtps_pd( f1 ), a ), b ));
+                __m128i t3 = _mm_cvtpd_epi32( _mm_add_pd( _mm_mul_pd(
+                                _mm_cvtps_pd( _mm_movehl_ps( f1, f1 )), a ), b ));
+
+                t0 = _mm_packs_epi32( _mm_unpacklo_epi64( t0, t1 ), _mm_unpacklo_epi64( t2, t3 ));
+                _mm_storel_epi64( (__m128i*)(dst + i), _mm_packus_epi16( t0, t0 ));
+            }
+        }
+
+        for( ; i < size.width; i++ )
+        {
+            int t = cvRound( src[i]*scale + shift );
+            dst[i] = CV_CAST_8U(t);
+        }
+    }
+
+    return CV_OK;
+}
+
+#endif
+
+
+#if CV_NEON
+
+static CvStatus CV_STDCALL
+icvCvtScale_8u16s_C1R_NEON( const uchar* src, int srcstep,
+                            short* dst, int dststep, CvSize size,
+                            double scale, double shift )
+{
+    int iscale = cvRound(scale), ishift = cvRound(shift);
+    int32x4_t b;
+
+    if( !ICV_CVT_SCALE_8U16S_INT( scale, shift, iscale, ishift ))
+        return icvCvtScale_8u16s_C1R_C( src, srcstep, dst, dststep,
+                                        size, scale, shift );
+
+    b = vdupq_n_s32( ishift );
+    dststep /= sizeof(dst[0]);
+
+    for( ; size.height--; src += srcstep, dst += dststep )
+    {
+        int i = 0;
+
+        if( iscale == 1 && ishift == 0 )
+        {
+            for( ; i <= size.width - 8; i += 8 )
+                vst1q_s16( dst + i, vreinterpretq_s16_u16( vmovl_u8( vld1_u8( src + i ))));
+        }
+        else
+        {
+            for( ; i <= size.width - 8; i += 8 )
+            {
+                int16x8_t v = vreinterpretq_s16_u16( vmovl_u8( vld1_u8( src + i )));
+                int32x4_t t0 = vmlal_n_s16( b, vget_low_s16( v ), (short)iscale );
+                int32x4_t t1 = vmlal_n_s16( b, vget_high_s16( v ), (short)iscale );
+                vst1q_s16( dst + i, vcombine_s16( vqmovn_s32( t0 ), vqmovn_s32( t1 )));
+            }
+        }
+
+        for( ; i < size.width; i++ )
+        {
+            int t = src[i]*iscale + ishift;
+            dst[i] = CV_CAST_16S(t);
+        }
+    }
+
+    return CV_OK;
+}
+
+
+static CvStatus CV_STDCALL
+icvCvtScale_8u32f_C1R_NEON( const uchar* src, int srcstep,
+                            float* dst, int dststep, CvSize size,
+                            double scale, double shift )
+{
+    float fscale = (float)scale, fshift = (float)shift;
+    int no_scale = scale == 1 && shift == 0;
+    float32x4_t b = vdupq_n_f32( fshift );
+
+    dststep /= sizeof(dst[0]);
+
+    for( ; size.height--; src += srcstep, dst += dststep )
+    {
+        int i;
+
+        for( i = 0; i <= size.width - 8; i += 8 )
+        {
+            uint16x8_t v = vmovl_u8( vld1_u8( src + i ));
+            float32x4_t f0 = vcvtq_f32_u32( vmovl_u16( vget_low_u16( v )));
+            float32x4_t f1 = vcvtq_f32_u32( vmovl_u16( vget_high_u16( v )));
+
+            if( !no_scale )
+            {
+                f0 = vmlaq_n_f32( b, f0, fscale );
+                f1 = vmlaq_n_f32( b, f1, fscale );
+            }
+
+            vst1q_f32( dst + i, f0 );
+            vst1q_f32( dst + i + 4, f1 );
+        }
+
+        for( ; i < size.width; i++ )
+            dst[i] = no_scale ? (float)src[i] : src[i]*fscale + fshift;
+    }
+
+    return CV_OK;
+}
+
+
+// there is no double precision in NEON, so the values are scaled in single precision
+// (the results may differ from the C ones by 1 when they are very close to x.5),
+// saturated and then rounded to the nearest even integer like in cvRound
+static CvStatus CV_STDCALL
+icvCvtScale_32f8u_C1R_NEON( const float* src, int srcstep,
+                            uchar* dst, int dststep, CvSize size,
+                            double scale, double shift )
+{
+    float fscale = (float)scale, fshift = (float)shift;
+    const float32x4_t lo = vdupq_n_f32( 0.f ), hi = vdupq_n_f32( 255.f );
+    const float32x4_t magic = vdupq_n_f32( 12582912.f );
+    float32x4_t b = vdupq_n_f32( fshift );
+
+    srcstep /= sizeof(src[0]);
+
+    for( ; size.height--; src += srcstep, dst += dststep )
+    {
+        int i;
+
+        for( i = 0; i <= size.width - 8; i += 8 )
+        {
+            float32x4_t f0 = vmlaq_n_f32( b, vld1q_f32( src + i ), fscale );
+            float32x4_t f1 = vmlaq_n_f32( b, vld1q_f32( src + i + 4 ), fscale );
+            uint32x4_t v0, v1;
+
+            f0 = vminq_f32( vmaxq_f32( f0, lo ), hi );
+            f1 = vminq_f32( vmaxq_f32( f1, lo ), hi );
+            v0 = vcvtq_u32_f32( vsubq_f32( vaddq_f32( f0, magic ), magic ));
+            v1 = vcvtq_u32_f32( vsubq_f32( vaddq_f32( f1, magic ), magic ));
+            vst1_u8( dst + i, vmovn_u16( vcombine_u16( vmovn_u32( v0 ), vmovn_u32( v1 ))));
+        }
+
+        for( ; i < size.width; i++ )
+        {
+            int t = cvRound( src[i]*fscale + fshift );
+            dst[i] = CV_CAST_8U(t);
+        }
+    }
+
+    return CV_OK;
+}
+
+#endif
+
+
+static const CvDispatchVariant icvCvtScale_8u16s_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvCvtScale_8u16s_C1R_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvCvtScale_8u16s_C1R_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvCvtScale_8u16s_C1R_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvCvtScale_8u32f_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvCvtScale_8u32f_C1R_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvCvtScale_8u32f_C1R_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvCvtScale_8u32f_C1R_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvCvtScale_32f8u_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvCvtScale_32f8u_C1R_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvCvtScale_32f8u_C1R_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvCvtScale_32f8u_C1R_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvCvtScale_8u16s_entry =
+    CV_DISPATCH_ENTRY( "cvConvertScale_8u16s", icvCvtScale_8u16s_variants );
+static CvDispatchEntry icvCvtScale_8u32f_entry =
+    CV_DISPATCH_ENTRY( "cvConvertScale_8u32f", icvCvtScale_8u32f_variants );
+static CvDispatchEntry icvCvtScale_32f8u_entry =
+    CV_DISPATCH_ENTRY( "cvConvertScale_32f8u", icvCvtScale_32f8u_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvCvtScale_8u16s_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvCvtScale_8u32f_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvCvtScale_32f8u_entry );
+
+
+static CvCvtScalePairFunc
+icvGetCvtScalePairFunc( int srcdepth, int dstdepth )
+{
+    CvDispatchEntry* entry = 0;
+
+    if( srcdepth == CV_8U && dstdepth == CV_16S )
+        entry = &icvCvtScale_8u16s_entry;
+    else if( srcdepth == CV_8U && dstdepth == CV_32F )
+        entry = &icvCvtScale_8u32f_entry;
+    else if( srcdepth == CV_32F && dstdepth == CV_8U )
+        entry = &icvCvtScale_32f8u_entry;
+
+    return entry ? (CvCvtScalePairFunc)cvGetDispatchFunc( entry ) : 0;
+}
+
+
 CV_IMPL void
 cvConvertScale( const void* srcarr, void* dstarr,
                 double scale, double shift )
@@ -1551,11 +2101,11 @@ cvConvertScale( const void* srcarr, void* dstarr,
         dsttype = iterator.hdr[1]->type;
         iterator.size.width *= CV_MAT_CN(type);
 
-        if( !inittab )
+        if( cvBeginInitOnce( &inittab ))
         {
             icvInitCvtToC1RTable( &cvt_tab );
             icvInitCvtScaleToC1RTable( &cvtscale_tab );
-            inittab = 1;
+            cvEndInitOnce( &inittab );
         }
 
         if( no_scale )
@@ -1646,16 +2196,28 @@ cvConvertScale( const void* srcarr, void* dstarr,
         }
     }
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitCvtToC1RTable( &cvt_tab );
         icvInitCvtScaleToC1RTable( &cvtscale_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_ARE_CNS_EQ( src, dst ))
         CV_ERROR( CV_StsUnmatchedFormats, "" );
 
+    {
+        CvCvtScalePairFunc func =
+            icvGetCvtScalePairFunc( CV_MAT_DEPTH(type), CV_MAT_DEPTH(dst->type) );
+
+        if( func )
+        {
+            IPPI_CALL( func( src->data.ptr, src_step,
+                             dst->data.ptr, dst_step, size, scale, shift ));
+            EXIT;
+        }
+    }
+
     if( no_scale )
     {
         CvCvtFunc func = (CvCvtFunc)(cvt_tab.fn_2d[CV_MAT_DEPTH(dst->type)]);
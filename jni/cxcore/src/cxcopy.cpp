@@ -275,10 +275,10 @@ icvGetCopyMaskFunc( int elem_size )
     static CvBtFuncTable copym_tab;
     static int inittab = 0;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitCopyMRTable( &copym_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
     return (CvCopyMaskFunc)copym_tab.fn_2d[elem_size];
 }
@@ -310,9 +310,36 @@ cvCopy( const void* srcarr, void* dstarr, const void* maskarr )
             memcpy( dst1->size, src1->size, src1->dims*sizeof(src1->size[0]));
             dst1->valoffset = src1->valoffset;
             dst1->idxoffset = src1->idxoffset;
+
+            if( CV_IS_SPARSE_MAT_OPEN_ADDR( dst1 ))
+            {
+                CvSparseSlots* slots = dst1->slots;
+                int elem_size = CV_ELEM_SIZE( src1->type );
+                slots->slotsize = CV_IS_SPARSE_MAT_OPEN_ADDR( src1 ) ?
+                    src1->slots->slotsize : src1->heap->elem_size;
+                slots->count = 0;
+                CV_CALL( cvFree( &slots->data ));
+                // start with the table size that fits all the source nodes
+                dst1->hashsize = CV_SPARSE_SLOTS_SIZE0;
+                while( CV_SPARSE_MAT_COUNT(src1)*16 >= dst1->hashsize*CV_SPARSE_SLOTS_LOAD )
+                    dst1->hashsize *= 2;
+                CV_CALL( slots->data = (uchar*)cvAlloc( (size_t)dst1->hashsize*(slots->slotsize + 1) ));
+                slots->probe = slots->data + (size_t)dst1->hashsize*slots->slotsize;
+                memset( slots->probe, 0, dst1->hashsize );
+
+                for( node = cvInitSparseMatIterator( src1, &iterator );
+                     node != 0; node = cvGetNextSparseNode( &iterator ))
+                {
+                    uchar* ptr;
+                    CV_CALL( ptr = cvPtrND( dst1, CV_NODE_IDX(src1,node), 0, -1, &node->hashval ));
+                    memcpy( ptr, CV_NODE_VAL(src1,node), elem_size );
+                }
+                EXIT;
+            }
+
             cvClearSet( dst1->heap );
 
-            if( src1->heap->active_count >= dst1->hashsize*CV_SPARSE_HASH_RATIO )
+            if( CV_SPARSE_MAT_COUNT(src1) >= dst1->hashsize*CV_SPARSE_HASH_RATIO )
             {
                 CV_CALL( cvFree( &dst1->hashtable ));
                 dst1->hashsize = src1->hashsize;
@@ -618,10 +645,10 @@ cvSet( void* arr, CvScalar value, const void* maskarr )
         if( !CV_IS_MASK_ARR( mask ))
             CV_ERROR( CV_StsBadMask, "" );
 
-        if( !inittab )
+        if( cvBeginInitOnce( &inittab ))
         {
             icvInitSetMRTable( &setm_tab );
-            inittab = 1;
+            cvEndInitOnce( &inittab );
         }
 
         if( !CV_ARE_SIZES_EQ( mat, mask ))
@@ -710,6 +737,12 @@ cvSetZero( CvArr* arr )
         else if( CV_IS_SPARSE_MAT(mat))
         {
             CvSparseMat* mat1 = (CvSparseMat*)mat;
+            if( CV_IS_SPARSE_MAT_OPEN_ADDR( mat1 ))
+            {
+                memset( mat1->slots->probe, 0, mat1->hashsize );
+                mat1->slots->count = 0;
+                EXIT;
+            }
             cvClearSet( mat1->heap );
             if( mat1->hashtable )
                 memset( mat1->hashtable, 0, mat1->hashsize*sizeof(mat1->hashtable[0]));
@@ -914,10 +947,10 @@ cvFlip( const CvArr* srcarr, CvArr* dstarr, int flip_mode )
     CvFunc2D_2A func = 0;
     int pix_size;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitFlipHorzRTable( &tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT( src ))
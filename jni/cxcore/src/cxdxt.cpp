@@ -428,6 +428,369 @@ static const double icv_fft5_5 = 0.363271264002680442947733378740309;
 #define ICV_DFT_NO_PERMUTE 2
 #define ICV_DFT_COMPLEX_INPUT_OR_OUTPUT 4
 
+/* The power-of-2 part of the mixed-radix transform: radix-4 butterflies followed by
+   a radix-2 one if log2(factor) is odd. The data are in the bit-reversed order,
+   wave contains tab_size twiddle factors */
+typedef void (CV_CDECL * CvDFTPow2Func_32fc)( CvComplex32f* dst, int n0, int factor,
+                                              const CvComplex32f* wave, int tab_size );
+
+static void CV_CDECL
+icvDFTPow2_32fc_C( CvComplex32f* dst, int n0, int factor,
+                   const CvComplex32f* wave, int tab_size )
+{
+    int n = 1, nx, dw0 = tab_size, dw, i, j;
+
+    // radix-4 transform
+    for( ; n*4 <= factor; )
+    {
+        nx = n;
+        n *= 4;
+        dw0 /= 4;
+
+        for( i = 0; i < n0; i += n )
+        {
+            CvComplex32f* v0;
+            CvComplex32f* v1;
+            double r0, i0, r1, i1, r2, i2, r3, i3, r4, i4;
+
+            v0 = dst + i;
+            v1 = v0 + nx*2;
+
+            r2 = v0[0].re; i2 = v0[0].im;
+            r1 = v0[nx].re; i1 = v0[nx].im;
+            
+            r0 = r1 + r2; i0 = i1 + i2;
+            r2 -= r1; i2 -= i1;
+
+            i3 = v1[nx].re; r3 = v1[nx].im;
+            i4 = v1[0].re; r4 = v1[0].im;
+
+            r1 = i4 + i3; i1 = r4 + r3;
+            r3 = r4 - r3; i3 = i3 - i4;
+
+            v0[0].re = (float)(r0 + r1); v0[0].im = (float)(i0 + i1);
+            v1[0].re = (float)(r0 - r1); v1[0].im = (float)(i0 - i1);
+            v0[nx].re = (float)(r2 + r3); v0[nx].im = (float)(i2 + i3);
+            v1[nx].re = (float)(r2 - r3); v1[nx].im = (float)(i2 - i3);
+
+            for( j = 1, dw = dw0; j < nx; j++, dw += dw0 )
+            {
+                v0 = dst + i + j;
+                v1 = v0 + nx*2;
+
+                r2 = v0[nx].re*wave[dw*2].re - v0[nx].im*wave[dw*2].im;
+                i2 = v0[nx].re*wave[dw*2].im + v0[nx].im*wave[dw*2].re;
+                r0 = v1[0].re*wave[dw].im + v1[0].im*wave[dw].re;
+                i0 = v1[0].re*wave[dw].re - v1[0].im*wave[dw].im;
+                r3 = v1[nx].re*wave[dw*3].im + v1[nx].im*wave[dw*3].re;
+                i3 = v1[nx].re*wave[dw*3].re - v1[nx].im*wave[dw*3].im;
+
+                r1 = i0 + i3; i1 = r0 + r3;
+                r3 = r0 - r3; i3 = i3 - i0;
+                r4 = v0[0].re; i4 = v0[0].im;
+
+                r0 = r4 + r2; i0 = i4 + i2;
+                r2 = r4 - r2; i2 = i4 - i2;
+
+                v0[0].re = (float)(r0 + r1); v0[0].im = (float)(i0 + i1);
+                v1[0].re = (float)(r0 - r1); v1[0].im = (float)(i0 - i1);
+                v0[nx].re = (float)(r2 + r3); v0[nx].im = (float)(i2 + i3);
+                v1[nx].re = (float)(r2 - r3); v1[nx].im = (float)(i2 - i3);
+            }
+        }
+    }
+
+    for( ; n < factor; )
+    {
+        // do the remaining radix-2 transform
+        nx = n;
+        n *= 2;
+        dw0 /= 2;
+
+        for( i = 0; i < n0; i += n )
+        {
+            CvComplex32f* v = dst + i;
+            double r0 = v[0].re + v[nx].re;
+            double i0 = v[0].im + v[nx].im;
+            double r1 = v[0].re - v[nx].re;
+            double i1 = v[0].im - v[nx].im;
+            v[0].re = (float)r0; v[0].im = (float)i0;
+            v[nx].re = (float)r1; v[nx].im = (float)i1;
+
+            for( j = 1, dw = dw0; j < nx; j++, dw += dw0 )
+            {
+                v = dst + i + j;
+                r1 = v[nx].re*wave[dw].re - v[nx].im*wave[dw].im;
+                i1 = v[nx].im*wave[dw].re + v[nx].re*wave[dw].im;
+                r0 = v[0].re; i0 = v[0].im;
+
+                v[0].re = (float)(r0 + r1); v[0].im = (float)(i0 + i1);
+                v[nx].re = (float)(r0 - r1); v[nx].im = (float)(i0 - i1);
+            }
+        }
+    }
+}
+
+
+/* radix-4 and radix-2 butterflies of the first stage, where no twiddle factors are needed */
+static void
+icvDFTFirstStage_32fc( CvComplex32f* dst, int n0, int radix )
+{
+    int i;
+
+    if( radix == 4 )
+    {
+        for( i = 0; i < n0; i += 4 )
+        {
+            CvComplex32f* v = dst + i;
+            float r0 = v[0].re + v[1].re, i0 = v[0].im + v[1].im;
+            float r2 = v[0].re - v[1].re, i2 = v[0].im - v[1].im;
+            float r1 = v[2].re + v[3].re, i1 = v[2].im + v[3].im;
+            float r3 = v[2].im - v[3].im, i3 = v[3].re - v[2].re;
+
+            v[0].re = r0 + r1; v[0].im = i0 + i1;
+            v[2].re = r0 - r1; v[2].im = i0 - i1;
+            v[1].re = r2 + r3; v[1].im = i2 + i3;
+            v[3].re = r2 - r3; v[3].im = i2 - i3;
+        }
+    }
+    else
+    {
+        for( i = 0; i < n0; i += 2 )
+        {
+            CvComplex32f* v = dst + i;
+            float r0 = v[0].re, i0 = v[0].im;
+            v[0].re = r0 + v[1].re; v[0].im = i0 + v[1].im;
+            v[1].re = r0 - v[1].re; v[1].im = i0 - v[1].im;
+        }
+    }
+}
+
+
+/* The vectorized variants compute in single precision and process two butterflies
+   (adjacent j) at once, so they are used for the stages with nx >= 2 */
+#if CV_SSE2
+
+#define ICV_DFT_LOAD2_32FC( p0, p1 ) \
+    _mm_loadh_pi( _mm_loadl_pi( _mm_setzero_ps(), (const __m64*)(p0) ), (const __m64*)(p1) )
+
+static void CV_CDECL
+icvDFTPow2_32fc_SSE2( CvComplex32f* dst, int n0, int factor,
+                      const CvComplex32f* wave, int tab_size )
+{
+    int n = 1, nx, dw0 = tab_size, i, j;
+    // sign masks for the real and for the imaginary parts
+    const __m128 re_mask = _mm_castsi128_ps( _mm_set_epi32( 0, 0x80000000, 0, 0x80000000 ));
+    const __m128 im_mask = _mm_castsi128_ps( _mm_set_epi32( 0x80000000, 0, 0x80000000, 0 ));
+
+    #define ICV_CMUL_SSE2( x, w )                                             \
+        _mm_add_ps( _mm_mul_ps( x, _mm_shuffle_ps( w, w, _MM_SHUFFLE(2,2,0,0) )), \
+            _mm_xor_ps( _mm_mul_ps( _mm_shuffle_ps( x, x, _MM_SHUFFLE(2,3,0,1) ), \
+                _mm_shuffle_ps( w, w, _MM_SHUFFLE(3,3,1,1) )), re_mask ))
+
+    // radix-4 transform
+    for( ; n*4 <= factor; )
+    {
+        nx = n;
+        n *= 4;
+        dw0 /= 4;
+
+        if( nx == 1 )
+        {
+            icvDFTFirstStage_32fc( dst, n0, 4 );
+            continue;
+        }
+
+        for( i = 0; i < n0; i += n )
+        {
+            float* v0 = (float*)(dst + i);
+            float* v1 = v0 + nx*4;
+
+            for( j = 0; j < nx; j += 2 )
+            {
+                const CvComplex32f* w = wave + j*dw0;
+                __m128 w1 = ICV_DFT_LOAD2_32FC( w, w + dw0 );
+                __m128 w2 = ICV_DFT_LOAD2_32FC( w + j*dw0, w + (j+2)*dw0 );
+                __m128 w3 = ICV_DFT_LOAD2_32FC( w + j*dw0*2, w + (j*2+3)*dw0 );
+                __m128 a = _mm_loadu_ps( v0 + j*2 );
+                __m128 b = _mm_loadu_ps( v0 + (j + nx)*2 );
+                __m128 c = _mm_loadu_ps( v1 + j*2 );
+                __m128 d = _mm_loadu_ps( v1 + (j + nx)*2 );
+                __m128 s0, s1, t0, t1;
+
+                b = ICV_CMUL_SSE2( b, w2 );
+                c = ICV_CMUL_SSE2( c, w1 );
+                d = ICV_CMUL_SSE2( d, w3 );
+
+                s0 = _mm_add_ps( a, b ); s1 = _mm_sub_ps( a, b );
+                t0 = _mm_add_ps( c, d ); t1 = _mm_sub_ps( c, d );
+                // multiply by -i
+                t1 = _mm_xor_ps( _mm_shuffle_ps( t1, t1, _MM_SHUFFLE(2,3,0,1) ), im_mask );
+
+                _mm_storeu_ps( v0 + j*2, _mm_add_ps( s0, t0 ));
+                _mm_storeu_ps( v1 + j*2, _mm_sub_ps( s0, t0 ));
+                _mm_storeu_ps( v0 + (j + nx)*2, _mm_add_ps( s1, t1 ));
+                _mm_storeu_ps( v1 + (j + nx)*2, _mm_sub_ps( s1, t1 ));
+            }
+        }
+    }
+
+    if( n < factor )
+    {
+        // the remaining radix-2 transform
+        nx = n;
+        n *= 2;
+        dw0 /= 2;
+
+        if( nx == 1 )
+            icvDFTFirstStage_32fc( dst, n0, 2 );
+        else
+        {
+            for( i = 0; i < n0; i += n )
+            {
+                float* v = (float*)(dst + i);
+
+                for( j = 0; j < nx; j += 2 )
+                {
+                    __m128 w = ICV_DFT_LOAD2_32FC( wave + j*dw0, wave + (j+1)*dw0 );
+                    __m128 a = _mm_loadu_ps( v + j*2 );
+                    __m128 b = _mm_loadu_ps( v + (j + nx)*2 );
+                    b = ICV_CMUL_SSE2( b, w );
+                    _mm_storeu_ps( v + j*2, _mm_add_ps( a, b ));
+                    _mm_storeu_ps( v + (j + nx)*2, _mm_sub_ps( a, b ));
+                }
+            }
+        }
+    }
+
+    #undef ICV_CMUL_SSE2
+}
+
+#undef ICV_DFT_LOAD2_32FC
+
+#endif
+
+
+#if CV_NEON
+
+#define ICV_DFT_LOAD2_32FC( p0, p1 ) \
+    vcombine_f32( vld1_f32( (const float*)(p0) ), vld1_f32( (const float*)(p1) ))
+
+static void CV_CDECL
+icvDFTPow2_32fc_NEON( CvComplex32f* dst, int n0, int factor,
+                      const CvComplex32f* wave, int tab_size )
+{
+    int n = 1, nx, dw0 = tab_size, i, j;
+    static const float re_sign[] = { -1.f, 1.f, -1.f, 1.f };
+    static const float im_sign[] = { 1.f, -1.f, 1.f, -1.f };
+    const float32x4_t re_neg = vld1q_f32( re_sign ), im_neg = vld1q_f32( im_sign );
+
+    #define ICV_CMUL_NEON( x, w, wt )                                         \
+        ( wt = vtrnq_f32( w, w ),                                             \
+          vmlaq_f32( vmulq_f32( x, wt.val[0] ), vrev64q_f32( x ),             \
+                     vmulq_f32( wt.val[1], re_neg )))
+
+    // radix-4 transform
+    for( ; n*4 <= factor; )
+    {
+        nx = n;
+        n *= 4;
+        dw0 /= 4;
+
+        if( nx == 1 )
+        {
+            icvDFTFirstStage_32fc( dst, n0, 4 );
+            continue;
+        }
+
+        for( i = 0; i < n0; i += n )
+        {
+            float* v0 = (float*)(dst + i);
+            float* v1 = v0 + nx*4;
+
+            for( j = 0; j < nx; j += 2 )
+            {
+                const CvComplex32f* w = wave + j*dw0;
+                float32x4x2_t wt;
+                float32x4_t w1 = ICV_DFT_LOAD2_32FC( w, w + dw0 );
+                float32x4_t w2 = ICV_DFT_LOAD2_32FC( w + j*dw0, w + (j+2)*dw0 );
+                float32x4_t w3 = ICV_DFT_LOAD2_32FC( w + j*dw0*2, w + (j*2+3)*dw0 );
+                float32x4_t a = vld1q_f32( v0 + j*2 );
+                float32x4_t b = vld1q_f32( v0 + (j + nx)*2 );
+                float32x4_t c = vld1q_f32( v1 + j*2 );
+                float32x4_t d = vld1q_f32( v1 + (j + nx)*2 );
+                float32x4_t s0, s1, t0, t1;
+
+                b = ICV_CMUL_NEON( b, w2, wt );
+                c = ICV_CMUL_NEON( c, w1, wt );
+                d = ICV_CMUL_NEON( d, w3, wt );
+
+                s0 = vaddq_f32( a, b ); s1 = vsubq_f32( a, b );
+                t0 = vaddq_f32( c, d ); t1 = vsubq_f32( c, d );
+                // multiply by -i
+                t1 = vmulq_f32( vrev64q_f32( t1 ), im_neg );
+
+                vst1q_f32( v0 + j*2, vaddq_f32( s0, t0 ));
+                vst1q_f32( v1 + j*2, vsubq_f32( s0, t0 ));
+                vst1q_f32( v0 + (j + nx)*2, vaddq_f32( s1, t1 ));
+                vst1q_f32( v1 + (j + nx)*2, vsubq_f32( s1, t1 ));
+            }
+        }
+    }
+
+    if( n < factor )
+    {
+        // the remaining radix-2 transform
+        nx = n;
+        n *= 2;
+        dw0 /= 2;
+
+        if( nx == 1 )
+            icvDFTFirstStage_32fc( dst, n0, 2 );
+        else
+        {
+            for( i = 0; i < n0; i += n )
+            {
+                float* v = (float*)(dst + i);
+
+                for( j = 0; j < nx; j += 2 )
+                {
+                    float32x4x2_t wt;
+                    float32x4_t w = ICV_DFT_LOAD2_32FC( wave + j*dw0, wave + (j+1)*dw0 );
+                    float32x4_t a = vld1q_f32( v + j*2 );
+                    float32x4_t b = vld1q_f32( v + (j + nx)*2 );
+                    b = ICV_CMUL_NEON( b, w, wt );
+                    vst1q_f32( v + j*2, vaddq_f32( a, b ));
+                    vst1q_f32( v + (j + nx)*2, vsubq_f32( a, b ));
+                }
+            }
+        }
+    }
+
+    #undef ICV_CMUL_NEON
+}
+
+#undef ICV_DFT_LOAD2_32FC
+
+#endif
+
+
+static const CvDispatchVariant icvDFTPow2_32fc_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvDFTPow2_32fc_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvDFTPow2_32fc_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvDFTPow2_32fc_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvDFTPow2_32fc_entry =
+    CV_DISPATCH_ENTRY( "cvDFT_32fc", icvDFTPow2_32fc_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvDFTPow2_32fc_entry );
+
+
 // mixed-radix complex discrete Fourier transform: double-precision version
 static CvStatus CV_STDCALL
 icvDFT_64fc( const CvComplex64f* src, CvComplex64f* dst, int n,
@@ -972,95 +1335,11 @@ icvDFT_32fc( const CvComplex32f* src, CvComplex32f* dst, int n,
     // 1. power-2 transforms
     if( (factors[0] & 1) == 0 )
     {
-        // radix-4 transform
-        for( ; n*4 <= factors[0]; )
-        {
-            nx = n;
-            n *= 4;
-            dw0 /= 4;
-
-            for( i = 0; i < n0; i += n )
-            {
-                CvComplex32f* v0;
-                CvComplex32f* v1;
-                double r0, i0, r1, i1, r2, i2, r3, i3, r4, i4;
-
-                v0 = dst + i;
-                v1 = v0 + nx*2;
-
-                r2 = v0[0].re; i2 = v0[0].im;
-                r1 = v0[nx].re; i1 = v0[nx].im;
-                
-                r0 = r1 + r2; i0 = i1 + i2;
-                r2 -= r1; i2 -= i1;
-
-                i3 = v1[nx].re; r3 = v1[nx].im;
-                i4 = v1[0].re; r4 = v1[0].im;
-
-                r1 = i4 + i3; i1 = r4 + r3;
-                r3 = r4 - r3; i3 = i3 - i4;
-
-                v0[0].re = (float)(r0 + r1); v0[0].im = (float)(i0 + i1);
-                v1[0].re = (float)(r0 - r1); v1[0].im = (float)(i0 - i1);
-                v0[nx].re = (float)(r2 + r3); v0[nx].im = (float)(i2 + i3);
-                v1[nx].re = (float)(r2 - r3); v1[nx].im = (float)(i2 - i3);
-
-                for( j = 1, dw = dw0; j < nx; j++, dw += dw0 )
-                {
-                    v0 = dst + i + j;
-                    v1 = v0 + nx*2;
-
-                    r2 = v0[nx].re*wave[dw*2].re - v0[nx].im*wave[dw*2].im;
-                    i2 = v0[nx].re*wave[dw*2].im + v0[nx].im*wave[dw*2].re;
-                    r0 = v1[0].re*wave[dw].im + v1[0].im*wave[dw].re;
-                    i0 = v1[0].re*wave[dw].re - v1[0].im*wave[dw].im;
-                    r3 = v1[nx].re*wave[dw*3].im + v1[nx].im*wave[dw*3].re;
-                    i3 = v1[nx].re*wave[dw*3].re - v1[nx].im*wave[dw*3].im;
-
-                    r1 = i0 + i3; i1 = r0 + r3;
-                    r3 = r0 - r3; i3 = i3 - i0;
-                    r4 = v0[0].re; i4 = v0[0].im;
-
-                    r0 = r4 + r2; i0 = i4 + i2;
-                    r2 = r4 - r2; i2 = i4 - i2;
-
-                    v0[0].re = (float)(r0 + r1); v0[0].im = (float)(i0 + i1);
-                    v1[0].re = (float)(r0 - r1); v1[0].im = (float)(i0 - i1);
-                    v0[nx].re = (float)(r2 + r3); v0[nx].im = (float)(i2 + i3);
-                    v1[nx].re = (float)(r2 - r3); v1[nx].im = (float)(i2 - i3);
-                }
-            }
-        }
-
-        for( ; n < factors[0]; )
-        {
-            // do the remaining radix-2 transform
-            nx = n;
-            n *= 2;
-            dw0 /= 2;
-
-            for( i = 0; i < n0; i += n )
-            {
-                CvComplex32f* v = dst + i;
-                double r0 = v[0].re + v[nx].re;
-                double i0 = v[0].im + v[nx].im;
-                double r1 = v[0].re - v[nx].re;
-                double i1 = v[0].im - v[nx].im;
-                v[0].re = (float)r0; v[0].im = (float)i0;
-                v[nx].re = (float)r1; v[nx].im = (float)i1;
-
-                for( j = 1, dw = dw0; j < nx; j++, dw += dw0 )
-                {
-                    v = dst + i + j;
-                    r1 = v[nx].re*wave[dw].re - v[nx].im*wave[dw].im;
-                    i1 = v[nx].im*wave[dw].re + v[nx].re*wave[dw].im;
-                    r0 = v[0].re; i0 = v[0].im;
-
-                    v[0].re = (float)(r0 + r1); v[0].im = (float)(i0 + i1);
-                    v[nx].re = (float)(r0 - r1); v[nx].im = (float)(i0 - i1);
-                }
-            }
-        }
+        CvDFTPow2Func_32fc pow2_func =
+            (CvDFTPow2Func_32fc)cvGetDispatchFunc( &icvDFTPow2_32fc_entry );
+        pow2_func( dst, n0, factors[0], wave, tab_size );
+        n = factors[0];
+        dw0 = tab_size/n;
     }
 
     // 2. all the other transforms
@@ -1280,6 +1559,272 @@ icvDFT_32fc( const CvComplex32f* src, CvComplex32f* dst, int n,
 }
 
 
+/* Transforms of several complex power-of-2 signals of the same length at once.
+   The signals are gathered into the planar layout re[k*4 + s], im[k*4 + s], so the
+   vectorized butterflies process one element of the 4 signals at a time and the
+   twiddle factors are shared by all the lanes */
+#define ICV_DFT_BATCH   4
+
+typedef void (CV_CDECL * CvDFTBatchFunc_32fc)( const CvComplex32f** src, CvComplex32f** dst,
+                                               int n, const int* itab, const CvComplex32f* wave,
+                                               int inv, double scale, float* buf );
+
+static void CV_CDECL
+icvDFTBatch_32fc_C( const CvComplex32f** src, CvComplex32f** dst, int n,
+                    const int* itab, const CvComplex32f* wave,
+                    int inv, double scale, float* buf )
+{
+    int s, factors[] = { n };
+
+    for( s = 0; s < ICV_DFT_BATCH; s++ )
+        icvDFT_32fc( src[s], dst[s], n, 1, factors, itab, wave, n,
+                     0, (CvComplex32f*)buf, inv, scale );
+}
+
+
+#if CV_SSE2 || CV_NEON
+
+static void
+icvDFTBatchGather_32fc( const CvComplex32f** src, int n, const int* itab,
+                        int inv, float* re, float* im )
+{
+    const CvComplex32f *src0 = src[0], *src1 = src[1], *src2 = src[2], *src3 = src[3];
+    float im_sign = inv ? -1.f : 1.f;
+    int i;
+
+    for( i = 0; i < n; i++, re += ICV_DFT_BATCH, im += ICV_DFT_BATCH )
+    {
+        int k = itab[i];
+        re[0] = src0[k].re; im[0] = src0[k].im*im_sign;
+        re[1] = src1[k].re; im[1] = src1[k].im*im_sign;
+        re[2] = src2[k].re; im[2] = src2[k].im*im_sign;
+        re[3] = src3[k].re; im[3] = src3[k].im*im_sign;
+    }
+}
+
+
+static void
+icvDFTBatchScatter_32fc( const float* re, const float* im, int n,
+                         int inv, double scale, CvComplex32f** dst )
+{
+    CvComplex32f *dst0 = dst[0], *dst1 = dst[1], *dst2 = dst[2], *dst3 = dst[3];
+    float re_scale = (float)scale, im_scale = inv ? -re_scale : re_scale;
+    int i;
+
+    for( i = 0; i < n; i++, re += ICV_DFT_BATCH, im += ICV_DFT_BATCH )
+    {
+        dst0[i].re = re[0]*re_scale; dst0[i].im = im[0]*im_scale;
+        dst1[i].re = re[1]*re_scale; dst1[i].im = im[1]*im_scale;
+        dst2[i].re = re[2]*re_scale; dst2[i].im = im[2]*im_scale;
+        dst3[i].re = re[3]*re_scale; dst3[i].im = im[3]*im_scale;
+    }
+}
+
+#endif
+
+
+#if CV_SSE2
+
+static void CV_CDECL
+icvDFTBatch_32fc_SSE2( const CvComplex32f** src, CvComplex32f** dst, int n0,
+                       const int* itab, const CvComplex32f* wave,
+                       int inv, double scale, float* buf )
+{
+    float* re = (float*)cvAlignPtr( buf, 16 );
+    float* im = re + n0*ICV_DFT_BATCH;
+    int n = 1, nx, dw0 = n0, dw, i, j;
+
+    icvDFTBatchGather_32fc( src, n0, itab, inv, re, im );
+
+    // radix-4 transform
+    for( ; n*4 <= n0; )
+    {
+        nx = n;
+        n *= 4;
+        dw0 /= 4;
+
+        for( i = 0; i < n0; i += n )
+        {
+            for( j = 0, dw = 0; j < nx; j++, dw += dw0 )
+            {
+                int k0 = (i + j)*ICV_DFT_BATCH, k1 = k0 + nx*ICV_DFT_BATCH;
+                int k2 = k0 + nx*ICV_DFT_BATCH*2, k3 = k0 + nx*ICV_DFT_BATCH*3;
+                __m128 w1r = _mm_set1_ps( wave[dw].re ), w1i = _mm_set1_ps( wave[dw].im );
+                __m128 w2r = _mm_set1_ps( wave[dw*2].re ), w2i = _mm_set1_ps( wave[dw*2].im );
+                __m128 w3r = _mm_set1_ps( wave[dw*3].re ), w3i = _mm_set1_ps( wave[dw*3].im );
+                __m128 xr, xi, r0, i0, r1, i1, r2, i2, r3, i3, r4, i4;
+
+                xr = _mm_load_ps( re + k1 ); xi = _mm_load_ps( im + k1 );
+                r2 = _mm_sub_ps( _mm_mul_ps( xr, w2r ), _mm_mul_ps( xi, w2i ));
+                i2 = _mm_add_ps( _mm_mul_ps( xr, w2i ), _mm_mul_ps( xi, w2r ));
+                xr = _mm_load_ps( re + k2 ); xi = _mm_load_ps( im + k2 );
+                r0 = _mm_add_ps( _mm_mul_ps( xr, w1i ), _mm_mul_ps( xi, w1r ));
+                i0 = _mm_sub_ps( _mm_mul_ps( xr, w1r ), _mm_mul_ps( xi, w1i ));
+                xr = _mm_load_ps( re + k3 ); xi = _mm_load_ps( im + k3 );
+                r3 = _mm_add_ps( _mm_mul_ps( xr, w3i ), _mm_mul_ps( xi, w3r ));
+                i3 = _mm_sub_ps( _mm_mul_ps( xr, w3r ), _mm_mul_ps( xi, w3i ));
+
+                r1 = _mm_add_ps( i0, i3 ); i1 = _mm_add_ps( r0, r3 );
+                r3 = _mm_sub_ps( r0, r3 ); i3 = _mm_sub_ps( i3, i0 );
+                r4 = _mm_load_ps( re + k0 ); i4 = _mm_load_ps( im + k0 );
+
+                r0 = _mm_add_ps( r4, r2 ); i0 = _mm_add_ps( i4, i2 );
+                r2 = _mm_sub_ps( r4, r2 ); i2 = _mm_sub_ps( i4, i2 );
+
+                _mm_store_ps( re + k0, _mm_add_ps( r0, r1 ));
+                _mm_store_ps( im + k0, _mm_add_ps( i0, i1 ));
+                _mm_store_ps( re + k2, _mm_sub_ps( r0, r1 ));
+                _mm_store_ps( im + k2, _mm_sub_ps( i0, i1 ));
+                _mm_store_ps( re + k1, _mm_add_ps( r2, r3 ));
+                _mm_store_ps( im + k1, _mm_add_ps( i2, i3 ));
+                _mm_store_ps( re + k3, _mm_sub_ps( r2, r3 ));
+                _mm_store_ps( im + k3, _mm_sub_ps( i2, i3 ));
+            }
+        }
+    }
+
+    if( n < n0 )
+    {
+        // the remaining radix-2 transform
+        nx = n;
+        dw0 /= 2;
+
+        for( i = 0; i < n0; i += n*2 )
+        {
+            for( j = 0, dw = 0; j < nx; j++, dw += dw0 )
+            {
+                int k0 = (i + j)*ICV_DFT_BATCH, k1 = k0 + nx*ICV_DFT_BATCH;
+                __m128 wr = _mm_set1_ps( wave[dw].re ), wi = _mm_set1_ps( wave[dw].im );
+                __m128 xr = _mm_load_ps( re + k1 ), xi = _mm_load_ps( im + k1 );
+                __m128 r1 = _mm_sub_ps( _mm_mul_ps( xr, wr ), _mm_mul_ps( xi, wi ));
+                __m128 i1 = _mm_add_ps( _mm_mul_ps( xi, wr ), _mm_mul_ps( xr, wi ));
+                __m128 r0 = _mm_load_ps( re + k0 ), i0 = _mm_load_ps( im + k0 );
+
+                _mm_store_ps( re + k0, _mm_add_ps( r0, r1 ));
+                _mm_store_ps( im + k0, _mm_add_ps( i0, i1 ));
+                _mm_store_ps( re + k1, _mm_sub_ps( r0, r1 ));
+                _mm_store_ps( im + k1, _mm_sub_ps( i0, i1 ));
+            }
+        }
+    }
+
+    icvDFTBatchScatter_32fc( re, im, n0, inv, scale, dst );
+}
+
+#endif
+
+
+#if CV_NEON
+
+static void CV_CDECL
+icvDFTBatch_32fc_NEON( const CvComplex32f** src, CvComplex32f** dst, int n0,
+                       const int* itab, const CvComplex32f* wave,
+                       int inv, double scale, float* buf )
+{
+    float* re = (float*)cvAlignPtr( buf, 16 );
+    float* im = re + n0*ICV_DFT_BATCH;
+    int n = 1, nx, dw0 = n0, dw, i, j;
+
+    icvDFTBatchGather_32fc( src, n0, itab, inv, re, im );
+
+    // radix-4 transform
+    for( ; n*4 <= n0; )
+    {
+        nx = n;
+        n *= 4;
+        dw0 /= 4;
+
+        for( i = 0; i < n0; i += n )
+        {
+            for( j = 0, dw = 0; j < nx; j++, dw += dw0 )
+            {
+                int k0 = (i + j)*ICV_DFT_BATCH, k1 = k0 + nx*ICV_DFT_BATCH;
+                int k2 = k0 + nx*ICV_DFT_BATCH*2, k3 = k0 + nx*ICV_DFT_BATCH*3;
+                float w1r = wave[dw].re, w1i = wave[dw].im;
+                float w2r = wave[dw*2].re, w2i = wave[dw*2].im;
+                float w3r = wave[dw*3].re, w3i = wave[dw*3].im;
+                float32x4_t xr, xi, r0, i0, r1, i1, r2, i2, r3, i3, r4, i4;
+
+                xr = vld1q_f32( re + k1 ); xi = vld1q_f32( im + k1 );
+                r2 = vmlsq_f32( vmulq_n_f32( xr, w2r ), xi, vdupq_n_f32( w2i ));
+                i2 = vmlaq_f32( vmulq_n_f32( xr, w2i ), xi, vdupq_n_f32( w2r ));
+                xr = vld1q_f32( re + k2 ); xi = vld1q_f32( im + k2 );
+                r0 = vmlaq_f32( vmulq_n_f32( xr, w1i ), xi, vdupq_n_f32( w1r ));
+                i0 = vmlsq_f32( vmulq_n_f32( xr, w1r ), xi, vdupq_n_f32( w1i ));
+                xr = vld1q_f32( re + k3 ); xi = vld1q_f32( im + k3 );
+                r3 = vmlaq_f32( vmulq_n_f32( xr, w3i ), xi, vdupq_n_f32( w3r ));
+                i3 = vmlsq_f32( vmulq_n_f32( xr, w3r ), xi, vdupq_n_f32( w3i ));
+
+                r1 = vaddq_f32( i0, i3 ); i1 = vaddq_f32( r0, r3 );
+                r3 = vsubq_f32( r0, r3 ); i3 = vsubq_f32( i3, i0 );
+                r4 = vld1q_f32( re + k0 ); i4 = vld1q_f32( im + k0 );
+
+                r0 = vaddq_f32( r4, r2 ); i0 = vaddq_f32( i4, i2 );
+                r2 = vsubq_f32( r4, r2 ); i2 = vsubq_f32( i4, i2 );
+
+                vst1q_f32( re + k0, vaddq_f32( r0, r1 ));
+                vst1q_f32( im + k0, vaddq_f32( i0, i1 ));
+                vst1q_f32( re + k2, vsubq_f32( r0, r1 ));
+                vst1q_f32( im + k2, vsubq_f32( i0, i1 ));
+                vst1q_f32( re + k1, vaddq_f32( r2, r3 ));
+                vst1q_f32( im + k1, vaddq_f32( i2, i3 ));
+                vst1q_f32( re + k3, vsubq_f32( r2, r3 ));
+                vst1q_f32( im + k3, vsubq_f32( i2, i3 ));
+            }
+        }
+    }
+
+    if( n < n0 )
+    {
+        // the remaining radix-2 transform
+        nx = n;
+        dw0 /= 2;
+
+        for( i = 0; i < n0; i += n*2 )
+        {
+            for( j = 0, dw = 0; j < nx; j++, dw += dw0 )
+            {
+                int k0 = (i + j)*ICV_DFT_BATCH, k1 = k0 + nx*ICV_DFT_BATCH;
+                float wr = wave[dw].re, wi = wave[dw].im;
+                float32x4_t xr = vld1q_f32( re + k1 ), xi = vld1q_f32( im + k1 );
+                float32x4_t r1 = vmlsq_f32( vmulq_n_f32( xr, wr ), xi, vdupq_n_f32( wi ));
+                float32x4_t i1 = vmlaq_f32( vmulq_n_f32( xi, wr ), xr, vdupq_n_f32( wi ));
+                float32x4_t r0 = vld1q_f32( re + k0 ), i0 = vld1q_f32( im + k0 );
+
+                vst1q_f32( re + k0, vaddq_f32( r0, r1 ));
+                vst1q_f32( im + k0, vaddq_f32( i0, i1 ));
+                vst1q_f32( re + k1, vsubq_f32( r0, r1 ));
+                vst1q_f32( im + k1, vsubq_f32( i0, i1 ));
+            }
+        }
+    }
+
+    icvDFTBatchScatter_32fc( re, im, n0, inv, scale, dst );
+}
+
+#endif
+
+
+static const CvDispatchVariant icvDFTBatch_32fc_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvDFTBatch_32fc_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvDFTBatch_32fc_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvDFTBatch_32fc_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvDFTBatch_32fc_entry =
+    CV_DISPATCH_ENTRY( "cvDFTBatch_32fc", icvDFTBatch_32fc_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvDFTBatch_32fc_entry );
+
+/* size of the buffer of icvDFTBatch_32fc_* */
+#define ICV_DFT_BATCH_BUF_SIZE( n ) \
+    ((n)*ICV_DFT_BATCH*2*sizeof(float) + 16)
+
+
 /* FFT of real vector
    output vector format:
      re(0), re(1), im(1), ... , re(n/2-1), im((n+1)/2-1) [, re((n+1)/2)] OR ...
@@ -1605,142 +2150,624 @@ icvCopyColumn( const uchar* _src, int src_step,
 }
 
 
-static void
-icvCopyFrom2Columns( const uchar* _src, int src_step,
-                     uchar* _dst0, uchar* _dst1,
-                     int len, int elem_size )
+/* copies count adjacent columns of len elements to count contiguous vectors and back.
+   The source rows are read (or the destination rows are written) sequentially,
+   so a block of columns that fits a cache line or two is transposed efficiently */
+static void
+icvCopyFromColumns( const uchar* _src, int src_step, uchar* _dst,
+                    int count, int len, int elem_size )
+{
+    int i, j, t0, t1;
+    const int* src = (const int*)_src;
+    int* dst = (int*)_dst;
+    src_step /= sizeof(src[0]);
+
+    if( elem_size == sizeof(int)*2 )
+    {
+        for( i = 0; i < len*2; i += 2, src += src_step )
+            for( j = 0; j < count; j++ )
+            {
+                int* d = dst + j*len*2 + i;
+                t0 = src[j*2]; t1 = src[j*2+1];
+                d[0] = t0; d[1] = t1;
+            }
+    }
+    else if( elem_size == sizeof(int)*4 )
+    {
+        for( i = 0; i < len*4; i += 4, src += src_step )
+            for( j = 0; j < count; j++ )
+            {
+                int* d = dst + j*len*4 + i;
+                t0 = src[j*4]; t1 = src[j*4+1];
+                d[0] = t0; d[1] = t1;
+                t0 = src[j*4+2]; t1 = src[j*4+3];
+                d[2] = t0; d[3] = t1;
+            }
+    }
+}
+
+
+static void
+icvCopyToColumns( const uchar* _src, uchar* _dst, int dst_step,
+                  int count, int len, int elem_size )
+{
+    int i, j, t0, t1;
+    const int* src = (const int*)_src;
+    int* dst = (int*)_dst;
+    dst_step /= sizeof(dst[0]);
+
+    if( elem_size == sizeof(int)*2 )
+    {
+        for( i = 0; i < len*2; i += 2, dst += dst_step )
+            for( j = 0; j < count; j++ )
+            {
+                const int* s = src + j*len*2 + i;
+                t0 = s[0]; t1 = s[1];
+                dst[j*2] = t0; dst[j*2+1] = t1;
+            }
+    }
+    else if( elem_size == sizeof(int)*4 )
+    {
+        for( i = 0; i < len*4; i += 4, dst += dst_step )
+            for( j = 0; j < count; j++ )
+            {
+                const int* s = src + j*len*4 + i;
+                t0 = s[0]; t1 = s[1];
+                dst[j*4] = t0; dst[j*4+1] = t1;
+                t0 = s[2]; t1 = s[3];
+                dst[j*4+2] = t0; dst[j*4+3] = t1;
+            }
+    }
+}
+
+
+static void
+icvExpandCCS( uchar* _ptr, int len, int elem_size )
+{
+    int i;
+    _ptr -= elem_size;
+    memcpy( _ptr, _ptr + elem_size, elem_size );
+    memset( _ptr + elem_size, 0, elem_size );
+    if( (len & 1) == 0 )
+        memset( _ptr + (len+1)*elem_size, 0, elem_size );
+
+    if( elem_size == sizeof(float) )
+    {
+        CvComplex32f* ptr = (CvComplex32f*)_ptr;
+
+        for( i = 1; i < (len+1)/2; i++ )
+        {
+            CvComplex32f t;
+            t.re = ptr[i].re;
+            t.im = -ptr[i].im;
+            ptr[len-i] = t;
+        }
+    }
+    else
+    {
+        CvComplex64f* ptr = (CvComplex64f*)_ptr;
+
+        for( i = 1; i < (len+1)/2; i++ )
+        {
+            CvComplex64f t;
+            t.re = ptr[i].re;
+            t.im = -ptr[i].im;
+            ptr[len-i] = t;
+        }
+    }
+}
+
+
+/****************************************************************************************\
+*                             Cache of the transform tables                              *
+\****************************************************************************************/
+
+#define ICV_DXT_TAB_DFT         0   // complex DFT and forward real DFT
+#define ICV_DXT_TAB_DFT_INV     1   // inverse real DFT (uses the inverse permutation)
+#define ICV_DXT_TAB_DCT         2
+#define ICV_DXT_TAB_DCT_INV     3
+
+#define ICV_DXT_CACHE_SIZE      16
+
+/* The tables of a transform of the particular length. They are not modified after
+   being built, so any number of transforms may use them at once */
+typedef struct CvDXTTab
+{
+    int n, depth, kind;
+    int nf;
+    int factors[34];
+    int* itab;
+    void* wave;
+    void* dct_wave;
+    int refcount;
+    int cached;             // the tables are in the cache list
+    struct CvDXTTab* prev;
+    struct CvDXTTab* next;
+}
+CvDXTTab;
+
+struct CvDFTPlan
+{
+    CvSize size;
+    int type;
+    int flags;
+    int dct;
+    int count;
+    CvDXTTab* tab[2];       // tables of the row and the column transforms
+};
+
+/* the tables that are not used at the moment are kept in the LRU order,
+   the list is protected by the global lock */
+static CvDXTTab* icvDXTCacheFirst = 0;
+static CvDXTTab* icvDXTCacheLast = 0;
+static int icvDXTCacheCount = 0;
+static int icvDXTCacheMaxCount = ICV_DXT_CACHE_SIZE;
+
+static void icvDCTInit( int n, int elem_size, void* _wave, int inv );
+
+static CvDXTTab*
+icvCreateDXTTab( int n, int depth, int kind )
+{
+    CvDXTTab* tab = 0;
+
+    CV_FUNCNAME( "icvCreateDXTTab" );
+
+    __BEGIN__;
+
+    int complex_elem_size = depth == CV_32F ? sizeof(CvComplex32f) : sizeof(CvComplex64f);
+    int dct = kind >= ICV_DXT_TAB_DCT;
+    int inv = kind == ICV_DXT_TAB_DFT_INV || kind == ICV_DXT_TAB_DCT_INV;
+    int hdr_size = cvAlign( sizeof(*tab), 16 );
+    int itab_size = cvAlign( n*sizeof(int), 16 );
+    int size = hdr_size + n*complex_elem_size + itab_size +
+               (dct ? (n/2 + 1)*complex_elem_size : 0);
+
+    CV_CALL( tab = (CvDXTTab*)cvAlloc( size ));
+    memset( tab, 0, sizeof(*tab) );
+    tab->n = n;
+    tab->depth = depth;
+    tab->kind = kind;
+    tab->refcount = 1;
+    tab->wave = (uchar*)tab + hdr_size;
+    tab->itab = (int*)((uchar*)tab->wave + n*complex_elem_size);
+    tab->dct_wave = dct ? (uchar*)tab->itab + itab_size : 0;
+
+    tab->nf = icvDFTFactorize( n, tab->factors );
+    icvDFTInit( n, tab->nf, tab->factors, tab->itab, complex_elem_size, tab->wave, inv );
+    if( dct )
+        icvDCTInit( n, complex_elem_size, tab->dct_wave, inv );
+
+    __END__;
+
+    return tab;
+}
+
+
+/* releases the least recently used tables that exceed the cache size;
+   must be called under the global lock */
+static void
+icvShrinkDXTCache( void )
+{
+    CvDXTTab* tab = icvDXTCacheLast;
+
+    while( icvDXTCacheCount > icvDXTCacheMaxCount && tab )
+    {
+        CvDXTTab* prev = tab->prev;
+        if( tab->refcount == 0 )
+        {
+            if( prev )
+                prev->next = tab->next;
+            else
+                icvDXTCacheFirst = tab->next;
+            if( tab->next )
+                tab->next->prev = prev;
+            else
+                icvDXTCacheLast = prev;
+            icvDXTCacheCount--;
+            cvFree( &tab );
+        }
+        tab = prev;
+    }
+}
+
+
+/* finds the tables in the cache and moves them to the front of the list;
+   must be called under the global lock */
+static CvDXTTab*
+icvFindDXTTab( int n, int depth, int kind )
+{
+    CvDXTTab* tab;
+
+    for( tab = icvDXTCacheFirst; tab != 0; tab = tab->next )
+    {
+        if( tab->n == n && tab->depth == depth && tab->kind == kind )
+        {
+            tab->refcount++;
+            if( tab->prev )
+            {
+                tab->prev->next = tab->next;
+                if( tab->next )
+                    tab->next->prev = tab->prev;
+                else
+                    icvDXTCacheLast = tab->prev;
+                tab->prev = 0;
+                tab->next = icvDXTCacheFirst;
+                icvDXTCacheFirst->prev = tab;
+                icvDXTCacheFirst = tab;
+            }
+            break;
+        }
+    }
+
+    return tab;
+}
+
+
+/* returns the tables of the transform with the reference counter incremented;
+   the tables are taken from the cache or built and put there */
+static CvDXTTab*
+icvAcquireDXTTab( int n, int depth, int kind )
+{
+    CvDXTTab* tab = 0;
+    CvDXTTab* new_tab = 0;
+
+    CV_FUNCNAME( "icvAcquireDXTTab" );
+
+    __BEGIN__;
+
+    cvLockGlobal();
+    tab = icvFindDXTTab( n, depth, kind );
+    cvUnlockGlobal();
+
+    if( tab )
+        EXIT;
+
+    // the tables are built without the lock held, so another thread
+    // may have put the same tables into the cache meanwhile
+    CV_CALL( new_tab = icvCreateDXTTab( n, depth, kind ));
+
+    cvLockGlobal();
+    tab = icvFindDXTTab( n, depth, kind );
+    if( !tab && icvDXTCacheMaxCount > 0 )
+    {
+        tab = new_tab;
+        new_tab = 0;
+        tab->cached = 1;
+        tab->next = icvDXTCacheFirst;
+        if( icvDXTCacheFirst )
+            icvDXTCacheFirst->prev = tab;
+        else
+            icvDXTCacheLast = tab;
+        icvDXTCacheFirst = tab;
+        icvDXTCacheCount++;
+        icvShrinkDXTCache();
+    }
+    cvUnlockGlobal();
+
+    if( !tab )
+    {
+        tab = new_tab;
+        new_tab = 0;
+    }
+
+    __END__;
+
+    if( new_tab )
+        cvFree( &new_tab );
+
+    return tab;
+}
+
+
+static void
+icvReleaseDXTTab( CvDXTTab* tab )
+{
+    int free_tab = 0;
+
+    if( !tab )
+        return;
+
+    cvLockGlobal();
+    if( --tab->refcount == 0 )
+    {
+        if( tab->cached )
+            icvShrinkDXTCache();
+        else
+            free_tab = 1;
+    }
+    cvUnlockGlobal();
+
+    if( free_tab )
+        cvFree( &tab );
+}
+
+
+/* returns the tables of the plan or, if the plan does not have them, from the cache.
+   The tables taken from the cache are stored in used[0..1] to be released by the caller */
+static CvDXTTab*
+icvGetDXTTab( const CvDFTPlan* plan, int n, int depth, int kind, CvDXTTab** used )
+{
+    int i;
+
+    for( i = 0; plan && i < plan->count; i++ )
+    {
+        CvDXTTab* tab = plan->tab[i];
+        if( tab->n == n && tab->depth == depth && tab->kind == kind )
+            return tab;
+    }
+
+    for( i = 0; i < 2; i++ )
+    {
+        CvDXTTab* tab = used[i];
+        if( tab && tab->n == n && tab->depth == depth && tab->kind == kind )
+            return tab;
+    }
+
+    i = used[0] != 0;
+    icvReleaseDXTTab( used[i] );
+    used[i] = icvAcquireDXTTab( n, depth, kind );
+    return used[i];
+}
+
+
+static CvDFTPlan*
+icvCreateDXTPlan( CvSize size, int type, int flags, int dct )
+{
+    CvDFTPlan* plan = 0;
+
+    CV_FUNCNAME( "icvCreateDXTPlan" );
+
+    __BEGIN__;
+
+    int depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
+    int inv = (flags & CV_DXT_INVERSE) != 0;
+    int len0, len1 = 0, kind0, kind1;
+
+    if( size.width <= 0 || size.height <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "Non-positive width or height" );
+
+    if( dct && ((depth != CV_32F && depth != CV_64F) || cn != 1) )
+        CV_ERROR( CV_StsUnsupportedFormat, "Only 32fC1 and 64fC1 formats are supported" );
+
+    if( !dct && ((depth != CV_32F && depth != CV_64F) || cn > 2) )
+        CV_ERROR( CV_StsUnsupportedFormat,
+        "Only 32fC1, 32fC2, 64fC1 and 64fC2 formats are supported" );
+
+    // the row transform (or the transform of the single column)
+    // and the column transform, if any
+    len0 = size.width == 1 && !(flags & CV_DXT_ROWS) ? size.height : size.width;
+    kind0 = dct ? ICV_DXT_TAB_DCT + inv : cn == 1 && inv ? ICV_DXT_TAB_DFT_INV : ICV_DXT_TAB_DFT;
+    kind1 = dct ? kind0 : ICV_DXT_TAB_DFT;
+    if( !(flags & CV_DXT_ROWS) && size.height > 1 && (size.height != len0 || kind1 != kind0) )
+        len1 = size.height;
+
+    if( dct && ((len0 > 1 && (len0 & 1)) || (len1 & 1)) )
+        CV_ERROR( CV_StsNotImplemented, "Odd-size DCT\'s are not implemented" );
+
+    CV_CALL( plan = (CvDFTPlan*)cvAlloc( sizeof(*plan) ));
+    memset( plan, 0, sizeof(*plan) );
+    plan->size = size;
+    plan->type = CV_MAT_TYPE(type);
+    plan->flags = flags;
+    plan->dct = dct;
+
+    CV_CALL( plan->tab[0] = icvAcquireDXTTab( len0, depth, kind0 ));
+    plan->count = 1;
+    if( len1 > 0 )
+    {
+        CV_CALL( plan->tab[1] = icvAcquireDXTTab( len1, depth, kind1 ));
+        plan->count = 2;
+    }
+
+    __END__;
+
+    if( cvGetErrStatus() < 0 )
+        cvReleaseDFTPlan( &plan );
+
+    return plan;
+}
+
+
+CV_IMPL CvDFTPlan*
+cvCreateDFTPlan( CvSize size, int type, int flags )
+{
+    return icvCreateDXTPlan( size, type, flags, 0 );
+}
+
+
+CV_IMPL CvDFTPlan*
+cvCreateDCTPlan( CvSize size, int type, int flags )
+{
+    return icvCreateDXTPlan( size, type, flags, 1 );
+}
+
+
+CV_IMPL void
+cvReleaseDFTPlan( CvDFTPlan** _plan )
+{
+    CV_FUNCNAME( "cvReleaseDFTPlan" );
+
+    __BEGIN__;
+
+    CvDFTPlan* plan;
+    int i;
+
+    if( !_plan )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    plan = *_plan;
+    if( !plan )
+        EXIT;
+
+    for( i = 0; i < plan->count; i++ )
+        icvReleaseDXTTab( plan->tab[i] );
+    cvFree( _plan );
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvSetDFTCacheSize( int max_count )
 {
-    int i, t0, t1;
-    const int* src = (const int*)_src;
-    int* dst0 = (int*)_dst0;
-    int* dst1 = (int*)_dst1;
-    src_step /= sizeof(src[0]);
+    CV_FUNCNAME( "cvSetDFTCacheSize" );
 
-    if( elem_size == sizeof(int) )
-    {
-        for( i = 0; i < len; i++, src += src_step )
-        {
-            t0 = src[0]; t1 = src[1];
-            dst0[i] = t0; dst1[i] = t1;
-        }
-    }
-    else if( elem_size == sizeof(int)*2 )
-    {
-        for( i = 0; i < len*2; i += 2, src += src_step )
-        {
-            t0 = src[0]; t1 = src[1];
-            dst0[i] = t0; dst0[i+1] = t1;
-            t0 = src[2]; t1 = src[3];
-            dst1[i] = t0; dst1[i+1] = t1;
-        }
-    }
-    else if( elem_size == sizeof(int)*4 )
-    {
-        for( i = 0; i < len*4; i += 4, src += src_step )
-        {
-            t0 = src[0]; t1 = src[1];
-            dst0[i] = t0; dst0[i+1] = t1;
-            t0 = src[2]; t1 = src[3];
-            dst0[i+2] = t0; dst0[i+3] = t1;
-            t0 = src[4]; t1 = src[5];
-            dst1[i] = t0; dst1[i+1] = t1;
-            t0 = src[6]; t1 = src[7];
-            dst1[i+2] = t0; dst1[i+3] = t1;
-        }
-    }
+    __BEGIN__;
+
+    if( max_count < 0 )
+        CV_ERROR( CV_StsOutOfRange, "The cache size must be non-negative" );
+
+    cvLockGlobal();
+    icvDXTCacheMaxCount = max_count;
+    icvShrinkDXTCache();
+    cvUnlockGlobal();
+
+    __END__;
 }
 
 
-static void
-icvCopyTo2Columns( const uchar* _src0, const uchar* _src1,
-                   uchar* _dst, int dst_step,
-                   int len, int elem_size )
+typedef CvStatus (CV_STDCALL *CvDFTFunc)(
+     const void* src, void* dst, int n, int nf, int* factors,
+     const int* itab, const void* wave, int tab_size,
+     const void* spec, void* buf, int inv, double scale );
+
+// the number of columns transposed and transformed at once
+#define ICV_DFT_COL_BLOCK       8
+// the minimal number of elements transformed by a thread
+#define ICV_DFT_PAR_MIN_SIZE    (1 << 12)
+
+/* The row-wise or the column-wise pass of the 2D transform */
+typedef struct CvDFTPassParams
 {
-    int i, t0, t1;
-    const int* src0 = (const int*)_src0;
-    const int* src1 = (const int*)_src1;
-    int* dst = (int*)_dst;
-    dst_step /= sizeof(dst[0]);
+    const uchar* src;
+    uchar* dst;
+    int src_step, dst_step;
+    int len, count;
+    int nf;
+    const int* factors;
+    const int* itab;
+    const void* wave;
+    const void* spec;
+    CvDFTFunc dft_func;
+    CvDFTBatchFunc_32fc batch_func; // 0 if the vectors are transformed one by one
+    int flags;
+    double scale;
+    int complex_elem_size;
+    int use_buf;
+    int nonzero_rows;               // the rows after that are set to zeros
+    int dptr_offset, dst_full_len;  // copying from the temporary output vector
+    uchar* buf;                     // per-thread buffers
+    int buf_step;
+}
+CvDFTPassParams;
 
-    if( elem_size == sizeof(int) )
+
+/* transforms the rows [start, end) */
+static void CV_CDECL
+icvDFTRowsBody( int start, int end, void* userdata )
+{
+    const CvDFTPassParams* p = (const CvDFTPassParams*)userdata;
+    uchar* ptr = p->buf + p->buf_step*cvGetThreadNum();
+    uchar* tmp_buf = 0;
+    int factors[34];
+    int i = start, k, len = p->len;
+
+    // the real transform modifies the factors temporarily
+    memcpy( factors, p->factors, p->nf*sizeof(factors[0]) );
+    if( p->use_buf )
     {
-        for( i = 0; i < len; i++, dst += dst_step )
-        {
-            t0 = src0[i]; t1 = src1[i];
-            dst[0] = t0; dst[1] = t1;
-        }
+        tmp_buf = ptr;
+        ptr += len*p->complex_elem_size;
     }
-    else if( elem_size == sizeof(int)*2 )
+
+    if( p->batch_func )
     {
-        for( i = 0; i < len*2; i += 2, dst += dst_step )
+        for( ; i <= MIN( end, p->nonzero_rows ) - ICV_DFT_BATCH; i += ICV_DFT_BATCH )
         {
-            t0 = src0[i]; t1 = src0[i+1];
-            dst[0] = t0; dst[1] = t1;
-            t0 = src1[i]; t1 = src1[i+1];
-            dst[2] = t0; dst[3] = t1;
+            const CvComplex32f* src[ICV_DFT_BATCH];
+            CvComplex32f* dst[ICV_DFT_BATCH];
+
+            for( k = 0; k < ICV_DFT_BATCH; k++ )
+            {
+                src[k] = (const CvComplex32f*)(p->src + (i + k)*p->src_step);
+                dst[k] = (CvComplex32f*)(p->dst + (i + k)*p->dst_step);
+            }
+            p->batch_func( src, dst, len, p->itab, (const CvComplex32f*)p->wave,
+                           p->flags & CV_DXT_INVERSE, p->scale, (float*)ptr );
         }
     }
-    else if( elem_size == sizeof(int)*4 )
+
+    for( ; i < end; i++ )
     {
-        for( i = 0; i < len*4; i += 4, dst += dst_step )
+        uchar* dptr0 = p->dst + i*p->dst_step;
+
+        if( i < p->nonzero_rows )
         {
-            t0 = src0[i]; t1 = src0[i+1];
-            dst[0] = t0; dst[1] = t1;
-            t0 = src0[i+2]; t1 = src0[i+3];
-            dst[2] = t0; dst[3] = t1;
-            t0 = src1[i]; t1 = src1[i+1];
-            dst[4] = t0; dst[5] = t1;
-            t0 = src1[i+2]; t1 = src1[i+3];
-            dst[6] = t0; dst[7] = t1;
+            uchar* dptr = tmp_buf ? tmp_buf : dptr0;
+            p->dft_func( p->src + i*p->src_step, dptr, len, p->nf, factors, p->itab,
+                         p->wave, len, p->spec, ptr, p->flags, p->scale );
+            if( dptr != dptr0 )
+                memcpy( dptr0, dptr + p->dptr_offset, p->dst_full_len );
         }
+        else
+            memset( dptr0, 0, p->dst_full_len );
     }
 }
 
 
-static void
-icvExpandCCS( uchar* _ptr, int len, int elem_size )
+/* transforms the blocks of ICV_DFT_COL_BLOCK complex columns [start, end).
+   Every block is transposed to the thread buffer, transformed there and transposed back */
+static void CV_CDECL
+icvDFTColsBody( int start, int end, void* userdata )
 {
-    int i;
-    _ptr -= elem_size;
-    memcpy( _ptr, _ptr + elem_size, elem_size );
-    memset( _ptr + elem_size, 0, elem_size );
-    if( (len & 1) == 0 )
-        memset( _ptr + (len+1)*elem_size, 0, elem_size );
+    const CvDFTPassParams* p = (const CvDFTPassParams*)userdata;
+    int len = p->len, vec_size = len*p->complex_elem_size;
+    uchar* buf = p->buf + p->buf_step*cvGetThreadNum();
+    uchar* dbuf = p->use_buf ? buf + vec_size*ICV_DFT_COL_BLOCK : buf;
+    uchar* ptr = buf + vec_size*ICV_DFT_COL_BLOCK*(p->use_buf + 1);
+    int factors[34];
+    int blk, j, k;
 
-    if( elem_size == sizeof(float) )
-    {
-        CvComplex32f* ptr = (CvComplex32f*)_ptr;
+    memcpy( factors, p->factors, p->nf*sizeof(factors[0]) );
 
-        for( i = 1; i < (len+1)/2; i++ )
-        {
-            CvComplex32f t;
-            t.re = ptr[i].re;
-            t.im = -ptr[i].im;
-            ptr[len-i] = t;
-        }
-    }
-    else
+    for( blk = start; blk < end; blk++ )
     {
-        CvComplex64f* ptr = (CvComplex64f*)_ptr;
+        int j0 = blk*ICV_DFT_COL_BLOCK;
+        int count = MIN( ICV_DFT_COL_BLOCK, p->count - j0 );
 
-        for( i = 1; i < (len+1)/2; i++ )
+        icvCopyFromColumns( p->src + j0*p->complex_elem_size, p->src_step,
+                            buf, count, len, p->complex_elem_size );
+        j = 0;
+
+        if( p->batch_func )
         {
-            CvComplex64f t;
-            t.re = ptr[i].re;
-            t.im = -ptr[i].im;
-            ptr[len-i] = t;
+            for( ; j <= count - ICV_DFT_BATCH; j += ICV_DFT_BATCH )
+            {
+                const CvComplex32f* src[ICV_DFT_BATCH];
+                CvComplex32f* dst[ICV_DFT_BATCH];
+
+                for( k = 0; k < ICV_DFT_BATCH; k++ )
+                {
+                    src[k] = (const CvComplex32f*)(buf + (j + k)*vec_size);
+                    dst[k] = (CvComplex32f*)(dbuf + (j + k)*vec_size);
+                }
+                p->batch_func( src, dst, len, p->itab, (const CvComplex32f*)p->wave,
+                               p->flags & CV_DXT_INVERSE, p->scale, (float*)ptr );
+            }
         }
-    }
-}
 
+        for( ; j < count; j++ )
+            p->dft_func( buf + j*vec_size, dbuf + j*vec_size, len, p->nf, factors,
+                         p->itab, p->wave, len, p->spec, ptr, p->flags, p->scale );
 
-typedef CvStatus (CV_STDCALL *CvDFTFunc)(
-     const void* src, void* dst, int n, int nf, int* factors,
-     const int* itab, const void* wave, int tab_size,
-     const void* spec, void* buf, int inv, double scale );
+        icvCopyToColumns( dbuf, p->dst + j0*p->complex_elem_size, p->dst_step,
+                          count, len, p->complex_elem_size );
+    }
+}
 
-CV_IMPL void
-cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
+static void
+icvDFT( const CvArr* srcarr, CvArr* dstarr, int flags,
+        int nonzero_rows, const CvDFTPlan* plan )
 {
     static CvDFTFunc dft_tbl[6];
     static int inittab = 0;
@@ -1749,12 +2776,13 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
     int local_alloc = 1;
     int depth = -1;
     void *spec_c = 0, *spec_r = 0, *spec = 0;
+    CvDXTTab* used_tab[] = { 0, 0 };
     
     CV_FUNCNAME( "cvDFT" );
 
     __BEGIN__;
 
-    int prev_len = 0, buf_size = 0, stage = 0;
+    int buf_size = 0, stage = 0, nthreads = cvGetNumThreads();
     int nf = 0, inv = (flags & CV_DXT_INVERSE) != 0;
     int real_transform = 0;
     CvMat *src = (CvMat*)srcarr, *dst = (CvMat*)dstarr;
@@ -1763,7 +2791,7 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
     int factors[34], inplace_transform = 0;
     int ipp_norm_flag = 0;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         dft_tbl[0] = (CvDFTFunc)icvDFT_32fc;
         dft_tbl[1] = (CvDFTFunc)icvRealDFT_32f;
@@ -1771,7 +2799,7 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
         dft_tbl[3] = (CvDFTFunc)icvDFT_64fc;
         dft_tbl[4] = (CvDFTFunc)icvRealDFT_64f;
         dft_tbl[5] = (CvDFTFunc)icvCCSIDFT_64f;
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT( src ))
@@ -1857,9 +2885,11 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
         uchar* wave = 0;
         int* itab = 0;
         uchar* ptr;
-        int i, len, count, sz = 0;
+        int i, len, count, sz = 0, thread_buf_size;
         int use_buf = 0, odd_real = 0;
         CvDFTFunc dft_func;
+        CvDFTBatchFunc_32fc batch_func = 0;
+        CvDFTPassParams p;
 
         if( stage == 0 ) // row-wise transform
         {
@@ -1876,7 +2906,6 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
         {
             len = dst->rows;
             count = !inv ? src0->cols : dst->cols;
-            sz = 2*len*complex_elem_size;
         }
 
         spec = 0;
@@ -1929,28 +2958,59 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
         }
         else
         {
-            if( len != prev_len )
-                nf = icvDFTFactorize( len, factors );
+            // the twiddle factors and the permutation table are shared with other
+            // transforms of the same length; the factors are copied because
+            // the real transform modifies them temporarily
+            CvDXTTab* tab;
+            CV_CALL( tab = icvGetDXTTab( plan, len, depth, stage == 0 && inv && real_transform ?
+                                         ICV_DXT_TAB_DFT_INV : ICV_DXT_TAB_DFT, used_tab ));
+            nf = tab->nf;
+            memcpy( factors, tab->factors, nf*sizeof(factors[0]) );
+            wave = (uchar*)tab->wave;
+            itab = tab->itab;
 
             inplace_transform = factors[0] == factors[nf-1];
-            sz += len*(complex_elem_size + sizeof(int));
             i = nf > 1 && (factors[0] & 1) == 0;
             if( (factors[i] & 1) != 0 && factors[i] > 5 )
                 sz += (factors[i]+1)*complex_elem_size;
 
             if( (stage == 0 && ((src->data.ptr == dst->data.ptr && !inplace_transform) || odd_real)) ||
                 (stage == 1 && !inplace_transform) )
-            {
                 use_buf = 1;
-                sz += len*complex_elem_size;
-            }
         }
 
+        // the power-of-2 complex single-precision transforms
+        // are done for several rows or columns at once
+        if( depth == CV_32F && !spec && nf == 1 && len >= 8 && (len & (len - 1)) == 0 &&
+            (stage == 1 || !real_transform) && count >= ICV_DFT_BATCH )
+        {
+            batch_func = (CvDFTBatchFunc_32fc)cvGetDispatchFunc( &icvDFTBatch_32fc_entry );
+            sz = MAX( sz, (int)ICV_DFT_BATCH_BUF_SIZE(len) );
+        }
+
+        // every thread gets the scratch buffer of the transform and the temporary
+        // output vector (stage 0) or the block of columns transposed to rows (stage 1)
+        if( stage == 0 )
+            sz += use_buf*len*complex_elem_size;
+        else
+            sz += ICV_DFT_COL_BLOCK*len*complex_elem_size*(use_buf + 1);
+        thread_buf_size = cvAlign( sz, 16 );
+        sz = thread_buf_size*nthreads;
+
+        memset( &p, 0, sizeof(p) );
+        p.len = len;
+        p.nf = nf;
+        p.factors = factors;
+        p.itab = itab;
+        p.wave = wave;
+        p.spec = spec;
+        p.batch_func = batch_func;
+        p.complex_elem_size = complex_elem_size;
+        p.use_buf = use_buf;
+        p.buf_step = thread_buf_size;
+
         if( sz > buf_size )
         {
-            prev_len = 0; // because we release the buffer,
-                          // force recalculation of
-                          // twiddle factors and permutation table
             if( !local_alloc && buffer )
                 cvFree( &buffer );
             if( sz <= CV_MAX_LOCAL_DFT_SIZE )
@@ -1967,35 +3027,17 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
             }
         }
 
-        ptr = (uchar*)buffer;
-        if( !spec )
-        {
-            wave = ptr;
-            ptr += len*complex_elem_size;
-            itab = (int*)ptr;
-            ptr = (uchar*)cvAlignPtr( ptr + len*sizeof(int), 16 );
-
-            if( len != prev_len || (!inplace_transform && inv && real_transform))
-                icvDFTInit( len, nf, factors, itab, complex_elem_size,
-                            wave, stage == 0 && inv && real_transform );
-            // otherwise reuse the tables calculated on the previous stage
-        }
+        ptr = (uchar*)cvAlignPtr( buffer, 16 );
 
         if( stage == 0 )
         {
-            uchar* tmp_buf = 0;
             int dptr_offset = 0;
             int dst_full_len = len*elem_size;
             int _flags = inv + (CV_MAT_CN(src->type) != CV_MAT_CN(dst->type) ?
                          ICV_DFT_COMPLEX_INPUT_OR_OUTPUT : 0);
-            if( use_buf )
-            {
-                tmp_buf = ptr;
-                ptr += len*complex_elem_size;
-                if( odd_real && !inv && len > 1 &&
-                    !(_flags & ICV_DFT_COMPLEX_INPUT_OR_OUTPUT))
-                    dptr_offset = elem_size;
-            }
+            if( use_buf && odd_real && !inv && len > 1 &&
+                !(_flags & ICV_DFT_COMPLEX_INPUT_OR_OUTPUT))
+                dptr_offset = elem_size;
 
             if( !inv && (_flags & ICV_DFT_COMPLEX_INPUT_OR_OUTPUT) )
                 dst_full_len += (len & 1) ? elem_size : complex_elem_size;
@@ -2010,25 +3052,21 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
             if( nonzero_rows <= 0 || nonzero_rows > count )
                 nonzero_rows = count;
 
-            for( i = 0; i < nonzero_rows; i++ )
-            {
-                uchar* sptr = src->data.ptr + i*src->step;
-                uchar* dptr0 = dst->data.ptr + i*dst->step;
-                uchar* dptr = dptr0;
-
-                if( tmp_buf )
-                    dptr = tmp_buf;
-                
-                dft_func( sptr, dptr, len, nf, factors, itab, wave, len, spec, ptr, _flags, scale );
-                if( dptr != dptr0 )
-                    memcpy( dptr0, dptr + dptr_offset, dst_full_len );
-            }
-
-            for( ; i < count; i++ )
-            {
-                uchar* dptr0 = dst->data.ptr + i*dst->step;
-                memset( dptr0, 0, dst_full_len );
-            }
+            p.src = src->data.ptr;
+            p.dst = dst->data.ptr;
+            p.src_step = src->step;
+            p.dst_step = dst->step;
+            p.count = count;
+            p.dft_func = dft_func;
+            p.flags = _flags;
+            p.scale = scale;
+            p.nonzero_rows = nonzero_rows;
+            p.dptr_offset = dptr_offset;
+            p.dst_full_len = dst_full_len;
+            p.buf = ptr;
+
+            cvParallelFor( count, icvDFTRowsBody, &p,
+                           MAX( ICV_DFT_BATCH, ICV_DFT_PAR_MIN_SIZE/len ));
 
             if( stage != 1 )
                 break;
@@ -2040,18 +3078,21 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
             uchar *buf0, *buf1, *dbuf0, *dbuf1;
             uchar* sptr0 = src->data.ptr;
             uchar* dptr0 = dst->data.ptr;
+
+            // the first and the last columns of the real transform are processed
+            // here, in the buffer of the current thread, the others - in parallel
+            p.buf = ptr;
+            ptr += thread_buf_size*cvGetThreadNum();
             buf0 = ptr;
-            ptr += len*complex_elem_size;
-            buf1 = ptr;
-            ptr += len*complex_elem_size;
+            buf1 = ptr + len*complex_elem_size;
             dbuf0 = buf0, dbuf1 = buf1;
             
             if( use_buf )
             {
-                dbuf1 = ptr;
+                dbuf1 = buf1 + len*complex_elem_size;
                 dbuf0 = buf1;
-                ptr += len*complex_elem_size;
             }
+            ptr += ICV_DFT_COL_BLOCK*len*complex_elem_size*(use_buf + 1);
 
             dft_func = dft_tbl[(depth == CV_64F)*3];
 
@@ -2152,26 +3193,19 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
                 }
             }
 
-            for( i = a; i < b; i += 2 )
+            if( a < b )
             {
-                if( i+1 < b )
-                {
-                    icvCopyFrom2Columns( sptr0, src->step, buf0, buf1, len, complex_elem_size );
-                    IPPI_CALL( dft_func( buf1, dbuf1, len, nf, factors, itab,
-                                         wave, len, spec, ptr, inv, scale ));
-                }
-                else
-                    icvCopyColumn( sptr0, src->step, buf0, complex_elem_size, len, complex_elem_size );
-
-                IPPI_CALL( dft_func( buf0, dbuf0, len, nf, factors, itab,
-                                     wave, len, spec, ptr, inv, scale ));
-
-                if( i+1 < b )
-                    icvCopyTo2Columns( dbuf0, dbuf1, dptr0, dst->step, len, complex_elem_size );
-                else
-                    icvCopyColumn( dbuf0, complex_elem_size, dptr0, dst->step, len, complex_elem_size );
-                sptr0 += 2*complex_elem_size;
-                dptr0 += 2*complex_elem_size;
+                p.src = sptr0;
+                p.dst = dptr0;
+                p.src_step = src->step;
+                p.dst_step = dst->step;
+                p.count = b - a;
+                p.dft_func = dft_func;
+                p.flags = inv;
+                p.scale = scale;
+
+                cvParallelFor( (b - a + ICV_DFT_COL_BLOCK - 1)/ICV_DFT_COL_BLOCK, icvDFTColsBody,
+                               &p, MAX( 1, ICV_DFT_PAR_MIN_SIZE/(len*ICV_DFT_COL_BLOCK) ));
             }
 
             if( stage != 0 )
@@ -2200,6 +3234,176 @@ cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
         else
             icvDFTFree_R_64f_p( spec_r );
     }
+
+    icvReleaseDXTTab( used_tab[0] );
+    icvReleaseDXTTab( used_tab[1] );
+}
+
+
+CV_IMPL void
+cvDFT( const CvArr* srcarr, CvArr* dstarr, int flags, int nonzero_rows )
+{
+    icvDFT( srcarr, dstarr, flags, nonzero_rows, 0 );
+}
+
+
+/* checks that the signal (the source of the forward transform or the destination
+   of the inverse one) matches the plan */
+static void
+icvCheckDXTPlan( const CvArr* srcarr, CvArr* dstarr, const CvDFTPlan* plan, int dct )
+{
+    CV_FUNCNAME( "icvCheckDXTPlan" );
+
+    __BEGIN__;
+
+    CvMat stub, *mat;
+    int coi = 0;
+
+    if( !plan )
+        CV_ERROR( CV_StsNullPtr, "NULL plan" );
+
+    if( plan->dct != dct )
+        CV_ERROR( CV_StsBadArg, dct ? "The plan is not a DCT plan" : "The plan is not a DFT plan" );
+
+    CV_CALL( mat = cvGetMat( plan->flags & CV_DXT_INVERSE ? (const CvArr*)dstarr : srcarr,
+                             &stub, &coi ));
+
+    if( CV_MAT_TYPE(mat->type) != plan->type )
+        CV_ERROR( CV_StsUnmatchedFormats, "The array type does not match the plan" );
+
+    if( mat->cols != plan->size.width || mat->rows != plan->size.height )
+        CV_ERROR( CV_StsUnmatchedSizes, "The array size does not match the plan" );
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvDFTWithPlan( const CvArr* srcarr, CvArr* dstarr, const CvDFTPlan* plan, int nonzero_rows )
+{
+    CV_FUNCNAME( "cvDFTWithPlan" );
+
+    __BEGIN__;
+
+    CV_CALL( icvCheckDXTPlan( srcarr, dstarr, plan, 0 ));
+    CV_CALL( icvDFT( srcarr, dstarr, plan->flags, nonzero_rows, plan ));
+
+    __END__;
+}
+
+
+CV_IMPL void
+cvDFTBatch( const CvArr** srcarr, CvArr** dstarr, int count,
+            int flags, const CvDFTPlan* plan )
+{
+    void* buffer = 0;
+    int local_alloc = 1;
+    CvDXTTab* used_tab[] = { 0, 0 };
+
+    CV_FUNCNAME( "cvDFTBatch" );
+
+    __BEGIN__;
+
+    CvMat srcstub, dststub, *src, *dst;
+    CvSize size = { 0, 0 };
+    int i, k, len, type = 0, nbatch = 0;
+    int batch_idx[ICV_DFT_BATCH];
+    const CvComplex32f* batch_src[ICV_DFT_BATCH];
+    CvComplex32f* batch_dst[ICV_DFT_BATCH];
+    CvDFTBatchFunc_32fc batch_func = 0;
+    const CvDXTTab* tab = 0;
+    double scale;
+
+    if( !srcarr || !dstarr )
+        CV_ERROR( CV_StsNullPtr, "" );
+
+    if( count <= 0 )
+        CV_ERROR( CV_StsOutOfRange, "The number of signals must be positive" );
+
+    if( plan )
+    {
+        CV_CALL( icvCheckDXTPlan( srcarr[0], dstarr[0], plan, 0 ));
+        flags = plan->flags;
+    }
+
+    for( i = 0; i < count; i++ )
+    {
+        CV_CALL( src = cvGetMat( srcarr[i], &srcstub ));
+
+        if( src->rows != 1 && src->cols != 1 )
+            CV_ERROR( CV_StsBadSize, "The signals must be single-row or single-column arrays" );
+
+        if( i == 0 )
+        {
+            size = cvGetMatSize( src );
+            type = CV_MAT_TYPE(src->type);
+        }
+
+        if( CV_MAT_TYPE(src->type) != type )
+            CV_ERROR( CV_StsUnmatchedFormats, "All the signals must have the same type" );
+
+        if( src->rows != size.height || src->cols != size.width )
+            CV_ERROR( CV_StsUnmatchedSizes, "All the signals must have the same size" );
+    }
+
+    // the complex single-precision power-of-2 signals are transformed
+    // ICV_DFT_BATCH at once, the others - one by one
+    len = size.width*size.height;
+    scale = flags & CV_DXT_SCALE ? 1./len : 1.;
+
+    if( type == CV_32FC2 && len >= 8 && (len & (len - 1)) == 0 && count >= ICV_DFT_BATCH )
+    {
+        int sz = ICV_DFT_BATCH_BUF_SIZE(len);
+
+        CV_CALL( tab = icvGetDXTTab( plan, len, CV_32F, ICV_DXT_TAB_DFT, used_tab ));
+        batch_func = (CvDFTBatchFunc_32fc)cvGetDispatchFunc( &icvDFTBatch_32fc_entry );
+
+        if( sz <= CV_MAX_LOCAL_DFT_SIZE )
+            buffer = cvStackAlloc( sz );
+        else
+        {
+            CV_CALL( buffer = cvAlloc( sz ));
+            local_alloc = 0;
+        }
+    }
+
+    for( i = 0; i < count; i++ )
+    {
+        if( batch_func )
+        {
+            CV_CALL( src = cvGetMat( srcarr[i], &srcstub ));
+            CV_CALL( dst = cvGetMat( dstarr[i], &dststub ));
+
+            if( CV_ARE_TYPES_EQ( src, dst ) && CV_ARE_SIZES_EQ( src, dst ) &&
+                (src->rows == 1 || CV_IS_MAT_CONT( src->type & dst->type )))
+            {
+                batch_idx[nbatch] = i;
+                batch_src[nbatch] = (const CvComplex32f*)src->data.ptr;
+                batch_dst[nbatch] = (CvComplex32f*)dst->data.ptr;
+                if( ++nbatch == ICV_DFT_BATCH )
+                {
+                    batch_func( batch_src, batch_dst, len, tab->itab,
+                                (const CvComplex32f*)tab->wave,
+                                flags & CV_DXT_INVERSE, scale, (float*)buffer );
+                    nbatch = 0;
+                }
+                continue;
+            }
+        }
+
+        CV_CALL( icvDFT( srcarr[i], dstarr[i], flags, 0, plan ));
+    }
+
+    for( k = 0; k < nbatch; k++ )
+        CV_CALL( icvDFT( srcarr[batch_idx[k]], dstarr[batch_idx[k]], flags, 0, plan ));
+
+    __END__;
+
+    if( buffer && !local_alloc )
+        cvFree( &buffer );
+
+    icvReleaseDXTTab( used_tab[0] );
+    icvReleaseDXTTab( used_tab[1] );
 }
 
 
@@ -2577,8 +3781,8 @@ typedef CvStatus (CV_STDCALL * CvDCTFunc)(
                 int nf, int* factors, const int* itab, const void* dft_wave,
                 const void* dct_wave, const void* spec, void* buf );
 
-CV_IMPL void
-cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
+static void
+icvDCT( const CvArr* srcarr, CvArr* dstarr, int flags, const CvDFTPlan* plan )
 {
     static CvDCTFunc dct_tbl[4];
     static int inittab = 0;
@@ -2587,6 +3791,7 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
     int local_alloc = 1;
     int inv = (flags & CV_DXT_INVERSE) != 0, depth = -1;
     void *spec_dft = 0, *spec = 0;
+    CvDXTTab* used_tab[] = { 0, 0 };
     
     CV_FUNCNAME( "cvDCT" );
 
@@ -2605,13 +3810,13 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
     int i, len, count;
     CvDCTFunc dct_func;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         dct_tbl[0] = (CvDCTFunc)icvDCT_fwd_32f;
         dct_tbl[1] = (CvDCTFunc)icvDCT_inv_32f;
         dct_tbl[2] = (CvDCTFunc)icvDCT_fwd_64f;
         dct_tbl[3] = (CvDCTFunc)icvDCT_inv_64f;
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT( src ))
@@ -2686,13 +3891,16 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
 
         if( len != prev_len )
         {
+            CvDXTTab* tab;
             int sz;
 
             if( len > 1 && (len & 1) )
                 CV_ERROR( CV_StsNotImplemented, "Odd-size DCT\'s are not implemented" );
 
             sz = len*elem_size;
-            sz += (len/2 + 1)*complex_elem_size;
+
+            CV_CALL( tab = icvGetDXTTab( plan, len, depth, ICV_DXT_TAB_DCT + inv, used_tab ));
+            dct_wave = (uchar*)tab->dct_wave;
 
             spec = 0;
             inplace_transform = 1;
@@ -2718,9 +3926,12 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
             }
             else
             {
-                sz += len*(complex_elem_size + sizeof(int)) + complex_elem_size;
+                nf = tab->nf;
+                memcpy( factors, tab->factors, nf*sizeof(factors[0]) );
+                dft_wave = (uchar*)tab->wave;
+                itab = tab->itab;
+                sz += complex_elem_size;
 
-                nf = icvDFTFactorize( len, factors );
                 inplace_transform = factors[0] == factors[nf-1];
 
                 i = nf > 1 && (factors[0] & 1) == 0;
@@ -2749,18 +3960,7 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
                 }
             }
 
-            ptr = (uchar*)buffer;
-            if( !spec )
-            {
-                dft_wave = ptr;
-                ptr += len*complex_elem_size;
-                itab = (int*)ptr;
-                ptr = (uchar*)cvAlignPtr( ptr + len*sizeof(int), 16 );
-                icvDFTInit( len, nf, factors, itab, complex_elem_size, dft_wave, inv );
-            }
-                
-            dct_wave = ptr;
-            ptr += (len/2 + 1)*complex_elem_size;
+            ptr = (uchar*)cvAlignPtr( buffer, 16 );
             src_dft_buf = dst_dft_buf = ptr;
             ptr += len*elem_size;
             if( !inplace_transform )
@@ -2768,7 +3968,6 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
                 dst_dft_buf = ptr;
                 ptr += len*elem_size;
             }
-            icvDCTInit( len, complex_elem_size, dct_wave, inv );
             if( !inv )
                 scale += scale;
             prev_len = len;
@@ -2796,6 +3995,30 @@ cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
 
     if( buffer && !local_alloc )
         cvFree( &buffer );
+
+    icvReleaseDXTTab( used_tab[0] );
+    icvReleaseDXTTab( used_tab[1] );
+}
+
+
+CV_IMPL void
+cvDCT( const CvArr* srcarr, CvArr* dstarr, int flags )
+{
+    icvDCT( srcarr, dstarr, flags, 0 );
+}
+
+
+CV_IMPL void
+cvDCTWithPlan( const CvArr* srcarr, CvArr* dstarr, const CvDFTPlan* plan )
+{
+    CV_FUNCNAME( "cvDCTWithPlan" );
+
+    __BEGIN__;
+
+    CV_CALL( icvCheckDXTPlan( srcarr, dstarr, plan, 1 ));
+    CV_CALL( icvDCT( srcarr, dstarr, plan->flags, plan ));
+
+    __END__;
 }
 
 
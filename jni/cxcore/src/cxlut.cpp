@@ -207,6 +207,81 @@ typedef CvStatus (CV_STDCALL * CvLUT_TransformCnFunc)(
     const void* src, int srcstep, void* dst,
     int dststep, CvSize size, const void* lut, int cn );
 
+/*
+   The 8-bit LUT is a byte gather, which neither SSE2 nor NEON (vtbl is limited to
+   32-byte tables) can do faster than the scalar loads, so large images are instead
+   split into horizontal stripes transformed on cvGetNumThreads() threads.
+*/
+#define ICV_LUT_PARALLEL_MIN_SIZE  (1 << 16)
+
+typedef struct CvLUTParallelParams
+{
+    CvLUT_TransformFunc func;
+    CvLUT_TransformCnFunc func_cn;
+    const uchar* src;
+    int srcstep;
+    uchar* dst;
+    int dststep;
+    int width, cn;
+    const void* lut;
+}
+CvLUTParallelParams;
+
+static void CV_CDECL
+icvLUTParallelBody( int start, int end, void* _params )
+{
+    const CvLUTParallelParams* p = (const CvLUTParallelParams*)_params;
+    const uchar* src = p->src + start*p->srcstep;
+    uchar* dst = p->dst + start*p->dststep;
+    CvSize size = { p->width, end - start };
+
+    if( p->func )
+        p->func( src, p->srcstep, dst, p->dststep, size, p->lut );
+    else
+        p->func_cn( src, p->srcstep, dst, p->dststep, size, p->lut, p->cn );
+}
+
+static void
+icvLUTParallel( CvLUT_TransformFunc func, CvLUT_TransformCnFunc func_cn,
+                const uchar* src, int srcstep, uchar* dst, int dststep,
+                CvSize size, const void* lut, int cn, int src_esz, int dst_esz )
+{
+    CvLUTParallelParams p;
+
+    // a continuous array is processed as a sequence of fixed-size row blocks
+    if( size.height == 1 )
+    {
+        const int block = 1 << 12;
+        int rows = size.width/block, tail = size.width - rows*block;
+        if( tail > 0 )
+        {
+            CvSize tsize = { tail, 1 };
+            const uchar* tsrc = src + rows*block*src_esz;
+            uchar* tdst = dst + rows*block*dst_esz;
+            if( func )
+                func( tsrc, CV_STUB_STEP, tdst, CV_STUB_STEP, tsize, lut );
+            else
+                func_cn( tsrc, CV_STUB_STEP, tdst, CV_STUB_STEP, tsize, lut, cn );
+        }
+        size = cvSize( block, rows );
+        srcstep = block*src_esz;
+        dststep = block*dst_esz;
+    }
+
+    p.func = func;
+    p.func_cn = func_cn;
+    p.src = src;
+    p.srcstep = srcstep;
+    p.dst = dst;
+    p.dststep = dststep;
+    p.width = size.width;
+    p.cn = cn;
+    p.lut = lut;
+
+    cvParallelFor( size.height, icvLUTParallelBody, &p,
+                   MAX( ICV_LUT_PARALLEL_MIN_SIZE/(size.width*cn), 1 ));
+}
+
 CV_IMPL  void
 cvLUT( const void* srcarr, void* dstarr, const void* lutarr )
 {
@@ -227,7 +302,7 @@ cvLUT( const void* srcarr, void* dstarr, const void* lutarr )
     uchar* shuffled_lut = 0;
     CvSize size;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitLUT_Transform8uC1RTable( &lut_c1_tab );
         icvInitLUT_Transform8uCnRTable( &lut_cn_tab );
@@ -235,7 +310,7 @@ cvLUT( const void* srcarr, void* dstarr, const void* lutarr )
         lut_8u_tab[1] = (CvLUT_TransformFunc)icvLUT_Transform8u_8u_C2R;
         lut_8u_tab[2] = (CvLUT_TransformFunc)icvLUT_Transform8u_8u_C3R;
         lut_8u_tab[3] = (CvLUT_TransformFunc)icvLUT_Transform8u_8u_C4R;
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(src) )
@@ -303,8 +378,12 @@ cvLUT( const void* srcarr, void* dstarr, const void* lutarr )
         if( !func )
             CV_ERROR( CV_StsUnsupportedFormat, "" );
 
-        IPPI_CALL( func( src->data.ptr, src->step, dst->data.ptr,
-                         dst->step, size, lut_data ));
+        if( size.width*size.height*cn >= ICV_LUT_PARALLEL_MIN_SIZE*2 && cvGetNumThreads() > 1 )
+            icvLUTParallel( func, 0, src->data.ptr, src->step, dst->data.ptr, dst->step,
+                            size, lut_data, cn, cn, CV_ELEM_SIZE1(depth)*cn );
+        else
+            IPPI_CALL( func( src->data.ptr, src->step, dst->data.ptr,
+                             dst->step, size, lut_data ));
     }
     else
     {
@@ -314,8 +393,12 @@ cvLUT( const void* srcarr, void* dstarr, const void* lutarr )
         if( !func )
             CV_ERROR( CV_StsUnsupportedFormat, "" );
 
-        IPPI_CALL( func( src->data.ptr, src->step, dst->data.ptr,
-                         dst->step, size, lut_data, cn ));
+        if( size.width*size.height*cn >= ICV_LUT_PARALLEL_MIN_SIZE*2 && cvGetNumThreads() > 1 )
+            icvLUTParallel( 0, func, src->data.ptr, src->step, dst->data.ptr, dst->step,
+                            size, lut_data, cn, cn, CV_ELEM_SIZE1(depth)*cn );
+        else
+            IPPI_CALL( func( src->data.ptr, src->step, dst->data.ptr,
+                             dst->step, size, lut_data, cn ));
     }
 
     __END__;
@@ -309,6 +309,584 @@ icvSqrMagnitude_##flavor(const arrtype* x, const arrtype* y,\
 ICV_DEF_SQR_MAGNITUDE_FUNC( 32f, float, float )
 ICV_DEF_SQR_MAGNITUDE_FUNC( 64f, double, double )
 
+/****************************************************************************************\
+*                      Single-precision kernels of the CV_MATH_FAST mode                 *
+\****************************************************************************************/
+
+static int icvMathMode = CV_MATH_PRECISE;
+
+CV_IMPL void
+cvSetMathMode( int mode )
+{
+    CV_FUNCNAME( "cvSetMathMode" );
+
+    __BEGIN__;
+
+    if( mode != CV_MATH_PRECISE && mode != CV_MATH_FAST )
+        CV_ERROR( CV_StsBadArg, "Unknown math mode" );
+
+    icvMathMode = mode;
+
+    __END__;
+}
+
+
+CV_IMPL int
+cvGetMathMode( void )
+{
+    return icvMathMode;
+}
+
+
+/* The argument reduction and the polynomials are those of Cephes expf and logf.
+   The whole computation is done in single precision, and the SIMD variants perform
+   the same operations as the C code (NEON replaces the division and the square root
+   with refined reciprocal estimates). The arguments of exp are clipped to
+   [ICV_EXP_FAST_MIN, ICV_EXP_FAST_MAX], which still gives 0 and +inf at the ends */
+#define ICV_EXP_FAST_MIN  -104.f
+#define ICV_EXP_FAST_MAX  88.8f
+#define ICV_LOG2E         1.44269504088896341f
+#define ICV_LN2_HI        0.693359375f
+#define ICV_LN2_LO        -2.12194440e-4f
+#define ICV_SQRT_HALF     0.707106781186547524f
+
+#define ICV_EXP_FAST_P0   1.9875691500e-4f
+#define ICV_EXP_FAST_P1   1.3981999507e-3f
+#define ICV_EXP_FAST_P2   8.3334519073e-3f
+#define ICV_EXP_FAST_P3   4.1665795894e-2f
+#define ICV_EXP_FAST_P4   1.6666665459e-1f
+#define ICV_EXP_FAST_P5   5.0000001201e-1f
+
+#define ICV_LOG_FAST_P0   7.0376836292e-2f
+#define ICV_LOG_FAST_P1   -1.1514610310e-1f
+#define ICV_LOG_FAST_P2   1.1676998740e-1f
+#define ICV_LOG_FAST_P3   -1.2420140846e-1f
+#define ICV_LOG_FAST_P4   1.4249322787e-1f
+#define ICV_LOG_FAST_P5   -1.6668057665e-1f
+#define ICV_LOG_FAST_P6   2.0000714765e-1f
+#define ICV_LOG_FAST_P7   -2.4999993993e-1f
+#define ICV_LOG_FAST_P8   3.3333331174e-1f
+
+typedef void (CV_CDECL * CvMathFastFunc_32f)( const float* src, float* dst, int len );
+typedef void (CV_CDECL * CvPowFastFunc_32f)( const float* src, float* dst,
+                                             int len, float power );
+typedef void (CV_CDECL * CvCartToPolarFastFunc_32f)( const float* x, const float* y,
+                                                     float* mag, float* angle,
+                                                     int len, float angle_scale );
+
+static inline float
+icvExpFast( float x )
+{
+    Cv32suf s1, s2;
+    float t, y, z;
+    int n;
+
+    x = MIN( MAX( x, ICV_EXP_FAST_MIN ), ICV_EXP_FAST_MAX );
+    t = x*ICV_LOG2E + 0.5f;
+    n = cvFloor( t );
+    t = (float)n;
+    x = x - t*ICV_LN2_HI - t*ICV_LN2_LO;
+    z = x*x;
+    y = ((((ICV_EXP_FAST_P0*x + ICV_EXP_FAST_P1)*x + ICV_EXP_FAST_P2)*x +
+        ICV_EXP_FAST_P3)*x + ICV_EXP_FAST_P4)*x + ICV_EXP_FAST_P5;
+    y = y*z + x + 1.f;
+
+    // n is within [-150,128], so 2^n is applied as the product of two normal numbers
+    s1.i = ((n >> 1) + 127) << 23;
+    s2.i = ((n - (n >> 1)) + 127) << 23;
+    return y*s1.f*s2.f;
+}
+
+
+static inline float
+icvLogFast( float x )
+{
+    Cv32suf v;
+    float e, y, z;
+
+    v.f = x;
+    v.i &= 0x7fffffff;
+    if( v.i < 0x00800000 )   // zeros and denormals are treated as FLT_MIN
+        v.i = 0x00800000;
+    e = (float)((v.i >> 23) - 126);
+    v.i = (v.i & 0x007fffff) | 0x3f000000;
+    x = v.f;
+
+    if( x < ICV_SQRT_HALF )
+    {
+        e -= 1.f;
+        x = x + x - 1.f;
+    }
+    else
+        x = x - 1.f;
+
+    z = x*x;
+    y = (((((((ICV_LOG_FAST_P0*x + ICV_LOG_FAST_P1)*x + ICV_LOG_FAST_P2)*x +
+        ICV_LOG_FAST_P3)*x + ICV_LOG_FAST_P4)*x + ICV_LOG_FAST_P5)*x +
+        ICV_LOG_FAST_P6)*x + ICV_LOG_FAST_P7)*x + ICV_LOG_FAST_P8;
+    y = y*x*z + e*ICV_LN2_LO - 0.5f*z;
+    return x + y + e*ICV_LN2_HI;
+}
+
+
+// the same approximation as in cvFastArctan, result is in degrees
+static inline float
+icvArctanFast( float y, float x )
+{
+    float ax = (float)fabs(x), ay = (float)fabs(y);
+    float z = MIN( ax, ay )/(MAX( ax, ay ) + FLT_MIN);
+    float a = (_CV_ATAN_CF0*z + _CV_ATAN_CF1)*z;
+
+    if( ay > ax )
+        a = 90.f - a;
+    if( x < 0 )
+        a = 180.f - a;
+    if( y < 0 )
+        a = 360.f - a;
+    return a;
+}
+
+
+static void CV_CDECL
+icvExpFast_32f_C( const float* src, float* dst, int len )
+{
+    int i;
+    for( i = 0; i < len; i++ )
+        dst[i] = icvExpFast( src[i] );
+}
+
+
+static void CV_CDECL
+icvLogFast_32f_C( const float* src, float* dst, int len )
+{
+    int i;
+    for( i = 0; i < len; i++ )
+        dst[i] = icvLogFast( src[i] );
+}
+
+
+// |x|^power; 0^power is 0 for positive and +inf for negative powers
+static void CV_CDECL
+icvPowFast_32f_C( const float* src, float* dst, int len, float power )
+{
+    Cv32suf zval;
+    int i;
+
+    zval.i = power > 0 ? 0 : 0x7f800000;
+    for( i = 0; i < len; i++ )
+        dst[i] = src[i] != 0 ? icvExpFast( icvLogFast( src[i] )*power ) : zval.f;
+}
+
+
+static void CV_CDECL
+icvCartToPolarFast_32f_C( const float* x, const float* y, float* mag,
+                          float* angle, int len, float angle_scale )
+{
+    int i;
+
+    // the outputs may be the same arrays as the inputs
+    for( i = 0; i < len; i++ )
+    {
+        float x0 = x[i], y0 = y[i];
+        if( mag )
+            mag[i] = (float)sqrt( x0*x0 + y0*y0 );
+        if( angle )
+            angle[i] = icvArctanFast( y0, x0 )*angle_scale;
+    }
+}
+
+
+#if CV_SSE2
+
+static inline __m128
+icvExpFast_SSE2( __m128 x )
+{
+    const __m128 one = _mm_set1_ps( 1.f );
+    __m128 t, y, z, adj;
+    __m128i n, n1, bias = _mm_set1_epi32( 127 );
+
+    x = _mm_min_ps( _mm_max_ps( x, _mm_set1_ps( ICV_EXP_FAST_MIN )),
+                    _mm_set1_ps( ICV_EXP_FAST_MAX ));
+    t = _mm_add_ps( _mm_mul_ps( x, _mm_set1_ps( ICV_LOG2E )), _mm_set1_ps( 0.5f ));
+
+    // floor(t): the truncation rounds the negative values up
+    n = _mm_cvttps_epi32( t );
+    z = _mm_cvtepi32_ps( n );
+    adj = _mm_cmpgt_ps( z, t );
+    n = _mm_add_epi32( n, _mm_castps_si128( adj ));
+    t = _mm_sub_ps( z, _mm_and_ps( adj, one ));
+
+    x = _mm_sub_ps( _mm_sub_ps( x, _mm_mul_ps( t, _mm_set1_ps( ICV_LN2_HI ))),
+                    _mm_mul_ps( t, _mm_set1_ps( ICV_LN2_LO )));
+    z = _mm_mul_ps( x, x );
+    y = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( ICV_EXP_FAST_P0 ), x ), _mm_set1_ps( ICV_EXP_FAST_P1 ));
+    y = _mm_add_ps( _mm_mul_ps( y, x ), _mm_set1_ps( ICV_EXP_FAST_P2 ));
+    y = _mm_add_ps( _mm_mul_ps( y, x ), _mm_set1_ps( ICV_EXP_FAST_P3 ));
+    y = _mm_add_ps( _mm_mul_ps( y, x ), _mm_set1_ps( ICV_EXP_FAST_P4 ));
+    y = _mm_add_ps( _mm_mul_ps( y, x ), _mm_set1_ps( ICV_EXP_FAST_P5 ));
+    y = _mm_add_ps( _mm_add_ps( _mm_mul_ps( y, z ), x ), one );
+
+    n1 = _mm_srai_epi32( n, 1 );
+    n = _mm_sub_epi32( n, n1 );
+    y = _mm_mul_ps( y, _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( n1, bias ), 23 )));
+    return _mm_mul_ps( y, _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( n, bias ), 23 )));
+}
+
+
+static inline __m128
+icvLogFast_SSE2( __m128 x )
+{
+    const __m128 one = _mm_set1_ps( 1.f );
+    __m128 e, y, z, mask;
+    __m128i v = _mm_and_si128( _mm_castps_si128( x ), _mm_set1_epi32( 0x7fffffff ));
+
+    // max(|x|, FLT_MIN); the integer comparison is fine as both are non-negative
+    mask = _mm_castsi128_ps( _mm_cmplt_epi32( v, _mm_set1_epi32( 0x00800000 )));
+    v = _mm_or_si128( _mm_andnot_si128( _mm_castps_si128( mask ), v ),
+                      _mm_and_si128( _mm_castps_si128( mask ), _mm_set1_epi32( 0x00800000 )));
+    e = _mm_cvtepi32_ps( _mm_sub_epi32( _mm_srli_epi32( v, 23 ), _mm_set1_epi32( 126 )));
+    x = _mm_castsi128_ps( _mm_or_si128( _mm_and_si128( v, _mm_set1_epi32( 0x007fffff )),
+                                        _mm_set1_epi32( 0x3f000000 )));
+
+    mask = _mm_cmplt_ps( x, _mm_set1_ps( ICV_SQRT_HALF ));
+    e = _mm_sub_ps( e, _mm_and_ps( mask, one ));
+    x = _mm_sub_ps( _mm_add_ps( x, _mm_and_ps( mask, x )), one );
+
+    z = _mm_mul_ps( x, x );
+    y = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( ICV_LOG_FAST_P0 ), x ), _mm_set1_ps( ICV_LOG_FAST_P1 ));
+    y = _mm_add_ps( _mm_mul_ps( y, x ), _mm_set1_ps( ICV_LOG_FAST_P2 ));
+    y = _mm_add_ps( _mm_mul_ps( y, x ), _mm_set1_ps( ICV_LOG_FAST_P3 ));
+    y = _mm_add_ps( _mm_mul_ps( y, x ), _mm_set1_ps( ICV_LOG_FAST_P4 ));
+    y = _mm_add_ps( _mm_mul_ps( y, x ), _mm_set1_ps( ICV_LOG_FAST_P5 ));
+    y = _mm_add_ps( _mm_mul_ps( y, x ), _mm_set1_ps( ICV_LOG_FAST_P6 ));
+    y = _mm_add_ps( _mm_mul_ps( y, x ), _mm_set1_ps( ICV_LOG_FAST_P7 ));
+    y = _mm_add_ps( _mm_mul_ps( y, x ), _mm_set1_ps( ICV_LOG_FAST_P8 ));
+    y = _mm_add_ps( _mm_mul_ps( _mm_mul_ps( y, x ), z ),
+                    _mm_mul_ps( e, _mm_set1_ps( ICV_LN2_LO )));
+    y = _mm_sub_ps( y, _mm_mul_ps( z, _mm_set1_ps( 0.5f )));
+    return _mm_add_ps( _mm_add_ps( x, y ), _mm_mul_ps( e, _mm_set1_ps( ICV_LN2_HI )));
+}
+
+
+static void CV_CDECL
+icvExpFast_32f_SSE2( const float* src, float* dst, int len )
+{
+    int i = 0;
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m128 y0 = icvExpFast_SSE2( _mm_loadu_ps( src + i ));
+        __m128 y1 = icvExpFast_SSE2( _mm_loadu_ps( src + i + 4 ));
+        _mm_storeu_ps( dst + i, y0 );
+        _mm_storeu_ps( dst + i + 4, y1 );
+    }
+    icvExpFast_32f_C( src + i, dst + i, len - i );
+}
+
+
+static void CV_CDECL
+icvLogFast_32f_SSE2( const float* src, float* dst, int len )
+{
+    int i = 0;
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m128 y0 = icvLogFast_SSE2( _mm_loadu_ps( src + i ));
+        __m128 y1 = icvLogFast_SSE2( _mm_loadu_ps( src + i + 4 ));
+        _mm_storeu_ps( dst + i, y0 );
+        _mm_storeu_ps( dst + i + 4, y1 );
+    }
+    icvLogFast_32f_C( src + i, dst + i, len - i );
+}
+
+
+static void CV_CDECL
+icvPowFast_32f_SSE2( const float* src, float* dst, int len, float power )
+{
+    const __m128 p = _mm_set1_ps( power );
+    const __m128 zval = _mm_castsi128_ps( _mm_set1_epi32( power > 0 ? 0 : 0x7f800000 ));
+    int i = 0;
+
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m128 x0 = _mm_loadu_ps( src + i ), x1 = _mm_loadu_ps( src + i + 4 );
+        __m128 y0 = icvExpFast_SSE2( _mm_mul_ps( icvLogFast_SSE2( x0 ), p ));
+        __m128 y1 = icvExpFast_SSE2( _mm_mul_ps( icvLogFast_SSE2( x1 ), p ));
+        __m128 zmask = _mm_cmpeq_ps( x0, _mm_setzero_ps() );
+        _mm_storeu_ps( dst + i, _mm_or_ps( _mm_andnot_ps( zmask, y0 ), _mm_and_ps( zmask, zval )));
+        zmask = _mm_cmpeq_ps( x1, _mm_setzero_ps() );
+        _mm_storeu_ps( dst + i + 4, _mm_or_ps( _mm_andnot_ps( zmask, y1 ), _mm_and_ps( zmask, zval )));
+    }
+    icvPowFast_32f_C( src + i, dst + i, len - i, power );
+}
+
+
+static void CV_CDECL
+icvCartToPolarFast_32f_SSE2( const float* x, const float* y, float* mag,
+                             float* angle, int len, float angle_scale )
+{
+    const __m128 absmask = _mm_castsi128_ps( _mm_set1_epi32( 0x7fffffff ));
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 d90 = _mm_set1_ps( 90.f ), d180 = _mm_set1_ps( 180.f ),
+                 d360 = _mm_set1_ps( 360.f ), scale = _mm_set1_ps( angle_scale );
+    int i = 0;
+
+    for( ; i <= len - 4; i += 4 )
+    {
+        __m128 x0 = _mm_loadu_ps( x + i ), y0 = _mm_loadu_ps( y + i );
+
+        if( mag )
+            _mm_storeu_ps( mag + i, _mm_sqrt_ps( _mm_add_ps(
+                _mm_mul_ps( x0, x0 ), _mm_mul_ps( y0, y0 ))));
+
+        if( angle )
+        {
+            __m128 ax = _mm_and_ps( x0, absmask ), ay = _mm_and_ps( y0, absmask );
+            __m128 z = _mm_div_ps( _mm_min_ps( ax, ay ),
+                                   _mm_add_ps( _mm_max_ps( ax, ay ), _mm_set1_ps( FLT_MIN )));
+            __m128 a = _mm_mul_ps( _mm_add_ps( _mm_mul_ps( _mm_set1_ps( _CV_ATAN_CF0 ), z ),
+                                               _mm_set1_ps( _CV_ATAN_CF1 )), z );
+            __m128 mask = _mm_cmpgt_ps( ay, ax );
+            a = _mm_or_ps( _mm_andnot_ps( mask, a ), _mm_and_ps( mask, _mm_sub_ps( d90, a )));
+            mask = _mm_cmplt_ps( x0, zero );
+            a = _mm_or_ps( _mm_andnot_ps( mask, a ), _mm_and_ps( mask, _mm_sub_ps( d180, a )));
+            mask = _mm_cmplt_ps( y0, zero );
+            a = _mm_or_ps( _mm_andnot_ps( mask, a ), _mm_and_ps( mask, _mm_sub_ps( d360, a )));
+            _mm_storeu_ps( angle + i, _mm_mul_ps( a, scale ));
+        }
+    }
+
+    icvCartToPolarFast_32f_C( x + i, y + i, mag ? mag + i : 0,
+                              angle ? angle + i : 0, len - i, angle_scale );
+}
+
+#endif
+
+
+#if CV_NEON
+
+// the reciprocal and the reciprocal square root estimates are refined by two Newton steps
+static inline float32x4_t
+icvRecipFast_NEON( float32x4_t x )
+{
+    float32x4_t r = vrecpeq_f32( x );
+    r = vmulq_f32( r, vrecpsq_f32( x, r ));
+    return vmulq_f32( r, vrecpsq_f32( x, r ));
+}
+
+
+static inline float32x4_t
+icvSqrtFast_NEON( float32x4_t x )
+{
+    float32x4_t r = vrsqrteq_f32( x );
+    r = vmulq_f32( r, vrsqrtsq_f32( vmulq_f32( x, r ), r ));
+    r = vmulq_f32( r, vrsqrtsq_f32( vmulq_f32( x, r ), r ));
+    // sqrt(0) would be 0*inf
+    return vreinterpretq_f32_u32( vandq_u32( vreinterpretq_u32_f32( vmulq_f32( x, r )),
+                                  vcgtq_f32( x, vdupq_n_f32( 0.f ))));
+}
+
+
+static inline float32x4_t
+icvExpFast_NEON( float32x4_t x )
+{
+    const float32x4_t one = vdupq_n_f32( 1.f );
+    float32x4_t t, y, z;
+    uint32x4_t adj;
+    int32x4_t n, n1, bias = vdupq_n_s32( 127 );
+
+    x = vminq_f32( vmaxq_f32( x, vdupq_n_f32( ICV_EXP_FAST_MIN )),
+                   vdupq_n_f32( ICV_EXP_FAST_MAX ));
+    t = vmlaq_f32( vdupq_n_f32( 0.5f ), x, vdupq_n_f32( ICV_LOG2E ));
+
+    // floor(t): the truncation rounds the negative values up
+    n = vcvtq_s32_f32( t );
+    z = vcvtq_f32_s32( n );
+    adj = vcgtq_f32( z, t );
+    n = vaddq_s32( n, vreinterpretq_s32_u32( adj ));
+    t = vsubq_f32( z, vreinterpretq_f32_u32( vandq_u32( adj, vreinterpretq_u32_f32( one ))));
+
+    x = vmlsq_f32( vmlsq_f32( x, t, vdupq_n_f32( ICV_LN2_HI )), t, vdupq_n_f32( ICV_LN2_LO ));
+    z = vmulq_f32( x, x );
+    y = vmlaq_f32( vdupq_n_f32( ICV_EXP_FAST_P1 ), x, vdupq_n_f32( ICV_EXP_FAST_P0 ));
+    y = vmlaq_f32( vdupq_n_f32( ICV_EXP_FAST_P2 ), y, x );
+    y = vmlaq_f32( vdupq_n_f32( ICV_EXP_FAST_P3 ), y, x );
+    y = vmlaq_f32( vdupq_n_f32( ICV_EXP_FAST_P4 ), y, x );
+    y = vmlaq_f32( vdupq_n_f32( ICV_EXP_FAST_P5 ), y, x );
+    y = vaddq_f32( vmlaq_f32( x, y, z ), one );
+
+    n1 = vshrq_n_s32( n, 1 );
+    n = vsubq_s32( n, n1 );
+    y = vmulq_f32( y, vreinterpretq_f32_s32( vshlq_n_s32( vaddq_s32( n1, bias ), 23 )));
+    return vmulq_f32( y, vreinterpretq_f32_s32( vshlq_n_s32( vaddq_s32( n, bias ), 23 )));
+}
+
+
+static inline float32x4_t
+icvLogFast_NEON( float32x4_t x )
+{
+    const float32x4_t one = vdupq_n_f32( 1.f );
+    float32x4_t e, y, z;
+    uint32x4_t mask;
+    int32x4_t v = vreinterpretq_s32_f32( vabsq_f32( x ));
+
+    v = vmaxq_s32( v, vdupq_n_s32( 0x00800000 ));
+    e = vcvtq_f32_s32( vsubq_s32( vshrq_n_s32( v, 23 ), vdupq_n_s32( 126 )));
+    x = vreinterpretq_f32_s32( vorrq_s32( vandq_s32( v, vdupq_n_s32( 0x007fffff )),
+                                          vdupq_n_s32( 0x3f000000 )));
+
+    mask = vcltq_f32( x, vdupq_n_f32( ICV_SQRT_HALF ));
+    e = vsubq_f32( e, vreinterpretq_f32_u32( vandq_u32( mask, vreinterpretq_u32_f32( one ))));
+    x = vsubq_f32( vaddq_f32( x, vreinterpretq_f32_u32( vandq_u32( mask,
+                   vreinterpretq_u32_f32( x )))), one );
+
+    z = vmulq_f32( x, x );
+    y = vmlaq_f32( vdupq_n_f32( ICV_LOG_FAST_P1 ), x, vdupq_n_f32( ICV_LOG_FAST_P0 ));
+    y = vmlaq_f32( vdupq_n_f32( ICV_LOG_FAST_P2 ), y, x );
+    y = vmlaq_f32( vdupq_n_f32( ICV_LOG_FAST_P3 ), y, x );
+    y = vmlaq_f32( vdupq_n_f32( ICV_LOG_FAST_P4 ), y, x );
+    y = vmlaq_f32( vdupq_n_f32( ICV_LOG_FAST_P5 ), y, x );
+    y = vmlaq_f32( vdupq_n_f32( ICV_LOG_FAST_P6 ), y, x );
+    y = vmlaq_f32( vdupq_n_f32( ICV_LOG_FAST_P7 ), y, x );
+    y = vmlaq_f32( vdupq_n_f32( ICV_LOG_FAST_P8 ), y, x );
+    y = vmlaq_f32( vmulq_f32( e, vdupq_n_f32( ICV_LN2_LO )), vmulq_f32( y, x ), z );
+    y = vmlsq_f32( y, z, vdupq_n_f32( 0.5f ));
+    return vmlaq_f32( vaddq_f32( x, y ), e, vdupq_n_f32( ICV_LN2_HI ));
+}
+
+
+static void CV_CDECL
+icvExpFast_32f_NEON( const float* src, float* dst, int len )
+{
+    int i = 0;
+    for( ; i <= len - 4; i += 4 )
+        vst1q_f32( dst + i, icvExpFast_NEON( vld1q_f32( src + i )));
+    icvExpFast_32f_C( src + i, dst + i, len - i );
+}
+
+
+static void CV_CDECL
+icvLogFast_32f_NEON( const float* src, float* dst, int len )
+{
+    int i = 0;
+    for( ; i <= len - 4; i += 4 )
+        vst1q_f32( dst + i, icvLogFast_NEON( vld1q_f32( src + i )));
+    icvLogFast_32f_C( src + i, dst + i, len - i );
+}
+
+
+static void CV_CDECL
+icvPowFast_32f_NEON( const float* src, float* dst, int len, float power )
+{
+    const float32x4_t p = vdupq_n_f32( power );
+    const uint32x4_t zval = vdupq_n_u32( power > 0 ? 0 : 0x7f800000 );
+    int i = 0;
+
+    for( ; i <= len - 4; i += 4 )
+    {
+        float32x4_t x = vld1q_f32( src + i );
+        uint32x4_t zmask = vceqq_f32( x, vdupq_n_f32( 0.f ));
+        float32x4_t y = icvExpFast_NEON( vmulq_f32( icvLogFast_NEON( x ), p ));
+        vst1q_f32( dst + i, vreinterpretq_f32_u32( vbslq_u32( zmask, zval,
+                                                   vreinterpretq_u32_f32( y ))));
+    }
+    icvPowFast_32f_C( src + i, dst + i, len - i, power );
+}
+
+
+static void CV_CDECL
+icvCartToPolarFast_32f_NEON( const float* x, const float* y, float* mag,
+                             float* angle, int len, float angle_scale )
+{
+    const float32x4_t zero = vdupq_n_f32( 0.f );
+    const float32x4_t d90 = vdupq_n_f32( 90.f ), d180 = vdupq_n_f32( 180.f ),
+                      d360 = vdupq_n_f32( 360.f );
+    int i = 0;
+
+    for( ; i <= len - 4; i += 4 )
+    {
+        float32x4_t x0 = vld1q_f32( x + i ), y0 = vld1q_f32( y + i );
+
+        if( mag )
+            vst1q_f32( mag + i, icvSqrtFast_NEON( vmlaq_f32( vmulq_f32( x0, x0 ), y0, y0 )));
+
+        if( angle )
+        {
+            float32x4_t ax = vabsq_f32( x0 ), ay = vabsq_f32( y0 );
+            float32x4_t z = vmulq_f32( vminq_f32( ax, ay ), icvRecipFast_NEON(
+                vaddq_f32( vmaxq_f32( ax, ay ), vdupq_n_f32( FLT_MIN ))));
+            float32x4_t a = vmulq_f32( vmlaq_f32( vdupq_n_f32( _CV_ATAN_CF1 ), z,
+                                                  vdupq_n_f32( _CV_ATAN_CF0 )), z );
+            a = vbslq_f32( vcgtq_f32( ay, ax ), vsubq_f32( d90, a ), a );
+            a = vbslq_f32( vcltq_f32( x0, zero ), vsubq_f32( d180, a ), a );
+            a = vbslq_f32( vcltq_f32( y0, zero ), vsubq_f32( d360, a ), a );
+            vst1q_f32( angle + i, vmulq_n_f32( a, angle_scale ));
+        }
+    }
+
+    icvCartToPolarFast_32f_C( x + i, y + i, mag ? mag + i : 0,
+                              angle ? angle + i : 0, len - i, angle_scale );
+}
+
+#endif
+
+
+static const CvDispatchVariant icvExpFast_32f_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvExpFast_32f_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvExpFast_32f_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvExpFast_32f_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvLogFast_32f_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvLogFast_32f_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvLogFast_32f_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvLogFast_32f_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvPowFast_32f_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvPowFast_32f_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvPowFast_32f_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvPowFast_32f_C, CV_CPU_NONE, "C" }
+};
+
+static const CvDispatchVariant icvCartToPolarFast_32f_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvCartToPolarFast_32f_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvCartToPolarFast_32f_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvCartToPolarFast_32f_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvExpFast_32f_entry =
+    CV_DISPATCH_ENTRY( "cvExp_32f_fast", icvExpFast_32f_variants );
+static CvDispatchEntry icvLogFast_32f_entry =
+    CV_DISPATCH_ENTRY( "cvLog_32f_fast", icvLogFast_32f_variants );
+static CvDispatchEntry icvPowFast_32f_entry =
+    CV_DISPATCH_ENTRY( "cvPow_32f_fast", icvPowFast_32f_variants );
+static CvDispatchEntry icvCartToPolarFast_32f_entry =
+    CV_DISPATCH_ENTRY( "cvCartToPolar_32f_fast", icvCartToPolarFast_32f_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvExpFast_32f_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvLogFast_32f_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvPowFast_32f_entry );
+CV_REGISTER_DISPATCH_ENTRY( icvCartToPolarFast_32f_entry );
+
+
 /****************************************************************************************\
 *                                  Cartezian -> Polar                                    *
 \****************************************************************************************/
@@ -399,7 +977,20 @@ cvCartToPolar( const CvArr* xarr, const CvArr* yarr,
         mag_buffer = (float*)cvStackAlloc( block_size*sizeof(float));
     }
 
-    if( depth == CV_32F )
+    if( depth == CV_32F && icvMathMode == CV_MATH_FAST )
+    {
+        CvCartToPolarFastFunc_32f func = (CvCartToPolarFastFunc_32f)
+            cvGetDispatchFunc( &icvCartToPolarFast_32f_entry );
+        float angle_scale = angle_in_degrees ? 1.f : (float)(CV_PI/180.);
+
+        for( y = 0; y < size.height; y++ )
+            func( (float*)(xmat->data.ptr + xmat->step*y),
+                  (float*)(ymat->data.ptr + ymat->step*y),
+                  mag ? (float*)(mag->data.ptr + mag->step*y) : 0,
+                  angle ? (float*)(angle->data.ptr + angle->step*y) : 0,
+                  size.width, angle_scale );
+    }
+    else if( depth == CV_32F )
     {
         for( y = 0; y < size.height; y++ )
         {
@@ -1026,6 +1617,7 @@ CV_IMPL void cvExp( const CvArr* srcarr, CvArr* dstarr )
     CvMat dststub, *dst = (CvMat*)dstarr;
     int coi1 = 0, coi2 = 0, src_depth, dst_depth;
     double* buffer = 0;
+    CvMathFastFunc_32f exp_func = 0;
     CvSize size;
     int x, y, dx = 0;
     
@@ -1062,6 +1654,9 @@ CV_IMPL void cvExp( const CvArr* srcarr, CvArr* dstarr )
         buffer = (double*)cvStackAlloc( dx*sizeof(buffer[0]) );
     }
 
+    if( src_depth == CV_32F && dst_depth == CV_32F && icvMathMode == CV_MATH_FAST )
+        exp_func = (CvMathFastFunc_32f)cvGetDispatchFunc( &icvExpFast_32f_entry );
+
     for( y = 0; y < size.height; y++ )
     {
         uchar* src_data = src->data.ptr + src->step*y;
@@ -1073,7 +1668,10 @@ CV_IMPL void cvExp( const CvArr* srcarr, CvArr* dstarr )
         }
         else if( src_depth == dst_depth )
         {
-            icvExp_32f( (float*)src_data, (float*)dst_data, size.width );
+            if( exp_func )
+                exp_func( (float*)src_data, (float*)dst_data, size.width );
+            else
+                icvExp_32f( (float*)src_data, (float*)dst_data, size.width );
         }
         else
         {
@@ -1585,6 +2183,7 @@ CV_IMPL void cvLog( const CvArr* srcarr, CvArr* dstarr )
     CvMat dststub, *dst = (CvMat*)dstarr;
     int coi1 = 0, coi2 = 0, src_depth, dst_depth;
     double* buffer = 0;
+    CvMathFastFunc_32f log_func = 0;
     CvSize size;
     int x, y, dx = 0;
     
@@ -1621,6 +2220,9 @@ CV_IMPL void cvLog( const CvArr* srcarr, CvArr* dstarr )
         buffer = (double*)cvStackAlloc( dx*sizeof(buffer[0]) );
     }
 
+    if( src_depth == CV_32F && dst_depth == CV_32F && icvMathMode == CV_MATH_FAST )
+        log_func = (CvMathFastFunc_32f)cvGetDispatchFunc( &icvLogFast_32f_entry );
+
     for( y = 0; y < size.height; y++ )
     {
         uchar* src_data = src->data.ptr + src->step*y;
@@ -1632,7 +2234,10 @@ CV_IMPL void cvLog( const CvArr* srcarr, CvArr* dstarr )
         }
         else if( src_depth == dst_depth )
         {
-            icvLog_32f( (float*)src_data, (float*)dst_data, size.width );
+            if( log_func )
+                log_func( (float*)src_data, (float*)dst_data, size.width );
+            else
+                icvLog_32f( (float*)src_data, (float*)dst_data, size.width );
         }
         else
         {
@@ -1734,10 +2339,10 @@ CV_IMPL void cvPow( const CvArr* srcarr, CvArr* dstarr, double power )
 
     if( fabs(ipower - power) < DBL_EPSILON )
     {
-        if( !inittab )
+        if( cvBeginInitOnce( &inittab ))
         {
             icvInitIPowTable( &ipow_tab );
-            inittab = 1;
+            cvEndInitOnce( &inittab );
         }
 
         if( ipower < 0 )
@@ -1807,6 +2412,14 @@ CV_IMPL void cvPow( const CvArr* srcarr, CvArr* dstarr, double power )
             sqrt_func( src_data, dst_data, size.width );
         }
     }
+    else if( depth == CV_32F && icvMathMode == CV_MATH_FAST )
+    {
+        CvPowFastFunc_32f func = (CvPowFastFunc_32f)cvGetDispatchFunc( &icvPowFast_32f_entry );
+
+        for( y = 0; y < size.height; y++ )
+            func( (float*)(src->data.ptr + src->step*y),
+                  (float*)(dst->data.ptr + dst->step*y), size.width, (float)power );
+    }
     else
     {
         block_size = MIN( size.width, ICV_MATH_BLOCK_SIZE );
@@ -601,6 +601,407 @@ static void icvInitGEMMTable( CvBigFuncTable* single_mul_tab,
 }
 
 
+/****************************************************************************************\
+*                      Packed-panel GEMM for single-precision matrices                   *
+\****************************************************************************************/
+
+/* register block (micro-tile) size */
+#define ICV_GEMM_MR  4
+#define ICV_GEMM_NR  8
+/* cache block sizes: a packed MC x KC panel of A, a KC x NC panel of B
+   and an MC x NC output tile per thread */
+#define ICV_GEMM_MC  64
+#define ICV_GEMM_NC  128
+#define ICV_GEMM_KC  256
+/* smaller products (m*n*k) are computed by the generic code */
+#define ICV_GEMM_PACKED_MIN_OPS  (32*32*32)
+
+/* multiplies a packed ICV_GEMM_MR x kc sliver of A by a packed kc x ICV_GEMM_NR sliver of B.
+   The mr x nr top-left part of the product is stored to (accumulate == 0) or
+   added to (accumulate != 0) the output */
+typedef void (CV_CDECL * CvGEMMMicroKernelFunc_32f)( int kc, const float* a, const float* b,
+                            float* d, int d_step, int mr, int nr, int accumulate );
+
+typedef struct CvGEMMPackedParams
+{
+    const float* a;
+    int a_step0, a_step1;   // steps (in elements) of op(A) along the rows and the columns
+    const float* b;
+    int b_step0, b_step1;   // the same for op(B)
+    const float* c;
+    int c_step0, c_step1;   // the same for op(C), both 0 if there is no C
+    float* d;
+    int d_step;
+    int m, n, k;
+    double alpha, beta;
+    int tiles_n;            // number of output tiles in a row
+    float* buf;             // per-thread packing buffers
+    int buf_step;
+    CvGEMMMicroKernelFunc_32f kernel;
+}
+CvGEMMPackedParams;
+
+
+/* copies the mc x kc block of op(A) into slivers of ICV_GEMM_MR rows,
+   stored column by column; the last sliver is padded with zeros */
+static void
+icvGEMMPackA_32f( const float* a, int step0, int step1, int mc, int kc, float* dst )
+{
+    int i, k, r;
+
+    for( i = 0; i < mc; i += ICV_GEMM_MR, dst += kc*ICV_GEMM_MR )
+    {
+        int mr = MIN( ICV_GEMM_MR, mc - i );
+        const float* src = a + i*step0;
+
+        if( mr == ICV_GEMM_MR && step0 == 1 )
+        {
+            for( k = 0; k < kc; k++, src += step1 )
+            {
+                float t0 = src[0], t1 = src[1];
+                dst[k*ICV_GEMM_MR] = t0; dst[k*ICV_GEMM_MR+1] = t1;
+                t0 = src[2]; t1 = src[3];
+                dst[k*ICV_GEMM_MR+2] = t0; dst[k*ICV_GEMM_MR+3] = t1;
+            }
+        }
+        else
+        {
+            for( r = 0; r < ICV_GEMM_MR; r++ )
+            {
+                if( r < mr )
+                {
+                    const float* s = src + r*step0;
+                    for( k = 0; k < kc; k++ )
+                        dst[k*ICV_GEMM_MR + r] = s[k*step1];
+                }
+                else
+                    for( k = 0; k < kc; k++ )
+                        dst[k*ICV_GEMM_MR + r] = 0.f;
+            }
+        }
+    }
+}
+
+
+/* copies the kc x nc block of op(B) into slivers of ICV_GEMM_NR columns,
+   stored row by row; the last sliver is padded with zeros */
+static void
+icvGEMMPackB_32f( const float* b, int step0, int step1, int kc, int nc, float* dst )
+{
+    int j, k, c;
+
+    for( j = 0; j < nc; j += ICV_GEMM_NR, dst += kc*ICV_GEMM_NR )
+    {
+        int nr = MIN( ICV_GEMM_NR, nc - j );
+        const float* src = b + j*step1;
+
+        if( nr == ICV_GEMM_NR && step1 == 1 )
+        {
+            for( k = 0; k < kc; k++, src += step0 )
+            {
+                float* t = dst + k*ICV_GEMM_NR;
+                t[0] = src[0]; t[1] = src[1]; t[2] = src[2]; t[3] = src[3];
+                t[4] = src[4]; t[5] = src[5]; t[6] = src[6]; t[7] = src[7];
+            }
+        }
+        else
+        {
+            for( c = 0; c < ICV_GEMM_NR; c++ )
+            {
+                if( c < nr )
+                {
+                    const float* s = src + c*step1;
+                    for( k = 0; k < kc; k++ )
+                        dst[k*ICV_GEMM_NR + c] = s[k*step0];
+                }
+                else
+                    for( k = 0; k < kc; k++ )
+                        dst[k*ICV_GEMM_NR + c] = 0.f;
+            }
+        }
+    }
+}
+
+
+/* stores (accumulate == 0) or adds (accumulate != 0) the mr x nr top-left part
+   of the ICV_GEMM_MR x ICV_GEMM_NR micro-tile t to the output */
+static void
+icvGEMMStoreMicroTile_32f( const float* t, float* d, int d_step,
+                           int mr, int nr, int accumulate )
+{
+    int i, j;
+
+    for( i = 0; i < mr; i++, d += d_step, t += ICV_GEMM_NR )
+    {
+        if( accumulate )
+            for( j = 0; j < nr; j++ )
+                d[j] += t[j];
+        else
+            for( j = 0; j < nr; j++ )
+                d[j] = t[j];
+    }
+}
+
+
+static void CV_CDECL
+icvGEMMMicroKernel_32f_C( int kc, const float* a, const float* b,
+                          float* d, int d_step, int mr, int nr, int accumulate )
+{
+    float t[ICV_GEMM_MR*ICV_GEMM_NR];
+    int i, j, k;
+
+    for( i = 0; i < ICV_GEMM_MR*ICV_GEMM_NR; i++ )
+        t[i] = 0.f;
+
+    for( k = 0; k < kc; k++, a += ICV_GEMM_MR, b += ICV_GEMM_NR )
+        for( i = 0; i < ICV_GEMM_MR; i++ )
+        {
+            float ai = a[i];
+            float* ti = t + i*ICV_GEMM_NR;
+            for( j = 0; j < ICV_GEMM_NR; j++ )
+                ti[j] += ai*b[j];
+        }
+
+    icvGEMMStoreMicroTile_32f( t, d, d_step, mr, nr, accumulate );
+}
+
+
+#if CV_SSE2
+static void CV_CDECL
+icvGEMMMicroKernel_32f_SSE2( int kc, const float* a, const float* b,
+                             float* d, int d_step, int mr, int nr, int accumulate )
+{
+    float t[ICV_GEMM_MR*ICV_GEMM_NR];
+    int k;
+
+    __m128 s00 = _mm_setzero_ps(), s01 = s00, s10 = s00, s11 = s00,
+           s20 = s00, s21 = s00, s30 = s00, s31 = s00;
+
+    for( k = 0; k < kc; k++, a += ICV_GEMM_MR, b += ICV_GEMM_NR )
+    {
+        __m128 b0 = _mm_load_ps( b ), b1 = _mm_load_ps( b + 4 ), a0;
+        a0 = _mm_set1_ps( a[0] );
+        s00 = _mm_add_ps( s00, _mm_mul_ps( a0, b0 ));
+        s01 = _mm_add_ps( s01, _mm_mul_ps( a0, b1 ));
+        a0 = _mm_set1_ps( a[1] );
+        s10 = _mm_add_ps( s10, _mm_mul_ps( a0, b0 ));
+        s11 = _mm_add_ps( s11, _mm_mul_ps( a0, b1 ));
+        a0 = _mm_set1_ps( a[2] );
+        s20 = _mm_add_ps( s20, _mm_mul_ps( a0, b0 ));
+        s21 = _mm_add_ps( s21, _mm_mul_ps( a0, b1 ));
+        a0 = _mm_set1_ps( a[3] );
+        s30 = _mm_add_ps( s30, _mm_mul_ps( a0, b0 ));
+        s31 = _mm_add_ps( s31, _mm_mul_ps( a0, b1 ));
+    }
+
+    if( mr == ICV_GEMM_MR && nr == ICV_GEMM_NR )
+    {
+        if( accumulate )
+        {
+            s00 = _mm_add_ps( s00, _mm_loadu_ps( d )); s01 = _mm_add_ps( s01, _mm_loadu_ps( d + 4 ));
+            s10 = _mm_add_ps( s10, _mm_loadu_ps( d + d_step )); s11 = _mm_add_ps( s11, _mm_loadu_ps( d + d_step + 4 ));
+            s20 = _mm_add_ps( s20, _mm_loadu_ps( d + d_step*2 )); s21 = _mm_add_ps( s21, _mm_loadu_ps( d + d_step*2 + 4 ));
+            s30 = _mm_add_ps( s30, _mm_loadu_ps( d + d_step*3 )); s31 = _mm_add_ps( s31, _mm_loadu_ps( d + d_step*3 + 4 ));
+        }
+        _mm_storeu_ps( d, s00 ); _mm_storeu_ps( d + 4, s01 );
+        _mm_storeu_ps( d + d_step, s10 ); _mm_storeu_ps( d + d_step + 4, s11 );
+        _mm_storeu_ps( d + d_step*2, s20 ); _mm_storeu_ps( d + d_step*2 + 4, s21 );
+        _mm_storeu_ps( d + d_step*3, s30 ); _mm_storeu_ps( d + d_step*3 + 4, s31 );
+        return;
+    }
+
+    _mm_storeu_ps( t, s00 ); _mm_storeu_ps( t + 4, s01 );
+    _mm_storeu_ps( t + 8, s10 ); _mm_storeu_ps( t + 12, s11 );
+    _mm_storeu_ps( t + 16, s20 ); _mm_storeu_ps( t + 20, s21 );
+    _mm_storeu_ps( t + 24, s30 ); _mm_storeu_ps( t + 28, s31 );
+    icvGEMMStoreMicroTile_32f( t, d, d_step, mr, nr, accumulate );
+}
+#endif
+
+
+#if CV_NEON
+static void CV_CDECL
+icvGEMMMicroKernel_32f_NEON( int kc, const float* a, const float* b,
+                             float* d, int d_step, int mr, int nr, int accumulate )
+{
+    float t[ICV_GEMM_MR*ICV_GEMM_NR];
+    int k;
+
+    float32x4_t s00 = vdupq_n_f32( 0.f ), s01 = s00, s10 = s00, s11 = s00,
+                s20 = s00, s21 = s00, s30 = s00, s31 = s00;
+
+    for( k = 0; k < kc; k++, a += ICV_GEMM_MR, b += ICV_GEMM_NR )
+    {
+        float32x4_t b0 = vld1q_f32( b ), b1 = vld1q_f32( b + 4 );
+        s00 = vmlaq_n_f32( s00, b0, a[0] );
+        s01 = vmlaq_n_f32( s01, b1, a[0] );
+        s10 = vmlaq_n_f32( s10, b0, a[1] );
+        s11 = vmlaq_n_f32( s11, b1, a[1] );
+        s20 = vmlaq_n_f32( s20, b0, a[2] );
+        s21 = vmlaq_n_f32( s21, b1, a[2] );
+        s30 = vmlaq_n_f32( s30, b0, a[3] );
+        s31 = vmlaq_n_f32( s31, b1, a[3] );
+    }
+
+    if( mr == ICV_GEMM_MR && nr == ICV_GEMM_NR )
+    {
+        if( accumulate )
+        {
+            s00 = vaddq_f32( s00, vld1q_f32( d )); s01 = vaddq_f32( s01, vld1q_f32( d + 4 ));
+            s10 = vaddq_f32( s10, vld1q_f32( d + d_step )); s11 = vaddq_f32( s11, vld1q_f32( d + d_step + 4 ));
+            s20 = vaddq_f32( s20, vld1q_f32( d + d_step*2 )); s21 = vaddq_f32( s21, vld1q_f32( d + d_step*2 + 4 ));
+            s30 = vaddq_f32( s30, vld1q_f32( d + d_step*3 )); s31 = vaddq_f32( s31, vld1q_f32( d + d_step*3 + 4 ));
+        }
+        vst1q_f32( d, s00 ); vst1q_f32( d + 4, s01 );
+        vst1q_f32( d + d_step, s10 ); vst1q_f32( d + d_step + 4, s11 );
+        vst1q_f32( d + d_step*2, s20 ); vst1q_f32( d + d_step*2 + 4, s21 );
+        vst1q_f32( d + d_step*3, s30 ); vst1q_f32( d + d_step*3 + 4, s31 );
+        return;
+    }
+
+    vst1q_f32( t, s00 ); vst1q_f32( t + 4, s01 );
+    vst1q_f32( t + 8, s10 ); vst1q_f32( t + 12, s11 );
+    vst1q_f32( t + 16, s20 ); vst1q_f32( t + 20, s21 );
+    vst1q_f32( t + 24, s30 ); vst1q_f32( t + 28, s31 );
+    icvGEMMStoreMicroTile_32f( t, d, d_step, mr, nr, accumulate );
+}
+#endif
+
+
+static const CvDispatchVariant icvGEMMMicroKernel_32f_variants[] =
+{
+#if CV_SSE2
+    { (void*)icvGEMMMicroKernel_32f_SSE2, CV_CPU_SSE2, "SSE2" },
+#endif
+#if CV_NEON
+    { (void*)icvGEMMMicroKernel_32f_NEON, CV_CPU_NEON, "NEON" },
+#endif
+    { (void*)icvGEMMMicroKernel_32f_C, CV_CPU_NONE, "C" }
+};
+
+static CvDispatchEntry icvGEMMMicroKernel_32f_entry =
+    CV_DISPATCH_ENTRY( "cvGEMM_32f", icvGEMMMicroKernel_32f_variants );
+CV_REGISTER_DISPATCH_ENTRY( icvGEMMMicroKernel_32f_entry );
+
+
+/* computes the output tiles [start, end) of D = alpha*op(A)*op(B) + beta*op(C).
+   The product is accumulated in float in a per-thread tile buffer over the KC-long
+   panels and then scaled and combined with C, so C may be the same matrix as D */
+static void CV_CDECL
+icvGEMMPackedBody_32f( int start, int end, void* userdata )
+{
+    const CvGEMMPackedParams* p = (const CvGEMMPackedParams*)userdata;
+    float* a_buf = p->buf + p->buf_step*cvGetThreadNum();
+    float* b_buf = a_buf + ICV_GEMM_MC*ICV_GEMM_KC;
+    float* t_buf = b_buf + ICV_GEMM_KC*ICV_GEMM_NC;
+    CvGEMMMicroKernelFunc_32f kernel = p->kernel;
+    double alpha = p->alpha, beta = p->beta;
+    int tile;
+
+    for( tile = start; tile < end; tile++ )
+    {
+        int i0 = (tile / p->tiles_n)*ICV_GEMM_MC, j0 = (tile % p->tiles_n)*ICV_GEMM_NC;
+        int mc = MIN( ICV_GEMM_MC, p->m - i0 ), nc = MIN( ICV_GEMM_NC, p->n - j0 );
+        float* d = p->d + i0*p->d_step + j0;
+        const float* c = p->c ? p->c + i0*p->c_step0 + j0*p->c_step1 : 0;
+        const float* t = t_buf;
+        int i, j, k0;
+
+        for( k0 = 0; k0 < p->k; k0 += ICV_GEMM_KC )
+        {
+            int kc = MIN( ICV_GEMM_KC, p->k - k0 );
+
+            icvGEMMPackB_32f( p->b + k0*p->b_step0 + j0*p->b_step1,
+                              p->b_step0, p->b_step1, kc, nc, b_buf );
+            icvGEMMPackA_32f( p->a + i0*p->a_step0 + k0*p->a_step1,
+                              p->a_step0, p->a_step1, mc, kc, a_buf );
+
+            for( j = 0; j < nc; j += ICV_GEMM_NR )
+                for( i = 0; i < mc; i += ICV_GEMM_MR )
+                    kernel( kc, a_buf + i*kc, b_buf + j*kc,
+                            t_buf + i*ICV_GEMM_NC + j, ICV_GEMM_NC,
+                            MIN( ICV_GEMM_MR, mc - i ), MIN( ICV_GEMM_NR, nc - j ), k0 > 0 );
+        }
+
+        for( i = 0; i < mc; i++, d += p->d_step, t += ICV_GEMM_NC )
+        {
+            if( c )
+            {
+                const float* ci = c + i*p->c_step0;
+                for( j = 0; j < nc; j++ )
+                    d[j] = (float)(t[j]*alpha + ci[j*p->c_step1]*beta);
+            }
+            else if( alpha != 1 )
+                for( j = 0; j < nc; j++ )
+                    d[j] = (float)(t[j]*alpha);
+            else
+                memcpy( d, t, nc*sizeof(d[0]) );
+        }
+    }
+}
+
+
+/* D = alpha*op(A)*op(B) + beta*op(C) for 32fC1 matrices.
+   D must not overlap A or B; it may be the same matrix as C if op(C) = C */
+static void
+icvGEMMPacked_32f( const CvMat* A, const CvMat* B, double alpha,
+                   const CvMat* C, double beta, CvMat* D, int flags )
+{
+    float* buffer = 0;
+
+    CV_FUNCNAME( "icvGEMMPacked_32f" );
+
+    __BEGIN__;
+
+    CvGEMMPackedParams p;
+    int a_step = A->step/sizeof(float), b_step = B->step/sizeof(float);
+    int nthreads = cvGetNumThreads();
+
+    p.m = D->rows;
+    p.n = D->cols;
+    p.k = flags & CV_GEMM_A_T ? A->rows : A->cols;
+
+    p.a = A->data.fl;
+    p.a_step0 = flags & CV_GEMM_A_T ? 1 : a_step;
+    p.a_step1 = flags & CV_GEMM_A_T ? a_step : 1;
+    p.b = B->data.fl;
+    p.b_step0 = flags & CV_GEMM_B_T ? 1 : b_step;
+    p.b_step1 = flags & CV_GEMM_B_T ? b_step : 1;
+
+    if( C && C->data.ptr )
+    {
+        int c_step = C->step/sizeof(float);
+        p.c = C->data.fl;
+        p.c_step0 = flags & CV_GEMM_C_T ? 1 : c_step;
+        p.c_step1 = flags & CV_GEMM_C_T ? c_step : 1;
+    }
+    else
+    {
+        p.c = 0;
+        p.c_step0 = p.c_step1 = 0;
+    }
+
+    p.d = D->data.fl;
+    p.d_step = D->step/sizeof(float);
+    p.alpha = alpha;
+    p.beta = beta;
+    p.tiles_n = (p.n + ICV_GEMM_NC - 1)/ICV_GEMM_NC;
+    p.kernel = (CvGEMMMicroKernelFunc_32f)cvGetDispatchFunc( &icvGEMMMicroKernel_32f_entry );
+
+    // packed panels of A and B and the output tile
+    p.buf_step = (ICV_GEMM_MC + ICV_GEMM_NC)*ICV_GEMM_KC + ICV_GEMM_MC*ICV_GEMM_NC;
+    CV_CALL( buffer = (float*)cvAlloc( nthreads*p.buf_step*sizeof(buffer[0]) ));
+    p.buf = buffer;
+
+    cvParallelFor( ((p.m + ICV_GEMM_MC - 1)/ICV_GEMM_MC)*p.tiles_n,
+                   icvGEMMPackedBody_32f, &p );
+
+    __END__;
+
+    cvFree( &buffer );
+}
+
+
 CV_IMPL void
 cvGEMM( const CvArr* Aarr, const CvArr* Barr, double alpha,
         const CvArr* Carr, double beta, CvArr* Darr, int flags )
@@ -629,7 +1030,7 @@ cvGEMM( const CvArr* Aarr, const CvArr* Barr, double alpha,
     
     CvMat stub, stub1, stub2, stub3;
     CvSize a_size, d_size;
-    int type;
+    int type, use_packed;
 
     if( !CV_IS_MAT( A ))
     {
@@ -661,6 +1062,9 @@ cvGEMM( const CvArr* Aarr, const CvArr* Barr, double alpha,
     if( beta == 0 )
         C = 0;
 
+    use_packed = (flags & CV_GEMM_REFERENCE) == 0;
+    flags &= ~CV_GEMM_REFERENCE;
+
     if( C )
     {
         if( !CV_IS_MAT( C ))
@@ -997,10 +1401,10 @@ cvGEMM( const CvArr* Aarr, const CvArr* Barr, double alpha,
         CvMat tmat, *D0 = D;
         icvBLAS_GEMM_32f_t blas_func = 0;
 
-        if( !inittab )
+        if( cvBeginInitOnce( &inittab ))
         {
             icvInitGEMMTable( &single_mul_tab, &block_mul_tab, &store_tab );
-            inittab = 1;
+            cvEndInitOnce( &inittab );
         }
 
         single_mul_func = (CvGEMMSingleMulFunc)single_mul_tab.fn_2d[type];
@@ -1022,6 +1426,10 @@ cvGEMM( const CvArr* Aarr, const CvArr* Barr, double alpha,
             D = &tmat;
         }
 
+        use_packed = use_packed && type == CV_32FC1 && icvBLAS_GEMM_32f_p == 0 &&
+            d_size.height >= ICV_GEMM_MR && d_size.width >= ICV_GEMM_NR && len >= ICV_GEMM_MR &&
+            (double)d_size.width*d_size.height*len >= ICV_GEMM_PACKED_MIN_OPS;
+
         if( (d_size.width == 1 || len == 1) && !(flags & CV_GEMM_B_T) && CV_IS_MAT_CONT(B->type) )
         {
             b_step = d_size.width == 1 ? 0 : CV_ELEM_SIZE(type);
@@ -1036,7 +1444,11 @@ cvGEMM( const CvArr* Aarr, const CvArr* Barr, double alpha,
                         type == CV_64FC2 ? (icvBLAS_GEMM_32f_t)icvBLAS_GEMM_64fc_p : 0;
         }
 
-        if( blas_func )
+        if( use_packed )
+        {
+            CV_CALL( icvGEMMPacked_32f( A, B, alpha, C, beta, D, flags ));
+        }
+        else if( blas_func )
         {
             const char* transa = flags & CV_GEMM_A_T ? "t" : "n";
             const char* transb = flags & CV_GEMM_B_T ? "t" : "n";
@@ -1612,11 +2024,11 @@ cvTransform( const CvArr* srcarr, CvArr* dstarr,
     int coi = 0, coi2 = 0;
     double* buffer = (double*)cvStackAlloc( CV_CN_MAX*(CV_CN_MAX+1)*sizeof(buffer[0]) );
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitTransformRTable( &transform_tab );
         icvInitDiagTransformRTable( &diag_transform_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( CV_IS_SEQ( src ))
@@ -2026,10 +2438,10 @@ cvPerspectiveTransform( const CvArr* srcarr, CvArr* dstarr, const CvMat* mat )
     CvFunc2D_2A1P func = 0;
     CvSize size;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitPerspectiveTransformTable( &tab[0], &tab[1] );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT( src ))
@@ -2289,10 +2701,10 @@ cvScaleAdd( const CvArr* srcarr1, CvScalar scale,
         size.height = 1;
     }
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitMulAddCTable( &muladds_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( CV_MAT_CN(type) > 2 )
@@ -2473,11 +2885,11 @@ cvCalcCovarMatrix( const CvArr** vecarr, int count,
     int is_covar_normal = (flags & CV_COVAR_NORMAL) != 0;
     double scale;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitDotProductShiftedTable( dot_tab + 0, dot_tab + 1 );
         icvInitExtProductShiftedTable( ext_tab + 0, ext_tab + 1 );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !vecarr )
@@ -2782,10 +3194,10 @@ cvMahalanobis( const CvArr* srcAarr, const CvArr* srcBarr, CvArr* matarr )
     CvMat temp;
     CvMahalanobisFunc func;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitMahalanobisTable( &mahal_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(srcA) )
@@ -3286,10 +3698,10 @@ cvDotProduct( const CvArr* srcAarr, const CvArr* srcBarr )
     int type, depth;
     CvFunc2D_2A1P func;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitDotProductC1RTable( &tab_2d );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT( srcA ))
@@ -452,11 +452,11 @@ cvTranspose( const CvArr* srcarr, CvArr* dstarr )
     CvSize size;
     int type, pix_size;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitTransposeIRTable( &inp_tab );
         icvInitTransposeRTable( &tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT( src ))
@@ -849,10 +849,10 @@ cvDet( const CvArr* arr )
         int buf_size = size.width*size.height*CV_ELEM_SIZE(worktype);
         CvMat tmat;
 
-        if( !lu_inittab )
+        if( cvBeginInitOnce( &lu_inittab ))
         {
             icvInitLUTable( &lu_decomp_tab, &lu_back_tab );
-            lu_inittab = 1;
+            cvEndInitOnce( &lu_inittab );
         }
 
         if( CV_MAT_CN( type ) != 1 || CV_MAT_DEPTH( type ) < CV_32F )
@@ -1104,10 +1104,10 @@ cvInvert( const CvArr* srcarr, CvArr* dstarr, int method )
         int buf_size = size.width*size.height*CV_ELEM_SIZE(worktype);
         CvMat tmat;
 
-        if( !lu_inittab )
+        if( cvBeginInitOnce( &lu_inittab ))
         {
             icvInitLUTable( &lu_decomp_tab, &lu_back_tab );
-            lu_inittab = 1;
+            cvEndInitOnce( &lu_inittab );
         }
 
         if( size.width <= CV_MAX_LOCAL_MAT_SIZE )
@@ -1404,10 +1404,10 @@ cvSolve( const CvArr* A, const CvArr* b, CvArr* x, int method )
         double d = 0;
         CvMat tmat;
 
-        if( !lu_inittab )
+        if( cvBeginInitOnce( &lu_inittab ))
         {
             icvInitLUTable( &lu_decomp_tab, &lu_back_tab );
-            lu_inittab = 1;
+            cvEndInitOnce( &lu_inittab );
         }
 
         if( size.width <= CV_MAX_LOCAL_MAT_SIZE )
@@ -1469,6 +1469,245 @@ cvSolve( const CvArr* A, const CvArr* b, CvArr* x, int method )
 
 
 
+
+/****************************************************************************************\
+*                      Batched solution of small linear systems                          *
+\****************************************************************************************/
+
+/* Solves a[n][n]*x = b[n][nb] in place (the solution replaces b) using
+   Gaussian elimination with partial pivoting; returns 0 if a is singular.
+   _N is the compile-time matrix size (0 - use the run-time n0). */
+#define ICV_DEF_LU_SOLVE_SMALL_FUNC( suffix, _N )                               \
+static int                                                                      \
+icvLUSolveSmall_##suffix( double* a, double* b, int n0, int nb )                \
+{                                                                               \
+    const int n = _N > 0 ? _N : n0;                                             \
+    int i, j, k;                                                                \
+                                                                                \
+    for( i = 0; i < n; i++ )                                                    \
+    {                                                                           \
+        double* ai = a + i*n;                                                   \
+        double* bi = b + i*nb;                                                  \
+        double kval = fabs(ai[i]), tval;                                        \
+        int piv = i;                                                            \
+                                                                                \
+        for( j = i + 1; j < n; j++ )                                            \
+        {                                                                       \
+            tval = fabs(a[j*n + i]);                                            \
+            if( tval > kval )                                                   \
+            {                                                                   \
+                kval = tval;                                                    \
+                piv = j;                                                        \
+            }                                                                   \
+        }                                                                       \
+                                                                                \
+        if( kval == 0 )                                                         \
+            return 0;                                                           \
+                                                                                \
+        if( piv != i )                                                          \
+        {                                                                       \
+            double* ak = a + piv*n;                                             \
+            double* bk = b + piv*nb;                                            \
+            for( k = i; k < n; k++ )                                            \
+                CV_SWAP( ai[k], ak[k], tval );                                  \
+            for( k = 0; k < nb; k++ )                                           \
+                CV_SWAP( bi[k], bk[k], tval );                                  \
+        }                                                                       \
+                                                                                \
+        tval = 1./ai[i];                                                        \
+        ai[i] = tval;                                                           \
+                                                                                \
+        for( j = i + 1; j < n; j++ )                                            \
+        {                                                                       \
+            double* aj = a + j*n;                                               \
+            double* bj = b + j*nb;                                              \
+            double alpha = -aj[i]*tval;                                         \
+                                                                                \
+            for( k = i + 1; k < n; k++ )                                        \
+                aj[k] += alpha*ai[k];                                           \
+            for( k = 0; k < nb; k++ )                                           \
+                bj[k] += alpha*bi[k];                                           \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    for( i = n - 1; i >= 0; i-- )                                               \
+    {                                                                           \
+        const double* ai = a + i*n;                                             \
+        for( k = 0; k < nb; k++ )                                               \
+        {                                                                       \
+            double x = b[i*nb + k];                                             \
+            for( j = i + 1; j < n; j++ )                                        \
+                x -= ai[j]*b[j*nb + k];                                         \
+            b[i*nb + k] = x*ai[i];                                              \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    return 1;                                                                   \
+}
+
+
+ICV_DEF_LU_SOLVE_SMALL_FUNC( 3x3, 3 )
+ICV_DEF_LU_SOLVE_SMALL_FUNC( 4x4, 4 )
+ICV_DEF_LU_SOLVE_SMALL_FUNC( 6x6, 6 )
+ICV_DEF_LU_SOLVE_SMALL_FUNC( 8x8, 8 )
+ICV_DEF_LU_SOLVE_SMALL_FUNC( 9x9, 9 )
+ICV_DEF_LU_SOLVE_SMALL_FUNC( nxn, 0 )
+
+
+static int
+icvLUSolveSmall( double* a, double* b, int n, int nb )
+{
+    switch( n )
+    {
+    case 3:
+        return icvLUSolveSmall_3x3( a, b, n, nb );
+    case 4:
+        return icvLUSolveSmall_4x4( a, b, n, nb );
+    case 6:
+        return icvLUSolveSmall_6x6( a, b, n, nb );
+    case 8:
+        return icvLUSolveSmall_8x8( a, b, n, nb );
+    case 9:
+        return icvLUSolveSmall_9x9( a, b, n, nb );
+    }
+    return icvLUSolveSmall_nxn( a, b, n, nb );
+}
+
+
+/* the packed matrices are converted to double one at a time */
+static void
+icvLoadSmallMat( const CvMat* mat, int row0, int rows, int cols,
+                 double* dst, int transpose )
+{
+    int i, j, type = CV_MAT_TYPE(mat->type);
+
+    for( i = 0; i < rows; i++ )
+    {
+        const uchar* src = mat->data.ptr + (row0 + i)*mat->step;
+        double* d = transpose ? dst + i : dst + i*cols;
+        int dstep = transpose ? rows : 1;
+
+        if( type == CV_32FC1 )
+            for( j = 0; j < cols; j++ )
+                d[j*dstep] = ((const float*)src)[j];
+        else
+            for( j = 0; j < cols; j++ )
+                d[j*dstep] = ((const double*)src)[j];
+    }
+}
+
+
+CV_IMPL int
+cvSolveBatch( const CvArr* A, const CvArr* b, CvArr* x, int count, int method )
+{
+    uchar* buffer = 0;
+    int local_alloc = 0;
+    int result = 0;
+
+    CV_FUNCNAME( "cvSolveBatch" );
+
+    __BEGIN__;
+
+    CvMat sstub, *src = (CvMat*)A;
+    CvMat dstub, *dst = (CvMat*)x;
+    CvMat bstub, *src2 = (CvMat*)b;
+    double *ta, *tb, *tx, *tbuf;
+    int type, m, n, nb, idx, i, j;
+    int buf_size;
+
+    if( !CV_IS_MAT( src ))
+        CV_CALL( src = cvGetMat( src, &sstub ));
+
+    if( !CV_IS_MAT( src2 ))
+        CV_CALL( src2 = cvGetMat( src2, &bstub ));
+
+    if( !CV_IS_MAT( dst ))
+        CV_CALL( dst = cvGetMat( dst, &dstub ));
+
+    type = CV_MAT_TYPE( src->type );
+
+    if( !CV_ARE_TYPES_EQ( src, dst ) || !CV_ARE_TYPES_EQ( src, src2 ))
+        CV_ERROR( CV_StsUnmatchedFormats, "" );
+
+    if( type != CV_32FC1 && type != CV_64FC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+
+    if( method != CV_LU && method != CV_SVD && method != CV_SVD_SYM )
+        CV_ERROR( CV_StsBadArg, "Unknown solution method" );
+
+    if( count <= 0 || src->rows % count != 0 )
+        CV_ERROR( CV_StsOutOfRange, "The number of rows in A must be a multiple of count" );
+
+    m = src->rows/count;
+    n = src->cols;
+    nb = src2->cols;
+
+    if( method != CV_SVD && m != n )
+        CV_ERROR( CV_StsBadSize, "The matrices must be square" );
+
+    if( src2->rows != count*m || dst->rows != count*n || dst->cols != nb )
+        CV_ERROR( CV_StsUnmatchedSizes, "" );
+
+    buf_size = m*n + m*nb + n*nb;
+    if( method != CV_LU )
+        buf_size += n*n + n + nb;
+    buf_size *= sizeof(double);
+
+    if( buf_size <= CV_MAX_LOCAL_SIZE )
+    {
+        buffer = (uchar*)cvStackAlloc( buf_size );
+        local_alloc = 1;
+    }
+    else
+        CV_CALL( buffer = (uchar*)cvAlloc( buf_size ));
+
+    ta = (double*)buffer;
+    tb = ta + m*n;
+    tx = tb + m*nb;
+    tbuf = tx + n*nb;
+
+    for( idx = 0; idx < count; idx++ )
+    {
+        int ok = 1;
+        const double* res = tx;
+
+        icvLoadSmallMat( src2, idx*m, m, nb, tb, 0 );
+
+        if( method == CV_LU )
+        {
+            icvLoadSmallMat( src, idx*m, m, n, ta, 0 );
+            ok = icvLUSolveSmall( ta, tb, n, nb );
+            res = tb;
+        }
+        else
+        {
+            icvLoadSmallMat( src, idx*m, m, n, ta, 1 );
+            icvSVDSolveSmall_64f( ta, m, n, tb, nb, nb, tx, nb, tbuf );
+        }
+
+        result += ok;
+
+        for( i = 0; i < n; i++ )
+        {
+            uchar* d = dst->data.ptr + (idx*n + i)*dst->step;
+
+            if( type == CV_32FC1 )
+                for( j = 0; j < nb; j++ )
+                    ((float*)d)[j] = ok ? (float)res[i*nb + j] : 0.f;
+            else
+                for( j = 0; j < nb; j++ )
+                    ((double*)d)[j] = ok ? res[i*nb + j] : 0.;
+        }
+    }
+
+    __END__;
+
+    if( buffer && !local_alloc )
+        cvFree( &buffer );
+
+    return result;
+}
+
 /****************************************************************************************\
 *                               3D vector cross-product                                  *
 \****************************************************************************************/
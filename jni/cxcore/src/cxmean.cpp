@@ -413,11 +413,11 @@ cvAvg( const void* img, const void* maskarr )
 
         CvMat stub, maskstub, *mat = (CvMat*)img, *mask = (CvMat*)maskarr;
 
-        if( !inittab )
+        if( cvBeginInitOnce( &inittab ))
         {
             icvInitMeanMRTable( &mean_tab );
             icvInitMeanCnCMRTable( &meancoi_tab );
-            inittab = 1;
+            cvEndInitOnce( &inittab );
         }
 
         if( !CV_IS_MAT(mat) )
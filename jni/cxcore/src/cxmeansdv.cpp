@@ -693,13 +693,13 @@ cvAvgSdv( const CvArr* img, CvScalar* _mean, CvScalar* _sdv, const void* mask )
     CvSize size;
     CvMat stub, maskstub, *mat = (CvMat*)img, *matmask = (CvMat*)mask;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitMean_StdDevRTable( &meansdv_tab );
         icvInitMean_StdDevCnCRTable( &meansdvcoi_tab );
         icvInitMean_StdDevMRTable( &meansdvmask_tab );
         icvInitMean_StdDevCnCMRTable( &meansdvmaskcoi_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(mat) )
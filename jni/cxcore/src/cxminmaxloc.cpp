@@ -304,13 +304,13 @@ cvMinMaxLoc( const void* img, double* _minVal, double* _maxVal,
     float minvf = 0.f, maxvf = 0.f;
     void *pmin = &minvf, *pmax = &maxvf;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitMinMaxIndxC1RTable( &minmax_tab );
         icvInitMinMaxIndxCnCRTable( &minmaxcoi_tab );
         icvInitMinMaxIndxC1MRTable( &minmaxmask_tab );
         icvInitMinMaxIndxCnCMRTable( &minmaxmaskcoi_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
     
     if( !CV_IS_MAT(mat) )
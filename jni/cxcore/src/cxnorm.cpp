@@ -1152,10 +1152,10 @@ cvNorm( const void* imgA, const void* imgB, int normType, const void* mask )
         CvNArrayIterator iterator;
         int pass_hint;
 
-        if( !inittab )
+        if( cvBeginInitOnce( &inittab ))
         {
             icvInitNormTabs( norm_tab, normmask_tab );
-            inittab = 1;
+            cvEndInitOnce( &inittab );
         }
 
         if( mask )
@@ -1245,10 +1245,10 @@ cvNorm( const void* imgA, const void* imgB, int normType, const void* mask )
         EXIT;
     }
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitNormTabs( norm_tab, normmask_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !mask )
@@ -461,11 +461,11 @@ cvRandArr( CvRNG* rng, CvArr* arr, int disttype, CvScalar param1, CvScalar param
     CvMatND stub_nd;
     CvNArrayIterator iterator_state, *iterator = 0;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitRandTable( &fastrng_tab, &rng_tab[CV_RAND_UNI],
                           &rng_tab[CV_RAND_NORMAL] );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !rng )
@@ -401,11 +401,11 @@ cvSum( const CvArr* arr )
     CvSize size;
     CvMat stub, *mat = (CvMat*)arr;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitSumRTable( &sum_tab );
         icvInitSumCnCRTable( &sumcoi_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(mat) )
@@ -592,11 +592,11 @@ cvCountNonZero( const CvArr* arr )
     CvSize size;
     CvMat stub, *mat = (CvMat*)arr;
 
-    if( !inittab )
+    if( cvBeginInitOnce( &inittab ))
     {
         icvInitCountNonZeroC1RTable( &nz_tab );
         icvInitCountNonZeroCnCRTable( &nzcoi_tab );
-        inittab = 1;
+        cvEndInitOnce( &inittab );
     }
 
     if( !CV_IS_MAT(mat) )
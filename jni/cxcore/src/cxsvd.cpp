@@ -1619,4 +1619,400 @@ cvSVBkSb( const CvArr* warr, const CvArr* uarr,
         cvFree( &buffer );
 }
 
+/****************************************************************************************\
+*                     Batched SVD of small matrices (one-sided Jacobi)                   *
+\****************************************************************************************/
+
+#define ICV_JACOBI_SVD_MAX_SWEEPS  30
+
+/* One-sided Jacobi SVD of a small m x n matrix stored transposed: the n columns
+   of A are the rows of at[n][m]. On exit w[0:n] holds the singular values in
+   descending order, the first nu rows of at hold the left singular vectors and
+   vt[n][n] (if not NULL) holds the right singular vectors as rows.
+   _M and _N are compile-time sizes (0 - use the run-time m0 and n0), so the
+   instantiations for the common sizes get fully unrolled inner loops. */
+#define ICV_DEF_JACOBI_SVD_FUNC( suffix, _M, _N )                               \
+static void                                                                     \
+icvJacobiSVD_##suffix( double* at, double* w, double* vt,                       \
+                       int m0, int n0, int nu )                                 \
+{                                                                               \
+    const int m = _M > 0 ? _M : m0, n = _N > 0 ? _N : n0;                       \
+    const double eps = DBL_EPSILON*10;                                          \
+    double minval = 0;                                                          \
+    int i, j, k, iter;                                                          \
+                                                                                \
+    for( i = 0; i < n; i++ )                                                    \
+    {                                                                           \
+        const double* ai = at + i*m;                                            \
+        double s = 0;                                                           \
+        for( k = 0; k < m; k++ )                                                \
+            s += ai[k]*ai[k];                                                   \
+        w[i] = s;                                                               \
+        minval += s;                                                            \
+                                                                                \
+        if( vt )                                                                \
+        {                                                                       \
+            for( k = 0; k < n; k++ )                                            \
+                vt[i*n + k] = 0;                                                \
+            vt[i*n + i] = 1;                                                    \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    /* columns that are that small relative to the matrix norm are                \
+       numerically zero; rotating them only risks an underflow */               \
+    minval = minval*DBL_EPSILON*DBL_EPSILON + DBL_MIN;                          \
+                                                                                \
+    for( iter = 0; iter < ICV_JACOBI_SVD_MAX_SWEEPS; iter++ )                   \
+    {                                                                           \
+        int changed = 0;                                                        \
+                                                                                \
+        for( i = 0; i < n - 1; i++ )                                            \
+            for( j = i + 1; j < n; j++ )                                        \
+            {                                                                   \
+                double *ai = at + i*m, *aj = at + j*m;                          \
+                double a = w[i], b = w[j], p = 0, zeta, t, c, s;                \
+                                                                                \
+                if( a <= minval || b <= minval )                                \
+                    continue;                                                   \
+                                                                                \
+                for( k = 0; k < m; k++ )                                        \
+                    p += ai[k]*aj[k];                                           \
+                                                                                \
+                if( p*p <= eps*eps*a*b )                                        \
+                    continue;                                                   \
+                                                                                \
+                /* rotation that makes the columns i and j orthogonal */        \
+                zeta = (b - a)/(p*2);                                           \
+                t = 1./(fabs(zeta) + sqrt(zeta*zeta + 1));                      \
+                t = zeta < 0 ? -t : t;                                          \
+                c = 1./sqrt(t*t + 1);                                           \
+                s = c*t;                                                        \
+                                                                                \
+                a = b = 0;                                                      \
+                for( k = 0; k < m; k++ )                                        \
+                {                                                               \
+                    double t0 = c*ai[k] - s*aj[k];                              \
+                    double t1 = s*ai[k] + c*aj[k];                              \
+                    ai[k] = t0; aj[k] = t1;                                     \
+                    a += t0*t0; b += t1*t1;                                     \
+                }                                                               \
+                w[i] = a; w[j] = b;                                             \
+                changed = 1;                                                    \
+                                                                                \
+                if( vt )                                                        \
+                {                                                               \
+                    double *vi = vt + i*n, *vj = vt + j*n;                      \
+                    for( k = 0; k < n; k++ )                                    \
+                    {                                                           \
+                        double t0 = c*vi[k] - s*vj[k];                          \
+                        double t1 = s*vi[k] + c*vj[k];                          \
+                        vi[k] = t0; vj[k] = t1;                                 \
+                    }                                                           \
+                }                                                               \
+            }                                                                   \
+                                                                                \
+        if( !changed )                                                          \
+            break;                                                              \
+    }                                                                           \
+                                                                                \
+    for( i = 0; i < n; i++ )                                                    \
+    {                                                                           \
+        const double* ai = at + i*m;                                            \
+        double s = 0;                                                           \
+        for( k = 0; k < m; k++ )                                                \
+            s += ai[k]*ai[k];                                                   \
+        w[i] = sqrt(s);                                                         \
+    }                                                                           \
+                                                                                \
+    /* sort the singular values (and the vectors) in descending order */        \
+    for( i = 0; i < n - 1; i++ )                                                \
+    {                                                                           \
+        int idx = i;                                                            \
+        for( j = i + 1; j < n; j++ )                                            \
+            if( w[idx] < w[j] )                                                 \
+                idx = j;                                                        \
+        if( idx != i )                                                          \
+        {                                                                       \
+            double t;                                                           \
+            CV_SWAP( w[i], w[idx], t );                                         \
+            if( nu )                                                            \
+                for( k = 0; k < m; k++ )                                        \
+                    CV_SWAP( at[i*m + k], at[idx*m + k], t );                   \
+            if( vt )                                                            \
+                for( k = 0; k < n; k++ )                                        \
+                    CV_SWAP( vt[i*n + k], vt[idx*n + k], t );                   \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    /* normalize the left singular vectors; the ones that correspond to         \
+       (almost) zero singular values are replaced with an orthonormal           \
+       completion built from the standard basis */                              \
+    for( i = 0; i < nu; i++ )                                                   \
+    {                                                                           \
+        double* ai = at + i*m;                                                  \
+        double s = w[i];                                                        \
+                                                                                \
+        if( s > w[0]*DBL_EPSILON*m && s > DBL_MIN )                             \
+        {                                                                       \
+            s = 1./s;                                                           \
+            for( k = 0; k < m; k++ )                                            \
+                ai[k] *= s;                                                     \
+            continue;                                                           \
+        }                                                                       \
+                                                                                \
+        for( j = 0; j < m; j++ )                                                \
+        {                                                                       \
+            int l, pass;                                                        \
+            for( k = 0; k < m; k++ )                                            \
+                ai[k] = k == j;                                                 \
+            for( pass = 0; pass < 2; pass++ )                                   \
+                for( l = 0; l < i; l++ )                                        \
+                {                                                               \
+                    const double* al = at + l*m;                                \
+                    double d = 0;                                               \
+                    for( k = 0; k < m; k++ )                                    \
+                        d += ai[k]*al[k];                                       \
+                    for( k = 0; k < m; k++ )                                    \
+                        ai[k] -= d*al[k];                                       \
+                }                                                               \
+            s = 0;                                                              \
+            for( k = 0; k < m; k++ )                                            \
+                s += ai[k]*ai[k];                                               \
+            if( s > 0.25 )                                                      \
+                break;                                                          \
+        }                                                                       \
+                                                                                \
+        s = 1./sqrt(s);                                                         \
+        for( k = 0; k < m; k++ )                                                \
+            ai[k] *= s;                                                         \
+    }                                                                           \
+}
+
+
+ICV_DEF_JACOBI_SVD_FUNC( 3x3, 3, 3 )
+ICV_DEF_JACOBI_SVD_FUNC( 4x4, 4, 4 )
+ICV_DEF_JACOBI_SVD_FUNC( 6x6, 6, 6 )
+ICV_DEF_JACOBI_SVD_FUNC( 7x9, 7, 9 )
+ICV_DEF_JACOBI_SVD_FUNC( 9x9, 9, 9 )
+ICV_DEF_JACOBI_SVD_FUNC( mxn, 0, 0 )
+
+
+static void
+icvJacobiSVD( double* at, double* w, double* vt, int m, int n, int nu )
+{
+    if( m == n )
+    {
+        if( n == 3 )
+        {
+            icvJacobiSVD_3x3( at, w, vt, m, n, nu );
+            return;
+        }
+        if( n == 4 )
+        {
+            icvJacobiSVD_4x4( at, w, vt, m, n, nu );
+            return;
+        }
+        if( n == 6 )
+        {
+            icvJacobiSVD_6x6( at, w, vt, m, n, nu );
+            return;
+        }
+        if( n == 9 )
+        {
+            icvJacobiSVD_9x9( at, w, vt, m, n, nu );
+            return;
+        }
+    }
+    else if( m == 7 && n == 9 )
+    {
+        icvJacobiSVD_7x9( at, w, vt, m, n, nu );
+        return;
+    }
+
+    icvJacobiSVD_mxn( at, w, vt, m, n, nu );
+}
+
+
+/* least-squares solution of a small m x n system via the Jacobi SVD;
+   at[n][m] is the transposed matrix (destroyed),
+   buffer must have room for n*n + n + nb elements */
+void
+icvSVDSolveSmall_64f( double* at, int m, int n,
+                      const double* b, int ldb, int nb,
+                      double* x, int ldx, double* buffer )
+{
+    double* vt = buffer;
+    double* w = vt + n*n;
+
+    icvJacobiSVD( at, w, vt, m, n, MIN(m,n) );
+    icvSVBkSb_64f( m, n, w, at, m, vt, n, b, ldb, nb, x, ldx, w + n );
+}
+
+
+CV_IMPL void
+cvSVDBatch( const CvArr* aarr, CvArr* warr, CvArr* uarr, CvArr* varr,
+            int count, int flags )
+{
+    uchar* buffer = 0;
+    int local_alloc = 0;
+
+    CV_FUNCNAME( "cvSVDBatch" );
+
+    __BEGIN__;
+
+    CvMat astub, *a = (CvMat*)aarr;
+    CvMat wstub, *w = (CvMat*)warr;
+    CvMat ustub, *u = (CvMat*)uarr;
+    CvMat vstub, *v = (CvMat*)varr;
+    double *at, *tw, *vt;
+    int type, m, n, nw, nu = 0;
+    int buf_size, idx, i, j;
+
+    if( !CV_IS_MAT( a ))
+        CV_CALL( a = cvGetMat( a, &astub ));
+
+    if( !CV_IS_MAT( w ))
+        CV_CALL( w = cvGetMat( w, &wstub ));
+
+    type = CV_MAT_TYPE( a->type );
+    if( type != CV_32FC1 && type != CV_64FC1 )
+        CV_ERROR( CV_StsUnsupportedFormat, "" );
+
+    if( count <= 0 || a->rows % count != 0 )
+        CV_ERROR( CV_StsOutOfRange, "The number of rows in A must be a multiple of count" );
+
+    m = a->rows/count;
+    n = a->cols;
+    nw = MIN( m, n );
+
+    if( !CV_ARE_TYPES_EQ( a, w ))
+        CV_ERROR( CV_StsUnmatchedFormats, "" );
+
+    if( w->rows != count || w->cols != nw )
+        CV_ERROR( CV_StsUnmatchedSizes, "W must be count x min(m,n) matrix" );
+
+    if( u )
+    {
+        if( !CV_IS_MAT( u ))
+            CV_CALL( u = cvGetMat( u, &ustub ));
+
+        if( !CV_ARE_TYPES_EQ( a, u ))
+            CV_ERROR( CV_StsUnmatchedFormats, "" );
+
+        if( !(flags & CV_SVD_U_T) ? u->rows != count*m || u->cols != nw :
+                                    u->rows != count*nw || u->cols != m )
+            CV_ERROR( CV_StsUnmatchedSizes, "U matrix has unappropriate size" );
+        nu = nw;
+    }
+
+    if( v )
+    {
+        if( !CV_IS_MAT( v ))
+            CV_CALL( v = cvGetMat( v, &vstub ));
+
+        if( !CV_ARE_TYPES_EQ( a, v ))
+            CV_ERROR( CV_StsUnmatchedFormats, "" );
+
+        if( v->rows != count*n || v->cols != n )
+            CV_ERROR( CV_StsUnmatchedSizes, "V matrix has unappropriate size" );
+    }
+
+    /* a single work buffer is shared by all the matrices of the batch */
+    buf_size = (m*n + n + n*n)*sizeof(double);
+
+    if( buf_size <= CV_MAX_LOCAL_SIZE )
+    {
+        buffer = (uchar*)cvStackAlloc( buf_size );
+        local_alloc = 1;
+    }
+    else
+        CV_CALL( buffer = (uchar*)cvAlloc( buf_size ));
+
+    at = (double*)buffer;
+    tw = at + m*n;
+    vt = tw + n;
+
+    for( idx = 0; idx < count; idx++ )
+    {
+        if( type == CV_32FC1 )
+        {
+            for( i = 0; i < m; i++ )
+            {
+                const float* src = (const float*)(a->data.ptr + (idx*m + i)*a->step);
+                for( j = 0; j < n; j++ )
+                    at[j*m + i] = src[j];
+            }
+        }
+        else
+        {
+            for( i = 0; i < m; i++ )
+            {
+                const double* src = (const double*)(a->data.ptr + (idx*m + i)*a->step);
+                for( j = 0; j < n; j++ )
+                    at[j*m + i] = src[j];
+            }
+        }
+
+        icvJacobiSVD( at, tw, v ? vt : 0, m, n, nu );
+
+        if( type == CV_32FC1 )
+        {
+            float* dst = (float*)(w->data.ptr + idx*w->step);
+            for( i = 0; i < nw; i++ )
+                dst[i] = (float)tw[i];
+
+            if( u )
+                for( i = 0; i < nu; i++ )
+                    for( j = 0; j < m; j++ )
+                    {
+                        if( flags & CV_SVD_U_T )
+                            ((float*)(u->data.ptr + (idx*nu + i)*u->step))[j] = (float)at[i*m + j];
+                        else
+                            ((float*)(u->data.ptr + (idx*m + j)*u->step))[i] = (float)at[i*m + j];
+                    }
+
+            if( v )
+                for( i = 0; i < n; i++ )
+                    for( j = 0; j < n; j++ )
+                    {
+                        if( flags & CV_SVD_V_T )
+                            ((float*)(v->data.ptr + (idx*n + i)*v->step))[j] = (float)vt[i*n + j];
+                        else
+                            ((float*)(v->data.ptr + (idx*n + j)*v->step))[i] = (float)vt[i*n + j];
+                    }
+        }
+        else
+        {
+            double* dst = (double*)(w->data.ptr + idx*w->step);
+            for( i = 0; i < nw; i++ )
+                dst[i] = tw[i];
+
+            if( u )
+                for( i = 0; i < nu; i++ )
+                    for( j = 0; j < m; j++ )
+                    {
+                        if( flags & CV_SVD_U_T )
+                            ((double*)(u->data.ptr + (idx*nu + i)*u->step))[j] = at[i*m + j];
+                        else
+                            ((double*)(u->data.ptr + (idx*m + j)*u->step))[i] = at[i*m + j];
+                    }
+
+            if( v )
+                for( i = 0; i < n; i++ )
+                    for( j = 0; j < n; j++ )
+                    {
+                        if( flags & CV_SVD_V_T )
+                            ((double*)(v->data.ptr + (idx*n + i)*v->step))[j] = vt[i*n + j];
+                        else
+                            ((double*)(v->data.ptr + (idx*n + j)*v->step))[i] = vt[i*n + j];
+                    }
+        }
+    }
+
+    __END__;
+
+    if( buffer && !local_alloc )
+        cvFree( &buffer );
+}
+
 /* End of file. */
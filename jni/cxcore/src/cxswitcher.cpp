@@ -59,12 +59,129 @@
 #else
 #include <dlfcn.h>
 #include <sys/time.h>
+#include <pthread.h>
 #endif
 
 #include <string.h>
 #include <stdio.h>
 #include <ctype.h>
 
+/****************************************************************************************\
+*                                One-time initialization                                 *
+\****************************************************************************************/
+
+/*
+   The lazily initialized static data (function tables etc.) are filled under a single
+   global lock. It is recursive, because an initialization block may call functions that
+   have their own ones. Once the flag is set, cvBeginInitOnce does not touch the lock.
+*/
+#if defined __GNUC__ && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1))
+#define ICV_MEMORY_BARRIER()    __sync_synchronize()
+#elif defined _MSC_VER && _MSC_VER >= 1400
+#define ICV_MEMORY_BARRIER()    MemoryBarrier()
+#else
+#define ICV_MEMORY_BARRIER()
+#endif
+
+#if defined WIN32 || defined WIN64
+
+static CRITICAL_SECTION icvInitLock;
+static volatile LONG icvInitLockState = 0; // 0 - not created, 1 - being created, 2 - ready
+
+static void icvLockInit(void)
+{
+    if( icvInitLockState != 2 )
+    {
+        if( InterlockedCompareExchange( (LONG*)&icvInitLockState, 1, 0 ) == 0 )
+        {
+            InitializeCriticalSection( &icvInitLock );
+            icvInitLockState = 2;
+        }
+        else
+        {
+            while( icvInitLockState != 2 )
+                Sleep( 0 );
+        }
+    }
+    EnterCriticalSection( &icvInitLock );
+}
+
+static void icvUnlockInit(void)
+{
+    LeaveCriticalSection( &icvInitLock );
+}
+
+#else
+
+static pthread_mutex_t icvInitLock;
+static pthread_once_t icvInitLockOnce = PTHREAD_ONCE_INIT;
+
+static void icvCreateInitLock(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init( &attr );
+    pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_RECURSIVE );
+    pthread_mutex_init( &icvInitLock, &attr );
+    pthread_mutexattr_destroy( &attr );
+}
+
+static void icvLockInit(void)
+{
+    pthread_once( &icvInitLockOnce, icvCreateInitLock );
+    pthread_mutex_lock( &icvInitLock );
+}
+
+static void icvUnlockInit(void)
+{
+    pthread_mutex_unlock( &icvInitLock );
+}
+
+#endif
+
+
+CV_IMPL void
+cvLockGlobal( void )
+{
+    icvLockInit();
+}
+
+
+CV_IMPL void
+cvUnlockGlobal( void )
+{
+    icvUnlockInit();
+}
+
+
+CV_IMPL int
+cvBeginInitOnce( int* flag )
+{
+    if( *(volatile int*)flag )
+    {
+        // the data written by the initializing thread must be visible after the flag
+        ICV_MEMORY_BARRIER();
+        return 0;
+    }
+
+    icvLockInit();
+    if( *(volatile int*)flag )
+    {
+        icvUnlockInit();
+        return 0;
+    }
+    return 1;
+}
+
+
+CV_IMPL void
+cvEndInitOnce( int* flag )
+{
+    ICV_MEMORY_BARRIER();
+    *(volatile int*)flag = 1;
+    icvUnlockInit();
+}
+
+
 #define CV_PROC_GENERIC             0
 #define CV_PROC_SHIFT               10
 #define CV_PROC_ARCH_MASK           ((1 << CV_PROC_SHIFT) - 1)
@@ -275,10 +392,10 @@ icvGetProcessorInfo()
 {
     static CvProcessorInfo cpu_info;
     static int init_cpu_info = 0;
-    if( !init_cpu_info )
+    if( cvBeginInitOnce( &init_cpu_info ))
     {
         icvInitProcessorInfo( &cpu_info );
-        init_cpu_info = 1;
+        cvEndInitOnce( &init_cpu_info );
     }
     return &cpu_info;
 }
@@ -719,6 +836,242 @@ cvGetModuleInfo( const char* name, const char **version, const char **plugin_lis
 }
 
 
+/****************************************************************************************\
+*                          CPU features and SIMD kernel dispatch                         *
+\****************************************************************************************/
+
+#define ICV_MAX_CPU_FEATURE     128
+
+static uchar icvCPUFeatures[ICV_MAX_CPU_FEATURE];
+static int icvCPUFeaturesInit = 0;
+
+#if defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+#include <cpuid.h>
+#define ICV_HAVE_CPUID 1
+
+static void icvCPUID( int leaf, int* regs )
+{
+    unsigned a = 0, b = 0, c = 0, d = 0;
+    __cpuid_count( leaf, 0, a, b, c, d );
+    regs[0] = (int)a; regs[1] = (int)b; regs[2] = (int)c; regs[3] = (int)d;
+}
+
+static int64 icvXGetBV(void)
+{
+    unsigned lo, hi;
+    asm volatile( ".byte 0x0f, 0x01, 0xd0" : "=a"(lo), "=d"(hi) : "c"(0) );
+    return ((int64)hi << 32) | lo;
+}
+
+#elif defined _MSC_VER && _MSC_FULL_VER >= 160040219 && (defined _M_IX86 || defined _M_X64)
+#include <intrin.h>
+#include <immintrin.h>
+#define ICV_HAVE_CPUID 1
+
+static void icvCPUID( int leaf, int* regs )
+{
+    __cpuidex( regs, leaf, 0 );
+}
+
+static int64 icvXGetBV(void)
+{
+    return (int64)_xgetbv( 0 );
+}
+
+#else
+#define ICV_HAVE_CPUID 0
+#endif
+
+static void
+icvInitCPUFeatures( uchar* have )
+{
+    memset( have, 0, ICV_MAX_CPU_FEATURE );
+    have[CV_CPU_NONE] = 1;
+
+#if ICV_HAVE_CPUID
+    int regs[4] = { 0, 0, 0, 0 }, max_leaf;
+
+    icvCPUID( 0, regs );
+    max_leaf = regs[0];
+    if( max_leaf >= 1 )
+    {
+        int ecx, edx;
+        icvCPUID( 1, regs );
+        ecx = regs[2];
+        edx = regs[3];
+
+        have[CV_CPU_MMX] = (edx & (1 << 23)) != 0;
+        have[CV_CPU_SSE] = (edx & (1 << 25)) != 0;
+        have[CV_CPU_SSE2] = (edx & (1 << 26)) != 0;
+        have[CV_CPU_SSE3] = (ecx & (1 << 0)) != 0;
+        have[CV_CPU_SSSE3] = (ecx & (1 << 9)) != 0;
+        have[CV_CPU_SSE4_1] = (ecx & (1 << 19)) != 0;
+        have[CV_CPU_SSE4_2] = (ecx & (1 << 20)) != 0;
+
+        // AVX also needs the OS to save the YMM registers (OSXSAVE and XCR0 bits 1, 2)
+        if( (ecx & (1 << 27)) && (ecx & (1 << 28)) && (icvXGetBV() & 6) == 6 )
+        {
+            have[CV_CPU_AVX] = 1;
+            if( max_leaf >= 7 )
+            {
+                icvCPUID( 7, regs );
+                have[CV_CPU_AVX2] = (regs[1] & (1 << 5)) != 0;
+            }
+        }
+    }
+#elif defined __aarch64__
+    have[CV_CPU_NEON] = 1;
+#elif defined __arm__
+    // the kernel lists "neon" among the "Features" of /proc/cpuinfo
+    FILE* file = fopen( "/proc/cpuinfo", "r" );
+
+    if( file )
+    {
+        char buffer[1024];
+
+        while( fgets( buffer, sizeof(buffer)-1, file ))
+        {
+            if( strncmp( buffer, "Features", 8 ) == 0 &&
+                (strstr( buffer, " neon" ) || strstr( buffer, " asimd" )))
+                have[CV_CPU_NEON] = 1;
+        }
+        fclose( file );
+    }
+#if defined __ARM_NEON || defined __ARM_NEON__
+    else
+        have[CV_CPU_NEON] = 1;
+#endif
+#endif
+}
+
+
+static const uchar*
+icvGetCPUFeatures(void)
+{
+    if( cvBeginInitOnce( &icvCPUFeaturesInit ))
+    {
+        icvInitCPUFeatures( icvCPUFeatures );
+        cvEndInitOnce( &icvCPUFeaturesInit );
+    }
+    return icvCPUFeatures;
+}
+
+
+CV_IMPL int
+cvCheckHardwareSupport( int feature )
+{
+    return (unsigned)feature < ICV_MAX_CPU_FEATURE ? icvGetCPUFeatures()[feature] : 0;
+}
+
+
+/*
+   The dispatched kernels are kept in a list in the order of registration. They are
+   registered and (re)bound under the initialization lock; the callers only read the
+   pointer to the bound variant.
+*/
+static CvDispatchEntry* icvDispatchFirst = 0;
+static CvDispatchEntry* icvDispatchLast = 0;
+static int icvDispatchMode = CV_DISPATCH_AUTO;
+
+static void
+icvBindDispatchEntry( CvDispatchEntry* entry )
+{
+    const uchar* have = icvGetCPUFeatures();
+    int i = entry->count - 1;
+
+    if( icvDispatchMode != CV_DISPATCH_SCALAR )
+    {
+        for( i = 0; i < entry->count - 1; i++ )
+        {
+            int feature = entry->variants[i].feature;
+            if( (unsigned)feature < ICV_MAX_CPU_FEATURE && have[feature] )
+                break;
+        }
+    }
+
+    entry->idx = i;
+    entry->func = entry->variants[i].func;
+}
+
+
+CV_IMPL void*
+cvGetDispatchFunc( CvDispatchEntry* entry )
+{
+    void* func = entry->func;
+
+    if( !func )
+    {
+        icvLockInit();
+        if( !entry->func )
+        {
+            entry->next = 0;
+            if( icvDispatchLast )
+                icvDispatchLast->next = entry;
+            else
+                icvDispatchFirst = entry;
+            icvDispatchLast = entry;
+            icvBindDispatchEntry( entry );
+        }
+        func = entry->func;
+        icvUnlockInit();
+    }
+
+    return func;
+}
+
+
+CV_IMPL void
+cvSetDispatchMode( int mode )
+{
+    CV_FUNCNAME( "cvSetDispatchMode" );
+
+    __BEGIN__;
+
+    CvDispatchEntry* entry;
+
+    if( mode != CV_DISPATCH_AUTO && mode != CV_DISPATCH_SCALAR )
+        CV_ERROR( CV_StsBadArg, "Unknown dispatch mode" );
+
+    icvLockInit();
+    icvDispatchMode = mode;
+    for( entry = icvDispatchFirst; entry != 0; entry = entry->next )
+        icvBindDispatchEntry( entry );
+    icvUnlockInit();
+
+    __END__;
+}
+
+
+CV_IMPL int
+cvGetDispatchMode( void )
+{
+    return icvDispatchMode;
+}
+
+
+CV_IMPL int
+cvGetDispatchInfo( const char** kernels, const char** variants, int max_count )
+{
+    int count = 0;
+    CvDispatchEntry* entry;
+
+    icvLockInit();
+    for( entry = icvDispatchFirst; entry != 0; entry = entry->next, count++ )
+    {
+        if( count < max_count )
+        {
+            if( kernels )
+                kernels[count] = entry->name;
+            if( variants )
+                variants[count] = entry->variants[entry->idx].name;
+        }
+    }
+    icvUnlockInit();
+
+    return count;
+}
+
+
 typedef int64 (CV_CDECL * rdtsc_func)(void);
 
 /* helper functions for RNG initialization and accurate time measurement */
@@ -768,9 +1121,112 @@ CV_IMPL  double  cvGetTickFrequency()
 }
 
 
+/****************************************************************************************\
+*                                     Multi-threading                                    *
+\****************************************************************************************/
+
+/*
+   Without OpenMP, the parallel loops (cvParallelFor) run on a small pool of POSIX
+   threads. The workers are created on demand, sleep on a condition variable between
+   the loops and take the chunks of the iteration range one by one. The calling thread
+   takes part in the loop, so cvGetThreadNum() is 0 for it and 1..N-1 for the workers.
+*/
+#if !defined _OPENMP && !defined WIN32 && !defined WIN64
+#define CV_USE_PTHREADS_POOL 1
+#include <pthread.h>
+#include <unistd.h>
+#else
+#define CV_USE_PTHREADS_POOL 0
+#endif
+
 static int icvNumThreads = 0;
 static int icvNumProcs = 0;
 
+#if CV_USE_PTHREADS_POOL
+
+typedef struct CvThreadPool
+{
+    pthread_mutex_t mutex;      // protects all the fields below
+    pthread_mutex_t busy;       // held by the thread that runs a parallel loop
+    pthread_cond_t job_cond;    // signaled when a new loop is started
+    pthread_cond_t done_cond;   // signaled when the last worker is done with the loop
+    pthread_t threads[CV_MAX_THREADS];
+    int nworkers;               // number of the started workers
+    int job_id;                 // incremented for each new loop
+
+    // the current loop
+    CvParallelLoopFunc body;
+    void* userdata;
+    int count, nchunks, next_chunk;
+    int nactive;                // number of the workers that take part in the loop
+    int nrunning;               // number of the workers that have not finished yet
+}
+CvThreadPool;
+
+static CvThreadPool icvThreadPool;
+static pthread_once_t icvThreadPoolOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t icvThreadIdxKey;
+
+static void icvInitThreadPool(void)
+{
+    CvThreadPool* pool = &icvThreadPool;
+    memset( pool, 0, sizeof(*pool) );
+    pthread_mutex_init( &pool->mutex, 0 );
+    pthread_mutex_init( &pool->busy, 0 );
+    pthread_cond_init( &pool->job_cond, 0 );
+    pthread_cond_init( &pool->done_cond, 0 );
+    pthread_key_create( &icvThreadIdxKey, 0 );
+}
+
+/* processes the chunks of the current loop until there is no more left;
+   must be called with pool->mutex locked */
+static void icvRunParallelChunks( CvThreadPool* pool )
+{
+    while( pool->next_chunk < pool->nchunks )
+    {
+        int i = pool->next_chunk++;
+        int start = (int)((int64)i*pool->count/pool->nchunks);
+        int end = (int)((int64)(i+1)*pool->count/pool->nchunks);
+        CvParallelLoopFunc body = pool->body;
+        void* userdata = pool->userdata;
+
+        pthread_mutex_unlock( &pool->mutex );
+        body( start, end, userdata );
+        pthread_mutex_lock( &pool->mutex );
+    }
+}
+
+static void* icvWorkerThread( void* arg )
+{
+    CvThreadPool* pool = &icvThreadPool;
+    size_t idx = (size_t)arg;
+    int job_id;
+
+    pthread_setspecific( icvThreadIdxKey, arg );
+    pthread_mutex_lock( &pool->mutex );
+    // the worker is created just before the loop it has to take part in is started
+    job_id = pool->job_id - 1;
+
+    for(;;)
+    {
+        while( pool->job_id == job_id )
+            pthread_cond_wait( &pool->job_cond, &pool->mutex );
+        job_id = pool->job_id;
+
+        if( (int)idx < pool->nactive )
+        {
+            icvRunParallelChunks( pool );
+            if( --pool->nrunning == 0 )
+                pthread_cond_signal( &pool->done_cond );
+        }
+    }
+
+    return 0;
+}
+
+#endif
+
+
 CV_IMPL int cvGetNumThreads(void)
 {
     if( !icvNumProcs )
@@ -784,19 +1240,22 @@ CV_IMPL void cvSetNumThreads( int threads )
     {
 #ifdef _OPENMP
         icvNumProcs = omp_get_num_procs();
-        icvNumProcs = MIN( icvNumProcs, CV_MAX_THREADS );
+#elif CV_USE_PTHREADS_POOL && defined _SC_NPROCESSORS_ONLN
+        icvNumProcs = (int)sysconf( _SC_NPROCESSORS_ONLN );
 #else
         icvNumProcs = 1;
 #endif
+        icvNumProcs = MAX( icvNumProcs, 1 );
+        icvNumProcs = MIN( icvNumProcs, CV_MAX_THREADS );
     }
 
-#ifdef _OPENMP
+#if defined _OPENMP || CV_USE_PTHREADS_POOL
     if( threads <= 0 )
         threads = icvNumProcs;
     //else
     //    threads = MIN( threads, icvNumProcs );
 
-    icvNumThreads = threads;
+    icvNumThreads = MIN( threads, CV_MAX_THREADS );
 #else
     icvNumThreads = 1;
 #endif
@@ -807,10 +1266,90 @@ CV_IMPL int cvGetThreadNum(void)
 {
 #ifdef _OPENMP
     return omp_get_thread_num();
+#elif CV_USE_PTHREADS_POOL
+    pthread_once( &icvThreadPoolOnce, icvInitThreadPool );
+    return (int)(size_t)pthread_getspecific( icvThreadIdxKey );
 #else
     return 0;
 #endif
 }
 
 
+CV_IMPL void
+cvParallelFor( int count, CvParallelLoopFunc body, void* userdata, int min_chunk )
+{
+    int nthreads = cvGetNumThreads(), nchunks;
+
+    if( count <= 0 )
+        return;
+
+    min_chunk = MAX( min_chunk, 1 );
+    nthreads = MIN( nthreads, count/min_chunk );
+
+    if( nthreads <= 1 )
+    {
+        body( 0, count, userdata );
+        return;
+    }
+
+    // a few chunks per thread to balance the load
+    nchunks = MIN( nthreads*4, count/min_chunk );
+
+#ifdef _OPENMP
+    {
+    int i;
+    #pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+    for( i = 0; i < nchunks; i++ )
+        body( (int)((int64)i*count/nchunks), (int)((int64)(i+1)*count/nchunks), userdata );
+    }
+#elif CV_USE_PTHREADS_POOL
+    {
+    CvThreadPool* pool = &icvThreadPool;
+    pthread_once( &icvThreadPoolOnce, icvInitThreadPool );
+
+    // nested loops and the loops started concurrently from different user threads
+    // are executed sequentially
+    if( pthread_getspecific( icvThreadIdxKey ) != 0 ||
+        pthread_mutex_trylock( &pool->busy ) != 0 )
+    {
+        body( 0, count, userdata );
+        return;
+    }
+
+    pthread_mutex_lock( &pool->mutex );
+    while( pool->nworkers < nthreads - 1 )
+    {
+        size_t idx = pool->nworkers + 1;
+        if( pthread_create( &pool->threads[pool->nworkers], 0,
+                            icvWorkerThread, (void*)idx ) != 0 )
+            break;
+        pool->nworkers++;
+    }
+
+    pool->body = body;
+    pool->userdata = userdata;
+    pool->count = count;
+    pool->nchunks = nchunks;
+    pool->next_chunk = 0;
+    // the worker #i takes part in the loop if i < nactive; the caller is #0
+    pool->nactive = MIN( nthreads, pool->nworkers + 1 );
+    pool->nrunning = pool->nactive - 1;
+    pool->job_id++;
+    pthread_cond_broadcast( &pool->job_cond );
+
+    icvRunParallelChunks( pool );
+    while( pool->nrunning > 0 )
+        pthread_cond_wait( &pool->done_cond, &pool->mutex );
+
+    pool->body = 0;
+    pool->userdata = 0;
+    pthread_mutex_unlock( &pool->mutex );
+    pthread_mutex_unlock( &pool->busy );
+    }
+#else
+    body( 0, count, userdata );
+#endif
+}
+
+
 /* End of file. */
@@ -93,12 +93,11 @@ GrFmtTiffReader::GrFmtTiffReader( const char* filename ) : GrFmtReader( filename
 {
     m_tif = 0;
 
-    if( !grfmt_tiff_err_handler_init )
+    if( cvBeginInitOnce( &grfmt_tiff_err_handler_init ))
     {
-        grfmt_tiff_err_handler_init = 1;
-
         TIFFSetErrorHandler( GrFmtSilentTIFFErrorHandler );
         TIFFSetWarningHandler( GrFmtSilentTIFFErrorHandler );
+        cvEndInitOnce( &grfmt_tiff_err_handler_init );
     }
 }
 
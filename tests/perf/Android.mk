@@ -0,0 +1,50 @@
+# Benchmarks and SIMD consistency checks, built as command line executables.
+# They are not part of APP_MODULES; build them with e.g.
+#   ndk-build APP_MODULES="perf_stereobm perf_mathfuncs perf_convert"
+# push them to the device and run them from adb shell.
+
+LOCAL_PATH := $(call my-dir)
+OPENCV_JNI_PATH := $(LOCAL_PATH)/../../jni
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE    := perf_stereobm
+LOCAL_C_INCLUDES := \
+        $(OPENCV_JNI_PATH)/cxcore/include \
+        $(OPENCV_JNI_PATH)/cv/include
+LOCAL_CFLAGS := $(LOCAL_C_INCLUDES:%=-I%)
+LOCAL_LDLIBS := -L$(SYSROOT)/usr/lib -ldl
+
+LOCAL_SRC_FILES := perf_stereobm.cpp
+
+LOCAL_STATIC_LIBRARIES := cv cxcore
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE    := perf_mathfuncs
+LOCAL_C_INCLUDES := \
+        $(OPENCV_JNI_PATH)/cxcore/include
+LOCAL_CFLAGS := $(LOCAL_C_INCLUDES:%=-I%)
+LOCAL_LDLIBS := -L$(SYSROOT)/usr/lib -ldl
+
+LOCAL_SRC_FILES := perf_mathfuncs.cpp
+
+LOCAL_STATIC_LIBRARIES := cxcore
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE    := perf_convert
+LOCAL_C_INCLUDES := \
+        $(OPENCV_JNI_PATH)/cxcore/include
+LOCAL_CFLAGS := $(LOCAL_C_INCLUDES:%=-I%)
+LOCAL_LDLIBS := -L$(SYSROOT)/usr/lib -ldl
+
+LOCAL_SRC_FILES := perf_convert.cpp
+
+LOCAL_STATIC_LIBRARIES := cxcore
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,328 @@
+/* cvConvertScale/cvConvertScaleAbs SIMD consistency check and benchmark.
+
+   1. Runs the depth pairs that have SIMD kernels (8u->16s, 8u->32f, 32f->8u,
+      abs 16s->8u) and 32f->16s over a set of scales/shifts, sizes, channel
+      counts and ROIs, with the scalar kernels (CV_DISPATCH_SCALAR) and with
+      the best SIMD kernels of the CPU, and requires identical results.
+      The only exception is 32f->8u on NEON, which scales in single precision:
+      there a difference of 1 is accepted where the exact value is within
+      float rounding of x.5.
+   2. Checks the rounding and the saturation of 32f->8u and 32f->16s against
+      a double precision reference (round half to even, like cvRound, then
+      saturate) on exact ties, their neighbor floats and out-of-range values,
+      with the same NEON exception for the neighbors of the ties. Also checks
+      the saturation of 8u->16s and abs 16s->8u. Values outside of the int
+      range are not tested, cvRound does not define them.
+   3. Times the pairs on 1920x1080 images.
+
+   The program returns non-zero when a check fails.
+
+   usage: perf_convert
+*/
+
+#include "cxcore.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+
+static int
+convert( const CvMat* src, CvMat* dst, double scale, double shift, int absmode )
+{
+    if( absmode )
+        cvConvertScaleAbs( src, dst, scale, shift );
+    else
+        cvConvertScale( src, dst, scale, shift );
+    return cvGetErrStatus() < 0;
+}
+
+/* the j-th value of the row i, whatever the channel count */
+static double
+element( const CvMat* m, int i, int j )
+{
+    const uchar* row = m->data.ptr + m->step*i;
+    int depth = CV_MAT_DEPTH(m->type);
+
+    return depth == CV_8U ? row[j] : depth == CV_16S ? ((const short*)row)[j] :
+           depth == CV_32F ? ((const float*)row)[j] : ((const int*)row)[j];
+}
+
+/* whether a 32f->8u result b may differ from a because the NEON kernel scales
+   in single precision: by 1, where v*scale + shift is within float rounding of x.5 */
+static int
+is_near_tie( double a, double b, double v, double scale, double shift )
+{
+    double t = v*scale + shift;
+    return fabs(a - b) == 1 && cvCheckHardwareSupport( CV_CPU_NEON ) &&
+           fabs( t - floor(t) - 0.5 ) <= 1e-6*(fabs(v*scale) + fabs(shift) + 1);
+}
+
+static int
+compare_modes( int sdepth, int ddepth, int cn, int w, int h, int roi,
+               double scale, double shift, int absmode, int* near_ties )
+{
+    CvRNG rng = cvRNG( w*131 + h + cn );
+    CvMat* big = cvCreateMat( h + 4, w + 6, CV_MAKETYPE(sdepth, cn) );
+    CvMat stub, *src;
+    CvMat *d0, *d1;
+    int i, j, diffs = 0;
+
+    if( sdepth == CV_32F )
+    {
+        cvRandArr( &rng, big, CV_RAND_UNI, cvScalarAll(-300), cvScalarAll(300) );
+        // inject exact ties
+        for( i = 0; i < big->rows; i++ )
+        {
+            float* p = (float*)(big->data.ptr + big->step*i);
+            for( j = i % 7; j < big->cols*cn; j += 7 )
+                p[j] = floorf(p[j]) + 0.5f;
+        }
+    }
+    else if( sdepth == CV_16S )
+        cvRandArr( &rng, big, CV_RAND_UNI, cvScalarAll(-32768), cvScalarAll(32768) );
+    else
+        cvRandArr( &rng, big, CV_RAND_UNI, cvScalarAll(0), cvScalarAll(256) );
+
+    if( roi )
+        src = cvGetSubRect( big, &stub, cvRect( 3, 2, w, h ));
+    else
+        src = big;
+
+    d0 = cvCreateMat( src->rows, src->cols, CV_MAKETYPE(ddepth, cn) );
+    d1 = cvCloneMat( d0 );
+
+    cvSetDispatchMode( CV_DISPATCH_SCALAR );
+    convert( src, d0, scale, shift, absmode );
+    cvSetDispatchMode( CV_DISPATCH_AUTO );
+    convert( src, d1, scale, shift, absmode );
+
+    for( i = 0; i < d0->rows; i++ )
+        for( j = 0; j < d0->cols*cn; j++ )
+        {
+            double a = element( d0, i, j ), b = element( d1, i, j );
+
+            if( a == b )
+                continue;
+            if( sdepth == CV_32F && ddepth == CV_8U &&
+                is_near_tie( a, b, element( src, i, j ), scale, shift ))
+                (*near_ties)++;
+            else if( ddepth == CV_32F && fabs(a - b) <= 1e-6*fabs(a) )
+                ;
+            else
+                diffs++;
+        }
+
+    if( diffs )
+        printf( "  FAILED: depth %d->%d%s, %d channel(s), %dx%d%s, scale %g, shift %g: "
+                "%d differences\n", sdepth, ddepth, absmode ? " (abs)" : "", cn, w, h,
+                roi ? " ROI" : "", scale, shift, diffs );
+
+    cvReleaseMat( &d0 );
+    cvReleaseMat( &d1 );
+    cvReleaseMat( &big );
+
+    return diffs != 0;
+}
+
+/* round half to even, then saturate */
+static double
+reference( double v, double lo, double hi )
+{
+    double r = floor(v), f = v - r;
+    if( f > 0.5 || (f == 0.5 && fmod( r, 2. ) != 0) )
+        r += 1;
+    return r < lo ? lo : r > hi ? hi : r;
+}
+
+static int
+check_32f_rounding( int ddepth, double scale, double shift, int* near_ties )
+{
+    double lo = ddepth == CV_8U ? 0 : -32768, hi = ddepth == CV_8U ? 255 : 32767;
+    float buf[4096];
+    int i, k, n = 0, mode, errors = 0;
+    CvMat src, *dst;
+
+    // the ties and their neighbors over the whole range and a bit beyond it,
+    // expressed as inputs of v*scale + shift
+    for( k = (int)lo - 3; k <= (int)hi + 3 && n < 4096 - 32;
+         k += ddepth == CV_8U ? 1 : 97 )
+    {
+        float t = (float)((k + 0.5 - shift)/scale);
+        buf[n++] = t;
+        buf[n++] = nextafterf( t, -FLT_MAX );
+        buf[n++] = nextafterf( t, FLT_MAX );
+        buf[n++] = (float)((k - shift)/scale);
+    }
+    {
+        static const double special[] = { -1e9, -65536.5, -32768.5, -32767.5, -256.5,
+            -1.5, -0.5, -0.49, -0., 0., 0.49, 0.5, 1.5, 2.5, 254.5, 255.49, 255.5, 256,
+            32766.5, 32767.49, 32767.5, 32768, 65535.5, 1e9 };
+        for( i = 0; i < (int)(sizeof(special)/sizeof(special[0])); i++ )
+            buf[n++] = (float)((special[i] - shift)/scale);
+    }
+
+    src = cvMat( 1, n, CV_32FC1, buf );
+    dst = cvCreateMat( 1, n, CV_MAKETYPE(ddepth, 1) );
+
+    for( mode = 0; mode < 2; mode++ )
+    {
+        int bad = 0;
+        cvSetDispatchMode( mode == 0 ? CV_DISPATCH_SCALAR : CV_DISPATCH_AUTO );
+        convert( &src, dst, scale, shift, 0 );
+        for( i = 0; i < n; i++ )
+        {
+            double r = reference( buf[i]*scale + shift, lo, hi );
+            double v = cvGetReal1D( dst, i );
+            if( mode == 1 && ddepth == CV_8U && is_near_tie( r, v, buf[i], scale, shift ))
+                (*near_ties)++;
+            else if( v != r )
+            {
+                if( bad++ < 5 )
+                    printf( "  FAILED: 32f->%s, %s kernel, scale %g, shift %g: "
+                            "%.9g -> %g instead of %g\n", ddepth == CV_8U ? "8u" : "16s",
+                            mode == 0 ? "scalar" : "SIMD", scale, shift, buf[i], v, r );
+            }
+        }
+        errors += bad != 0;
+    }
+    cvSetDispatchMode( CV_DISPATCH_AUTO );
+
+    cvReleaseMat( &dst );
+    return errors;
+}
+
+/* 8u->16s and abs 16s->8u on the values that saturate */
+static int
+check_int_saturation( void )
+{
+    uchar src8u[256];
+    short src16s[64], dst16s[256];
+    uchar dst8u[64];
+    int i, mode, errors = 0;
+    CvMat s8 = cvMat( 1, 256, CV_8UC1, src8u ), d16 = cvMat( 1, 256, CV_16SC1, dst16s );
+    CvMat s16 = cvMat( 1, 64, CV_16SC1, src16s ), d8 = cvMat( 1, 64, CV_8UC1, dst8u );
+
+    for( i = 0; i < 256; i++ )
+        src8u[i] = (uchar)i;
+    for( i = 0; i < 64; i++ )
+        src16s[i] = (short)(i < 32 ? -32768 + i*97 : 32767 - (i - 32)*97);
+    src16s[5] = -256; src16s[6] = 255; src16s[7] = 256; src16s[8] = -255; src16s[9] = 0;
+
+    for( mode = 0; mode < 2; mode++ )
+    {
+        cvSetDispatchMode( mode == 0 ? CV_DISPATCH_SCALAR : CV_DISPATCH_AUTO );
+
+        // 8u->16s with the integer scale and shift of the fixed-point path
+        cvConvertScale( &s8, &d16, 200, -30000 );
+        for( i = 0; i < 256; i++ )
+            errors += dst16s[i] != (short)MIN( MAX( i*200 - 30000, -32768 ), 32767 );
+        cvConvertScale( &s8, &d16, -300, 100 );
+        for( i = 0; i < 256; i++ )
+            errors += dst16s[i] != (short)MIN( MAX( i*-300 + 100, -32768 ), 32767 );
+
+        // abs 16s->8u with the plain and a fractional scale
+        cvConvertScaleAbs( &s16, &d8, 1, 0 );
+        for( i = 0; i < 64; i++ )
+            errors += dst8u[i] != (uchar)MIN( abs(src16s[i]), 255 );
+        cvConvertScaleAbs( &s16, &d8, 0.25, 0 );
+        for( i = 0; i < 64; i++ )
+            errors += dst8u[i] != (uchar)reference( fabs( src16s[i]*0.25 ), 0, 255 );
+    }
+    cvSetDispatchMode( CV_DISPATCH_AUTO );
+
+    if( errors )
+        printf( "  FAILED: 8u->16s/abs 16s->8u saturation, %d errors\n", errors );
+    return errors != 0;
+}
+
+static double
+time_convert( const CvMat* src, CvMat* dst, double scale, double shift, int absmode )
+{
+    double best = DBL_MAX;
+    int r;
+
+    for( r = 0; r < 30; r++ )
+    {
+        int64 t = cvGetTickCount();
+        convert( src, dst, scale, shift, absmode );
+        t = cvGetTickCount() - t;
+        best = MIN( best, t/(cvGetTickFrequency()*1000.) );
+    }
+    return best;
+}
+
+int
+main( int, char** )
+{
+    static const double scales[][2] = { {1, 0}, {2, -128}, {-1, 255}, {0.5, 0}, {1/255., 0},
+        {255, 0}, {0.25, 10}, {3.7, -1.3}, {1e-3, 0}, {40000, 0}, {-0.125, 0.5}, {1, 0.5},
+        {15/32768., 0}, {1, -40000}, {128, 0} };
+    static const int sizes[][2] = { {1, 1}, {7, 3}, {17, 5}, {33, 2}, {640, 480}, {1920, 1080} };
+    static const int pairs[][3] = { {CV_8U, CV_16S, 0}, {CV_8U, CV_32F, 0}, {CV_32F, CV_8U, 0},
+        {CV_32F, CV_16S, 0}, {CV_16S, CV_8U, 1} };
+    static const struct { int sdepth, ddepth, absmode; double scale, shift; const char* name; }
+    bench[] = {
+        { CV_8U, CV_16S, 0, 1, 0, "8u->16s" },
+        { CV_8U, CV_16S, 0, 2, -128, "8u->16s *2-128" },
+        { CV_8U, CV_32F, 0, 1, 0, "8u->32f" },
+        { CV_8U, CV_32F, 0, 1/255., 0, "8u->32f /255" },
+        { CV_32F, CV_8U, 0, 1, 0, "32f->8u" },
+        { CV_32F, CV_8U, 0, 255, 0, "32f->8u *255" },
+        { CV_16S, CV_8U, 1, 1, 0, "abs 16s->8u" },
+        { CV_16S, CV_8U, 1, 0.25, 0, "abs 16s->8u *0.25" } };
+    int p, s, z, cn, roi, i, ncases = 0, errors = 0, near_ties = 0;
+    CvRNG rng = cvRNG(1);
+
+    printf( "SIMD vs scalar:\n" );
+    for( p = 0; p < (int)(sizeof(pairs)/sizeof(pairs[0])); p++ )
+        for( s = 0; s < (int)(sizeof(scales)/sizeof(scales[0])); s++ )
+            for( z = 0; z < (int)(sizeof(sizes)/sizeof(sizes[0])); z++ )
+                for( cn = 1; cn <= 3; cn += 2 )
+                    for( roi = 0; roi < 2; roi++, ncases++ )
+                        errors += compare_modes( pairs[p][0], pairs[p][1], cn,
+                                                 sizes[z][0], sizes[z][1], roi,
+                                                 scales[s][0], scales[s][1],
+                                                 pairs[p][2], &near_ties );
+    printf( "  %d cases, %d failed, %d single precision tie difference(s)\n",
+            ncases, errors, near_ties );
+
+    printf( "rounding and saturation:\n" );
+    near_ties = 0;
+    {
+        int e = check_32f_rounding( CV_8U, 1, 0, &near_ties ) +
+                check_32f_rounding( CV_8U, 2, 0.5, &near_ties ) +
+                check_32f_rounding( CV_8U, 0.25, -3, &near_ties ) +
+                check_32f_rounding( CV_16S, 1, 0, &near_ties ) +
+                check_32f_rounding( CV_16S, 4, 0.25, &near_ties ) +
+                check_32f_rounding( CV_16S, 0.5, 1, &near_ties ) +
+                check_int_saturation();
+        printf( "  %s, %d single precision tie difference(s)\n",
+                e ? "FAILED" : "passed", near_ties );
+        errors += e;
+    }
+
+    printf( "1920x1080, best of 30 runs:\n" );
+    for( i = 0; i < (int)(sizeof(bench)/sizeof(bench[0])); i++ )
+    {
+        CvMat* src = cvCreateMat( 1080, 1920, bench[i].sdepth );
+        CvMat* dst = cvCreateMat( 1080, 1920, bench[i].ddepth );
+        double t0, t1;
+
+        cvRandArr( &rng, src, CV_RAND_UNI,
+                   cvScalarAll( bench[i].sdepth == CV_16S ? -1000 : 0 ),
+                   cvScalarAll( bench[i].sdepth == CV_32F ? 1 :
+                                bench[i].sdepth == CV_16S ? 1000 : 256 ));
+        cvSetDispatchMode( CV_DISPATCH_SCALAR );
+        t0 = time_convert( src, dst, bench[i].scale, bench[i].shift, bench[i].absmode );
+        cvSetDispatchMode( CV_DISPATCH_AUTO );
+        t1 = time_convert( src, dst, bench[i].scale, bench[i].shift, bench[i].absmode );
+        printf( "  %-20s scalar %6.2f ms  SIMD %6.2f ms  (x%.1f)\n",
+                bench[i].name, t0, t1, t0/t1 );
+
+        cvReleaseMat( &src );
+        cvReleaseMat( &dst );
+    }
+
+    printf( "%s\n", errors ? "FAILED" : "passed" );
+    return errors != 0;
+}
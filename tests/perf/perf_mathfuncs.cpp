@@ -0,0 +1,277 @@
+/* CV_MATH_FAST accuracy check and benchmark.
+
+   Measures the error of cvExp, cvLog, cvPow and cvCartToPolar on 32f arrays
+   in ulp against double precision references, both with the best SIMD
+   kernels of the CPU and with the scalar kernels (CV_DISPATCH_SCALAR),
+   and fails when an error exceeds the documented bound:
+
+     exp, log        1 ulp for normalized results
+     pow             2 + 3*|power*log(x)| ulp, which is what the precise
+                     mode gives too: the rounding error of power*log(x)
+                     is amplified by exp
+     cartToPolar     3 ulp for the magnitude, 0.3 degree for the angle
+
+   Then times the functions on 16K-element arrays in CV_MATH_PRECISE mode
+   and in CV_MATH_FAST mode with the SIMD and with the scalar kernels.
+
+   usage: perf_mathfuncs [-exhaustive]
+     -exhaustive    checks exp and log on every float of their normalized
+                    range instead of 1M random values (takes minutes)
+*/
+
+#include "cxcore.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#define N (1 << 20)
+#define BENCH_N (1 << 14)
+
+static float a[N], b[N], c[N], d[N];
+
+/* the error of r in the units in the last place of the correctly rounded ref */
+static double
+ulp_error( float r, double ref )
+{
+    float fr = (float)ref, u;
+
+    if( fabs(ref) > FLT_MAX || fabs(fr) > FLT_MAX )
+        return fabs(r) > FLT_MAX && (r > 0) == (ref > 0) ? 0 : DBL_MAX;
+    if( fabs(ref) < FLT_MIN )
+        return fabs(r - ref)/1.4012984643e-45;
+    u = nextafterf( fabsf(fr), FLT_MAX ) - fabsf(fr);
+    return fabs(r - ref)/u;
+}
+
+static int
+check( const char* name, double err, double bound )
+{
+    printf( "  %-28s %8.3f%s\n", name, err, err <= bound ? "" : "  FAILED" );
+    return err <= bound ? 0 : 1;
+}
+
+static int
+check_exp_log( CvRNG* rng )
+{
+    CvMat A = cvMat( 1, N, CV_32FC1, a ), C = cvMat( 1, N, CV_32FC1, c );
+    double err = 0;
+    int i, errors = 0;
+
+    // normalized results only, the denormal ones are flushed to 0
+    for( i = 0; i < N; i++ )
+        a[i] = (float)(cvRandReal(rng)*(88.72 + 87.33) - 87.33);
+    a[0] = 88.72283f; a[1] = -87.33f; a[2] = 0.f;
+    cvExp( &A, &C );
+    for( i = 0; i < N; i++ )
+        err = MAX( err, ulp_error( c[i], exp((double)a[i]) ));
+    errors += check( "exp, ulp", err, 1 );
+
+    a[0] = 88.7229f; a[1] = 1000.f; a[2] = -1000.f;
+    cvExp( &A, &C );
+    errors += check( "exp overflow/underflow",
+                     c[0] == c[1] && c[1] > FLT_MAX && c[2] == 0 ? 0 : 1, 0 );
+
+    for( i = 0; i < N; i++ )
+        a[i] = (float)exp( cvRandReal(rng)*(88.72 + 87.33) - 87.33 );
+    a[0] = 1.f; a[1] = FLT_MIN; a[2] = FLT_MAX;
+    cvLog( &A, &C );
+    for( i = 0, err = 0; i < N; i++ )
+        err = MAX( err, ulp_error( c[i], log((double)a[i]) ));
+    errors += check( "log, ulp", err, 1 );
+
+    return errors;
+}
+
+static int
+check_pow( CvRNG* rng )
+{
+    static const double powers[] = { 2.7, -0.37, 0.5001, 13.3, -3.5 };
+    CvMat A = cvMat( 1, N, CV_32FC1, a ), C = cvMat( 1, N, CV_32FC1, c );
+    double worst = 0;
+    int i, k, errors = 0;
+
+    for( k = 0; k < (int)(sizeof(powers)/sizeof(powers[0])); k++ )
+    {
+        double p = powers[k];
+
+        // keep the results within the float range
+        for( i = 0; i < N; i++ )
+            a[i] = (float)exp( (cvRandReal(rng)*2 - 1)*MIN( 80/fabs(p), 85. ));
+        cvPow( &A, &C, p );
+        for( i = 0; i < N; i++ )
+        {
+            double y = fabs( p*log((double)a[i]) );
+            worst = MAX( worst, ulp_error( c[i], pow((double)a[i], p) ) - 2 - 3*y );
+        }
+    }
+    errors += check( "pow, ulp above bound", MAX( worst, 0 ), 0 );
+
+    return errors;
+}
+
+static int
+check_cart_to_polar( CvRNG* rng )
+{
+    CvMat A = cvMat( 1, N, CV_32FC1, a ), B = cvMat( 1, N, CV_32FC1, b );
+    CvMat C = cvMat( 1, N, CV_32FC1, c ), D = cvMat( 1, N, CV_32FC1, d );
+    double merr = 0, aerr = 0;
+    int i, errors = 0, mismatches = 0;
+
+    for( i = 0; i < N; i++ )
+    {
+        a[i] = (float)(cvRandReal(rng)*2 - 1);
+        b[i] = (float)(cvRandReal(rng)*2 - 1);
+    }
+    a[0] = b[0] = 0;
+    cvCartToPolar( &A, &B, &C, &D, 1 );
+    for( i = 1; i < N; i++ )
+    {
+        double angle = atan2( (double)b[i], (double)a[i] )*180/CV_PI, e;
+        if( angle < 0 )
+            angle += 360;
+        e = fabs( d[i] - angle );
+        aerr = MAX( aerr, MIN( e, 360 - e ));
+        merr = MAX( merr, ulp_error( c[i], sqrt( (double)a[i]*a[i] + (double)b[i]*b[i] )));
+    }
+    errors += check( "cartToPolar magnitude, ulp", merr, 3 );
+    errors += check( "cartToPolar angle, degrees", aerr, 0.3 );
+
+    // in-place: the magnitude over x and the angle over y
+    cvCartToPolar( &A, &B, &A, &B, 1 );
+    for( i = 0; i < N; i++ )
+        mismatches += a[i] != c[i] || b[i] != d[i];
+    errors += check( "cartToPolar in-place", mismatches, 0 );
+
+    return errors;
+}
+
+/* exp and log on every float of their normalized range */
+static int
+check_exhaustive( void )
+{
+    CvMat A, C;
+    double eerr = 0, lerr = 0;
+    unsigned u = 0;
+    int i, n, errors = 0;
+
+    do
+    {
+        Cv32suf s;
+
+        for( i = n = 0; i < N; i++ )
+        {
+            s.u = u + i;
+            if( s.f >= -87.33f && s.f <= 88.72f )
+                a[n++] = s.f;
+        }
+        if( n > 0 )
+        {
+            A = cvMat( 1, n, CV_32FC1, a );
+            C = cvMat( 1, n, CV_32FC1, c );
+            cvExp( &A, &C );
+            for( i = 0; i < n; i++ )
+                eerr = MAX( eerr, ulp_error( c[i], exp((double)a[i]) ));
+        }
+
+        for( i = n = 0; i < N; i++ )
+        {
+            s.u = u + i;
+            if( s.i >= 0x00800000 && s.i < 0x7f800000 )
+                a[n++] = s.f;
+        }
+        if( n > 0 )
+        {
+            A = cvMat( 1, n, CV_32FC1, a );
+            C = cvMat( 1, n, CV_32FC1, c );
+            cvLog( &A, &C );
+            for( i = 0; i < n; i++ )
+                lerr = MAX( lerr, ulp_error( c[i], log((double)a[i]) ));
+        }
+        u += N;
+    }
+    while( u != 0 );
+
+    errors += check( "exp, all floats, ulp", eerr, 1 );
+    errors += check( "log, all floats, ulp", lerr, 1 );
+    return errors;
+}
+
+static double
+ns_per_element( int func )
+{
+    CvMat A = cvMat( 1, BENCH_N, CV_32FC1, a ), B = cvMat( 1, BENCH_N, CV_32FC1, b );
+    CvMat C = cvMat( 1, BENCH_N, CV_32FC1, c ), D = cvMat( 1, BENCH_N, CV_32FC1, d );
+    double best = DBL_MAX;
+    int r, i;
+
+    for( r = 0; r < 200; r++ )
+    {
+        int64 t = cvGetTickCount();
+        for( i = 0; i < 10; i++ )
+        {
+            if( func == 0 )
+                cvExp( &B, &C );
+            else if( func == 1 )
+                cvLog( &A, &C );
+            else if( func == 2 )
+                cvPow( &A, &C, 1.7 );
+            else
+                cvCartToPolar( &A, &B, &C, &D, 1 );
+        }
+        t = cvGetTickCount() - t;
+        best = MIN( best, t*1000./(cvGetTickFrequency()*10*BENCH_N) );
+    }
+
+    return best;
+}
+
+int
+main( int argc, char** argv )
+{
+    static const char* names[] = { "exp", "log", "pow", "cartToPolar" };
+    static const char* modes[] = { "precise", "fast", "fast, scalar" };
+    int exhaustive = argc > 1 && strcmp( argv[1], "-exhaustive" ) == 0;
+    int i, k, errors = 0;
+
+    cvSetMathMode( CV_MATH_FAST );
+    for( k = 0; k < 2; k++ )
+    {
+        CvRNG rng = cvRNG(3);
+        cvSetDispatchMode( k == 0 ? CV_DISPATCH_AUTO : CV_DISPATCH_SCALAR );
+        printf( "CV_MATH_FAST, %s kernels:\n", k == 0 ? "SIMD" : "scalar" );
+        errors += check_exp_log( &rng );
+        errors += check_pow( &rng );
+        errors += check_cart_to_polar( &rng );
+        if( exhaustive )
+            errors += check_exhaustive();
+    }
+
+    {
+        CvRNG rng = cvRNG(5);
+        for( i = 0; i < BENCH_N; i++ )
+        {
+            a[i] = (float)(cvRandReal(&rng)*10 + 0.01);
+            b[i] = (float)(cvRandReal(&rng)*20 - 10);
+        }
+    }
+
+    printf( "\n%d-element 32f arrays, ns per element:\n%-14s", BENCH_N, "" );
+    for( i = 0; i < 4; i++ )
+        printf( "%12s", names[i] );
+    printf( "\n" );
+    for( k = 0; k < 3; k++ )
+    {
+        cvSetMathMode( k == 0 ? CV_MATH_PRECISE : CV_MATH_FAST );
+        cvSetDispatchMode( k == 2 ? CV_DISPATCH_SCALAR : CV_DISPATCH_AUTO );
+        printf( "%-14s", modes[k] );
+        for( i = 0; i < 4; i++ )
+            printf( "%12.2f", ns_per_element( i ));
+        printf( "\n" );
+    }
+    cvSetMathMode( CV_MATH_PRECISE );
+    cvSetDispatchMode( CV_DISPATCH_AUTO );
+
+    printf( "\n%s\n", errors ? "FAILED" : "passed" );
+    return errors != 0;
+}
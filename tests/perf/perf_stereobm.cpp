@@ -0,0 +1,179 @@
+/* Block-matching stereo benchmark and consistency check.
+
+   Builds a synthetic rectified pair with a known disparity map (a textured
+   background plane and a closer rectangle), then times
+   cvFindStereoCorrespondenceBM with the scalar kernels (CV_DISPATCH_SCALAR)
+   and with the best SIMD kernel of the CPU (CV_DISPATCH_AUTO), on one thread
+   and on all threads, and cvUpdateStereoCorrespondenceBM for a small changed
+   rectangle.
+
+   The SIMD and threaded results must be identical to the single-threaded
+   scalar ones; the program returns non-zero when they are not.
+
+   usage: perf_stereobm [width height [ndisparities [iterations]]]
+*/
+
+#include "cv.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+
+/* the background plane is seen at disparity ndisp/4, a rectangle in front
+   of it at ndisp*3/4; each surface has its own texture */
+static void
+make_pair( CvMat* left, CvMat* right, CvMat* truth, int ndisp )
+{
+    CvRNG rng = cvRNG(-1);
+    int x, y, w = left->cols, h = left->rows;
+    int d0 = ndisp/4, d1 = ndisp*3/4;
+    CvMat* back = cvCreateMat( h, w + ndisp, CV_8UC1 );
+    CvMat* front = cvCreateMat( h, w + ndisp, CV_8UC1 );
+
+    cvRandArr( &rng, back, CV_RAND_UNI, cvScalarAll(0), cvScalarAll(256) );
+    cvRandArr( &rng, front, CV_RAND_UNI, cvScalarAll(0), cvScalarAll(256) );
+    cvSmooth( back, back, CV_GAUSSIAN, 3, 3 );
+    cvSmooth( front, front, CV_GAUSSIAN, 3, 3 );
+
+    for( y = 0; y < h; y++ )
+    {
+        const uchar* b = back->data.ptr + y*back->step + ndisp;
+        const uchar* f = front->data.ptr + y*front->step + ndisp;
+        uchar* l = left->data.ptr + y*left->step;
+        uchar* r = right->data.ptr + y*right->step;
+        uchar* g = truth->data.ptr + y*truth->step;
+        int inside_y = y >= h/4 && y < h*3/4;
+
+        // the point seen at x in the left view is seen at x - d in the right one
+        for( x = 0; x < w; x++ )
+        {
+            int in_front = inside_y && x >= w/4 && x < w*3/4;
+            l[x] = in_front ? f[x - d1] : b[x - d0];
+            g[x] = (uchar)(in_front ? d1 : d0);
+            r[x] = inside_y && x + d1 >= w/4 && x + d1 < w*3/4 ? f[x] : b[x];
+        }
+    }
+
+    cvReleaseMat( &back );
+    cvReleaseMat( &front );
+}
+
+static double
+run_bm( const CvMat* left, const CvMat* right, CvMat* disp,
+        CvStereoBMState* state, int iterations, const CvRect* roi )
+{
+    double best = DBL_MAX;
+    int i;
+
+    for( i = 0; i < iterations; i++ )
+    {
+        int64 t = cvGetTickCount();
+        if( roi )
+            cvUpdateStereoCorrespondenceBM( left, right, disp, state, *roi );
+        else
+            cvFindStereoCorrespondenceBM( left, right, disp, state );
+        t = cvGetTickCount() - t;
+        best = MIN( best, t/(cvGetTickFrequency()*1000.) );
+    }
+
+    return best;
+}
+
+static int
+count_diff( const CvMat* a, const CvMat* b )
+{
+    CvMat* mask = cvCreateMat( a->rows, a->cols, CV_8UC1 );
+    int n;
+
+    cvCmp( a, b, mask, CV_CMP_NE );
+    n = cvCountNonZero( mask );
+    cvReleaseMat( &mask );
+    return n;
+}
+
+/* the share of the pixels with a valid disparity within 1 of the truth */
+static double
+accuracy( const CvMat* disp, const CvMat* truth, int min_disp )
+{
+    int x, y, good = 0, valid = 0;
+
+    for( y = 0; y < disp->rows; y++ )
+    {
+        const short* d = (const short*)(disp->data.ptr + y*disp->step);
+        const uchar* g = truth->data.ptr + y*truth->step;
+        for( x = 0; x < disp->cols; x++ )
+        {
+            if( d[x] < (min_disp - 1)*16 )
+                continue;
+            valid++;
+            good += abs( d[x] - g[x]*16 ) <= 16;
+        }
+    }
+
+    return valid ? (double)good/valid : 0;
+}
+
+int
+main( int argc, char** argv )
+{
+    int w = argc > 2 ? atoi(argv[1]) : 640;
+    int h = argc > 2 ? atoi(argv[2]) : 480;
+    int ndisp = argc > 3 ? atoi(argv[3]) : 64;
+    int iterations = argc > 4 ? atoi(argv[4]) : 10;
+    int nthreads = cvGetNumThreads();
+    int errors = 0;
+    double t_scalar, t_simd, t_simd_mt, t_update;
+    CvRect roi = cvRect( w/2 - 16, h/2 - 16, 32, 32 );
+
+    CvMat* left = cvCreateMat( h, w, CV_8UC1 );
+    CvMat* right = cvCreateMat( h, w, CV_8UC1 );
+    CvMat* truth = cvCreateMat( h, w, CV_8UC1 );
+    CvMat* ref = cvCreateMat( h, w, CV_16SC1 );
+    CvMat* disp = cvCreateMat( h, w, CV_16SC1 );
+    CvStereoBMState* state = cvCreateStereoBMState( CV_STEREO_BM_BASIC, ndisp );
+
+    make_pair( left, right, truth, ndisp );
+
+    printf( "%dx%d, %d disparities, SAD window %d, best of %d runs\n",
+            w, h, ndisp, state->SADWindowSize, iterations );
+
+    cvSetNumThreads( 1 );
+    cvSetDispatchMode( CV_DISPATCH_SCALAR );
+    t_scalar = run_bm( left, right, ref, state, iterations, 0 );
+
+    cvSetDispatchMode( CV_DISPATCH_AUTO );
+    t_simd = run_bm( left, right, disp, state, iterations, 0 );
+    errors += count_diff( ref, disp );
+
+    cvSetNumThreads( nthreads );
+    t_simd_mt = run_bm( left, right, disp, state, iterations, 0 );
+    errors += count_diff( ref, disp );
+
+    // a change inside roi: the update must give what a full run gives
+    {
+        CvMat sub;
+        cvGetSubRect( left, &sub, roi );
+        cvNot( &sub, &sub );
+    }
+    t_update = run_bm( left, right, disp, state, iterations, &roi );
+    cvSetNumThreads( 1 );
+    cvSetDispatchMode( CV_DISPATCH_SCALAR );
+    run_bm( left, right, ref, state, 1, 0 );
+    errors += count_diff( ref, disp );
+    cvSetDispatchMode( CV_DISPATCH_AUTO );
+
+    printf( "scalar, 1 thread      %8.2f ms\n", t_scalar );
+    printf( "SIMD, 1 thread        %8.2f ms  (x%.2f)\n", t_simd, t_scalar/t_simd );
+    printf( "SIMD, %d thread(s)     %8.2f ms  (x%.2f)\n", nthreads, t_simd_mt, t_scalar/t_simd_mt );
+    printf( "update of a 32x32 ROI %8.2f ms  (x%.2f)\n", t_update, t_simd_mt/t_update );
+    printf( "within 1px of truth   %8.2f %%\n", accuracy( ref, truth, state->minDisparity )*100 );
+    printf( "%s: %d differing pixel(s)\n", errors ? "FAILED" : "passed", errors );
+
+    cvReleaseStereoBMState( &state );
+    cvReleaseMat( &left );
+    cvReleaseMat( &right );
+    cvReleaseMat( &truth );
+    cvReleaseMat( &ref );
+    cvReleaseMat( &disp );
+
+    return errors != 0;
+}